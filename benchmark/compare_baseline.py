@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Сравнение результатов бенчмарков с базовым прогоном.
+
+Оба файла - JSON-вывод Google Benchmark (--benchmark_out=... --benchmark_out_format=json).
+Время и счётчики, где меньше - лучше (bytes_per_book, allocs_*), сравниваются отношением current / baseline,
+items_per_second - обратным отношением. Изменение больше порога помечается как регрессия или улучшение.
+Код возврата 1, если есть хотя бы одна регрессия.
+
+Оба файла стоит снимать с повторами (--benchmark_repetitions), тогда сравниваются медианы.
+baseline.json снят так на виртуальной машине с 1 CPU: код собран с -O2 -DNDEBUG, поле library_build_type
+относится к системной сборке Google Benchmark. Медианы двух прогонов подряд на этой машине расходились
+на 5-25%, отдельные бенчмарки - до 43%, поэтому порог по умолчанию 50%: он ловит только грубые регрессии.
+Многопоточные варианты на одном ядре не показывают масштабирование. На другой машине, особенно многоядерной,
+baseline.json нужно перезаписать тем же способом, оценить разброс двумя прогонами и задать --threshold
+чуть выше него.
+
+    BOOKDB_WORKLOAD_ROWS=1000000 ./BookDB_benchmark --benchmark_filter=Workload --benchmark_repetitions=5 \\
+        --benchmark_out=current.json --benchmark_out_format=json
+    python3 benchmark/compare_baseline.py benchmark/baseline.json current.json
+"""
+
+import argparse
+import json
+import sys
+
+TIME_UNITS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+LOWER_IS_BETTER = ("bytes_per_book", "allocs_per_op", "allocs_per_insert")
+HIGHER_IS_BETTER = ("items_per_second",)
+
+
+def load(path, metric):
+    with open(path, encoding="utf-8") as file:
+        data = json.load(file)
+    runs = data.get("benchmarks", [])
+    # При --benchmark_repetitions сравниваются только медианы: они устойчивее средних к выбросам
+    has_aggregates = any(run.get("run_type") == "aggregate" for run in runs)
+    if not has_aggregates:
+        print(f"warning: {path} has no repetitions, single runs are compared", file=sys.stderr)
+    result = {}
+    for run in runs:
+        if has_aggregates:
+            if run.get("aggregate_name") != "median":
+                continue
+            name = run["run_name"]
+        else:
+            name = run["name"]
+        values = {"time": run[metric] * TIME_UNITS[run.get("time_unit", "ns")]}
+        for counter in LOWER_IS_BETTER + HIGHER_IS_BETTER:
+            if counter in run:
+                values[counter] = run[counter]
+        result[name] = values
+    return result
+
+
+def compare(baseline, current, threshold):
+    regressions = 0
+    rows = []
+    for name in baseline:
+        if name not in current:
+            continue
+        for key, old in baseline[name].items():
+            new = current[name].get(key)
+            if new is None or old <= 0 or new <= 0:
+                continue
+            # ratio > 1 - стало хуже независимо от направления метрики
+            ratio = old / new if key in HIGHER_IS_BETTER else new / old
+            if ratio > 1 + threshold:
+                status = "REGRESSION"
+                regressions += 1
+            elif ratio < 1 - threshold:
+                status = "improvement"
+            else:
+                continue
+            rows.append((name, key, old, new, ratio, status))
+    return rows, regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.50, help="допустимое относительное изменение")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+    rows, regressions = compare(baseline, current, args.threshold)
+
+    for name, key, old, new, ratio, status in rows:
+        unit = " ns" if key == "time" else ""
+        print(f"{status:<11} {name:<55} {key:<17} {old:>14.4g}{unit} -> {new:.4g}{unit} (x{ratio:.2f})")
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"missing     {name}")
+    for name in sorted(current.keys() - baseline.keys()):
+        print(f"new         {name}")
+
+    compared = len(baseline.keys() & current.keys())
+    print(f"{compared} benchmarks compared, {regressions} regressions (threshold {args.threshold:.0%})")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,22 +1,53 @@
+// Счётчики кучи (allocs_per_insert, bytes_per_book): перехватчики operator new из memory_stats.hpp
+#define BOOKDB_DEFINE_ALLOCATION_HOOKS
+#include "memory_stats.hpp"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <benchmark/benchmark.h>
 #include <boost/container/flat_map.hpp>
 #include <cstddef>
 #include <cstdlib>
 #include <deque>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
 #include <random>
 #include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "book.hpp"
 #include "book_database.hpp"
+#include "book_snapshot.hpp"
+#include "book_sort.hpp"
+#include "book_view.hpp"
+#include "bulk_loader.hpp"
+#include "columnar_book_database.hpp"
 #include "comparators.hpp"
+#include "compact_book_database.hpp"
 #include "concepts.hpp"
+#include "concurrent_book_database.hpp"
+#include "durable_book_database.hpp"
 #include "filters.hpp"
+#include "group_by.hpp"
+#include "memory_policy.hpp"
+#include "query_planner.hpp"
+#include "query_profiler.hpp"
+#include "sharded_book_database.hpp"
+#include "sketches.hpp"
 #include "statsistics.hpp"
+#include "text_search.hpp"
+#include "thread_pool.hpp"
+#include "workload.hpp"
 
 using benchmark::DoNotOptimize;
 using namespace bookdb;
@@ -63,40 +94,68 @@ const std::span<Book_data> generateData(size_t N) {
     return newIt->second;
 }
 
-template <BookContainerLike Cont>
+template <BookContainerLike Cont, MemoryPolicyLike Policy = HeapMemoryPolicy>
 static void BM_PushBack(benchmark::State &state) {
     int count = state.range(0);
     auto data = generateData(count);
 
+    size_t allocations = 0;
     for (auto _ : state) {
         {
-            BookDatabase<Cont> cont;
-            for (auto v : data) {
+            AllocationScope scope;
+            BookDatabase<Cont, Policy> cont;
+            for (const auto &v : data) {
                 cont.PushBack(Book{v.author, v.title, v.year, v.genre, v.rating, v.read_count});
             }
+            allocations += scope.Delta().allocations;
 
             state.PauseTiming();
         }
         state.ResumeTiming();
     }
+    state.counters["allocs_per_insert"] =
+        static_cast<double>(allocations) / static_cast<double>(state.iterations() * data.size());
 }
 
-template <BookContainerLike Cont>
+template <BookContainerLike Cont, MemoryPolicyLike Policy = HeapMemoryPolicy>
 static void BM_EmplaceBack(benchmark::State &state) {
     int count = state.range(0);
     auto data = generateData(count);
 
+    size_t allocations = 0;
     for (auto _ : state) {
         {
-            BookDatabase<Cont> cont;
-            for (auto v : data) {
+            AllocationScope scope;
+            BookDatabase<Cont, Policy> cont;
+            for (const auto &v : data) {
                 cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
             }
+            allocations += scope.Delta().allocations;
 
             state.PauseTiming();
         }
         state.ResumeTiming();
     }
+    state.counters["allocs_per_insert"] =
+        static_cast<double>(allocations) / static_cast<double>(state.iterations() * data.size());
+}
+
+// Очистка заполненной базы: для арены - освобождение всей памяти одним вызовом вместо удаления каждой строки
+template <BookContainerLike Cont, MemoryPolicyLike Policy = HeapMemoryPolicy>
+static void BM_Clear(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont, Policy> cont;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (const auto &v : data) {
+            cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+        }
+        state.ResumeTiming();
+
+        cont.Clear();
+    }
 }
 
 template <BookContainerLike Cont>
@@ -111,11 +170,11 @@ static void BM_SortLessByAuthor(benchmark::State &state) {
 
     for (auto _ : state) {
         {
-            std::sort(cont.begin(), cont.end(), comp::LessByAuthor{});
+            std::ranges::sort(cont.MutableRange(), comp::LessByAuthor{});
             state.PauseTiming();
         }
         state.ResumeTiming();
-        std::shuffle(cont.begin(), cont.end(), std::mt19937{42});
+        std::ranges::shuffle(cont.MutableRange(), std::mt19937{42});
     }
 }
 
@@ -131,11 +190,11 @@ static void BM_SortLessByPopularity(benchmark::State &state) {
 
     for (auto _ : state) {
         {
-            std::sort(cont.begin(), cont.end(), comp::LessByPopularity{});
+            std::ranges::sort(cont.MutableRange(), comp::LessByPopularity{});
             state.PauseTiming();
         }
         state.ResumeTiming();
-        std::shuffle(cont.begin(), cont.end(), std::mt19937{42});
+        std::ranges::shuffle(cont.MutableRange(), std::mt19937{42});
     }
 }
 
@@ -151,11 +210,11 @@ static void BM_SortLessByRating(benchmark::State &state) {
 
     for (auto _ : state) {
         {
-            std::sort(cont.begin(), cont.end(), comp::LessByRating{});
+            std::ranges::sort(cont.MutableRange(), comp::LessByRating{});
             state.PauseTiming();
         }
         state.ResumeTiming();
-        std::shuffle(cont.begin(), cont.end(), std::mt19937{42});
+        std::ranges::shuffle(cont.MutableRange(), std::mt19937{42});
     }
 }
 
@@ -178,6 +237,82 @@ static void BM_BuildAuthorHistogramFlat(benchmark::State &state) {
     }
 }
 
+// Плотная гистограмма по идентификаторам авторов, без подстановки имён
+template <BookContainerLike Cont>
+static void BM_BuildAuthorHistogram(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        {
+            DoNotOptimize(buildAuthorHistogram(cont));
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+}
+
+// Запросы по базе с материализованными агрегатами: без сканирования книг
+template <BookContainerLike Cont>
+static void BM_AggregatedStatistics(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    cont.EnableAggregates();
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(cont));
+        DoNotOptimize(calculateAverageRating(cont));
+    }
+}
+
+// Та же пара запросов сканированием базы
+template <BookContainerLike Cont>
+static void BM_ScannedStatistics(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(cont));
+        DoNotOptimize(calculateAverageRating(cont));
+    }
+}
+
+// Стоимость поддержки агрегатов при изменении книг
+template <BookContainerLike Cont>
+static void BM_ModifyAggregated(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    cont.EnableAggregates();
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    std::mt19937 gen{42};
+    for (auto _ : state) {
+        for (size_t i = 0; i < cont.size(); ++i) {
+            cont.Modify(i, [&](Book &book) { book.rating = gen() % 50 / 10.0; });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * cont.size());
+}
+
 template <BookContainerLike Cont>
 static void BM_CalculateGenreRatings(benchmark::State &state) {
     int count = state.range(0);
@@ -255,8 +390,29 @@ static void BM_FilterBooksAnyOf(benchmark::State &state) {
     }
 }
 
+// Построчная проверка обычной лямбдой, с ней сравниваются фильтры на битовых масках
 template <BookContainerLike Cont>
-static void BM_GetTopNBy(benchmark::State &state) {
+static void BM_FilterBooksAllOfBranchy(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    auto pred = [](const Book &book) { return book.year >= 1900 && book.year < 1999 && book.rating > 4.5; };
+    for (auto _ : state) {
+        {
+            DoNotOptimize(filterBooks(cont.begin(), cont.end(), pred));
+            state.PauseTiming();
+        }
+        state.ResumeTiming();
+    }
+}
+
+template <BookContainerLike Cont>
+static void BM_FilterBooksAnyOfBranchy(benchmark::State &state) {
     int count = state.range(0);
     auto data = generateData(count);
 
@@ -265,15 +421,85 @@ static void BM_GetTopNBy(benchmark::State &state) {
         cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
     }
 
+    auto pred = [](const Book &book) {
+        return book.genre == Genre::SciFi || (book.year >= 1900 && book.year < 1999) || book.rating > 4.5;
+    };
     for (auto _ : state) {
         {
-            DoNotOptimize(getTopNBy(cont.begin(), cont.end(), 10, comp::LessByRating{}));
+            DoNotOptimize(filterBooks(cont.begin(), cont.end(), pred));
             state.PauseTiming();
         }
         state.ResumeTiming();
     }
 }
 
+// Узкий диапазон годов: полное сканирование против вторичного индекса
+template <BookContainerLike Cont>
+static void BM_FilterBooksYearScan(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(std::as_const(cont), all_of(YearBetween(1950, 1951), RatingAbove(4.5))));
+    }
+}
+
+template <BookContainerLike Cont>
+static void BM_FilterBooksYearIndexed(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    cont.CreateIndex(IndexedField::Year);
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(std::as_const(cont), all_of(YearBetween(1950, 1951), RatingAbove(4.5))));
+    }
+}
+
+template <BookContainerLike Cont>
+static void BM_GetTopNBy(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(getTopNBy(cont.cbegin(), cont.cend(), 10, comp::LessByRating{}));
+    }
+}
+
+// Прежняя реализация: partial_sort по копии книг, без копии она переставляла бы базу
+template <BookContainerLike Cont>
+static void BM_GetTopNByPartialSort(benchmark::State &state) {
+    int count = state.range(0);
+    auto data = generateData(count);
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        std::vector<std::reference_wrapper<const Book>> books(cont.cbegin(), cont.cend());
+        std::partial_sort(books.begin(), books.begin() + std::min<size_t>(10, books.size()), books.end(),
+                          comp::LessByRating{});
+        books.erase(books.begin() + std::min<size_t>(10, books.size()), books.end());
+        DoNotOptimize(books);
+    }
+}
+
 template <BookContainerLike Cont>
 static void BM_SampleRandomBooks(benchmark::State &state) {
     int count = state.range(0);
@@ -293,96 +519,1918 @@ static void BM_SampleRandomBooks(benchmark::State &state) {
     }
 }
 
-const size_t ITERATIONS = 10;
-const size_t RANGE_FROM = 1000;
-const size_t RANGE_TO = 100000;
+// ################### Параллельные статистики ###################
+// state.range(0) - количество книг, state.range(1) - количество потоков
+template <BookContainerLike Cont>
+static void BM_BuildAuthorHistogramFlatParallel(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    ThreadPool pool(state.range(1));
 
-// ################### Тестирование с Vector ##################################
-using Vector = std::vector<Book>;
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
 
-BENCHMARK(BM_PushBack<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_EmplaceBack<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByAuthor<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByPopularity<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByRating<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_BuildAuthorHistogramFlat<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_CalculateGenreRatings<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_CalculateAverageRating<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_FilterBooksAllOf<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_FilterBooksAnyOf<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_GetTopNBy<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SampleRandomBooks<Vector>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-// ################### Тестирование с Vector ##################################
+    for (auto _ : state) {
+        DoNotOptimize(buildAuthorHistogramFlat(cont, pool));
+    }
+}
 
-// ################### Тестирование с Deque ##################################
-using Deque = std::deque<Book>;
+template <BookContainerLike Cont>
+static void BM_CalculateGenreRatingsParallel(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    ThreadPool pool(state.range(1));
 
-BENCHMARK(BM_PushBack<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_EmplaceBack<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByAuthor<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByPopularity<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SortLessByRating<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_BuildAuthorHistogramFlat<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_CalculateGenreRatings<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_CalculateAverageRating<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_FilterBooksAllOf<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_FilterBooksAnyOf<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_GetTopNBy<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
-BENCHMARK(BM_SampleRandomBooks<Deque>)
-    ->Range(RANGE_FROM, RANGE_TO)
-    ->Iterations(ITERATIONS)
-    ->Unit(benchmark::kMicrosecond);
-// ################### Тестирование с Deque ##################################
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(cont.begin(), cont.end(), pool));
+    }
+}
+
+template <BookContainerLike Cont>
+static void BM_GetTopNByParallel(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    ThreadPool pool(state.range(1));
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(getTopNBy(cont.cbegin(), cont.cend(), 10, comp::LessByRating{}, pool));
+    }
+}
+
+template <BookContainerLike Cont>
+static void BM_CalculateAverageRatingParallel(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    ThreadPool pool(state.range(1));
+
+    BookDatabase<Cont> cont;
+    for (auto v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(cont.begin(), cont.end(), pool));
+    }
+}
+// ################### Параллельные статистики ###################
+
+// ################### Колоночное хранилище ###################
+ColumnarBookDatabase makeColumnar(size_t count) {
+    auto data = generateData(count);
+
+    ColumnarBookDatabase cont;
+    cont.Reserve(data.size());
+    for (const auto &v : data) {
+        cont.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+    return cont;
+}
+
+static void BM_ColumnarBuildAuthorHistogramFlat(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(buildAuthorHistogramFlat(cont));
+    }
+}
+
+static void BM_ColumnarCalculateGenreRatings(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(cont));
+    }
+}
+
+static void BM_ColumnarCalculateAverageRating(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(cont));
+    }
+}
+
+static void BM_ColumnarFilterBooksAllOf(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(cont, all_of(YearBetween(1900, 1999), RatingAbove(4.5))));
+    }
+}
+
+static void BM_ColumnarFilterBooksAnyOf(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(cont, any_of(GenreIs("SciFi"), YearBetween(1900, 1999), RatingAbove(4.5))));
+    }
+}
+
+// ################### Массовая загрузка ##################################
+// CSV-файл из count строк, генерируется один раз на запуск. 50M строк - около 2 ГБ
+std::filesystem::path catalogFile(size_t count) {
+    const auto path = std::filesystem::temp_directory_path() / ("bookdb_catalog_" + std::to_string(count) + ".csv");
+    if (std::filesystem::exists(path)) {
+        return path;
+    }
+
+    std::mt19937 gen{42};
+    std::ofstream out{path};
+    for (size_t i = 0; i < count; ++i) {
+        // Около 8 книг на автора
+        out << "Author" << gen() % (count / 8 + 1) << ",Title of the book number " << i << ',' << 1900 + gen() % 120
+            << ',' << ConvertGenre(static_cast<Genre>(gen() % kGenreCount)) << ',' << gen() % 50 / 10.0 << ','
+            << gen() % 1000 << '\n';
+    }
+    return path;
+}
+
+static void BM_LoadBooks(benchmark::State &state) {
+    const auto path = catalogFile(state.range(0));
+    ThreadPool pool(state.range(1));
+
+    LoadStats stats;
+    for (auto _ : state) {
+        BookDatabase<> db;
+        stats = loadBooks(db, path, pool);
+        DoNotOptimize(db);
+    }
+    state.SetBytesProcessed(state.iterations() * stats.bytes);
+    state.SetItemsProcessed(state.iterations() * stats.rows);
+    state.counters["malformed"] = stats.malformed;
+}
+
+// Построчное чтение через getline и добавление через EmplaceBack с ConvertGenre(std::string_view)
+static void BM_LoadBooksNaive(benchmark::State &state) {
+    const auto path = catalogFile(state.range(0));
+
+    size_t bytes = 0;
+    size_t rows = 0;
+    for (auto _ : state) {
+        BookDatabase<> db;
+        std::ifstream in{path};
+        std::string line;
+        while (std::getline(in, line)) {
+            std::array<std::string_view, 6> fields;
+            std::string_view rest = line;
+            for (auto &field : fields) {
+                const size_t end = std::min(rest.find(','), rest.size());
+                field = rest.substr(0, end);
+                rest.remove_prefix(std::min(end + 1, rest.size()));
+            }
+            db.EmplaceBack(fields[0], fields[1], std::stoi(std::string{fields[2]}), fields[3],
+                           std::stod(std::string{fields[4]}), std::stoi(std::string{fields[5]}));
+        }
+        rows = db.size();
+        DoNotOptimize(db);
+    }
+    bytes = std::filesystem::file_size(path);
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.SetItemsProcessed(state.iterations() * rows);
+}
+// ################### Массовая загрузка ##################################
+
+// ################### Снимки ##################################
+std::filesystem::path snapshotPath(size_t count) {
+    return std::filesystem::temp_directory_path() / ("bookdb_benchmark_" + std::to_string(count) + ".snap");
+}
+
+// Холодный старт без снимка: все книги заново добавляются в хранилище
+static void BM_ColumnarLoad(benchmark::State &state) {
+    for (auto _ : state) {
+        DoNotOptimize(makeColumnar(state.range(0)));
+    }
+}
+
+// Холодный старт со снимка: отображение файла и проверка заголовка, без десериализации
+static void BM_SnapshotOpen(benchmark::State &state) {
+    const auto path = snapshotPath(state.range(0));
+    saveSnapshot(makeColumnar(state.range(0)), path);
+
+    for (auto _ : state) {
+        DoNotOptimize(BookSnapshot::Open(path));
+    }
+    std::filesystem::remove(path);
+}
+
+static void BM_SnapshotCalculateAverageRating(benchmark::State &state) {
+    const auto path = snapshotPath(state.range(0));
+    saveSnapshot(makeColumnar(state.range(0)), path);
+    const auto snapshot = BookSnapshot::Open(path);
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(snapshot));
+    }
+    std::filesystem::remove(path);
+}
+
+static void BM_SnapshotFilterBooksAllOf(benchmark::State &state) {
+    const auto path = snapshotPath(state.range(0));
+    saveSnapshot(makeColumnar(state.range(0)), path);
+    const auto snapshot = BookSnapshot::Open(path);
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(snapshot, all_of(YearBetween(1900, 1999), RatingAbove(4.5))));
+    }
+    std::filesystem::remove(path);
+}
+// ################### Снимки ##################################
+
+// ################### Группировка ##################################
+// groupBy и специализированные функции считают одно и то же на одной базе нагрузки (см. workload.hpp):
+// авторы по закону Ципфа, жанры с перекосом
+
+const BookDatabase<> &groupByDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        bench::WorkloadGenerator generator{count};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.PushBack(generator.Next());
+        }
+    }
+    return it->second;
+}
+
+static void BM_GroupByGenreBaseline(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(db.cbegin(), db.cend()));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+static void BM_GroupByGenre(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, group::ByGenre{}, agg::Avg{&Book::rating}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+static void BM_GroupByAuthorBaseline(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(buildAuthorHistogramFlat(db));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+static void BM_GroupByAuthor(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, group::ByAuthor{}, agg::Count{}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+// Хеш по идентификатору автора, имена не читаются
+static void BM_GroupByAuthorId(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, group::ByAuthorId{}, agg::Count{}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+// Шесть агрегатов за один проход по десятилетиям
+static void BM_GroupByDecadeComposed(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, group::ByDecade{}, agg::Count{}, agg::Sum{&Book::read_count},
+                              agg::Avg{&Book::rating}, agg::Min{&Book::rating}, agg::Max{&Book::read_count},
+                              agg::Variance{&Book::rating}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+static void BM_GroupByGenreParallel(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    ThreadPool pool(state.range(1));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, pool, group::ByGenre{}, agg::Avg{&Book::rating}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+
+static void BM_GroupByAuthorParallel(benchmark::State &state) {
+    const auto &db = groupByDatabase(state.range(0));
+    ThreadPool pool(state.range(1));
+    for (auto _ : state) {
+        DoNotOptimize(groupBy(db, pool, group::ByAuthor{}, agg::Count{}));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+}
+// ################### Группировка ##################################
+
+// ################### Профилирование запросов ##################################
+// Накладные расходы профилирования сравниваются сборками с -DBOOKDB_PROFILING и без него: без макроса
+// QueryProbe пуст, и эти же бенчмарки показывают время запросов без замеров
+
+// Создание и разрушение замера без запроса: два чтения steady_clock и запись в профиль потока
+static void BM_QueryProbe(benchmark::State &state) {
+    for (auto _ : state) {
+        QueryProbe probe{QueryKind::FilterBooks};
+        probe.Scanned(1);
+        probe.Matched(1);
+        benchmark::ClobberMemory();
+    }
+    state.counters["profiling"] = kProfilingEnabled;
+}
+
+static void BM_LatencyHistogramRecord(benchmark::State &state) {
+    LatencyHistogram histogram;
+    std::mt19937_64 gen{42};
+    std::lognormal_distribution<double> latency{10., 2.};
+    std::vector<uint64_t> values(4096);
+    std::ranges::generate(values, [&] { return static_cast<uint64_t>(latency(gen)); });
+
+    size_t i = 0;
+    for (auto _ : state) {
+        histogram.Record(values[i++ % values.size()]);
+    }
+    DoNotOptimize(histogram.Quantile(0.99));
+}
+
+// Снимок складывает профили всех потоков, которые делали запросы
+static void BM_ProfileSnapshot(benchmark::State &state) {
+    for (auto _ : state) {
+        DoNotOptimize(QueryProfiler::Snapshot());
+    }
+}
+
+// База из count книг реалистичной нагрузки (см. workload.hpp)
+const BookDatabase<> &profilingDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        bench::WorkloadGenerator generator{count};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.PushBack(generator.Next());
+        }
+    }
+    return it->second;
+}
+
+// Запрос на базе нагрузки; при включённом профилировании - квантили задержки и строки из профиля
+template <typename Query>
+void runProfiledQuery(benchmark::State &state, QueryKind kind, Query query) {
+    const auto &db = profilingDatabase(state.range(0));
+    QueryProfiler::Reset();
+    for (auto _ : state) {
+        DoNotOptimize(query(db));
+    }
+    state.SetItemsProcessed(state.iterations() * db.size());
+    state.counters["profiling"] = kProfilingEnabled;
+    if constexpr (kProfilingEnabled) {
+        const auto snapshot = QueryProfiler::Snapshot();
+        const auto &profile = snapshot[kind];
+        const auto calls = static_cast<double>(std::max<uint64_t>(profile.calls, 1));
+        state.counters["p50_us"] = static_cast<double>(profile.P50()) / 1e3;
+        state.counters["p99_us"] = static_cast<double>(profile.P99()) / 1e3;
+        state.counters["scanned_per_call"] = static_cast<double>(profile.rows_scanned) / calls;
+        state.counters["matched_per_call"] = static_cast<double>(profile.rows_matched) / calls;
+    }
+}
+
+static void BM_ProfiledFilterBooks(benchmark::State &state) {
+    runProfiledQuery(state, QueryKind::FilterBooks,
+                     [](const BookDatabase<> &db) { return filterBooks(db, GenreIs("Mystery")); });
+}
+
+static void BM_ProfiledGenreRatings(benchmark::State &state) {
+    runProfiledQuery(state, QueryKind::GenreRatings,
+                     [](const BookDatabase<> &db) { return calculateGenreRatings(db, RatingAbove(4.)); });
+}
+
+static void BM_ProfiledTopN(benchmark::State &state) {
+    runProfiledQuery(state, QueryKind::TopN, [](const BookDatabase<> &db) {
+        return getTopNBy(db.cbegin(), db.cend(), 10, comp::LessByPopularity{});
+    });
+}
+// ################### Профилирование запросов ##################################
+
+// ################### Учёт памяти ##################################
+// База из count книг реалистичной нагрузки (см. workload.hpp) с индексами и агрегатами
+const BookDatabase<> &memoryStatsDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        bench::WorkloadGenerator generator{count};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.PushBack(generator.Next());
+        }
+        it->second.GetAuthorIndex();
+    }
+    return it->second;
+}
+
+// Разбивка MemoryStats() в байтах на книгу
+template <typename Db>
+void reportMemoryStats(benchmark::State &state, const Db &db) {
+    const auto stats = db.MemoryStats();
+    const auto per_book = [&](size_t bytes) { return static_cast<double>(bytes) / static_cast<double>(db.size()); };
+    state.counters["book_storage_per_book"] = per_book(stats.book_storage);
+    state.counters["title_heap_per_book"] = per_book(stats.title_heap);
+    state.counters["author_set_per_book"] = per_book(stats.author_set);
+    state.counters["indexes_per_book"] = per_book(stats.indexes);
+    state.counters["derived_per_book"] = per_book(stats.derived);
+}
+
+// Вставка книг нагрузки в базу со счётчиком выделений ресурса: выделения на вставку и разбивка памяти
+static void BM_CountedInsert(benchmark::State &state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    bench::WorkloadGenerator generator{count};
+    std::vector<Book> books;
+    books.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        books.push_back(generator.Next());
+    }
+
+    for (auto _ : state) {
+        {
+            BookDatabase<std::vector<Book>, CountingMemoryPolicy<>> db;
+            for (const Book &book : books) {
+                db.PushBack(book);
+            }
+
+            state.PauseTiming();
+            const auto counters = db.GetMemoryPolicy().Counters();
+            state.counters["resource_allocs_per_insert"] =
+                static_cast<double>(counters.allocations) / static_cast<double>(count);
+            state.counters["resource_peak_bytes"] = static_cast<double>(counters.peak_bytes);
+            reportMemoryStats(state, db);
+        }
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+// Выделения кучи на один запрос и память, которую держит его результат
+template <typename Query>
+void runCountedQuery(benchmark::State &state, Query query) {
+    const auto &db = memoryStatsDatabase(state.range(0));
+    AllocationScope scope;
+    for (auto _ : state) {
+        DoNotOptimize(query(db));
+    }
+    const auto delta = scope.Delta();
+    const auto iterations = static_cast<double>(state.iterations());
+    state.counters["allocs_per_op"] = static_cast<double>(delta.allocations) / iterations;
+    state.counters["bytes_per_op"] = static_cast<double>(delta.bytes_allocated) / iterations;
+
+    scope.Restart();
+    const auto result = query(db);
+    state.counters["result_bytes"] = static_cast<double>(scope.Delta().retained_bytes);
+    DoNotOptimize(result);
+    reportMemoryStats(state, db);
+}
+
+static void BM_CountedFilterBooks(benchmark::State &state) {
+    runCountedQuery(state, [](const BookDatabase<> &db) { return filterBooks(db, GenreIs("Mystery")); });
+}
+
+static void BM_CountedAuthorHistogram(benchmark::State &state) {
+    runCountedQuery(state, [](const BookDatabase<> &db) { return buildAuthorHistogramFlat(db); });
+}
+
+static void BM_CountedGenreRatings(benchmark::State &state) {
+    runCountedQuery(state, [](const BookDatabase<> &db) { return calculateGenreRatings(db, RatingAbove(4.)); });
+}
+
+static void BM_CountedTopN(benchmark::State &state) {
+    runCountedQuery(state, [](const BookDatabase<> &db) {
+        return getTopNBy(db.cbegin(), db.cend(), 100, comp::LessByPopularity{});
+    });
+}
+// ################### Учёт памяти ##################################
+
+// ################### Реалистичная нагрузка ##################################
+// Книги из bench::WorkloadGenerator: авторы по Ципфу, перекос жанров и годов, длинные заголовки.
+// Наибольший размер задаётся переменной окружения BOOKDB_WORKLOAD_ROWS (по умолчанию 10M)
+std::vector<int64_t> workloadSizes(int64_t limit = std::numeric_limits<int64_t>::max()) {
+    int64_t max_rows = 10000000;
+    if (const char *rows = std::getenv("BOOKDB_WORKLOAD_ROWS")) {
+        max_rows = std::atoll(rows);
+    }
+    std::vector<int64_t> sizes;
+    for (int64_t rows = 100000; rows <= std::min(max_rows, limit); rows *= 10) {
+        sizes.push_back(rows);
+    }
+    return sizes;
+}
+
+// База из count книг нагрузки и живые байты кучи на книгу после её заполнения
+struct WorkloadDatabase {
+    BookDatabase<> db;
+    double bytes_per_book = 0;
+};
+
+// Многопоточные бенчмарки обращаются к кешу из всех своих потоков
+const WorkloadDatabase &workloadDatabase(size_t count) {
+    static std::mutex mutex;
+    static std::unordered_map<size_t, WorkloadDatabase> cache;
+    std::lock_guard lock{mutex};
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        bench::WorkloadGenerator generator{count};
+        AllocationScope scope;
+        it->second.db.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.db.PushBack(generator.Next());
+        }
+        it->second.bytes_per_book = static_cast<double>(scope.Delta().retained_bytes) / static_cast<double>(count);
+        it->second.db.GetZoneMap();
+    }
+    return it->second;
+}
+
+// Счётчики памяти базы и выделений памяти на одну операцию замера
+void reportWorkloadCounters(benchmark::State &state, const WorkloadDatabase &workload, size_t allocations) {
+    state.counters["bytes_per_book"] = workload.bytes_per_book;
+    state.counters["allocs_per_op"] = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+}
+
+template <typename Query>
+void runWorkloadQuery(benchmark::State &state, Query query) {
+    const auto &workload = workloadDatabase(state.range(0));
+    AllocationScope scope;
+    for (auto _ : state) {
+        query(workload.db);
+    }
+    reportWorkloadCounters(state, workload, scope.Delta().allocations);
+    state.SetItemsProcessed(state.iterations() * workload.db.size());
+}
+
+// Вставка: книги созданы заранее, замеряется только PushBack с копированием длинных заголовков
+static void BM_WorkloadInsert(benchmark::State &state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    bench::WorkloadGenerator generator{count};
+    std::vector<Book> books;
+    books.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        books.push_back(generator.Next());
+    }
+
+    size_t allocations = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        BookDatabase<> db;
+        AllocationScope scope;
+        for (const Book &book : books) {
+            db.PushBack(book);
+        }
+        allocations += scope.Delta().allocations;
+        bytes = static_cast<size_t>(scope.Delta().retained_bytes);
+        state.PauseTiming();
+        db.Clear();
+        state.ResumeTiming();
+    }
+    state.counters["allocs_per_insert"] =
+        static_cast<double>(allocations) / static_cast<double>(state.iterations() * books.size());
+    state.counters["bytes_per_book"] = static_cast<double>(bytes) / static_cast<double>(books.size());
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+static void BM_WorkloadFilter(benchmark::State &state) {
+    runWorkloadQuery(state, [](const BookDatabase<> &db) {
+        DoNotOptimize(filterBooks(db, all_of(GenreIs("Fiction"), YearBetween(2000, 2020), RatingAbove(4.5))).size());
+    });
+}
+
+static void BM_WorkloadGenreRatings(benchmark::State &state) {
+    runWorkloadQuery(state,
+                     [](const BookDatabase<> &db) { DoNotOptimize(calculateGenreRatings(db.cbegin(), db.cend())); });
+}
+
+// Гистограмма по Ципфу: несколько авторов с огромными счётчиками и длинный хвост авторов с одной книгой
+static void BM_WorkloadAuthorHistogram(benchmark::State &state) {
+    runWorkloadQuery(state, [](const BookDatabase<> &db) { DoNotOptimize(buildAuthorHistogramFlat(db).size()); });
+}
+
+static void BM_WorkloadTopN(benchmark::State &state) {
+    runWorkloadQuery(state, [](const BookDatabase<> &db) {
+        DoNotOptimize(getTopNBy(db.cbegin(), db.cend(), 100, comp::LessByPopularity{}).size());
+    });
+}
+
+static void BM_WorkloadSortByAuthor(benchmark::State &state) {
+    runWorkloadQuery(state,
+                     [](const BookDatabase<> &db) { DoNotOptimize(sortedRows(db, comp::LessByAuthor{}).data()); });
+}
+
+// Многопоточное сканирование общей базы: каждый поток обрабатывает свою часть строк, поэтому время итерации -
+// время части, а масштабирование по потокам показывает items_per_second
+static void BM_WorkloadParallelScan(benchmark::State &state) {
+    const auto &workload = workloadDatabase(state.range(0));
+    const auto &books = workload.db.GetBooks();
+    const auto threads = static_cast<size_t>(state.threads());
+    const auto thread = static_cast<size_t>(state.thread_index());
+    const size_t part = (books.size() + threads - 1) / threads;
+    const auto first = books.begin() + static_cast<std::ptrdiff_t>(std::min(books.size(), part * thread));
+    const auto last = books.begin() + static_cast<std::ptrdiff_t>(std::min(books.size(), part * (thread + 1)));
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(first, last));
+        DoNotOptimize(filterBooks(first, last, all_of(GenreIs("Mystery"), RatingAbove(4.5))).size());
+    }
+    state.counters["bytes_per_book"] = benchmark::Counter(workload.bytes_per_book, benchmark::Counter::kAvgThreads);
+    state.SetItemsProcessed(state.iterations() * (last - first));
+}
+
+// Шарды по хешу автора: при распределении Ципфа популярные авторы перегружают свои шарды
+static void BM_WorkloadSharded(benchmark::State &state) {
+    const auto count = static_cast<size_t>(state.range(0));
+    ShardedBookDatabase<> db{static_cast<size_t>(state.range(1))};
+    bench::WorkloadGenerator generator{count};
+    for (size_t i = 0; i < count; ++i) {
+        db.PushBack(generator.Next());
+    }
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(db));
+        DoNotOptimize(buildAuthorHistogramFlat(db).size());
+    }
+    size_t largest = 0;
+    for (size_t shard = 0; shard < db.ShardCount(); ++shard) {
+        largest = std::max(largest, db.GetShard(shard).size());
+    }
+    state.counters["shard_imbalance"] =
+        static_cast<double>(largest * db.ShardCount()) / static_cast<double>(std::max<size_t>(count, 1));
+    state.SetItemsProcessed(state.iterations() * count);
+}
+// ################### Реалистичная нагрузка ##################################
+
+// ################### Скетчи ##################################
+// Книги из generateData: авторы различны, рейтинг и число прочтений - случайные целые
+std::vector<Book> sketchBooks(size_t count) {
+    const auto data = generateData(count);
+    std::vector<Book> books;
+    books.reserve(data.size());
+    std::ranges::for_each(data, [&](const Book_data &v) {
+        books.emplace_back(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    });
+    return books;
+}
+
+static void BM_SketchUpdate(benchmark::State &state) {
+    const auto books = sketchBooks(state.range(0));
+    for (auto _ : state) {
+        BookSketches sketches;
+        std::ranges::for_each(books, [&](const Book &book) { sketches.Add(book); });
+        DoNotOptimize(sketches.DistinctAuthors());
+    }
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+static void BM_HyperLogLogUpdate(benchmark::State &state) {
+    const auto books = sketchBooks(state.range(0));
+    for (auto _ : state) {
+        HyperLogLog hll;
+        std::ranges::for_each(books, [&](const Book &book) { hll.Add(book.author); });
+        DoNotOptimize(hll.Estimate());
+    }
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+static void BM_TDigestUpdate(benchmark::State &state) {
+    const auto books = sketchBooks(state.range(0));
+    for (auto _ : state) {
+        TDigest digest;
+        std::ranges::for_each(books, [&](const Book &book) { digest.Add(book.rating); });
+        DoNotOptimize(digest.Quantile(0.99));
+    }
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+static void BM_HeavyHittersUpdate(benchmark::State &state) {
+    const auto books = sketchBooks(state.range(0));
+    for (auto _ : state) {
+        HeavyHitters top;
+        std::ranges::for_each(books, [&](const Book &book) { top.Add(book.author); });
+        DoNotOptimize(top.Top().size());
+    }
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+// Цена вставки со скетчами и без них
+static void BM_PushBackSketches(benchmark::State &state) {
+    const auto books = sketchBooks(state.range(0));
+    for (auto _ : state) {
+        BookDatabase<> db;
+        if (state.range(1) != 0) {
+            db.EnableSketches();
+        }
+        db.Reserve(books.size());
+        std::ranges::for_each(books, [&](const Book &book) { db.PushBack(book); });
+        DoNotOptimize(db.size());
+    }
+    state.SetItemsProcessed(state.iterations() * books.size());
+}
+
+// Точное число авторов и медиана сканированием против ответа по готовым скетчам
+static void BM_ExactDashboard(benchmark::State &state) {
+    BookDatabase<> db;
+    std::ranges::for_each(sketchBooks(state.range(0)), [&](const Book &book) { db.PushBack(book); });
+    for (auto _ : state) {
+        DoNotOptimize(buildAuthorHistogramFlat(db).size());
+        std::vector<double> ratings(db.size());
+        std::ranges::transform(db.GetBooks(), ratings.begin(), &Book::rating);
+        std::ranges::nth_element(ratings, ratings.begin() + static_cast<std::ptrdiff_t>(ratings.size() / 2));
+        DoNotOptimize(ratings[ratings.size() / 2]);
+    }
+}
+
+static void BM_SketchDashboard(benchmark::State &state) {
+    BookDatabase<> db;
+    db.EnableSketches();
+    std::ranges::for_each(sketchBooks(state.range(0)), [&](const Book &book) { db.PushBack(book); });
+    for (auto _ : state) {
+        const auto *sketches = db.GetSketches();
+        DoNotOptimize(sketches->DistinctAuthors());
+        DoNotOptimize(sketches->RatingQuantile(0.5));
+        DoNotOptimize(sketches->TopAuthors().size());
+    }
+}
+// ################### Скетчи ##################################
+
+// ################### Сортировка перестановки ##################################
+// count книг, по 100 книг на автора; копия берётся перед каждой сортировкой вне замера
+const BookDatabase<> &permutationSortDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        std::mt19937 gen{42};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.EmplaceBack("Author" + std::to_string(gen() % (count / 100 + 1)), "Title" + std::to_string(i),
+                                   1900 + static_cast<int>(gen() % 120), static_cast<Genre>(gen() % kGenreCount),
+                                   static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000));
+        }
+    }
+    return it->second;
+}
+
+// Сортировка сравнениями с перемещением книг
+template <typename Comp>
+static void BM_SortLessByComparison(benchmark::State &state) {
+    const auto &source = permutationSortDatabase(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = source;
+        state.ResumeTiming();
+        std::ranges::sort(db.MutableRange(), Comp{});
+        DoNotOptimize(db.GetBooks().data());
+    }
+}
+
+// Поразрядная сортировка перестановки и одно перемещение книг
+template <typename Comp>
+static void BM_SortLessByRadix(benchmark::State &state) {
+    const auto &source = permutationSortDatabase(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = source;
+        state.ResumeTiming();
+        sortBooks(db, Comp{});
+        DoNotOptimize(db.GetBooks().data());
+    }
+}
+
+// Только перестановка строк, книги остаются на месте
+template <typename Comp>
+static void BM_SortedRows(benchmark::State &state) {
+    const auto &db = permutationSortDatabase(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(sortedRows(db, Comp{}).data());
+    }
+}
+// ################### Сортировка перестановки ##################################
+
+// ################### Компактные записи ##################################
+// count книг, по 100 книг на автора. Заголовки короткие и в Book помещаются внутрь строки (SSO),
+// поэтому байты на книгу у BookDatabase - это sizeof(Book)
+template <typename Db>
+const Db &hotColdDatabase(size_t count) {
+    static std::unordered_map<size_t, Db> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        std::mt19937 gen{42};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.EmplaceBack("Author" + std::to_string(gen() % (count / 100 + 1)), "Title" + std::to_string(i),
+                                   1900 + static_cast<int>(gen() % 120), static_cast<Genre>(gen() % kGenreCount),
+                                   static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000));
+        }
+    }
+    return it->second;
+}
+
+const auto hotColdPredicate = [] { return all_of(YearBetween(1950, 2000), RatingAbove(2.5)); };
+
+void reportBytesPerBook(benchmark::State &state, size_t bytes, size_t count) {
+    state.counters["bytes_per_book"] = static_cast<double>(bytes) / static_cast<double>(count);
+}
+
+static void BM_RowScan(benchmark::State &state) {
+    const auto &db = hotColdDatabase<BookDatabase<>>(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(db.cbegin(), db.cend()));
+        DoNotOptimize(filterBooks(db.cbegin(), db.cend(), hotColdPredicate()).size());
+    }
+    reportBytesPerBook(state, sizeof(Book) * db.size(), db.size());
+}
+
+static void BM_CompactScan(benchmark::State &state) {
+    const auto &db = hotColdDatabase<CompactBookDatabase>(state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(db));
+        DoNotOptimize(filterBooks(db, hotColdPredicate()).size());
+    }
+    reportBytesPerBook(state, db.HotBytes() + db.ColdBytes(), db.size());
+    state.counters["hot_bytes_per_book"] = static_cast<double>(sizeof(CompactBook));
+}
+
+template <typename Comp>
+static void BM_RowSort(benchmark::State &state) {
+    auto db = hotColdDatabase<BookDatabase<>>(state.range(0));
+    for (auto _ : state) {
+        std::ranges::sort(db.MutableRange(), Comp{});
+        state.PauseTiming();
+        std::ranges::shuffle(db.MutableRange(), std::mt19937{42});
+        state.ResumeTiming();
+    }
+    reportBytesPerBook(state, sizeof(Book) * db.size(), db.size());
+}
+
+template <typename Comp>
+static void BM_CompactSort(benchmark::State &state) {
+    const auto &source = hotColdDatabase<CompactBookDatabase>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = source;
+        state.ResumeTiming();
+        db.Sort(Comp{});
+        DoNotOptimize(db.GetBooks().data());
+    }
+    reportBytesPerBook(state, source.HotBytes() + source.ColdBytes(), source.size());
+}
+// ################### Компактные записи ##################################
+
+// ################### Журнал предзаписи ##################################
+std::filesystem::path walPath() { return std::filesystem::temp_directory_path() / "bookdb_benchmark.wal"; }
+
+// Добавление state.range(0) книг в базу с журналом; state.range(1) - политика WalSync
+static void BM_DurableInsert(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    const WalOptions options{.sync = static_cast<WalSync>(state.range(1))};
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::filesystem::remove(walPath());
+        state.ResumeTiming();
+        DurableBookDatabase<> db{walPath(), options};
+        for (const auto &v : data) {
+            db.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+        }
+        db.Sync();
+    }
+    std::filesystem::remove(walPath());
+    state.counters["inserts/s"] = benchmark::Counter(static_cast<double>(state.iterations() * data.size()),
+                                                     benchmark::Counter::kIsRate);
+}
+
+static void BM_NonDurableInsert(benchmark::State &state) {
+    auto data = generateData(state.range(0));
+    for (auto _ : state) {
+        BookDatabase<> db;
+        for (const auto &v : data) {
+            db.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+        }
+        DoNotOptimize(db);
+    }
+    state.counters["inserts/s"] = benchmark::Counter(static_cast<double>(state.iterations() * data.size()),
+                                                     benchmark::Counter::kIsRate);
+}
+
+static void BM_WalReplay(benchmark::State &state) {
+    {
+        std::filesystem::remove(walPath());
+        DurableBookDatabase<> db{walPath(), {.sync = WalSync::None}};
+        for (const auto &v : generateData(state.range(0))) {
+            db.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+        }
+    }
+    for (auto _ : state) {
+        DurableBookDatabase<> db{walPath()};
+        DoNotOptimize(db.size());
+    }
+    std::filesystem::remove(walPath());
+}
+// ################### Журнал предзаписи ##################################
+
+// ################### Шардированная база ##################################
+// state.range(0) - количество книг, state.range(1) - количество шардов (и потоков пула)
+const auto shardedPredicate = [] { return all_of(YearBetween(1950, 1970), RatingAbove(5.0)); };
+
+void fillSharded(ShardedBookDatabase<> &db, size_t count) {
+    for (const auto &v : generateData(count)) {
+        db.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+}
+
+static void BM_ShardedCalculateGenreRatings(benchmark::State &state) {
+    ShardedBookDatabase<> db(state.range(1));
+    fillSharded(db, state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(calculateGenreRatings(db, shardedPredicate()));
+    }
+}
+
+static void BM_ShardedFilterBooks(benchmark::State &state) {
+    ShardedBookDatabase<> db(state.range(1));
+    fillSharded(db, state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(db, shardedPredicate()));
+    }
+}
+
+static void BM_ShardedGetTopNBy(benchmark::State &state) {
+    ShardedBookDatabase<> db(state.range(1));
+    fillSharded(db, state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(getTopNBy(db, 100, comp::LessByPopularity{}));
+    }
+}
+
+static void BM_ShardedBuildAuthorHistogramFlat(benchmark::State &state) {
+    ShardedBookDatabase<> db(state.range(1));
+    fillSharded(db, state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(buildAuthorHistogramFlat(db));
+    }
+}
+
+static void BM_ShardedSampleRandomBooks(benchmark::State &state) {
+    ShardedBookDatabase<> db(state.range(1));
+    fillSharded(db, state.range(0));
+    for (auto _ : state) {
+        DoNotOptimize(sampleRandomBooks(db, 1000));
+    }
+}
+// ################### Шардированная база ##################################
+
+// ################### Конкурентная база ##################################
+// Писатель добавляет книги пачками по 100 в фоновом потоке, пока читатель измеряется (не больше limit книг)
+template <typename Append>
+std::jthread startWriter(Append append, size_t limit, std::atomic<size_t> &written) {
+    return std::jthread([append, limit, &written](std::stop_token stop) mutable {
+        std::mt19937 gen{1};
+        while (!stop.stop_requested() && written.load(std::memory_order_relaxed) < limit) {
+            for (int i = 0; i < 100; ++i) {
+                append(gen);
+            }
+            written.fetch_add(100, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    });
+}
+
+template <typename Db>
+void appendRandomBook(Db &db, std::mt19937 &gen) {
+    db.EmplaceBack("Author" + std::to_string(gen() % 1000), "Title", 1900 + static_cast<int>(gen() % 120),
+                   static_cast<Genre>(gen() % kGenreCount), static_cast<double>(gen() % 50) / 10.0,
+                   static_cast<int>(gen() % 1000));
+}
+
+// Читатель берёт снимок без блокировок и считает статистики, пока писатель добавляет книги
+static void BM_ConcurrentSnapshotRead(benchmark::State &state) {
+    ConcurrentBookDatabase db;
+    std::mt19937 gen{42};
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        appendRandomBook(db, gen);
+    }
+    std::atomic<size_t> written = 0;
+    auto writer = startWriter([&](std::mt19937 &g) { appendRandomBook(db, g); }, 4 * state.range(0), written);
+
+    for (auto _ : state) {
+        auto snapshot = db.GetSnapshot();
+        DoNotOptimize(calculateAverageRating(snapshot.begin(), snapshot.end()));
+        DoNotOptimize(calculateGenreRatings(snapshot.begin(), snapshot.end()));
+    }
+    writer.request_stop();
+    writer.join();
+    state.counters["written"] = benchmark::Counter(static_cast<double>(written.load()));
+    state.counters["reads/s"] =
+        benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+// Прежний способ: копия всей базы под мьютексом, который блокирует и писателя
+static void BM_MutexCopyRead(benchmark::State &state) {
+    BookDatabase<std::vector<Book>> db;
+    std::mutex mutex;
+    std::mt19937 gen{42};
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        appendRandomBook(db, gen);
+    }
+    std::atomic<size_t> written = 0;
+    auto writer = startWriter(
+        [&](std::mt19937 &g) {
+            std::lock_guard lock{mutex};
+            appendRandomBook(db, g);
+        },
+        4 * state.range(0), written);
+
+    for (auto _ : state) {
+        auto copy = [&] {
+            std::lock_guard lock{mutex};
+            return db;
+        }();
+        DoNotOptimize(calculateAverageRating(copy.cbegin(), copy.cend()));
+        DoNotOptimize(calculateGenreRatings(copy.cbegin(), copy.cend()));
+    }
+    writer.request_stop();
+    writer.join();
+    state.counters["written"] = benchmark::Counter(static_cast<double>(written.load()));
+    state.counters["reads/s"] =
+        benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+// ################### Конкурентная база ##################################
+
+// ################### Индекс авторов ##################################
+// count книг, у каждого автора в среднем 10 книг
+const BookDatabase<std::vector<Book>> &authorDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<std::vector<Book>>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        std::mt19937 gen{42};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.EmplaceBack("Author" + std::to_string(gen() % (count / 10 + 1)), "Title", 1900, Genre::Fiction,
+                                   4.0, 1);
+        }
+        it->second.GetAuthorIndex();
+    }
+    return it->second;
+}
+
+static void BM_GetBooksByAuthor(benchmark::State &state) {
+    const auto &db = authorDatabase(state.range(0));
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        DoNotOptimize(db.GetBooksByAuthor("Author" + std::to_string(gen() % (db.size() / 10))));
+    }
+}
+
+static void BM_GetBooksByAuthorScan(benchmark::State &state) {
+    const auto &db = authorDatabase(state.range(0));
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        const auto author = "Author" + std::to_string(gen() % (db.size() / 10));
+        DoNotOptimize(filterBooks(db.cbegin(), db.cend(), [&](const Book &book) { return book.author == author; }));
+    }
+}
+
+// Подсказки при вводе: первые 10 авторов по префиксу из 8 символов
+static void BM_AuthorPrefixSuggest(benchmark::State &state) {
+    const auto &db = authorDatabase(state.range(0));
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        const auto prefix = "Author" + std::to_string(gen() % 100);
+        auto authors = db.GetAuthorIndex().Prefix(prefix);
+        DoNotOptimize(authors.first(std::min<size_t>(10, authors.size())));
+    }
+}
+
+static void BM_GetBooksByAuthorPrefix(benchmark::State &state) {
+    const auto &db = authorDatabase(state.range(0));
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        DoNotOptimize(db.GetBooksByAuthorPrefix("Author" + std::to_string(gen() % 1000)));
+    }
+}
+
+static void BM_GetBooksByAuthorPrefixScan(benchmark::State &state) {
+    const auto &db = authorDatabase(state.range(0));
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        const auto prefix = "Author" + std::to_string(gen() % 1000);
+        DoNotOptimize(
+            filterBooks(db.cbegin(), db.cend(), [&](const Book &book) { return book.author.starts_with(prefix); }));
+    }
+}
+// ################### Индекс авторов ##################################
+
+// ################### Полнотекстовый поиск ##################################
+// Словарь из 4096 слов из трёх слогов, заголовки - от 2 до 6 слов словаря с редкими словами чаще в конце
+const std::vector<std::string> &textVocabulary() {
+    static const std::vector<std::string> words = [] {
+        constexpr std::array<std::string_view, 16> syllables{"ka", "lo", "mi", "ne", "su", "ta", "vo", "ri",
+                                                             "gan", "dor", "wel", "ith", "mor", "sil", "bra", "eth"};
+        std::vector<std::string> result;
+        for (size_t i = 0; i < 4096; ++i) {
+            result.push_back(std::string{syllables[i % 16]} + std::string{syllables[i / 16 % 16]} +
+                             std::string{syllables[i / 256]});
+        }
+        return result;
+    }();
+    return words;
+}
+
+const BookDatabase<std::vector<Book>> &textDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<std::vector<Book>>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        const auto &words = textVocabulary();
+        std::mt19937 gen{42};
+        it->second.Reserve(count);
+        it->second.EnableTextIndex({.trigrams = true});
+        std::string title;
+        for (size_t i = 0; i < count; ++i) {
+            title.clear();
+            for (size_t word = 0, size = 2 + gen() % 5; word < size; ++word) {
+                // Частые слова встречаются в десятках тысяч заголовков, редкие - в единицах
+                const size_t range = word == 0 ? 64 : words.size();
+                title += (word == 0 ? "" : " ") + words[gen() % range];
+            }
+            it->second.EmplaceBack("Author" + std::to_string(gen() % 1000), title, 1900, Genre::Fiction, 4.0, 1);
+        }
+    }
+    return it->second;
+}
+
+template <typename MakeQuery>
+void runTextSearch(benchmark::State &state, MakeQuery make_query) {
+    const auto &db = textDatabase(state.range(0));
+    const auto &words = textVocabulary();
+    std::mt19937 gen{7};
+    size_t found = 0;
+
+    for (auto _ : state) {
+        auto rows = searchBooks(db, make_query(words, gen));
+        found += rows.size();
+        DoNotOptimize(rows);
+    }
+    state.counters["found"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_TextSearchTerm(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::Term(TextField::Title, words[gen() % words.size()]);
+    });
+}
+
+static void BM_TextSearchFrequentTerm(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::Term(TextField::Title, words[gen() % 64]);
+    });
+}
+
+static void BM_TextSearchAnd(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::And({TextQuery::Term(TextField::Title, words[gen() % 64]),
+                               TextQuery::Term(TextField::Title, words[gen() % words.size()])});
+    });
+}
+
+static void BM_TextSearchPhrase(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::Phrase(TextField::Title, words[gen() % 64] + " " + words[gen() % words.size()]);
+    });
+}
+
+static void BM_TextSearchPrefix(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::Prefix(TextField::Title, std::string_view{words[gen() % words.size()]}.substr(0, 5));
+    });
+}
+
+static void BM_TextSearchSubstring(benchmark::State &state) {
+    runTextSearch(state, [](const auto &words, std::mt19937 &gen) {
+        return TextQuery::Substring(TextField::Title, std::string_view{words[gen() % words.size()]}.substr(1, 4));
+    });
+}
+
+// Тот же запрос по слову без индекса: проверка всех заголовков
+static void BM_TextSearchTermScan(benchmark::State &state) {
+    const auto &db = textDatabase(state.range(0));
+    const auto &words = textVocabulary();
+    std::mt19937 gen{7};
+
+    for (auto _ : state) {
+        DoNotOptimize(detail::scanRows(db, TextQuery::Term(TextField::Title, words[gen() % words.size()])));
+    }
+}
+// ################### Полнотекстовый поиск ##################################
+
+// ################### Ленивые представления ##################################
+// База из count книг с короткими заголовками (без выделения памяти под строки), строится один раз на запуск
+const BookDatabase<std::vector<Book>> &pagingDatabase(size_t count) {
+    static std::unordered_map<size_t, BookDatabase<std::vector<Book>>> cache;
+    auto [it, inserted] = cache.try_emplace(count);
+    if (inserted) {
+        std::mt19937 gen{42};
+        it->second.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            it->second.EmplaceBack("Author" + std::to_string(gen() % 1000), "Title",
+                                   1900 + static_cast<int>(gen() % 120), static_cast<Genre>(gen() % kGenreCount),
+                                   static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000));
+        }
+    }
+    return it->second;
+}
+
+const auto pagePredicate = all_of(GenreIs("SciFi"), RatingAbove(4.0));
+
+// Первая страница из 20 книг: обход останавливается, как только страница заполнена
+static void BM_FilterViewFirstPage(benchmark::State &state) {
+    const auto &db = pagingDatabase(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(filterView(db, pagePredicate).Page(0, 20));
+    }
+}
+
+// Первая страница из полного результата filterBooks
+static void BM_FilterBooksFirstPage(benchmark::State &state) {
+    const auto &db = pagingDatabase(state.range(0));
+
+    for (auto _ : state) {
+        auto books = filterBooks(db, pagePredicate);
+        books.erase(books.begin() + std::min<size_t>(20, books.size()), books.end());
+        DoNotOptimize(books);
+    }
+}
+
+static void BM_FilterViewTopN(benchmark::State &state) {
+    const auto &db = pagingDatabase(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(getTopNBy(filterView(db, pagePredicate), 20, comp::LessByPopularity{}));
+    }
+}
+
+static void BM_FilterBooksTopN(benchmark::State &state) {
+    const auto &db = pagingDatabase(state.range(0));
+
+    for (auto _ : state) {
+        auto books = filterBooks(db, pagePredicate);
+        DoNotOptimize(getTopNBy(books.cbegin(), books.cend(), 20, comp::LessByPopularity{}));
+    }
+}
+// ################### Ленивые представления ##################################
+
+// ################### Карта зон ##################################
+// Книги добавлены в хронологическом порядке, как при пополнении каталога, поэтому годы соседних книг близки
+BookDatabase<std::vector<Book>> makeChronological(size_t count) {
+    auto data = generateData(count);
+    std::vector<Book_data> sorted(data.begin(), data.end());
+    std::ranges::stable_sort(sorted, {}, &Book_data::year);
+
+    BookDatabase<std::vector<Book>> db;
+    db.Reserve(sorted.size());
+    for (const auto &v : sorted) {
+        db.EmplaceBack(v.author, v.title, v.year, v.genre, v.rating, v.read_count);
+    }
+    return db;
+}
+
+void reportZoneCounters(benchmark::State &state, const ZoneMap &zones) {
+    const auto counters = zones.GetCounters();
+    state.counters["skipped"] = benchmark::Counter(counters.skipped, benchmark::Counter::kAvgIterations);
+    state.counters["scanned"] = benchmark::Counter(counters.scanned, benchmark::Counter::kAvgIterations);
+    state.counters["full"] = benchmark::Counter(counters.full, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_FilterBooksZoneMap(benchmark::State &state) {
+    auto db = makeChronological(state.range(0));
+    db.GetZoneMap().ResetCounters();
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(db, YearBetween(1985, 1990)));
+    }
+    reportZoneCounters(state, db.GetZoneMap());
+}
+
+static void BM_FilterBooksFullScan(benchmark::State &state) {
+    auto db = makeChronological(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(db.cbegin(), db.cend(), YearBetween(1985, 1990)));
+    }
+}
+
+static void BM_AverageRatingZoneMap(benchmark::State &state) {
+    auto db = makeChronological(state.range(0));
+    db.GetZoneMap().ResetCounters();
+
+    for (auto _ : state) {
+        DoNotOptimize(calculateAverageRating(db, YearBetween(1930, 1980)));
+    }
+    reportZoneCounters(state, db.GetZoneMap());
+}
+
+static void BM_AverageRatingFullScan(benchmark::State &state) {
+    auto db = makeChronological(state.range(0));
+
+    for (auto _ : state) {
+        auto books = filterBooks(db.cbegin(), db.cend(), YearBetween(1930, 1980));
+        DoNotOptimize(std::reduce(books.begin(), books.end(), 0.0, TransparentRatingSum{}) / books.size());
+    }
+}
+// ################### Карта зон ##################################
+
+// ################### Планировщик запросов ##################################
+// Предикаты записаны в неудачном порядке: первым идёт фильтр, который проходят почти все книги
+// (жанр у сгенерированных книг всегда Unknown, годы 1920-1988, рейтинг 0-9)
+const auto unorderedAllOf = all_of(RatingAbove(1.0), GenreIs("Unknown"), YearBetween(1920, 1925));
+const auto unorderedAnyOf = any_of(YearBetween(1920, 1925), RatingAbove(8.5), GenreIs("Unknown"));
+
+static void BM_QueryPlan(benchmark::State &state) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(planQuery(Query::From(unorderedAllOf), ColumnStatistics::Collect(cont)));
+    }
+}
+
+template <typename Pred>
+static void BM_QueryPlanned(benchmark::State &state, Pred pred) {
+    auto cont = makeColumnar(state.range(0));
+    const auto plan = planQuery(Query::From(pred), ColumnStatistics::Collect(cont));
+
+    for (auto _ : state) {
+        DoNotOptimize(executeQuery(cont, plan));
+    }
+}
+
+// Векторная проверка блоками: все фильтры проверяются для всех строк
+template <typename Pred>
+static void BM_QueryMaskFilter(benchmark::State &state, Pred pred) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        DoNotOptimize(filterBooks(cont, pred));
+    }
+}
+
+// Построчная лямбда с порядком проверок, выбранным вручную
+template <typename Pred>
+static void BM_QueryHandOrdered(benchmark::State &state, Pred pred) {
+    auto cont = makeColumnar(state.range(0));
+
+    for (auto _ : state) {
+        std::vector<size_t> rows;
+        for (size_t row = 0; row < cont.size(); ++row) {
+            if (pred(cont, row)) {
+                rows.push_back(row);
+            }
+        }
+        DoNotOptimize(rows);
+    }
+}
+
+const auto handOrderedAllOf = [](const ColumnarBookDatabase &cont, size_t row) {
+    const int year = cont.Years()[row];
+    return year >= 1920 && year < 1925 && cont.Genres()[row] == Genre::Unknown && cont.Ratings()[row] > 1.0;
+};
+
+const auto handOrderedAnyOf = [](const ColumnarBookDatabase &cont, size_t row) {
+    const int year = cont.Years()[row];
+    return cont.Genres()[row] == Genre::Unknown || cont.Ratings()[row] > 8.5 || (year >= 1920 && year < 1925);
+};
+
+const auto unorderedLambdaAllOf = [](const ColumnarBookDatabase &cont, size_t row) {
+    const int year = cont.Years()[row];
+    return cont.Ratings()[row] > 1.0 && cont.Genres()[row] == Genre::Unknown && year >= 1920 && year < 1925;
+};
+// ################### Планировщик запросов ##################################
+// ################### Колоночное хранилище ###################
+
+const size_t ITERATIONS = 10;
+const size_t RANGE_FROM = 1000;
+const size_t RANGE_TO = 100000;
+
+// ################### Тестирование с Vector ##################################
+using Vector = std::vector<Book>;
+
+BENCHMARK(BM_PushBack<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EmplaceBack<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByAuthor<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByPopularity<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByRating<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildAuthorHistogramFlat<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildAuthorHistogram<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateGenreRatings<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateAverageRating<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AggregatedStatistics<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ScannedStatistics<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ModifyAggregated<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAllOf<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAnyOf<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAllOfBranchy<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAnyOfBranchy<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksYearScan<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksYearIndexed<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetTopNBy<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetTopNByPartialSort<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SampleRandomBooks<Vector>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Тестирование с Vector ##################################
+
+// ################### Тестирование с Deque ##################################
+using Deque = std::deque<Book>;
+
+BENCHMARK(BM_PushBack<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EmplaceBack<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByAuthor<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByPopularity<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortLessByRating<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildAuthorHistogramFlat<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildAuthorHistogram<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateGenreRatings<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateAverageRating<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAllOf<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAnyOf<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAllOfBranchy<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksAnyOfBranchy<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksYearScan<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksYearIndexed<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetTopNBy<Deque>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SampleRandomBooks<Deque>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Тестирование с Deque ##################################
+
+// ################### Параллельные статистики ##################################
+const std::vector<int64_t> PARALLEL_SIZES{100000, 1000000};
+const std::vector<int64_t> PARALLEL_THREADS{1, 2, 4, 8, 16};
+
+BENCHMARK(BM_BuildAuthorHistogramFlatParallel<Vector>)
+    ->ArgsProduct({PARALLEL_SIZES, PARALLEL_THREADS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateGenreRatingsParallel<Vector>)
+    ->ArgsProduct({PARALLEL_SIZES, PARALLEL_THREADS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetTopNByParallel<Vector>)
+    ->ArgsProduct({PARALLEL_SIZES, PARALLEL_THREADS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CalculateAverageRatingParallel<Vector>)
+    ->ArgsProduct({PARALLEL_SIZES, PARALLEL_THREADS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+// ################### Параллельные статистики ##################################
+
+// ################### Тестирование с Columnar ##################################
+BENCHMARK(BM_ColumnarBuildAuthorHistogramFlat)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ColumnarCalculateGenreRatings)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ColumnarCalculateAverageRating)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ColumnarFilterBooksAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ColumnarFilterBooksAnyOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Тестирование с Columnar ##################################
+
+// ################### Массовая загрузка ##################################
+// Размер многогигабайтного прогона задаётся переменной окружения BOOKDB_LOADER_ROWS (например, 50000000)
+std::vector<int64_t> loaderSizes() {
+    std::vector<int64_t> sizes{1000000};
+    if (const char *rows = std::getenv("BOOKDB_LOADER_ROWS")) {
+        sizes.push_back(std::atoll(rows));
+    }
+    return sizes;
+}
+
+BENCHMARK(BM_LoadBooksNaive)->ArgsProduct({loaderSizes()})->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadBooks)
+    ->ArgsProduct({loaderSizes(), {1, 2, 4, 8}})
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+// ################### Массовая загрузка ##################################
+
+// ################### Снимки ##################################
+BENCHMARK(BM_ColumnarLoad)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotOpen)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotCalculateAverageRating)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotFilterBooksAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Снимки ##################################
+
+// ################### Политики памяти ##################################
+using PmrVector = std::pmr::vector<Book>;
+
+BENCHMARK(BM_PushBack<Vector, MonotonicArenaPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EmplaceBack<Vector, MonotonicArenaPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EmplaceBack<PmrVector, MonotonicArenaPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EmplaceBack<Vector, PoolMemoryPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Clear<Vector>)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Clear<Vector, MonotonicArenaPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Clear<PmrVector, MonotonicArenaPolicy>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Политики памяти ##################################
+
+// ################### Планировщик запросов ##################################
+BENCHMARK(BM_QueryPlan)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryPlanned, AllOf, unorderedAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryMaskFilter, AllOf, unorderedAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryHandOrdered, AllOf, handOrderedAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryHandOrdered, AllOfUnordered, unorderedLambdaAllOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryPlanned, AnyOf, unorderedAnyOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryMaskFilter, AnyOf, unorderedAnyOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_QueryHandOrdered, AnyOf, handOrderedAnyOf)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Планировщик запросов ##################################
+
+// ################### Карта зон ##################################
+BENCHMARK(BM_FilterBooksZoneMap)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksFullScan)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AverageRatingZoneMap)->Range(RANGE_FROM, RANGE_TO)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AverageRatingFullScan)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+// ################### Карта зон ##################################
+
+// ################### Ленивые представления ##################################
+BENCHMARK(BM_FilterViewFirstPage)->Arg(10000000)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterBooksFirstPage)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FilterViewTopN)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FilterBooksTopN)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+// ################### Ленивые представления ##################################
+
+// ################### Полнотекстовый поиск ##################################
+BENCHMARK(BM_TextSearchTerm)->Arg(1000000)->Arg(10000000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchFrequentTerm)->Arg(1000000)->Arg(10000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchAnd)->Arg(1000000)->Arg(10000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchPhrase)->Arg(1000000)->Arg(10000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchPrefix)->Arg(1000000)->Arg(10000000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchSubstring)->Arg(1000000)->Arg(10000000)->Iterations(100)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TextSearchTermScan)->Arg(1000000)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+// ################### Полнотекстовый поиск ##################################
+
+// ################### Индекс авторов ##################################
+BENCHMARK(BM_GetBooksByAuthor)->Arg(1000000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetBooksByAuthorScan)->Arg(1000000)->Iterations(10)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AuthorPrefixSuggest)->Arg(1000000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetBooksByAuthorPrefix)->Arg(1000000)->Iterations(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetBooksByAuthorPrefixScan)->Arg(1000000)->Iterations(10)->Unit(benchmark::kMicrosecond);
+// ################### Индекс авторов ##################################
+
+// ################### Конкурентная база ##################################
+BENCHMARK(BM_ConcurrentSnapshotRead)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Iterations(20)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_MutexCopyRead)->Arg(100000)->Arg(1000000)->Iterations(20)->Unit(benchmark::kMicrosecond)->UseRealTime();
+// ################### Конкурентная база ##################################
+
+// ################### Шардированная база ##################################
+const std::vector<int64_t> SHARDS{1, 2, 4, 8};
+
+BENCHMARK(BM_ShardedCalculateGenreRatings)
+    ->ArgsProduct({{1000000}, SHARDS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ShardedFilterBooks)
+    ->ArgsProduct({{1000000}, SHARDS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ShardedGetTopNBy)
+    ->ArgsProduct({{1000000}, SHARDS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ShardedBuildAuthorHistogramFlat)
+    ->ArgsProduct({{1000000}, SHARDS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ShardedSampleRandomBooks)
+    ->ArgsProduct({{1000000}, SHARDS})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
+// ################### Шардированная база ##################################
+
+// ################### Журнал предзаписи ##################################
+BENCHMARK(BM_DurableInsert)
+    ->Args({100000, static_cast<int64_t>(WalSync::None)})
+    ->Args({100000, static_cast<int64_t>(WalSync::Group)})
+    ->Iterations(ITERATIONS)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+// Каждая вставка ждёт fdatasync
+BENCHMARK(BM_DurableInsert)
+    ->Args({1000, static_cast<int64_t>(WalSync::Always)})
+    ->Iterations(3)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NonDurableInsert)->Arg(100000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WalReplay)->Arg(100000)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+// ################### Журнал предзаписи ##################################
+
+// ################### Компактные записи ##################################
+BENCHMARK(BM_RowScan)->Arg(10000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompactScan)->Arg(10000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RowSort<comp::LessByRating>)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompactSort<comp::LessByRating>)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RowSort<comp::LessByAuthor>)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompactSort<comp::LessByAuthor>)->Arg(10000000)->Iterations(3)->Unit(benchmark::kMillisecond);
+// ################### Компактные записи ##################################
+
+// ################### Сортировка перестановки ##################################
+BENCHMARK(BM_SortLessByComparison<comp::LessByRating>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortLessByRadix<comp::LessByRating>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortedRows<comp::LessByRating>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortLessByComparison<comp::LessByPopularity>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortLessByRadix<comp::LessByPopularity>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortedRows<comp::LessByPopularity>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortLessByComparison<comp::LessByAuthor>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortLessByRadix<comp::LessByAuthor>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SortedRows<comp::LessByAuthor>)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+// ################### Сортировка перестановки ##################################
+
+// ################### Скетчи ##################################
+BENCHMARK(BM_SketchUpdate)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HyperLogLogUpdate)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TDigestUpdate)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HeavyHittersUpdate)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PushBackSketches)
+    ->Args({1000000, 0})
+    ->Args({1000000, 1})
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExactDashboard)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SketchDashboard)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMicrosecond);
+// ################### Скетчи ##################################
+
+// ################### Реалистичная нагрузка ##################################
+BENCHMARK(BM_WorkloadInsert)->ArgsProduct({workloadSizes(1000000)})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadFilter)->ArgsProduct({workloadSizes()})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadGenreRatings)->ArgsProduct({workloadSizes()})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadAuthorHistogram)->ArgsProduct({workloadSizes()})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadTopN)->ArgsProduct({workloadSizes()})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadSortByAuthor)->ArgsProduct({workloadSizes()})->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadParallelScan)
+    ->ArgsProduct({workloadSizes()})
+    ->ThreadRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorkloadSharded)
+    ->ArgsProduct({workloadSizes(1000000), {1, 2, 4, 8}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+// ################### Реалистичная нагрузка ##################################
+
+// ################### Учёт памяти ##################################
+BENCHMARK(BM_EmplaceBack<Vector, CountingMemoryPolicy<>>)
+    ->Range(RANGE_FROM, RANGE_TO)
+    ->Iterations(ITERATIONS)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CountedInsert)->Arg(1000000)->Iterations(ITERATIONS)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountedFilterBooks)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountedAuthorHistogram)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountedGenreRatings)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CountedTopN)->Arg(1000000)->Unit(benchmark::kMillisecond);
+// ################### Учёт памяти ##################################
+
+// ################### Профилирование запросов ##################################
+BENCHMARK(BM_QueryProbe);
+BENCHMARK(BM_LatencyHistogramRecord);
+BENCHMARK(BM_ProfileSnapshot);
+BENCHMARK(BM_ProfiledFilterBooks)->Arg(1000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ProfiledGenreRatings)->Arg(1000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ProfiledTopN)->Arg(1000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+// ################### Профилирование запросов ##################################
+
+// ################### Группировка ##################################
+BENCHMARK(BM_GroupByGenreBaseline)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByGenre)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByAuthorBaseline)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByAuthor)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByAuthorId)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByDecadeComposed)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByGenreParallel)->ArgsProduct({{1000000}, {1, 2, 4}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupByAuthorParallel)->ArgsProduct({{1000000}, {1, 2, 4}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+// ################### Группировка ##################################
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "book.hpp"
+
+// Генератор реалистичной нагрузки для бенчмарков. В отличие от generateData авторы распределены по закону Ципфа
+// (у популярных авторов тысячи книг, у большинства - единицы), жанры, годы и рейтинги - с перекосом,
+// как в реальном каталоге, заголовки длинные и не помещаются в строку без выделения памяти (SSO).
+// Книги выдаются по одной, поэтому 10M+ книг не требуют промежуточного массива
+
+namespace bookdb::bench {
+
+struct WorkloadOptions {
+    // Размер словаря авторов; 0 - по автору на 20 книг
+    size_t authors = 0;
+    // Показатель Ципфа для популярности авторов, 0 - равномерно
+    double author_skew = 1.1;
+    size_t min_title_words = 3;
+    size_t max_title_words = 10;
+    uint64_t seed = 42;
+};
+
+// Распределение Ципфа на [1, n]: P(k) ~ k^-s. Выборка отбором с обращением (rejection-inversion, Hörmann и
+// Derflinger) за O(1) без таблицы вероятностей, поэтому подходит для словарей из миллионов авторов
+class ZipfDistribution {
+public:
+    ZipfDistribution(uint64_t n, double s) : n_(n), s_(s) {
+        if (n == 0 || s < 0.0) {
+            throw std::invalid_argument{"Zipf distribution needs n > 0 and s >= 0"};
+        }
+        h_integral_x1_ = HIntegral(1.5) - 1.0;
+        h_integral_n_ = HIntegral(static_cast<double>(n) + 0.5);
+        squeeze_ = 2.0 - HIntegralInverse(HIntegral(2.5) - H(2.0));
+    }
+
+    template <typename Gen>
+    uint64_t operator()(Gen &gen) {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        while (true) {
+            const double u = h_integral_n_ + uniform(gen) * (h_integral_x1_ - h_integral_n_);
+            const double x = HIntegralInverse(u);
+            const auto k = std::clamp<uint64_t>(static_cast<uint64_t>(x + 0.5), 1, n_);
+            const auto rank = static_cast<double>(k);
+            if (rank - x <= squeeze_ || u >= HIntegral(rank + 0.5) - H(rank)) {
+                return k;
+            }
+        }
+    }
+
+private:
+    double H(double x) const { return std::exp(-s_ * std::log(x)); }
+
+    // Первообразная H и обратная к ней; helper-функции устойчивы при s -> 1
+    double HIntegral(double x) const {
+        const double log_x = std::log(x);
+        return Expm1OverX((1.0 - s_) * log_x) * log_x;
+    }
+
+    double HIntegralInverse(double x) const {
+        const double t = std::max(x * (1.0 - s_), -1.0);
+        return std::exp(Log1pOverX(t) * x);
+    }
+
+    static double Log1pOverX(double x) {
+        return std::abs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    static double Expm1OverX(double x) {
+        return std::abs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+    }
+
+    uint64_t n_;
+    double s_;
+    double h_integral_x1_;
+    double h_integral_n_;
+    double squeeze_;
+};
+
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(size_t books, const WorkloadOptions &options = {})
+        : gen_(Validate(options).seed),
+          authors_(MakeAuthors(options.authors != 0 ? options.authors : std::max<size_t>(books / 20, 1), gen_)),
+          author_rank_(authors_.size(), options.author_skew),
+          title_length_(options.min_title_words, options.max_title_words),
+          genre_(kGenreWeights.begin(), kGenreWeights.end()) {}
+
+    // Автор книги ссылается на имя в генераторе, заголовок - собственная строка книги
+    Book Next() {
+        // Популярность не связана с алфавитом: ранг Ципфа переводится в случайного автора
+        const std::string &author = authors_[author_rank_(gen_) - 1];
+        return Book{author, MakeTitle(), MakeYear(), static_cast<Genre>(genre_(gen_)), MakeRating(), MakeReadCount()};
+    }
+
+    const std::vector<std::string> &Authors() const { return authors_; }
+
+private:
+    // Проверяется до создания членов: uniform_int_distribution с min > max - неопределённое поведение
+    static const WorkloadOptions &Validate(const WorkloadOptions &options) {
+        if (options.min_title_words == 0 || options.min_title_words > options.max_title_words) {
+            throw std::invalid_argument{"Workload title length range is empty"};
+        }
+        return options;
+    }
+
+    static std::vector<std::string> MakeAuthors(size_t count, std::mt19937_64 &gen) {
+        static constexpr std::array<std::string_view, 16> kFirst{
+            "Anna", "Boris", "Clara", "Dmitry", "Elena", "Fyodor", "Galina", "Ivan",
+            "Julia", "Kirill", "Lev", "Maria", "Nikolai", "Olga", "Pavel", "Sofia"};
+        static constexpr std::array<std::string_view, 16> kLast{
+            "Ivanova", "Petrov", "Smirnova", "Kuznetsov", "Popova", "Sokolov", "Lebedeva", "Kozlov",
+            "Novikova", "Morozov", "Volkova", "Solovyov", "Vasilieva", "Zaitsev", "Pavlova", "Semenov"};
+        std::vector<std::string> names;
+        names.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            // Общие имена и фамилии дают длинные общие префиксы, как в реальном каталоге
+            std::string name{kFirst[i % kFirst.size()]};
+            name += ' ';
+            name += kLast[(i / kFirst.size()) % kLast.size()];
+            if (const size_t series = i / (kFirst.size() * kLast.size()); series != 0) {
+                name += ' ' + std::to_string(series);
+            }
+            names.push_back(std::move(name));
+        }
+        std::ranges::shuffle(names, gen);
+        return names;
+    }
+
+    std::string MakeTitle() {
+        static constexpr std::array<std::string_view, 32> kWords{
+            "the", "of", "and", "night", "river", "silent", "garden", "winter", "last", "house", "war",
+            "peace", "shadow", "light", "city", "journey", "secret", "memory", "stone", "glass", "empire",
+            "sea", "letters", "machine", "forest", "return", "crown", "storm", "island", "mirror", "song", "north"};
+        std::uniform_int_distribution<size_t> word(0, kWords.size() - 1);
+        std::string title;
+        const size_t words = title_length_(gen_);
+        for (size_t i = 0; i < words; ++i) {
+            if (i != 0) {
+                title += ' ';
+            }
+            title += kWords[word(gen_)];
+        }
+        return title;
+    }
+
+    // Большая часть каталога - книги последних десятилетий, хвост уходит в XVIII век
+    int MakeYear() {
+        std::exponential_distribution<double> age(1.0 / 20.0);
+        return std::max(1700, 2024 - static_cast<int>(age(gen_)));
+    }
+
+    // Оценки смещены к 4 и округлены до сотых, как средние оценки читателей
+    double MakeRating() {
+        std::normal_distribution<double> rating(3.9, 0.45);
+        return std::round(std::clamp(rating(gen_), 1.0, 5.0) * 100.0) / 100.0;
+    }
+
+    // Тяжёлый хвост: большинство книг читают десятки раз, единицы - сотни тысяч
+    int MakeReadCount() {
+        std::lognormal_distribution<double> reads(4.0, 1.5);
+        return static_cast<int>(std::min(reads(gen_), static_cast<double>(std::numeric_limits<int>::max())));
+    }
+
+    // Доли жанров Fiction, NonFiction, SciFi, Biography, Mystery, Unknown
+    static constexpr std::array<double, kGenreCount> kGenreWeights{35, 20, 12, 8, 15, 10};
+
+    std::mt19937_64 gen_;
+    std::vector<std::string> authors_;
+    ZipfDistribution author_rank_;
+    std::uniform_int_distribution<size_t> title_length_;
+    std::discrete_distribution<size_t> genre_;
+};
+
+}  // namespace bookdb::bench
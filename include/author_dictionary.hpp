@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "memory_stats.hpp"
+
+namespace bookdb {
+
+// Словарь авторов: каждому имени при первом добавлении назначается плотный идентификатор 0, 1, 2, ...
+// Группировка по автору сводится к индексации массива по идентификатору, имя нужно только при выводе.
+// Символы имён выделяются из memory_resource словаря и не перемещаются, выданные string_view остаются валидными
+class AuthorDictionary {
+public:
+    using size_type = size_t;
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+    using const_iterator = std::pmr::vector<std::string_view>::const_iterator;
+
+    AuthorDictionary() = default;
+    explicit AuthorDictionary(const allocator_type &alloc) : names_(alloc), ids_(alloc) {}
+
+    AuthorDictionary(const AuthorDictionary &other, const allocator_type &alloc = {}) : AuthorDictionary(alloc) {
+        names_.reserve(other.size());
+        std::ranges::for_each(other, [&](std::string_view name) { Add(name); });
+    }
+
+    AuthorDictionary(AuthorDictionary &&other) noexcept = default;
+
+    AuthorDictionary &operator=(const AuthorDictionary &other) {
+        if (this != &other) {
+            AuthorDictionary copy{other, get_allocator()};
+            swap(copy);
+        }
+        return *this;
+    }
+
+    AuthorDictionary &operator=(AuthorDictionary &&other) {
+        if (get_allocator() == other.get_allocator()) {
+            swap(other);
+        } else {
+            *this = other;
+        }
+        return *this;
+    }
+
+    ~AuthorDictionary() { clear(); }
+
+    // Обмен допустим только для словарей с одинаковым аллокатором
+    void swap(AuthorDictionary &other) noexcept {
+        names_.swap(other.names_);
+        ids_.swap(other.ids_);
+    }
+
+    allocator_type get_allocator() const { return names_.get_allocator(); }
+
+    AuthorId Add(std::string_view name) {
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+
+        char *data = get_allocator().allocate_object<char>(name.size());
+        std::ranges::copy(name, data);
+        const std::string_view stored{data, name.size()};
+
+        const auto id = static_cast<AuthorId>(names_.size());
+        names_.push_back(stored);
+        ids_.emplace(stored, id);
+        return id;
+    }
+
+    std::optional<AuthorId> Find(std::string_view name) const {
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::string_view Name(AuthorId id) const { return names_[id]; }
+
+    void clear() {
+        for (auto name : names_) {
+            get_allocator().deallocate_object(const_cast<char *>(name.data()), name.size());
+        }
+        names_.clear();
+        ids_.clear();
+    }
+
+    size_type size() const { return names_.size(); }
+
+    bool empty() const { return names_.empty(); }
+
+    // Символы имён, массив имён и хеш-таблица поиска
+    size_t MemoryBytes() const {
+        size_t bytes = names_.capacity() * sizeof(std::string_view) + detail::hashTableBytes(ids_);
+        std::ranges::for_each(names_, [&](std::string_view name) { bytes += name.size(); });
+        return bytes;
+    }
+
+    // Имена в порядке назначения идентификаторов
+    const_iterator begin() const { return names_.begin(); }
+
+    const_iterator end() const { return names_.end(); }
+
+private:
+    std::pmr::vector<std::string_view> names_;
+    std::pmr::unordered_map<std::string_view, AuthorId> ids_;
+};
+
+}  // namespace bookdb
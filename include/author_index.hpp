@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "author_dictionary.hpp"
+#include "book.hpp"
+#include "heterogeneous_lookup.hpp"
+
+namespace bookdb {
+
+// Упорядоченный индекс авторов: отсортированный по имени массив авторов словаря и списки вхождений
+// "автор -> номера строк его книг" по возрастанию. Точный поиск, поиск по префиксу и по диапазону имён
+// выполняются бинарным поиском по string_view за O(log n + k) без создания временных строк.
+// Новые авторы словаря добавляются в массив лениво (Sync): хвост сортируется и сливается с уже упорядоченной частью
+class AuthorIndex {
+public:
+    struct Entry {
+        std::string_view name;
+        AuthorId id;
+    };
+
+    void Add(size_t row, AuthorId author) {
+        if (author >= postings_.size()) {
+            postings_.resize(author + 1);
+        }
+        auto &rows = postings_[author];
+        if (rows.empty() || rows.back() < row) {
+            rows.push_back(row);
+        } else {
+            rows.insert(std::ranges::lower_bound(rows, row), row);
+        }
+    }
+
+    void Remove(size_t row, AuthorId author) {
+        if (author >= postings_.size()) {
+            return;
+        }
+        auto &rows = postings_[author];
+        if (auto it = std::ranges::lower_bound(rows, row); it != rows.end() && *it == row) {
+            rows.erase(it);
+        }
+    }
+
+    // Сбрасывает списки вхождений, упорядоченные авторы сохраняются
+    void ClearRows() { postings_.clear(); }
+
+    void Clear() {
+        postings_.clear();
+        entries_.clear();
+    }
+
+    // Добавляет авторов, появившихся в словаре после прошлой синхронизации
+    void Sync(const AuthorDictionary &authors) {
+        const size_t sorted = entries_.size();
+        if (sorted == authors.size()) {
+            return;
+        }
+        for (size_t id = sorted; id < authors.size(); ++id) {
+            entries_.push_back({authors.Name(static_cast<AuthorId>(id)), static_cast<AuthorId>(id)});
+        }
+        const auto middle = entries_.begin() + static_cast<std::ptrdiff_t>(sorted);
+        std::ranges::sort(middle, entries_.end(), TransparentStringLess{}, &Entry::name);
+        std::ranges::inplace_merge(entries_, middle, TransparentStringLess{}, &Entry::name);
+    }
+
+    // Перенаправляет имена на другой словарь с теми же идентификаторами (копия базы)
+    void Rebind(const AuthorDictionary &authors) {
+        std::ranges::for_each(entries_, [&](Entry &entry) { entry.name = authors.Name(entry.id); });
+    }
+
+    // Авторы в порядке имён
+    std::span<const Entry> Authors() const { return entries_; }
+
+    // Автор с именем name (пустой диапазон, если его нет)
+    std::span<const Entry> Find(std::string_view name) const {
+        return Slice(std::ranges::equal_range(entries_, name, TransparentStringLess{}, &Entry::name));
+    }
+
+    // Авторы, имена которых начинаются с prefix, по возрастанию имён (подсказки при вводе)
+    std::span<const Entry> Prefix(std::string_view prefix) const {
+        auto first = std::ranges::lower_bound(entries_, prefix, TransparentStringLess{}, &Entry::name);
+        auto last = std::ranges::partition_point(first, entries_.end(),
+                                                 [&](const Entry &entry) { return entry.name.starts_with(prefix); });
+        return Slice(std::ranges::subrange(first, last));
+    }
+
+    // Авторы с именами из [from, to)
+    std::span<const Entry> Range(std::string_view from, std::string_view to) const {
+        if (!(from < to)) {
+            return {};
+        }
+        auto first = std::ranges::lower_bound(entries_, from, TransparentStringLess{}, &Entry::name);
+        auto last = std::ranges::lower_bound(first, entries_.end(), to, TransparentStringLess{}, &Entry::name);
+        return Slice(std::ranges::subrange(first, last));
+    }
+
+    // Строки книг автора по возрастанию
+    std::span<const size_t> Rows(AuthorId author) const {
+        return author < postings_.size() ? std::span<const size_t>{postings_[author]} : std::span<const size_t>{};
+    }
+
+    // Строки книг всех авторов из entries по возрастанию
+    std::vector<size_t> Rows(std::span<const Entry> entries) const {
+        std::vector<size_t> rows;
+        for (const Entry &entry : entries) {
+            auto author_rows = Rows(entry.id);
+            rows.insert(rows.end(), author_rows.begin(), author_rows.end());
+        }
+        if (entries.size() > 1) {
+            std::ranges::sort(rows);
+        }
+        return rows;
+    }
+
+    // Количество упорядоченных авторов
+    size_t size() const { return entries_.size(); }
+
+    bool empty() const { return entries_.empty(); }
+
+    size_t MemoryBytes() const {
+        size_t bytes = entries_.capacity() * sizeof(Entry) + postings_.capacity() * sizeof(std::vector<size_t>);
+        std::ranges::for_each(postings_, [&](const auto &rows) { bytes += rows.capacity() * sizeof(size_t); });
+        return bytes;
+    }
+
+private:
+    template <typename Subrange>
+    std::span<const Entry> Slice(Subrange range) const {
+        return {range.begin(), range.end()};
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<std::vector<size_t>> postings_;
+};
+
+}  // namespace bookdb
@@ -1,7 +1,11 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <format>
+#include <limits>
+#include <memory_resource>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -14,6 +18,16 @@ namespace bookdb {
 
 enum class Genre { Fiction, NonFiction, SciFi, Biography, Mystery, Unknown };
 
+// Количество значений Genre, позволяет хранить агрегаты по жанрам в плотном массиве
+constexpr size_t kGenreCount = static_cast<size_t>(Genre::Unknown) + 1;
+
+// Индекс жанра в массивах из kGenreCount элементов. Значение вне перечисления (например, из повреждённого
+// снимка) попадает в Unknown, а не за границу массива
+constexpr size_t genreIndex(Genre genre) {
+    const auto index = static_cast<size_t>(genre);
+    return index < kGenreCount ? index : static_cast<size_t>(Genre::Unknown);
+}
+
 constexpr Genre ConvertGenre(const std::string_view s) {
 
     if (s == "Fiction") {
@@ -52,25 +66,56 @@ constexpr const std::string_view ConvertGenre(const Genre g) {
     }
 };
 
+// Плотный идентификатор автора, назначается словарём авторов базы
+using AuthorId = uint32_t;
+
+constexpr AuthorId kNoAuthorId = std::numeric_limits<AuthorId>::max();
+
+// Book поддерживает uses-allocator construction: pmr-контейнеры и BookDatabase с политикой памяти
+// размещают заголовок книги в своём memory_resource (например, в арене)
 struct Book {
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
     // string_view для экономии памяти, чтобы ссылаться на оригинальную строку, хранящуюся в другом контейнере
     std::string_view author;
-    std::string title;
+    std::pmr::string title;
 
     int year;
     Genre genre;
     double rating;
     int read_count;
 
-    constexpr Book(std::string_view author, std::string &&title, int year, std::string_view genre, double rating,
-                   int read_count)
-        : author(author), title(std::move(title)), year(year), genre(ConvertGenre(genre)), rating(rating),
+    // Назначается базой при добавлении книги, занимает выравнивание после read_count и не увеличивает размер Book
+    AuthorId author_id = kNoAuthorId;
+
+    Book(std::string_view author, std::string_view title, int year, std::string_view genre, double rating,
+         int read_count, const allocator_type &alloc = {})
+        : author(author), title(title, alloc), year(year), genre(ConvertGenre(genre)), rating(rating),
           read_count(read_count) {};
 
-    constexpr Book(std::string_view author, std::string title, int year, Genre genre, double rating, int read_count)
-        : author(author), title(std::move(title)), year(year), genre(genre), rating(rating), read_count(read_count) {};
+    Book(std::string_view author, std::string_view title, int year, Genre genre, double rating, int read_count,
+         const allocator_type &alloc = {})
+        : author(author), title(title, alloc), year(year), genre(genre), rating(rating), read_count(read_count) {};
 
-    bool operator<=>(const Book &other) const = default;
+    Book(const Book &other) = default;
+    Book(Book &&other) noexcept = default;
+
+    Book(const Book &other, const allocator_type &alloc)
+        : author(other.author), title(other.title, alloc), year(other.year), genre(other.genre),
+          rating(other.rating), read_count(other.read_count), author_id(other.author_id) {};
+
+    Book(Book &&other, const allocator_type &alloc)
+        : author(other.author), title(std::move(other.title), alloc), year(other.year), genre(other.genre),
+          rating(other.rating), read_count(other.read_count), author_id(other.author_id) {};
+
+    Book &operator=(const Book &other) = default;
+    Book &operator=(Book &&other) = default;
+
+    // Идентификатор автора зависит от базы, в которой хранится книга, поэтому в сравнении не участвует
+    bool operator==(const Book &other) const {
+        return author == other.author && title == other.title && year == other.year && genre == other.genre &&
+               rating == other.rating && read_count == other.read_count;
+    }
 };
 }  // namespace bookdb
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "book.hpp"
+
+namespace bookdb {
+
+// Сумма и количество рейтингов
+struct RatingSum {
+    double sum = 0.0;
+    size_t count = 0;
+
+    void Add(double rating) {
+        sum += rating;
+        count++;
+    }
+
+    void Remove(double rating) {
+        sum -= rating;
+        count--;
+    }
+
+    double Avg() const { return count == 0 ? 0.0 : sum / count; }
+};
+
+// Сумма рейтингов с компенсацией (алгоритм Ноймайера): ошибки округления добавлений и вычитаний
+// накапливаются в отдельном слагаемом, поэтому сумма не дрейфует при длинной серии изменений
+struct CompensatedRatingSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+    size_t count = 0;
+
+    void Add(double rating) {
+        Accumulate(rating);
+        count++;
+    }
+
+    void Remove(double rating) {
+        Accumulate(-rating);
+        count--;
+    }
+
+    RatingSum Value() const { return {sum + compensation, count}; }
+
+    void Accumulate(double value) {
+        const double next = sum + value;
+        compensation += std::abs(sum) >= std::abs(value) ? (sum - next) + value : (value - next) + sum;
+        sum = next;
+    }
+};
+
+// Материализованные агрегаты базы: суммы рейтингов по жанрам и в целом, количество книг каждого автора.
+// Обновляются при каждом добавлении и изменении книги, поэтому запросы не сканируют коллекцию.
+// Суммы компенсированные: после любого числа изменений они отличаются от суммы, посчитанной заново,
+// лишь последними битами, а не накопленной ошибкой вычитаний
+class BookAggregates {
+public:
+    void Add(const Book &book) {
+        genres_[static_cast<size_t>(book.genre)].Add(book.rating);
+        total_.Add(book.rating);
+        if (book.author_id >= author_counts_.size()) {
+            author_counts_.resize(book.author_id + 1);
+        }
+        author_counts_[book.author_id]++;
+    }
+
+    void Remove(const Book &book) {
+        genres_[static_cast<size_t>(book.genre)].Remove(book.rating);
+        total_.Remove(book.rating);
+        author_counts_[book.author_id]--;
+    }
+
+    void Clear() {
+        genres_ = {};
+        total_ = {};
+        author_counts_.clear();
+    }
+
+    RatingSum ByGenre(Genre genre) const { return genres_[static_cast<size_t>(genre)].Value(); }
+
+    RatingSum Total() const { return total_.Value(); }
+
+    // Количество книг автора по его идентификатору; авторы без книг в конце массива могут отсутствовать
+    std::span<const size_t> AuthorCounts() const { return author_counts_; }
+
+    size_t MemoryBytes() const { return author_counts_.capacity() * sizeof(size_t); }
+
+private:
+    std::array<CompensatedRatingSum, kGenreCount> genres_{};
+    CompensatedRatingSum total_;
+    std::vector<size_t> author_counts_;
+};
+
+}  // namespace bookdb
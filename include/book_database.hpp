@@ -1,16 +1,34 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <print>
 #include <string>
-#include <unordered_set>
+#include <string_view>
 #include <vector>
 
+#include "author_dictionary.hpp"
+#include "author_index.hpp"
+#include "book_aggregates.hpp"
 #include "book.hpp"
 #include "concepts.hpp"
+#include "memory_policy.hpp"
+#include "memory_stats.hpp"
+#include "secondary_index.hpp"
+#include "sketches.hpp"
+#include "text_index.hpp"
+#include "zone_map.hpp"
 
 namespace bookdb {
 
-template <BookContainerLike BookContainer = std::vector<Book>>
+// MemoryPolicy задаёт memory_resource для заголовков книг и имён авторов (см. memory_policy.hpp).
+// Если BookContainer - pmr-контейнер, в том же ресурсе размещаются и сами книги
+template <BookContainerLike BookContainer = std::vector<Book>, MemoryPolicyLike MemoryPolicy = HeapMemoryPolicy>
 class BookDatabase {
 public:
     // Type aliases
@@ -43,16 +61,141 @@ public:
     using reverse_iterator = typename BookContainer::reverse_iterator;
     using const_reverse_iterator = typename BookContainer::const_reverse_iterator;
 
-    using AuthorContainer = std::unordered_set<std::string>;
+    using AuthorContainer = AuthorDictionary;
 
-    BookDatabase() = default;
-    BookDatabase(std::initializer_list<Book> list) : books_(list) {
-        std::for_each(books_.begin(), books_.end(), [&](reference book) { AddAuthor(book); });
+    using YearIndex = SecondaryIndex<int>;
+    using RatingIndex = SecondaryIndex<double>;
+    using ReadCountIndex = SecondaryIndex<int>;
+
+    BookDatabase() : books_(MakeBooks()), authors_(memory_.resource()) {}
+    BookDatabase(std::initializer_list<Book> list) : BookDatabase() {
+        std::for_each(list.begin(), list.end(), [&](const Book &book) { PushBack(book); });
     };
 
+    // Копия получает собственные ресурс памяти и словарь авторов, авторы книг перенаправляются на него.
+    // Идентификаторы авторов сохраняются, поэтому индексы и агрегаты копируются как есть
+    BookDatabase(const BookDatabase &other) : books_(MakeBooks()), authors_(other.authors_, memory_.resource()) {
+        Reserve(other.size());
+        std::for_each(other.books_.begin(), other.books_.end(), [&](const Book &book) {
+            EmplaceBook(book);
+            books_.back().author = authors_.Name(book.author_id);
+        });
+        std::lock_guard lock{other.derived_mutex_};
+        year_index_ = other.year_index_;
+        rating_index_ = other.rating_index_;
+        read_count_index_ = other.read_count_index_;
+        indexes_dirty_ = other.indexes_dirty_;
+        aggregates_ = other.aggregates_;
+        aggregates_dirty_ = other.aggregates_dirty_;
+        zones_ = other.zones_;
+        zones_dirty_ = other.zones_dirty_;
+        text_index_ = other.text_index_;
+        text_index_dirty_ = other.text_index_dirty_;
+        sketches_ = other.sketches_;
+        sketches_dirty_ = other.sketches_dirty_;
+        author_index_ = other.author_index_;
+        author_index_.Rebind(authors_);
+        author_index_dirty_ = other.author_index_dirty_;
+    }
+
+    // Ресурс политики хранится по указателю, поэтому перемещённые контейнеры продолжают ссылаться на живой ресурс.
+    // Исходная база остаётся пустой и рабочей: её контейнеры пересоздаются на новом ресурсе её политики.
+    // Единственное, что здесь может бросить, - выделение этого нового ресурса; нехватка памяти в этот момент
+    // завершает программу, зато перемещение никогда не оставляет базу наполовину собранной
+    BookDatabase(BookDatabase &&other) noexcept
+        : memory_(std::move(other.memory_)),
+          books_(std::move(other.books_)),
+          authors_(std::move(other.authors_)),
+          year_index_(std::move(other.year_index_)),
+          rating_index_(std::move(other.rating_index_)),
+          read_count_index_(std::move(other.read_count_index_)),
+          indexes_dirty_(other.indexes_dirty_),
+          aggregates_(std::move(other.aggregates_)),
+          aggregates_dirty_(other.aggregates_dirty_),
+          zones_(std::move(other.zones_)),
+          zones_dirty_(other.zones_dirty_),
+          text_index_(std::move(other.text_index_)),
+          text_index_dirty_(other.text_index_dirty_),
+          sketches_(std::move(other.sketches_)),
+          sketches_dirty_(other.sketches_dirty_),
+          author_index_(std::move(other.author_index_)),
+          author_index_dirty_(other.author_index_dirty_) {
+        other.ResetStorage();
+        other.Clear();
+    }
+
+    // Почленное присваивание разрушило бы ресурс раньше контейнеров, выделивших из него память, а обмен
+    // pmr-контейнеров с разными ресурсами не определён. Поэтому объект пересоздаётся целиком: конструктор
+    // перемещения noexcept, и между destroy_at и construct_at исключение вылететь не может
+    BookDatabase &operator=(BookDatabase &&other) noexcept {
+        if (this != &other) {
+            std::destroy_at(this);
+            std::construct_at(this, std::move(other));
+        }
+        return *this;
+    }
+
+    BookDatabase &operator=(const BookDatabase &other) {
+        if (this != &other) {
+            *this = BookDatabase(other);
+        }
+        return *this;
+    }
+
     void Clear() {
-        books_.clear();
-        authors_.clear();
+        if constexpr (MemoryPolicy::kBulkRelease) {
+            // Строки (и книги для pmr-контейнера) лежат в ресурсе политики: вся память ресурса возвращается
+            // одним вызовом. Если и буфер книг в ресурсе, деструкторы элементов не вызываются вовсе - они лишь
+            // освобождали бы память ресурса, и очистка не зависит от числа книг. Буфер std::vector лежит в куче,
+            // поэтому такой контейнер разрушается обычным образом
+            if constexpr (!kBooksInResource) {
+                std::destroy_at(&books_);
+            }
+            memory_.release();
+            std::construct_at(&books_, MakeBooks());
+            std::construct_at(&authors_, memory_.resource());
+        } else {
+            books_.clear();
+            authors_.clear();
+        }
+        RebuildIndexes();
+        RebuildAggregates();
+        RebuildZones();
+        RebuildTextIndex();
+        RebuildSketches();
+        author_index_.Clear();
+        RebuildAuthorIndex();
+    }
+
+    std::pmr::memory_resource *GetMemoryResource() const { return memory_.resource(); }
+
+    // Политика памяти базы; у CountingMemoryPolicy через неё доступны счётчики выделений
+    const MemoryPolicy &GetMemoryPolicy() const { return memory_; }
+
+    // Разбивка памяти базы по структурам (см. memory_stats.hpp). Производные структуры, ожидающие
+    // перестроения, учитываются в текущем состоянии
+    bookdb::MemoryStats MemoryStats() const {
+        std::lock_guard lock{derived_mutex_};
+        bookdb::MemoryStats stats;
+        if constexpr (requires { books_.capacity(); }) {
+            stats.book_storage = books_.capacity() * sizeof(value_type);
+        } else {
+            stats.book_storage = books_.size() * sizeof(value_type);
+        }
+        std::for_each(books_.begin(), books_.end(),
+                      [&](const Book &book) { stats.title_heap += detail::stringHeapBytes(book.title); });
+        stats.author_set = authors_.MemoryBytes();
+
+        stats.indexes += year_index_ ? year_index_->MemoryBytes() : 0;
+        stats.indexes += rating_index_ ? rating_index_->MemoryBytes() : 0;
+        stats.indexes += read_count_index_ ? read_count_index_->MemoryBytes() : 0;
+        stats.indexes += text_index_ ? text_index_->MemoryBytes() : 0;
+        stats.indexes += author_index_.MemoryBytes();
+
+        stats.derived = zones_.MemoryBytes();
+        stats.derived += aggregates_ ? aggregates_->MemoryBytes() : 0;
+        stats.derived += sketches_ ? sketches_->MemoryBytes() : 0;
+        return stats;
     }
 
     const_reference back() const { return books_.back(); }
@@ -60,18 +203,258 @@ public:
     // Standard container interface methods
     template <typename... Args>
     const_reference EmplaceBack(Args &&...args) {
-        books_.emplace_back(std::forward<Args>(args)...);
+        EmplaceBook(std::forward<Args>(args)...);
         AddAuthor(books_.back());
+        AddToDerived(books_.size() - 1);
         return books_.back();
     }
 
+    // Пакетное добавление (см. bulk_loader.hpp): авторы пачки заносятся в словарь заранее через InternAuthor,
+    // а EmplaceBackInterned добавляет книгу, не обращаясь к словарю повторно
+    AuthorId InternAuthor(std::string_view name) { return authors_.Add(name); }
+
+    const_reference EmplaceBackInterned(AuthorId author, std::string_view title, int year, Genre genre, double rating,
+                                        int read_count) {
+        EmplaceBook(authors_.Name(author), title, year, genre, rating, read_count);
+        books_.back().author_id = author;
+        AddToDerived(books_.size() - 1);
+        return books_.back();
+    }
+
+    // Резервирует место под count книг, если контейнер это поддерживает
+    void Reserve(size_type count) {
+        if constexpr (requires { books_.reserve(count); }) {
+            books_.reserve(count);
+        }
+    }
+
     template <BookRef BookRef>
     void PushBack(BookRef &&book) {
-        books_.push_back(std::forward<BookRef>(book));
+        if constexpr (kAllocatorAwareBooks) {
+            books_.push_back(std::forward<BookRef>(book));
+        } else if constexpr (std::same_as<std::remove_cvref_t<BookRef>, Book>) {
+            books_.emplace_back(std::forward<BookRef>(book), Book::allocator_type{memory_.resource()});
+        } else {
+            books_.emplace_back(Book(std::forward<BookRef>(book)), Book::allocator_type{memory_.resource()});
+        }
         AddAuthor(books_.back());
+        AddToDerived(books_.size() - 1);
+    }
+
+    const_reference operator[](size_type idx) const { return books_[idx]; }
+
+    // Изменение книги: fn(Book &) меняет поля книги, индексы и агрегаты обновляются инкрементально.
+    // Если fn бросает исключение, книга могла измениться частично, и производные данные перестраиваются целиком
+    template <std::invocable<reference> Fn>
+    void Modify(size_type idx, Fn &&fn) {
+        RemoveFromDerived(idx);
+        try {
+            std::forward<Fn>(fn)(books_[idx]);
+        } catch (...) {
+            InvalidateDerived();
+            throw;
+        }
+        AddAuthor(books_[idx]);
+        AddToDerived(idx);
+    }
+
+    // Замена книги целиком, заголовок остаётся в памяти базы
+    template <BookRef BookRef>
+    void Replace(size_type idx, BookRef &&book) {
+        Modify(idx, [&](reference target) { target = std::forward<BookRef>(book); });
+    }
+
+    // Материализованные агрегаты (см. book_aggregates.hpp). Поддерживаются при добавлении книг и в Modify,
+    // после изменений через MutableRange() пересчитываются при следующем обращении
+    void EnableAggregates() {
+        aggregates_.emplace();
+        RebuildAggregates();
+    }
+
+    void DisableAggregates() { aggregates_.reset(); }
+
+    bool HasAggregates() const { return aggregates_.has_value(); }
+
+    // nullptr, если агрегаты не включены
+    const BookAggregates *GetAggregates() const {
+        std::lock_guard lock{derived_mutex_};
+        if (aggregates_dirty_) {
+            RebuildAggregates();
+        }
+        return aggregates_ ? &*aggregates_ : nullptr;
+    }
+
+    // Потоковые скетчи (см. sketches.hpp) пополняются при добавлении книг. Удалять значения скетчи не умеют,
+    // поэтому после Modify и MutableRange() строятся заново при следующем обращении
+    void EnableSketches(const SketchOptions &options = {}) {
+        sketches_.emplace(options);
+        RebuildSketches();
+    }
+
+    void DisableSketches() { sketches_.reset(); }
+
+    bool HasSketches() const { return sketches_.has_value(); }
+
+    // nullptr, если скетчи не включены
+    const BookSketches *GetSketches() const {
+        std::lock_guard lock{derived_mutex_};
+        if (sketches_dirty_) {
+            RebuildSketches();
+        }
+        return sketches_ ? &*sketches_ : nullptr;
+    }
+
+    // Карта зон (см. zone_map.hpp) поддерживается всегда: при добавлении книг и в Modify,
+    // после изменений через MutableRange() перестраивается при следующем обращении
+    const ZoneMap &GetZoneMap() const {
+        std::lock_guard lock{derived_mutex_};
+        if (zones_dirty_) {
+            RebuildZones();
+        }
+        return zones_;
+    }
+
+    // Полнотекстовый индекс заголовков и имён авторов (см. text_index.hpp и text_search.hpp).
+    // Добавление книг обновляет его инкрементально; сжатые списки вхождений не поддерживают удаление,
+    // поэтому после Modify и MutableRange() индекс перестраивается при следующем обращении
+    void EnableTextIndex(const TextIndexOptions &options = {}) {
+        text_index_.emplace(options);
+        RebuildTextIndex();
+    }
+
+    void DisableTextIndex() { text_index_.reset(); }
+
+    bool HasTextIndex() const { return text_index_.has_value(); }
+
+    // nullptr, если индекс не включён
+    const BookTextIndex *GetTextIndex() const {
+        std::lock_guard lock{derived_mutex_};
+        if (text_index_dirty_) {
+            RebuildTextIndex();
+        }
+        return text_index_ ? &*text_index_ : nullptr;
     }
 
-    reference operator[](size_type idx) { return books_[idx]; }
+    // Упорядоченный индекс авторов (см. author_index.hpp) поддерживается всегда, как и карта зон.
+    // Авторы, добавленные в словарь после прошлого обращения, упорядочиваются при следующем: слияние
+    // на каждое добавление стоило бы O(число авторов). Слияние идёт под тем же мьютексом, что и перестроения
+    const AuthorIndex &GetAuthorIndex() const {
+        std::lock_guard lock{derived_mutex_};
+        if (author_index_dirty_) {
+            RebuildAuthorIndex();
+        }
+        author_index_.Sync(authors_);
+        return author_index_;
+    }
+
+    // Книги автора в порядке строк, без сканирования базы
+    std::vector<std::reference_wrapper<const Book>> GetBooksByAuthor(std::string_view author) const {
+        const auto id = authors_.Find(author);
+        if (!id) {
+            return {};
+        }
+        auto rows = GetAuthorIndex().Rows(*id);
+        return BooksAt(rows);
+    }
+
+    // Книги авторов, имена которых начинаются с prefix, в порядке строк
+    std::vector<std::reference_wrapper<const Book>> GetBooksByAuthorPrefix(std::string_view prefix) const {
+        const auto &index = GetAuthorIndex();
+        return BooksAt(index.Rows(index.Prefix(prefix)));
+    }
+
+    // Книги авторов с именами из [from, to) в порядке строк
+    std::vector<std::reference_wrapper<const Book>> GetBooksByAuthorRange(std::string_view from,
+                                                                          std::string_view to) const {
+        const auto &index = GetAuthorIndex();
+        return BooksAt(index.Rows(index.Range(from, to)));
+    }
+
+    // Вторичные индексы. Добавление книг и Modify обновляют их инкрементально.
+    // Изменяемый доступ через MutableRange() может переупорядочить или изменить книги,
+    // поэтому после него индексы перестраиваются при следующем обращении к ним
+    void CreateIndex(IndexedField field) {
+        switch (field) {
+        case IndexedField::Year:
+            year_index_.emplace();
+            break;
+        case IndexedField::Rating:
+            rating_index_.emplace();
+            break;
+        case IndexedField::ReadCount:
+            read_count_index_.emplace();
+            break;
+        }
+        RebuildIndexes();
+    }
+
+    void DropIndex(IndexedField field) {
+        switch (field) {
+        case IndexedField::Year:
+            year_index_.reset();
+            break;
+        case IndexedField::Rating:
+            rating_index_.reset();
+            break;
+        case IndexedField::ReadCount:
+            read_count_index_.reset();
+            break;
+        }
+    }
+
+    bool HasIndex(IndexedField field) const {
+        switch (field) {
+        case IndexedField::Year:
+            return year_index_.has_value();
+        case IndexedField::Rating:
+            return rating_index_.has_value();
+        case IndexedField::ReadCount:
+            return read_count_index_.has_value();
+        }
+        return false;
+    }
+
+    // nullptr, если индекс не создан
+    const YearIndex *GetYearIndex() const {
+        EnsureIndexes();
+        return year_index_ ? &*year_index_ : nullptr;
+    }
+
+    const RatingIndex *GetRatingIndex() const {
+        EnsureIndexes();
+        return rating_index_ ? &*rating_index_ : nullptr;
+    }
+
+    const ReadCountIndex *GetReadCountIndex() const {
+        EnsureIndexes();
+        return read_count_index_ ? &*read_count_index_ : nullptr;
+    }
+
+    // Изменяемый доступ к книгам в обход Modify, например для std::ranges::sort. Производные структуры
+    // помечаются устаревшими при разрушении диапазона, то есть после всех изменений через него: запрос,
+    // перестроивший их посреди изменений, не оставит их устаревшими. Итераторы не должны переживать диапазон
+    class MutableBooks {
+    public:
+        explicit MutableBooks(BookDatabase &db) : db_(&db) {}
+
+        MutableBooks(const MutableBooks &) = delete;
+        MutableBooks &operator=(const MutableBooks &) = delete;
+
+        ~MutableBooks() { db_->InvalidateDerived(); }
+
+        iterator begin() const { return db_->books_.begin(); }
+
+        iterator end() const { return db_->books_.end(); }
+
+        reverse_iterator rbegin() const { return db_->books_.rbegin(); }
+
+        reverse_iterator rend() const { return db_->books_.rend(); }
+
+    private:
+        BookDatabase *db_;
+    };
+
+    MutableBooks MutableRange() { return MutableBooks{*this}; }
 
     const BookContainer &GetBooks() const { return books_; }
 
@@ -81,35 +464,241 @@ public:
 
     bool empty() const { return books_.empty(); }
 
-    iterator begin() { return books_.begin(); }
+    // Обход базы только читает книги, поэтому не трогает производные структуры; изменять книги можно
+    // через Modify, Replace или MutableRange()
+    const_iterator begin() const { return books_.cbegin(); }
 
-    iterator end() { return books_.end(); }
+    const_iterator end() const { return books_.cend(); }
 
     const_iterator cbegin() const { return books_.cbegin(); }
 
     const_iterator cend() const { return books_.cend(); }
 
-    reverse_iterator rbegin() { return books_.rbegin(); }
+    const_reverse_iterator rbegin() const { return books_.crbegin(); }
 
-    reverse_iterator rend() { return books_.rend(); }
+    const_reverse_iterator rend() const { return books_.crend(); }
 
     const_reverse_iterator crbegin() const { return books_.crbegin(); }
 
     const_reverse_iterator crend() const { return books_.crend(); }
 
 private:
-    void AddAuthor(reference book) { book.author = *authors_.emplace(book.author).first; }
+    // pmr-контейнер сам передаёт свой аллокатор конструктору Book, для кучи аллокатор передавать не нужно
+    static constexpr bool kBooksInResource = std::same_as<allocator_type, std::pmr::polymorphic_allocator<Book>>;
+
+    static constexpr bool kAllocatorAwareBooks = kBooksInResource || std::same_as<MemoryPolicy, HeapMemoryPolicy>;
+
+    BookContainer MakeBooks() const {
+        if constexpr (kBooksInResource) {
+            return BookContainer(allocator_type{memory_.resource()});
+        } else {
+            return BookContainer{};
+        }
+    }
+
+    // Пересоздаёт пустые контейнеры на текущем ресурсе политики (после перемещения из базы)
+    void ResetStorage() {
+        std::destroy_at(&authors_);
+        std::destroy_at(&books_);
+        std::construct_at(&books_, MakeBooks());
+        std::construct_at(&authors_, memory_.resource());
+    }
+
+    template <typename... Args>
+    void EmplaceBook(Args &&...args) {
+        if constexpr (kAllocatorAwareBooks) {
+            books_.emplace_back(std::forward<Args>(args)...);
+        } else {
+            books_.emplace_back(std::forward<Args>(args)..., Book::allocator_type{memory_.resource()});
+        }
+    }
+
+    // Автор книги заменяется ссылкой на имя в словаре базы и получает плотный идентификатор
+    void AddAuthor(reference book) {
+        book.author_id = authors_.Add(book.author);
+        book.author = authors_.Name(book.author_id);
+    }
+
+    template <std::ranges::input_range Rows>
+    std::vector<std::reference_wrapper<const Book>> BooksAt(Rows &&rows) const {
+        std::vector<std::reference_wrapper<const Book>> books;
+        books.reserve(std::ranges::size(rows));
+        std::ranges::for_each(rows, [&](size_t row) { books.emplace_back(books_[row]); });
+        return books;
+    }
+
+    void AddToDerived(size_type row) {
+        AddToIndexes(row);
+        if (aggregates_ && !aggregates_dirty_) {
+            aggregates_->Add(books_[row]);
+        }
+        if (!zones_dirty_) {
+            zones_.Add(row, books_[row]);
+        }
+        if (text_index_ && !text_index_dirty_) {
+            text_index_->Add(row, books_[row]);
+        }
+        if (sketches_ && !sketches_dirty_) {
+            sketches_->Add(books_[row]);
+        }
+        if (!author_index_dirty_) {
+            author_index_.Add(row, books_[row].author_id);
+        }
+    }
+
+    void RemoveFromDerived(size_type row) {
+        const Book &book = books_[row];
+        if (!indexes_dirty_) {
+            if (year_index_) {
+                year_index_->Erase(book.year, row);
+            }
+            if (rating_index_) {
+                rating_index_->Erase(book.rating, row);
+            }
+            if (read_count_index_) {
+                read_count_index_->Erase(book.read_count, row);
+            }
+        }
+        if (aggregates_ && !aggregates_dirty_) {
+            aggregates_->Remove(book);
+        }
+        if (!zones_dirty_) {
+            zones_.Remove(row, book);
+        }
+        text_index_dirty_ = text_index_.has_value();
+        sketches_dirty_ = sketches_.has_value();
+        if (!author_index_dirty_) {
+            author_index_.Remove(row, book.author_id);
+        }
+    }
+
+    void AddToIndexes(size_type row) const {
+        if (indexes_dirty_) {
+            return;  // индексы всё равно будут перестроены целиком
+        }
+        const Book &book = books_[row];
+        if (year_index_) {
+            year_index_->Insert(book.year, row);
+        }
+        if (rating_index_) {
+            rating_index_->Insert(book.rating, row);
+        }
+        if (read_count_index_) {
+            read_count_index_->Insert(book.read_count, row);
+        }
+    }
+
+    void InvalidateDerived() {
+        indexes_dirty_ = year_index_ || rating_index_ || read_count_index_;
+        aggregates_dirty_ = aggregates_.has_value();
+        zones_dirty_ = true;
+        text_index_dirty_ = text_index_.has_value();
+        sketches_dirty_ = sketches_.has_value();
+        author_index_dirty_ = true;
+    }
+
+    void EnsureIndexes() const {
+        std::lock_guard lock{derived_mutex_};
+        if (indexes_dirty_) {
+            RebuildIndexes();
+        }
+    }
+
+    void RebuildIndexes() const {
+        indexes_dirty_ = false;
+        if (year_index_) {
+            year_index_->Clear();
+        }
+        if (rating_index_) {
+            rating_index_->Clear();
+        }
+        if (read_count_index_) {
+            read_count_index_->Clear();
+        }
+        for (size_type row = 0; row < books_.size(); ++row) {
+            AddToIndexes(row);
+        }
+    }
+
+    void RebuildAggregates() const {
+        aggregates_dirty_ = false;
+        if (aggregates_) {
+            aggregates_->Clear();
+            std::for_each(books_.begin(), books_.end(), [&](const Book &book) { aggregates_->Add(book); });
+        }
+    }
+
+    void RebuildZones() const {
+        zones_dirty_ = false;
+        zones_.Clear();
+        for (size_type row = 0; row < books_.size(); ++row) {
+            zones_.Add(row, books_[row]);
+        }
+    }
+
+    void RebuildTextIndex() const {
+        text_index_dirty_ = false;
+        if (text_index_) {
+            text_index_->Clear();
+            for (size_type row = 0; row < books_.size(); ++row) {
+                text_index_->Add(row, books_[row]);
+            }
+        }
+    }
+
+    void RebuildSketches() const {
+        sketches_dirty_ = false;
+        if (sketches_) {
+            sketches_->Clear();
+            std::for_each(books_.begin(), books_.end(), [&](const Book &book) { sketches_->Add(book); });
+        }
+    }
+
+    void RebuildAuthorIndex() const {
+        author_index_dirty_ = false;
+        author_index_.ClearRows();
+        for (size_type row = 0; row < books_.size(); ++row) {
+            author_index_.Add(row, books_[row].author_id);
+        }
+    }
+
+    // Политика объявлена первой: она должна пережить контейнеры, которые выделяют из неё память
+    MemoryPolicy memory_;
     BookContainer books_;
     AuthorContainer authors_;
+
+    // Индексы - производные от books_ данные, перестраиваются лениво и в const-методах.
+    // Ленивое перестроение идёт под derived_mutex_, поэтому базу могут одновременно читать несколько потоков;
+    // читать одновременно с изменением базы по-прежнему нельзя
+    mutable std::mutex derived_mutex_;
+    mutable std::optional<YearIndex> year_index_;
+    mutable std::optional<RatingIndex> rating_index_;
+    mutable std::optional<ReadCountIndex> read_count_index_;
+    mutable bool indexes_dirty_ = false;
+
+    mutable std::optional<BookAggregates> aggregates_;
+    mutable bool aggregates_dirty_ = false;
+
+    mutable ZoneMap zones_;
+    mutable bool zones_dirty_ = false;
+
+    mutable std::optional<BookTextIndex> text_index_;
+    mutable bool text_index_dirty_ = false;
+
+    mutable std::optional<BookSketches> sketches_;
+    mutable bool sketches_dirty_ = false;
+
+    mutable AuthorIndex author_index_;
+    mutable bool author_index_dirty_ = false;
 };
 
 }  // namespace bookdb
 
 namespace std {
-template <bookdb::BookContainerLike T>
-struct formatter<bookdb::BookDatabase<T>> {
+template <bookdb::BookContainerLike T, bookdb::MemoryPolicyLike P>
+struct formatter<bookdb::BookDatabase<T, P>> {
     template <typename FormatContext>
-    auto format(const bookdb::BookDatabase<T> &db, FormatContext &fc) const {
+    auto format(const bookdb::BookDatabase<T, P> &db, FormatContext &fc) const {
 
         format_to(fc.out(), "BookDatabase (size = {}): \n", db.size());
 
@@ -0,0 +1,394 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "mapped_file.hpp"
+
+namespace bookdb {
+
+// Бинарный снимок базы книг.
+//
+// Формат (все числа в порядке байт машины, записавшей снимок, проверяется по kSnapshotEndianTag):
+//     SnapshotHeader
+//     years          int32[book_count]
+//     genres         Genre(int32)[book_count]
+//     ratings        double[book_count]
+//     read_counts    int32[book_count]
+//     author_ids     uint32[book_count]
+//     author_offsets uint64[author_count + 1]   имя i-го автора - [author_offsets[i], author_offsets[i + 1])
+//     author_heap    char[]                     в author_heap
+//     title_offsets  uint64[book_count + 1]     заголовок i-й книги - [title_offsets[i], title_offsets[i + 1])
+//     title_heap     char[]                     в title_heap
+// Каждая секция начинается с границы kSnapshotAlignment, поэтому колонки можно читать прямо из отображённого файла.
+
+inline constexpr std::array<char, 8> kSnapshotMagic{'B', 'O', 'O', 'K', 'S', 'N', 'A', 'P'};
+inline constexpr uint32_t kSnapshotVersion = 1;
+inline constexpr uint32_t kSnapshotEndianTag = 0x01020304;
+inline constexpr size_t kSnapshotAlignment = 64;
+
+// Смещение и длина секции в байтах от начала файла
+struct SnapshotSection {
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct SnapshotHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t endian_tag;
+    uint64_t book_count;
+    uint64_t author_count;
+    uint64_t file_size;
+
+    SnapshotSection years;
+    SnapshotSection genres;
+    SnapshotSection ratings;
+    SnapshotSection read_counts;
+    SnapshotSection author_ids;
+    SnapshotSection author_offsets;
+    SnapshotSection author_heap;
+    SnapshotSection title_offsets;
+    SnapshotSection title_heap;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+static_assert(sizeof(Genre) == sizeof(int32_t), "Genre хранится в снимке как int32");
+
+namespace detail {
+
+// Последовательная запись секций снимка с выравниванием
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::filesystem::path &path) : out_(path, std::ios::binary | std::ios::trunc) {
+        if (!out_) {
+            throw std::runtime_error{"Unable to create snapshot file " + path.string()};
+        }
+        Pad(sizeof(SnapshotHeader));
+    }
+
+    // Записывает секцию из значений, которые generate(i) возвращает для i в [0, count)
+    template <typename T, typename Generate>
+    SnapshotSection WriteColumn(size_t count, Generate generate) {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        Pad(AlignUp(position_));
+        const SnapshotSection section{position_, count * sizeof(T)};
+
+        // Колонка пишется порциями, чтобы не собирать её целиком в памяти
+        constexpr size_t kChunk = 4096;
+        std::vector<T> chunk;
+        chunk.reserve(std::min(count, kChunk));
+        for (size_t i = 0; i < count; ++i) {
+            chunk.push_back(generate(i));
+            if (chunk.size() == kChunk || i + 1 == count) {
+                Write(chunk.data(), chunk.size() * sizeof(T));
+                chunk.clear();
+            }
+        }
+        return section;
+    }
+
+    // Записывает строки get(i), i в [0, count), подряд в одну кучу и возвращает секции смещений и кучи
+    template <typename Get>
+    std::pair<SnapshotSection, SnapshotSection> WriteStrings(size_t count, Get get) {
+        uint64_t end = 0;
+        const auto offsets = WriteColumn<uint64_t>(count + 1, [&](size_t i) {
+            if (i != 0) {
+                end += std::string_view{get(i - 1)}.size();
+            }
+            return end;
+        });
+
+        Pad(AlignUp(position_));
+        const SnapshotSection heap{position_, end};
+        for (size_t i = 0; i < count; ++i) {
+            const std::string_view str{get(i)};
+            Write(str.data(), str.size());
+        }
+        return {offsets, heap};
+    }
+
+    void Finish(SnapshotHeader header) {
+        Pad(AlignUp(position_));
+        header.file_size = position_;
+        out_.seekp(0);
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error{"Unable to write snapshot file"};
+        }
+    }
+
+private:
+    static uint64_t AlignUp(uint64_t value) {
+        return (value + kSnapshotAlignment - 1) / kSnapshotAlignment * kSnapshotAlignment;
+    }
+
+    void Write(const void *data, size_t size) {
+        out_.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        position_ += size;
+    }
+
+    void Pad(uint64_t until) {
+        static constexpr std::array<char, kSnapshotAlignment> zeros{};
+        while (position_ < until) {
+            Write(zeros.data(), std::min<uint64_t>(until - position_, zeros.size()));
+        }
+    }
+
+    std::ofstream out_;
+    uint64_t position_ = 0;
+};
+
+// Сбрасывает на диск содержимое файла или каталога
+inline void syncPath(const std::filesystem::path &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(), "Unable to open " + path.string()};
+    }
+    const int result = ::fsync(fd);
+    const int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error{error, std::generic_category(), "Unable to sync " + path.string()};
+    }
+}
+
+// Общая часть записи: row(i) возвращает книгу (или объект с её полями) для строки i
+template <typename Row, typename AuthorName, typename Title>
+void writeSnapshot(const std::filesystem::path &path, size_t book_count, size_t author_count, Row row,
+                   AuthorName author_name, Title title) {
+    // Снимок сначала пишется во временный файл и заменяет старый только целиком
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+
+    SnapshotHeader header{};
+    header.magic = kSnapshotMagic;
+    header.version = kSnapshotVersion;
+    header.endian_tag = kSnapshotEndianTag;
+    header.book_count = book_count;
+    header.author_count = author_count;
+
+    {
+        SnapshotWriter writer{tmp_path};
+        header.years = writer.WriteColumn<int32_t>(book_count, [&](size_t i) { return row(i).year; });
+        header.genres = writer.WriteColumn<Genre>(book_count, [&](size_t i) { return row(i).genre; });
+        header.ratings = writer.WriteColumn<double>(book_count, [&](size_t i) { return row(i).rating; });
+        header.read_counts = writer.WriteColumn<int32_t>(book_count, [&](size_t i) { return row(i).read_count; });
+        header.author_ids = writer.WriteColumn<AuthorId>(book_count, [&](size_t i) { return row(i).author_id; });
+        std::tie(header.author_offsets, header.author_heap) =
+            writer.WriteStrings(author_count, [&](size_t i) { return author_name(static_cast<AuthorId>(i)); });
+        std::tie(header.title_offsets, header.title_heap) = writer.WriteStrings(book_count, title);
+        writer.Finish(header);
+    }
+
+    // Без fsync после сбоя питания rename мог бы оказаться на диске раньше данных, и на месте старого снимка
+    // остался бы файл с нулями. Каталог синхронизируется, чтобы на диске сохранилась и сама замена
+    syncPath(tmp_path);
+    std::filesystem::rename(tmp_path, path);
+    const auto directory = path.parent_path();
+    syncPath(directory.empty() ? std::filesystem::path{"."} : directory);
+}
+
+}  // namespace detail
+
+// Сохраняет колоночное хранилище в снимок
+template <BookColumnsLike Columns>
+void saveSnapshot(const Columns &columns, const std::filesystem::path &path) {
+    struct RowView {
+        int year;
+        Genre genre;
+        double rating;
+        int read_count;
+        AuthorId author_id;
+    };
+
+    const auto years = columns.Years();
+    const auto genres = columns.Genres();
+    const auto ratings = columns.Ratings();
+    const auto read_counts = columns.ReadCounts();
+    const auto author_ids = columns.AuthorIds();
+
+    detail::writeSnapshot(
+        path, columns.size(), columns.AuthorCount(),
+        [&](size_t i) { return RowView{years[i], genres[i], ratings[i], read_counts[i], author_ids[i]}; },
+        [&](AuthorId id) { return columns.AuthorName(id); }, [&](size_t i) { return columns.Title(i); });
+}
+
+// Сохраняет BookDatabase в снимок, идентификаторы авторов берутся из словаря базы
+template <BookContainerLike T, MemoryPolicyLike P>
+void saveSnapshot(const BookDatabase<T, P> &db, const std::filesystem::path &path) {
+    const auto &books = db.GetBooks();
+    detail::writeSnapshot(
+        path, books.size(), db.GetAuthors().size(), [&](size_t i) -> const Book & { return books[i]; },
+        [&](AuthorId id) { return db.GetAuthors().Name(id); },
+        [&](size_t i) { return std::string_view{books[i].title}; });
+}
+
+// Снимок, отображённый в память только для чтения.
+// Open не десериализует данные: колонки и строки читаются прямо из отображения, страницы подгружаются
+// операционной системой при первом обращении. Удовлетворяет BookColumnsLike, поэтому фильтры, статистики
+// и getTopNBy для колоночного хранилища работают со снимком без изменений.
+// Open проверяет только заголовок, границы секций и крайние смещения строк, поэтому его время не зависит
+// от размера снимка. Verify дополнительно просматривает колонки целиком; его стоит вызывать для файлов
+// из недоверенного источника
+class BookSnapshot {
+public:
+    using size_type = size_t;
+
+    static BookSnapshot Open(const std::filesystem::path &path) {
+        auto file = MappedFile::Open(path);
+        if (file.size() < sizeof(SnapshotHeader)) {
+            throw std::runtime_error{"Snapshot " + path.string() + " is truncated"};
+        }
+        return BookSnapshot{std::move(file)};
+    }
+
+    // Проверяет содержимое колонок: смещения строк не убывают, идентификаторы авторов и жанры лежат
+    // в допустимых границах. Читает около 20 байт на книгу
+    void Verify() const {
+        CheckOffsetsSorted(header_.author_offsets);
+        CheckOffsetsSorted(header_.title_offsets);
+        const uint64_t authors = header_.author_count;
+        if (std::ranges::any_of(AuthorIds(), [authors](AuthorId id) { return id >= authors; })) {
+            throw std::runtime_error{"Snapshot author ids are out of range"};
+        }
+        if (std::ranges::any_of(Genres(), [](Genre genre) { return static_cast<size_t>(genre) >= kGenreCount; })) {
+            throw std::runtime_error{"Snapshot genres are out of range"};
+        }
+    }
+
+    // Собирает книгу из колонок снимка
+    Book GetBook(size_type row) const {
+        Book book{Author(row), Title(row), Years()[row], Genres()[row], Ratings()[row], ReadCounts()[row]};
+        book.author_id = AuthorIds()[row];
+        return book;
+    }
+
+    size_type size() const { return header_.book_count; }
+
+    bool empty() const { return size() == 0; }
+
+    std::span<const int> Years() const { return Column<int>(header_.years); }
+
+    std::span<const Genre> Genres() const { return Column<Genre>(header_.genres); }
+
+    std::span<const double> Ratings() const { return Column<double>(header_.ratings); }
+
+    std::span<const int> ReadCounts() const { return Column<int>(header_.read_counts); }
+
+    std::span<const AuthorId> AuthorIds() const { return Column<AuthorId>(header_.author_ids); }
+
+    size_t AuthorCount() const { return header_.author_count; }
+
+    std::string_view AuthorName(AuthorId id) const {
+        return String(header_.author_offsets, header_.author_heap, id);
+    }
+
+    std::string_view Author(size_type row) const { return AuthorName(AuthorIds()[row]); }
+
+    std::string_view Title(size_type row) const { return String(header_.title_offsets, header_.title_heap, row); }
+
+private:
+    explicit BookSnapshot(MappedFile file) : file_(std::move(file)) {
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        Validate();
+    }
+
+    void Validate() const {
+        if (header_.magic != kSnapshotMagic) {
+            throw std::runtime_error{"Not a book snapshot"};
+        }
+        if (header_.version != kSnapshotVersion) {
+            throw std::runtime_error{"Unsupported snapshot version " + std::to_string(header_.version)};
+        }
+        if (header_.endian_tag != kSnapshotEndianTag) {
+            throw std::runtime_error{"Snapshot was written with a different byte order"};
+        }
+        if (header_.file_size != file_.size()) {
+            throw std::runtime_error{"Snapshot size does not match its header"};
+        }
+
+        const uint64_t books = header_.book_count;
+        const uint64_t authors = header_.author_count;
+        // Каждая книга и каждый автор занимают в файле хотя бы байт, это же исключает переполнение размеров ниже
+        if (books > file_.size() || authors > file_.size()) {
+            throw std::runtime_error{"Snapshot counts do not match its size"};
+        }
+        CheckSection(header_.years, books * sizeof(int32_t));
+        CheckSection(header_.genres, books * sizeof(Genre));
+        CheckSection(header_.ratings, books * sizeof(double));
+        CheckSection(header_.read_counts, books * sizeof(int32_t));
+        CheckSection(header_.author_ids, books * sizeof(AuthorId));
+        CheckSection(header_.author_offsets, (authors + 1) * sizeof(uint64_t));
+        CheckSection(header_.author_heap, header_.author_heap.size);
+        CheckSection(header_.title_offsets, (books + 1) * sizeof(uint64_t));
+        CheckSection(header_.title_heap, header_.title_heap.size);
+
+        CheckOffsetBounds(header_.author_offsets, header_.author_heap);
+        CheckOffsetBounds(header_.title_offsets, header_.title_heap);
+    }
+
+    // Смещения начинаются с нуля и заканчиваются длиной кучи
+    void CheckOffsetBounds(const SnapshotSection &offsets, const SnapshotSection &heap) const {
+        const auto bounds = Column<uint64_t>(offsets);
+        if (bounds.front() != 0 || bounds.back() != heap.size) {
+            throw std::runtime_error{"Snapshot string offsets are corrupted"};
+        }
+    }
+
+    // Вместе с крайними значениями неубывание гарантирует, что каждая строка лежит внутри кучи
+    void CheckOffsetsSorted(const SnapshotSection &offsets) const {
+        if (!std::ranges::is_sorted(Column<uint64_t>(offsets))) {
+            throw std::runtime_error{"Snapshot string offsets are corrupted"};
+        }
+    }
+
+    void CheckSection(const SnapshotSection &section, uint64_t expected_size) const {
+        if (section.size != expected_size || section.offset % kSnapshotAlignment != 0 ||
+            section.offset < sizeof(SnapshotHeader) || section.offset > file_.size() ||
+            section.size > file_.size() - section.offset) {
+            throw std::runtime_error{"Snapshot section is out of bounds"};
+        }
+    }
+
+    // Секции выровнены и содержат тривиальные типы, поэтому читаются из отображения без копирования
+    template <typename T>
+    std::span<const T> Column(const SnapshotSection &section) const {
+        return {reinterpret_cast<const T *>(file_.data() + section.offset), section.size / sizeof(T)};
+    }
+
+    std::string_view String(const SnapshotSection &offsets, const SnapshotSection &heap, size_t index) const {
+        const auto bounds = Column<uint64_t>(offsets);
+        const auto *data = reinterpret_cast<const char *>(file_.data() + heap.offset);
+        return {data + bounds[index], bounds[index + 1] - bounds[index]};
+    }
+
+    MappedFile file_;
+    SnapshotHeader header_{};
+};
+
+static_assert(BookColumnsLike<BookSnapshot>);
+
+}  // namespace bookdb
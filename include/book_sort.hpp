@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "concepts.hpp"
+#include "memory_policy.hpp"
+
+namespace bookdb {
+
+// Сортировка перестановки строк вместо перемещения книг. Для компараторов из comparators.hpp каждая книга
+// получает 64-битный ключ, порядок которого как беззнакового числа совпадает с порядком компаратора,
+// и строки упорядочиваются устойчивой поразрядной сортировкой (LSD) без единого сравнения книг.
+// Остальные компараторы сортируют перестановку через std::stable_sort. Книги переставляются (если нужно)
+// один раз в конце: каждая перемещается ровно один раз
+
+namespace detail {
+
+constexpr unsigned kRadixBits = 11;
+constexpr size_t kRadixBuckets = size_t{1} << kRadixBits;
+constexpr size_t kRadixDigits = (64 + kRadixBits - 1) / kRadixBits;
+
+// Ключ, упорядоченный как число: у положительных чисел выставляется знаковый бит, у отрицательных
+// инвертируются все биты. -0.0 и 0.0 равны для компараторов, поэтому получают один ключ
+inline uint64_t radixKey(double value) {
+    const auto bits = std::bit_cast<uint64_t>(value == 0. ? 0. : value);
+    constexpr uint64_t kSignBit = uint64_t{1} << 63;
+    return (bits & kSignBit) != 0 ? ~bits : bits | kSignBit;
+}
+
+inline uint64_t radixKey(int value) { return static_cast<uint32_t>(value) ^ uint32_t{0x80000000}; }
+
+// Номера строк по возрастанию ключей keys[row]; строки с равными ключами сохраняют исходный порядок.
+// Гистограммы всех разрядов считаются за один проход, разряды, одинаковые у всех ключей, пропускаются
+inline std::vector<size_t> radixSortRows(std::vector<uint64_t> keys) {
+    const size_t count = keys.size();
+    std::vector<size_t> rows(count);
+    std::iota(rows.begin(), rows.end(), size_t{0});
+
+    std::vector<std::array<size_t, kRadixBuckets>> histograms(kRadixDigits);
+    for (const uint64_t key : keys) {
+        for (size_t digit = 0; digit < kRadixDigits; ++digit) {
+            ++histograms[digit][(key >> (digit * kRadixBits)) & (kRadixBuckets - 1)];
+        }
+    }
+
+    std::vector<uint64_t> keys_out(count);
+    std::vector<size_t> rows_out(count);
+    for (size_t digit = 0; digit < kRadixDigits; ++digit) {
+        auto &offsets = histograms[digit];
+        if (std::ranges::find(offsets, count) != offsets.end()) {
+            continue;
+        }
+        std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), size_t{0});
+        const unsigned shift = static_cast<unsigned>(digit) * kRadixBits;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t pos = offsets[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+            keys_out[pos] = keys[i];
+            rows_out[pos] = rows[i];
+        }
+        keys.swap(keys_out);
+        rows.swap(rows_out);
+    }
+    return rows;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, typename KeyFn>
+std::vector<uint64_t> mapRadixKeys(const BookDatabase<T, P> &db, KeyFn key_fn) {
+    std::vector<uint64_t> keys(db.size());
+    std::ranges::transform(db.GetBooks(), keys.begin(), key_fn);
+    return keys;
+}
+
+// Ключи по порядку компараторов: убывающие порядки получают инвертированный ключ
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<uint64_t> radixKeys(const BookDatabase<T, P> &db, comp::LessByRating) {
+    return mapRadixKeys(db, [](const Book &book) { return ~radixKey(book.rating); });
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<uint64_t> radixKeys(const BookDatabase<T, P> &db, comp::LessByPopularity) {
+    return mapRadixKeys(db, [](const Book &book) { return ~radixKey(book.read_count) & 0xFFFFFFFF; });
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<uint64_t> radixKeys(const BookDatabase<T, P> &db, comp::LessByYear) {
+    return mapRadixKeys(db, [](const Book &book) { return radixKey(book.year); });
+}
+
+// Имена сравниваются один раз на автора словаря: ключ книги - алфавитный ранг её автора
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<uint64_t> radixKeys(const BookDatabase<T, P> &db, comp::LessByAuthor) {
+    const auto &authors = db.GetAuthors();
+    std::vector<AuthorId> order(authors.size());
+    std::iota(order.begin(), order.end(), AuthorId{0});
+    std::ranges::sort(order, [&](AuthorId lhs, AuthorId rhs) {
+        return std::ranges::lexicographical_compare(authors.Name(lhs), authors.Name(rhs));
+    });
+    // Авторы с одинаковым именем неразличимы для LessByAuthor и получают один ранг
+    std::vector<uint64_t> rank(order.size());
+    for (size_t i = 1; i < order.size(); ++i) {
+        const bool same = authors.Name(order[i - 1]) == authors.Name(order[i]);
+        rank[order[i]] = rank[order[i - 1]] + (same ? 0 : 1);
+    }
+    return mapRadixKeys(db, [&](const Book &book) { return rank[book.author_id]; });
+}
+
+}  // namespace detail
+
+// Перестановка строк в порядке comp: i-я книга отсортированной базы - db[rows[i]]. Порядок устойчивый,
+// как у std::stable_sort: равные книги идут в порядке строк
+template <BookContainerLike T, MemoryPolicyLike P, typename Comp>
+    requires BookComparator<Comp>
+std::vector<size_t> sortedRows(const BookDatabase<T, P> &db, const Comp &comp) {
+    if constexpr (requires { detail::radixKeys(db, comp); }) {
+        return detail::radixSortRows(detail::radixKeys(db, comp));
+    } else {
+        std::vector<size_t> rows(db.size());
+        std::iota(rows.begin(), rows.end(), size_t{0});
+        const auto &books = db.GetBooks();
+        std::ranges::stable_sort(rows, [&](size_t lhs, size_t rhs) { return comp(books[lhs], books[rhs]); });
+        return rows;
+    }
+}
+
+// Переставляет книги так, что на место i встаёт книга строки rows[i]. Перестановка проходится по циклам,
+// каждая книга перемещается один раз. Производные структуры базы перестраиваются при следующем обращении
+template <BookContainerLike T, MemoryPolicyLike P>
+void applyPermutation(BookDatabase<T, P> &db, std::span<const size_t> rows) {
+    if (rows.size() != db.size()) {
+        throw std::invalid_argument{"Permutation size does not match the database size"};
+    }
+    std::vector<bool> placed(rows.size());
+    for (const size_t row : rows) {
+        if (row >= rows.size() || placed[row]) {
+            throw std::invalid_argument{"Rows are not a permutation"};
+        }
+        placed[row] = true;
+    }
+
+    placed.assign(rows.size(), false);
+    auto range = db.MutableRange();
+    auto books = range.begin();
+    for (size_t start = 0; start < rows.size(); ++start) {
+        if (placed[start]) {
+            continue;
+        }
+        Book first = std::move(books[start]);
+        size_t pos = start;
+        for (; rows[pos] != start; pos = rows[pos]) {
+            placed[pos] = true;
+            books[pos] = std::move(books[rows[pos]]);
+        }
+        placed[pos] = true;
+        books[pos] = std::move(first);
+    }
+}
+
+// Сортирует книги базы в порядке comp (устойчиво): перестановка строк и одно перемещение книг
+template <BookContainerLike T, MemoryPolicyLike P, typename Comp>
+    requires BookComparator<Comp>
+void sortBooks(BookDatabase<T, P> &db, const Comp &comp) {
+    applyPermutation(db, sortedRows(db, comp));
+}
+
+}  // namespace bookdb
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "filter_kernels.hpp"
+#include "filters.hpp"
+#include "zone_map.hpp"
+
+namespace bookdb {
+
+// Страница результатов: next - курсор следующей страницы (номер строки её первой книги), nullopt для последней
+struct BookPage {
+    std::vector<std::reference_wrapper<const Book>> books;
+    std::optional<size_t> next;
+};
+
+// Ленивое представление книг базы, удовлетворяющих pred. Книги проверяются по мере обхода блоками,
+// зоны без подходящих книг пропускаются (см. zone_map.hpp), поэтому обход можно прервать на первых результатах.
+// Представление совместимо с std::ranges: его можно продолжить std::views::filter, transform, take, drop
+// и передать в getTopNBy и функции статистики, принимающие диапазоны.
+// Представление ссылается на базу: база должна жить дольше него, изменение базы делает итераторы недействительными
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+class FilterView : public std::ranges::view_interface<FilterView<T, P, Pred>> {
+public:
+    // Итератор хранит маску текущего блока (simd::kBlockWords слов, 128 байт), поэтому его копия стоит
+    // около 180 байт копирования. Маска не вынесена в представление: копии итератора и обходы страниц
+    // одного представления стоят на разных блоках и перетирали бы общую маску друг друга.
+    // Range-for итератор не копирует, алгоритмы, принимающие итераторы по значению (std::ranges::next), - копируют
+    class Iterator {
+    public:
+        using value_type = Book;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::forward_iterator_tag;
+
+        Iterator() = default;
+
+        const Book &operator*() const { return view_->db_->GetBooks()[row_]; }
+
+        const Book *operator->() const { return &**this; }
+
+        Iterator &operator++() {
+            ++row_;
+            Settle();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const Iterator &other) const { return row_ == other.row_; }
+
+        bool operator==(std::default_sentinel_t) const { return row_ == view_->db_->size(); }
+
+        // Номер строки текущей книги в базе
+        size_t Row() const { return row_; }
+
+    private:
+        friend FilterView;
+
+        // Карта зон запрашивается у базы один раз: её getter берёт мьютекс перестроения (см. BookDatabase),
+        // а изменение базы всё равно делает итератор недействительным
+        Iterator(const FilterView *view, size_t row) : view_(view), zones_(&view->db_->GetZoneMap()), row_(row) {
+            Settle();
+        }
+
+        // Переходит к первой подходящей книге, начиная с row_. Зона проверяется по метаданным
+        // один раз при входе в неё, строки зоны - блоками по simd::kBlockSize векторными ядрами фильтра
+        void Settle() {
+            const auto &books = view_->db_->GetBooks();
+            const auto &zones = *zones_;
+            while (row_ < books.size()) {
+                const size_t zone = row_ / ZoneMap::kZoneRows;
+                if (zone != zone_) {
+                    zone_ = zone;
+                    match_ = detail::zoneMatch(*view_->pred_, zones[zone]);
+                    zones.Count(match_);
+                    if (match_ == ZoneMatch::None) {
+                        row_ = (zone + 1) * ZoneMap::kZoneRows;
+                        continue;
+                    }
+                }
+                if (match_ == ZoneMatch::All) {
+                    return;
+                }
+
+                const size_t block = row_ / simd::kBlockSize;
+                const size_t first = block * simd::kBlockSize;
+                const size_t count = std::min(simd::kBlockSize, books.size() - first);
+                if (block != block_) {
+                    block_ = block;
+                    detail::evalMask(*view_->pred_, books.cbegin() + first, count, mask_.data());
+                }
+                if (const size_t bit = NextSetBit(row_ - first, count); bit < count) {
+                    row_ = first + bit;
+                    return;
+                }
+                row_ = first + count;
+            }
+            row_ = books.size();
+        }
+
+        // Первый установленный бит маски блока с номером не меньше bit или count, если таких нет
+        size_t NextSetBit(size_t bit, size_t count) const {
+            while (bit < count) {
+                const simd::MaskWord word = mask_[bit / simd::kMaskWordBits] >> (bit % simd::kMaskWordBits);
+                if (word != 0) {
+                    return std::min<size_t>(bit + std::countr_zero(word), count);
+                }
+                bit = (bit / simd::kMaskWordBits + 1) * simd::kMaskWordBits;
+            }
+            return count;
+        }
+
+        const FilterView *view_ = nullptr;
+        const ZoneMap *zones_ = nullptr;
+        size_t row_ = 0;
+        size_t zone_ = std::numeric_limits<size_t>::max();
+        ZoneMatch match_ = ZoneMatch::Partial;
+        size_t block_ = std::numeric_limits<size_t>::max();
+        std::array<simd::MaskWord, simd::kBlockWords> mask_;
+    };
+
+    FilterView(const BookDatabase<T, P> &db, Pred pred) : db_(&db), pred_(std::move(pred)) {}
+
+    FilterView(const FilterView &) = default;
+    FilterView(FilterView &&) = default;
+
+    // Лямбды с захватом не присваиваются, поэтому предикат пересоздаётся в std::optional (как movable-box
+    // в std::ranges). Если его копирование бросит, представление останется разрушаемым, но без предиката
+    FilterView &operator=(const FilterView &other) {
+        if (this != &other) {
+            db_ = other.db_;
+            pred_.emplace(*other.pred_);
+        }
+        return *this;
+    }
+
+    FilterView &operator=(FilterView &&other) {
+        if (this != &other) {
+            db_ = other.db_;
+            pred_.emplace(std::move(*other.pred_));
+        }
+        return *this;
+    }
+
+    Iterator begin() const { return Iterator{this, 0}; }
+
+    std::default_sentinel_t end() const { return {}; }
+
+    // Первая подходящая книга, начиная со строки row
+    Iterator From(size_t row) const { return Iterator{this, std::min(row, db_->size())}; }
+
+    // Страница по курсору: не больше limit книг, начиная со строки cursor.
+    // Обход останавливается на первой книге следующей страницы, её строка становится курсором
+    BookPage Page(size_t cursor, size_t limit) const {
+        BookPage page;
+        auto it = From(cursor);
+        for (; it != end() && page.books.size() < limit; ++it) {
+            page.books.emplace_back(*it);
+        }
+        if (it != end()) {
+            page.next = it.Row();
+        }
+        return page;
+    }
+
+    // Страница по смещению: книги с номерами [offset, offset + limit) среди подходящих.
+    // Предыдущие offset книг перебираются заново, для глубоких страниц выгоднее курсор
+    BookPage PageAt(size_t offset, size_t limit) const {
+        auto it = begin();
+        for (; it != end() && offset > 0; ++it, --offset) {
+        }
+        return Page(it.Row(), limit);
+    }
+
+private:
+    const BookDatabase<T, P> *db_;
+    std::optional<Pred> pred_;
+};
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+FilterView<T, P, Pred> filterView(const BookDatabase<T, P> &db, Pred pred) {
+    return FilterView<T, P, Pred>{db, std::move(pred)};
+}
+
+}  // namespace bookdb
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+
+namespace bookdb {
+
+// Массовая загрузка книг из CSV/TSV.
+//
+// Строка файла: author<d>title<d>year<d>genre<d>rating<d>read_count, где <d> - LoadOptions::delimiter.
+// Поля не экранируются и не заключаются в кавычки: разделитель внутри поля делает строку некорректной.
+// Некорректные строки (не 6 полей, нечисловые значения, неизвестный жанр) пропускаются и подсчитываются,
+// пустые строки пропускаются молча.
+//
+// Файл отображается в память и делится на куски по границам строк. Куски разбираются в пуле потоков
+// без копирования полей (string_view на отображение, числа - std::from_chars), авторы каждого куска
+// собираются в локальный словарь. Затем куски по порядку добавляются в базу: каждый уникальный автор куска
+// заносится в словарь базы один раз, книги добавляются через EmplaceBackInterned.
+// Порядок книг в базе совпадает с порядком строк в файле.
+
+struct LoadOptions {
+    char delimiter = ',';
+    bool skip_header = false;
+
+    // Примерный размер куска, который разбирает одна задача пула
+    size_t chunk_bytes = 4 << 20;
+};
+
+struct LoadStats {
+    size_t rows = 0;
+    size_t malformed = 0;
+    size_t bytes = 0;
+    std::chrono::duration<double> elapsed{};
+
+    double RowsPerSecond() const { return elapsed.count() > 0 ? rows / elapsed.count() : 0.0; }
+};
+
+namespace detail {
+
+// Быстрое сравнение названия жанра: сначала по длине, затем не более двух сравнений строк
+inline std::optional<Genre> tryParseGenre(std::string_view s) {
+    switch (s.size()) {
+    case 5:
+        if (s == "SciFi") {
+            return Genre::SciFi;
+        }
+        break;
+    case 7:
+        if (s == "Fiction") {
+            return Genre::Fiction;
+        } else if (s == "Mystery") {
+            return Genre::Mystery;
+        } else if (s == "Unknown") {
+            return Genre::Unknown;
+        }
+        break;
+    case 9:
+        if (s == "Biography") {
+            return Genre::Biography;
+        }
+        break;
+    case 10:
+        if (s == "NonFiction") {
+            return Genre::NonFiction;
+        }
+        break;
+    }
+    return std::nullopt;
+}
+
+// Число должно занимать поле целиком
+template <typename T>
+bool parseNumber(std::string_view field, T &value) {
+    const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return error == std::errc{} && end == field.data() + field.size();
+}
+
+// Разобранная строка: поля ссылаются на отображённый файл, автор - индекс в локальном словаре куска
+struct ParsedRow {
+    std::string_view title;
+    uint32_t author;
+    int year;
+    Genre genre;
+    double rating;
+    int read_count;
+};
+
+struct ParsedChunk {
+    std::vector<ParsedRow> rows;
+    std::vector<std::string_view> authors;
+    size_t malformed = 0;
+};
+
+inline bool parseRow(std::string_view line, char delimiter, std::array<std::string_view, 6> &fields) {
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const size_t end = i + 1 < fields.size() ? line.find(delimiter) : line.size();
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        fields[i] = line.substr(0, end);
+        line.remove_prefix(std::min(end + 1, line.size()));
+    }
+    return fields.back().find(delimiter) == std::string_view::npos;
+}
+
+inline ParsedChunk parseChunk(std::string_view text, char delimiter) {
+    ParsedChunk chunk;
+    std::unordered_map<std::string_view, uint32_t> author_ids;
+    std::array<std::string_view, 6> fields;
+
+    while (!text.empty()) {
+        const size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        ParsedRow row;
+        std::optional<Genre> genre;
+        if (!parseRow(line, delimiter, fields) || !parseNumber(fields[2], row.year) ||
+            !(genre = tryParseGenre(fields[3])) || !parseNumber(fields[4], row.rating) ||
+            !parseNumber(fields[5], row.read_count)) {
+            chunk.malformed++;
+            continue;
+        }
+
+        auto [it, inserted] = author_ids.try_emplace(fields[0], static_cast<uint32_t>(chunk.authors.size()));
+        if (inserted) {
+            chunk.authors.push_back(fields[0]);
+        }
+        row.author = it->second;
+        row.title = fields[1];
+        row.genre = *genre;
+        chunk.rows.push_back(row);
+    }
+
+    return chunk;
+}
+
+// Делит текст на куски примерно по chunk_bytes, каждый кусок заканчивается концом строки
+inline std::vector<std::string_view> splitChunks(std::string_view text, size_t chunk_bytes) {
+    std::vector<std::string_view> chunks;
+    chunk_bytes = std::max<size_t>(chunk_bytes, 1);
+    while (!text.empty()) {
+        size_t end = std::min(chunk_bytes, text.size());
+        if (end < text.size()) {
+            const size_t eol = text.find('\n', end - 1);
+            end = eol == std::string_view::npos ? text.size() : eol + 1;
+        }
+        chunks.push_back(text.substr(0, end));
+        text.remove_prefix(end);
+    }
+    return chunks;
+}
+
+}  // namespace detail
+
+// Загружает книги из текста в памяти, книги добавляются в конец db
+template <BookContainerLike T, MemoryPolicyLike P>
+LoadStats loadBooksFromBuffer(BookDatabase<T, P> &db, std::string_view text, ThreadPool &pool,
+                              const LoadOptions &options = {}) {
+    const auto start = std::chrono::steady_clock::now();
+
+    LoadStats stats;
+    stats.bytes = text.size();
+
+    if (options.skip_header) {
+        const size_t eol = text.find('\n');
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+    }
+
+    const auto chunks = detail::splitChunks(text, options.chunk_bytes);
+
+    // Разбирается не больше window кусков одновременно, чтобы разобранные строки не занимали память
+    // пропорционально размеру файла
+    const size_t window = 2 * pool.size();
+    std::deque<std::future<detail::ParsedChunk>> in_flight;
+    size_t next = 0;
+    auto submit = [&] {
+        in_flight.push_back(pool.Submit([chunk = chunks[next], delimiter = options.delimiter] {
+            return detail::parseChunk(chunk, delimiter);
+        }));
+        ++next;
+    };
+
+    // Задачи ссылаются на текст, поэтому при исключении дожидаемся их завершения
+    struct WaitAll {
+        std::deque<std::future<detail::ParsedChunk>> &futures;
+        ~WaitAll() {
+            std::ranges::for_each(futures, [](auto &future) { future.wait(); });
+        }
+    } wait_all{in_flight};
+
+    while (next < chunks.size() && in_flight.size() < window) {
+        submit();
+    }
+
+    std::vector<AuthorId> global_ids;
+    bool reserved = false;
+    for (size_t index = 0; !in_flight.empty(); ++index) {
+        auto chunk = in_flight.front().get();
+        in_flight.pop_front();
+        if (next < chunks.size()) {
+            submit();
+        }
+
+        // Размер базы оценивается по плотности строк в первом непустом куске
+        if (!reserved && !chunk.rows.empty()) {
+            db.Reserve(db.size() + chunk.rows.size() * (text.size() / chunks[index].size() + 1));
+            reserved = true;
+        }
+
+        global_ids.resize(chunk.authors.size());
+        std::ranges::transform(chunk.authors, global_ids.begin(),
+                               [&](std::string_view name) { return db.InternAuthor(name); });
+
+        for (const auto &row : chunk.rows) {
+            db.EmplaceBackInterned(global_ids[row.author], row.title, row.year, row.genre, row.rating,
+                                   row.read_count);
+        }
+
+        stats.rows += chunk.rows.size();
+        stats.malformed += chunk.malformed;
+    }
+
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+// Загружает книги из файла, книги добавляются в конец db
+template <BookContainerLike T, MemoryPolicyLike P>
+LoadStats loadBooks(BookDatabase<T, P> &db, const std::filesystem::path &path, ThreadPool &pool,
+                    const LoadOptions &options = {}) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto file = MappedFile::Open(path);
+    file.AdviseSequential();
+
+    auto stats = loadBooksFromBuffer(db, file.Text(), pool, options);
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+}  // namespace bookdb
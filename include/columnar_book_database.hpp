@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "author_dictionary.hpp"
+#include "book.hpp"
+#include "concepts.hpp"
+
+namespace bookdb {
+
+// Колоночное (structure-of-arrays) хранилище книг.
+// Каждое поле лежит в своём непрерывном массиве, поэтому сканирующие функции
+// (средний рейтинг, фильтры по году и т.д.) читают из памяти только нужную колонку.
+class ColumnarBookDatabase {
+public:
+    using size_type = size_t;
+
+    ColumnarBookDatabase() = default;
+    ColumnarBookDatabase(std::initializer_list<Book> list) {
+        Reserve(list.size());
+        std::ranges::for_each(list, [&](const Book &book) { PushBack(book); });
+    };
+
+    void Clear() {
+        years_.clear();
+        genres_.clear();
+        ratings_.clear();
+        read_counts_.clear();
+        author_ids_.clear();
+        title_offsets_.assign(1, 0);
+        title_heap_.clear();
+        authors_.clear();
+    }
+
+    void Reserve(size_type count) {
+        years_.reserve(count);
+        genres_.reserve(count);
+        ratings_.reserve(count);
+        read_counts_.reserve(count);
+        author_ids_.reserve(count);
+        title_offsets_.reserve(count + 1);
+    }
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        PushBack(Book{std::forward<Args>(args)...});
+    }
+
+    template <BookRef BookRef>
+    void PushBack(BookRef &&book) {
+        const Book &ref = book;
+        years_.push_back(ref.year);
+        genres_.push_back(ref.genre);
+        ratings_.push_back(ref.rating);
+        read_counts_.push_back(ref.read_count);
+        author_ids_.push_back(authors_.Add(ref.author));
+        title_heap_.append(ref.title);
+        title_offsets_.push_back(title_heap_.size());
+    }
+
+    // Собирает книгу из колонок, в колонках книга как единый объект не хранится
+    Book GetBook(size_type row) const {
+        Book book{Author(row), std::string{Title(row)}, years_[row], genres_[row], ratings_[row], read_counts_[row]};
+        book.author_id = author_ids_[row];
+        return book;
+    }
+
+    size_type size() const { return years_.size(); }
+
+    bool empty() const { return years_.empty(); }
+
+    std::span<const int> Years() const { return years_; }
+
+    std::span<const Genre> Genres() const { return genres_; }
+
+    std::span<const double> Ratings() const { return ratings_; }
+
+    std::span<const int> ReadCounts() const { return read_counts_; }
+
+    std::span<const AuthorId> AuthorIds() const { return author_ids_; }
+
+    size_t AuthorCount() const { return authors_.size(); }
+
+    std::string_view AuthorName(AuthorId id) const { return authors_.Name(id); }
+
+    const AuthorDictionary &GetAuthors() const { return authors_; }
+
+    std::string_view Author(size_type row) const { return AuthorName(author_ids_[row]); }
+
+    std::string_view Title(size_type row) const {
+        return std::string_view{title_heap_}.substr(title_offsets_[row], title_offsets_[row + 1] - title_offsets_[row]);
+    }
+
+private:
+    std::vector<int> years_;
+    std::vector<Genre> genres_;
+    std::vector<double> ratings_;
+    std::vector<int> read_counts_;
+    std::vector<AuthorId> author_ids_;
+
+    // Заголовки упакованы в одну строку, i-й заголовок - [title_offsets_[i], title_offsets_[i + 1])
+    std::vector<size_t> title_offsets_{0};
+    std::string title_heap_;
+
+    AuthorDictionary authors_;
+};
+
+static_assert(BookColumnsLike<ColumnarBookDatabase>);
+
+}  // namespace bookdb
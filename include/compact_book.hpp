@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "book.hpp"
+
+namespace bookdb {
+
+// Номер заголовка в холодной куче заголовков CompactBookDatabase
+using TitleId = uint32_t;
+
+// Горячая часть книги для сканирований и сортировок: поля, которые читают фильтры, статистики и компараторы,
+// и ссылки на автора и заголовок. Строки лежат отдельно, поэтому запись занимает 24 байта вместо 80 у Book
+class CompactBook {
+public:
+    CompactBook(AuthorId author, TitleId title, int year, Genre genre, double rating, int read_count)
+        : rating_(rating), read_count_(read_count), author_(author), title_(title), year_(NarrowYear(year)),
+          genre_(static_cast<uint8_t>(genre)) {}
+
+    int Year() const { return year_; }
+
+    Genre GetGenre() const { return static_cast<Genre>(genre_); }
+
+    double Rating() const { return rating_; }
+
+    int ReadCount() const { return read_count_; }
+
+    AuthorId Author() const { return author_; }
+
+    TitleId Title() const { return title_; }
+
+private:
+    static uint16_t NarrowYear(int year) {
+        if (year < 0 || year > std::numeric_limits<uint16_t>::max()) {
+            throw std::out_of_range{"Year " + std::to_string(year) + " does not fit into CompactBook"};
+        }
+        return static_cast<uint16_t>(year);
+    }
+
+    double rating_;
+    int32_t read_count_;
+    AuthorId author_;
+    TitleId title_;
+    uint16_t year_;
+    uint8_t genre_;
+};
+
+static_assert(sizeof(CompactBook) <= 24);
+static_assert(kGenreCount <= std::numeric_limits<uint8_t>::max());
+
+}  // namespace bookdb
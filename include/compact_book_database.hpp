@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "author_dictionary.hpp"
+#include "book.hpp"
+#include "comparators.hpp"
+#include "compact_book.hpp"
+#include "concepts.hpp"
+#include "statsistics.hpp"
+#include "top_n.hpp"
+
+namespace bookdb {
+
+// Хранилище с разделением на горячую и холодную части (hot/cold split).
+// Горячие записи CompactBook (24 байта) лежат подряд в одном массиве: сканирования и сортировки читают
+// и перемещают только их. Заголовки хранятся в холодной куче и связаны с записью номером заголовка,
+// поэтому перестановка записей не трогает строки; имена авторов - в словаре, как и в BookDatabase
+class CompactBookDatabase {
+public:
+    using size_type = size_t;
+    using const_iterator = std::vector<CompactBook>::const_iterator;
+
+    CompactBookDatabase() = default;
+    CompactBookDatabase(std::initializer_list<Book> list) {
+        Reserve(list.size());
+        std::ranges::for_each(list, [&](const Book &book) { PushBack(book); });
+    }
+
+    void Clear() {
+        books_.clear();
+        title_offsets_.assign(1, 0);
+        title_heap_.clear();
+        authors_.clear();
+    }
+
+    void Reserve(size_type count) {
+        books_.reserve(count);
+        title_offsets_.reserve(count + 1);
+    }
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        PushBack(Book{std::forward<Args>(args)...});
+    }
+
+    template <BookRef BookRef>
+    void PushBack(BookRef &&book) {
+        const Book &ref = book;
+        if (title_offsets_.size() > std::numeric_limits<TitleId>::max()) {
+            throw std::length_error{"CompactBookDatabase title heap is full"};
+        }
+        const auto title = static_cast<TitleId>(title_offsets_.size() - 1);
+        books_.emplace_back(authors_.Add(ref.author), title, ref.year, ref.genre, ref.rating, ref.read_count);
+        title_heap_.append(ref.title);
+        title_offsets_.push_back(title_heap_.size());
+    }
+
+    // Собирает книгу из горячей записи и холодных строк
+    Book GetBook(size_type row) const {
+        const CompactBook &book = books_[row];
+        Book result{AuthorName(book.Author()), TitleOf(book), book.Year(), book.GetGenre(), book.Rating(),
+                    book.ReadCount()};
+        result.author_id = book.Author();
+        return result;
+    }
+
+    const CompactBook &operator[](size_type row) const { return books_[row]; }
+
+    std::span<const CompactBook> GetBooks() const { return books_; }
+
+    const_iterator begin() const { return books_.begin(); }
+
+    const_iterator end() const { return books_.end(); }
+
+    size_type size() const { return books_.size(); }
+
+    bool empty() const { return books_.empty(); }
+
+    const AuthorDictionary &GetAuthors() const { return authors_; }
+
+    std::string_view AuthorName(AuthorId id) const { return authors_.Name(id); }
+
+    std::string_view Author(size_type row) const { return AuthorName(books_[row].Author()); }
+
+    std::string_view TitleOf(const CompactBook &book) const {
+        const size_t first = title_offsets_[book.Title()];
+        return std::string_view{title_heap_}.substr(first, title_offsets_[book.Title() + 1] - first);
+    }
+
+    std::string_view Title(size_type row) const { return TitleOf(books_[row]); }
+
+    // Упорядочивает записи компаратором из comparators.hpp. LessByAuthor сравнивает имена, которых в записи нет:
+    // записи сортируются по алфавитному рангу автора, вычисленному один раз для всего словаря
+    template <typename Comp>
+    void Sort(const Comp &comp) {
+        if constexpr (std::same_as<Comp, comp::LessByAuthor>) {
+            std::vector<AuthorId> order(authors_.size());
+            std::iota(order.begin(), order.end(), AuthorId{0});
+            std::ranges::sort(order, [&](AuthorId lhs, AuthorId rhs) {
+                return std::ranges::lexicographical_compare(AuthorName(lhs), AuthorName(rhs));
+            });
+            std::vector<uint32_t> rank(order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                rank[order[i]] = static_cast<uint32_t>(i);
+            }
+            std::ranges::sort(books_, {}, [&](const CompactBook &book) { return rank[book.Author()]; });
+        } else {
+            std::ranges::sort(books_, comp);
+        }
+    }
+
+    // Байты горячих записей и холодных строк (заголовки со смещениями), без словаря авторов
+    size_t HotBytes() const { return books_.size() * sizeof(CompactBook); }
+
+    size_t ColdBytes() const { return title_heap_.size() + title_offsets_.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<CompactBook> books_;
+
+    // i-й заголовок - [title_offsets_[i], title_offsets_[i + 1]) в title_heap_
+    std::vector<uint64_t> title_offsets_{0};
+    std::string title_heap_;
+
+    AuthorDictionary authors_;
+};
+
+// Запросы по горячим записям; результаты с книгами - номера строк, как у колоночного хранилища
+
+template <typename Pred>
+    requires std::predicate<const Pred &, const CompactBook &>
+std::vector<size_t> filterBooks(const CompactBookDatabase &db, Pred pred) {
+    std::vector<size_t> rows;
+    const auto books = db.GetBooks();
+    // Строки блока записываются без ветвлений: номер пишется всегда, а счётчик растёт только для подходящих
+    constexpr size_t kBlock = 256;
+    std::array<size_t, kBlock> block;
+    for (size_t first = 0; first < books.size(); first += kBlock) {
+        const size_t last = std::min(first + kBlock, books.size());
+        size_t found = 0;
+        for (size_t row = first; row < last; ++row) {
+            block[found] = row;
+            found += static_cast<size_t>(pred(books[row]));
+        }
+        rows.insert(rows.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(found));
+    }
+    return rows;
+}
+
+template <typename Pred>
+    requires std::predicate<const Pred &, const CompactBook &>
+GenreStatsContainer calculateGenreRatings(const CompactBookDatabase &db, Pred pred) {
+    std::array<RatingSum, kGenreCount> sums{};
+    for (const CompactBook &book : db) {
+        if (pred(book)) {
+            sums[static_cast<size_t>(book.GetGenre())].Add(book.Rating());
+        }
+    }
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sums[genre].count != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sums[genre].Avg());
+        }
+    }
+    return ratings_avg;
+}
+
+inline GenreStatsContainer calculateGenreRatings(const CompactBookDatabase &db) {
+    return calculateGenreRatings(db, [](const CompactBook &) { return true; });
+}
+
+template <typename Pred>
+    requires std::predicate<const Pred &, const CompactBook &>
+double calculateAverageRating(const CompactBookDatabase &db, Pred pred) {
+    RatingSum total;
+    for (const CompactBook &book : db) {
+        if (pred(book)) {
+            total.Add(book.Rating());
+        }
+    }
+    return total.Avg();
+}
+
+inline double calculateAverageRating(const CompactBookDatabase &db) {
+    return calculateAverageRating(db, [](const CompactBook &) { return true; });
+}
+
+inline HistogramContainer buildAuthorHistogramFlat(const CompactBookDatabase &db) {
+    std::vector<size_t> counts(db.GetAuthors().size());
+    std::ranges::for_each(db, [&](const CompactBook &book) { counts[book.Author()]++; });
+    return detail::resolveAuthorHistogram(counts, [&](AuthorId id) { return db.AuthorName(id); });
+}
+
+// Номера count лучших строк по comp, от лучшей к худшей
+template <typename Comp>
+    requires std::predicate<const Comp &, const CompactBook &, const CompactBook &>
+std::vector<size_t> getTopNBy(const CompactBookDatabase &db, size_t count, const Comp comp) {
+    if (count == 0) {
+        return {};
+    }
+    const auto books = db.GetBooks();
+    auto better = detail::positionTieBreak([&](size_t lhs, size_t rhs) { return comp(books[lhs], books[rhs]); });
+    BoundedTopN<size_t, decltype(better)> top{count, better};
+    for (size_t row = 0; row < books.size(); ++row) {
+        // Строки идут по возрастанию, строка с равным худшей отобранной ключом не проходит
+        if (top.size() < count || comp(books[row], books[*top.Worst()])) {
+            top.Offer(row);
+        }
+    }
+    return std::move(top).TakeSorted();
+}
+
+}  // namespace bookdb
@@ -1,23 +1,66 @@
 #pragma once
 
 #include "book.hpp"
+#include "compact_book.hpp"
+#include "concepts.hpp"
 #include <algorithm>
+#include <cstddef>
 #include <string_view>
 
 namespace bookdb::comp {
 
+// Перегрузки (columns, lhs_row, rhs_row) сравнивают строки колоночного хранилища, не собирая книги.
+// Компактные записи CompactBook сравниваются по полям; имя автора в записи не хранится,
+// поэтому LessByAuthor для них применяет CompactBookDatabase::Sort
+
 struct LessByAuthor {
     bool operator()(const Book &lhs, const Book &rhs) const {
         return std::ranges::lexicographical_compare(lhs.author, rhs.author);
     }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t lhs, size_t rhs) const {
+        const auto ids = columns.AuthorIds();
+        return std::ranges::lexicographical_compare(std::string_view{columns.AuthorName(ids[lhs])},
+                                                    std::string_view{columns.AuthorName(ids[rhs])});
+    }
 };
 
 struct LessByPopularity {
     bool operator()(const Book &lhs, const Book &rhs) const { return lhs.read_count > rhs.read_count; }
+
+    bool operator()(const CompactBook &lhs, const CompactBook &rhs) const { return lhs.ReadCount() > rhs.ReadCount(); }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t lhs, size_t rhs) const {
+        const auto read_counts = columns.ReadCounts();
+        return read_counts[lhs] > read_counts[rhs];
+    }
 };
 
 struct LessByRating {
     bool operator()(const Book &lhs, const Book &rhs) const { return lhs.rating > rhs.rating; }
+
+    bool operator()(const CompactBook &lhs, const CompactBook &rhs) const { return lhs.Rating() > rhs.Rating(); }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t lhs, size_t rhs) const {
+        const auto ratings = columns.Ratings();
+        return ratings[lhs] > ratings[rhs];
+    }
+};
+
+// Старые книги раньше новых
+struct LessByYear {
+    bool operator()(const Book &lhs, const Book &rhs) const { return lhs.year < rhs.year; }
+
+    bool operator()(const CompactBook &lhs, const CompactBook &rhs) const { return lhs.Year() < rhs.Year(); }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t lhs, size_t rhs) const {
+        const auto years = columns.Years();
+        return years[lhs] < years[rhs];
+    }
 };
 
 }  // namespace bookdb::comp
\ No newline at end of file
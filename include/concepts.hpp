@@ -2,7 +2,11 @@
 
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <ranges>
+#include <span>
+#include <string_view>
 #include <utility>
 
 #include "book.hpp"
@@ -23,6 +27,31 @@ concept BookContainerLike = requires(T t) {
     requires std::random_access_iterator<typename T::iterator>;  // с расчетом на возможное использование deque
 };
 
+// Колоночное хранилище: каждое поле книги лежит в отдельном непрерывном массиве,
+// авторы представлены плотными целочисленными идентификаторами
+template <typename T>
+concept BookColumnsLike = requires(const T t, size_t row, uint32_t author_id) {
+    { t.size() } -> std::same_as<size_t>;
+    { t.Years() } -> std::convertible_to<std::span<const int>>;
+    { t.Genres() } -> std::convertible_to<std::span<const Genre>>;
+    { t.Ratings() } -> std::convertible_to<std::span<const double>>;
+    { t.ReadCounts() } -> std::convertible_to<std::span<const int>>;
+    { t.AuthorIds() } -> std::convertible_to<std::span<const uint32_t>>;
+    { t.AuthorCount() } -> std::same_as<size_t>;
+    { t.AuthorName(author_id) } -> std::convertible_to<std::string_view>;
+    { t.Title(row) } -> std::convertible_to<std::string_view>;
+};
+
+template <typename P, typename Columns>
+concept BookColumnPredicate = BookColumnsLike<Columns> && std::predicate<const P &, const Columns &, size_t>;
+
+// Предикат, умеющий проверить блок строк колоночного хранилища за раз и записать результат в битовую маску
+template <typename P, typename Columns>
+concept BookColumnMaskPredicate =
+    BookColumnPredicate<P, Columns> && requires(const P p, const Columns &columns, size_t n, uint64_t *mask) {
+        p.EvalMask(columns, n, n, mask);
+    };
+
 template <typename T>
 concept BookIterator =
     std::random_access_iterator<T> &&
@@ -31,14 +60,30 @@ concept BookIterator =
 template <typename S, typename I>
 concept BookSentinel = std::sentinel_for<S, I>;
 
+// Ленивый диапазон книг (представление std::ranges, например filterView). Контейнеры и BookDatabase
+// представлениями не являются и обрабатываются перегрузками с итераторами
+template <typename R>
+concept BookRange = std::ranges::view<std::remove_cvref_t<R>> && std::ranges::input_range<R> &&
+                    std::convertible_to<std::ranges::range_reference_t<R>, const Book &>;
+
 template <typename P>
 concept BookPredicate = std::predicate<P, Book>;
 
+// Предикат, умеющий проверить блок книг, начинающийся с итератора It, и записать результат в битовую маску
+template <typename P, typename It>
+concept BookMaskPredicate = BookPredicate<P> && requires(const P p, It it, size_t n, uint64_t *mask) {
+    p.EvalMask(it, n, mask);
+};
+
 template <typename C>
 concept BookComparator = requires(C c) {
     { c(std::declval<Book>(), std::declval<Book>()) } -> std::convertible_to<bool>;
 };
 
+// Компаратор строк колоночного хранилища: comp(columns, lhs_row, rhs_row)
+template <typename C, typename Columns>
+concept BookColumnComparator = BookColumnsLike<Columns> && std::predicate<const C &, const Columns &, size_t, size_t>;
+
 template <typename T>
 concept BookRef = std::convertible_to<T, Book>;
 
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "author_dictionary.hpp"
+#include "book.hpp"
+#include "concepts.hpp"
+#include "statsistics.hpp"
+
+namespace bookdb {
+
+namespace detail {
+
+// Массив только для добавления из сегментов по SegmentSize элементов. Элементы не перемещаются,
+// таблица сегментов при росте копируется и публикуется атомарно (RCU): читатель, загрузивший таблицу
+// и размер, видит неизменяемый префикс и удерживает его сегменты, пока они ему нужны.
+// Добавление - только из одного потока одновременно (вызывающий сериализует писателей)
+template <typename T, size_t SegmentSize>
+class AppendOnlyLog {
+public:
+    class Segment {
+    public:
+        Segment() : items_(std::allocator<T>{}.allocate(SegmentSize)) {}
+
+        Segment(const Segment &) = delete;
+        Segment &operator=(const Segment &) = delete;
+
+        ~Segment() {
+            std::destroy_n(items_, count_);
+            std::allocator<T>{}.deallocate(items_, SegmentSize);
+        }
+
+        const T &operator[](size_t idx) const { return items_[idx]; }
+
+    private:
+        friend AppendOnlyLog;
+
+        T *items_;
+        size_t count_ = 0;
+    };
+
+    using Table = std::vector<std::shared_ptr<Segment>>;
+
+    // Опубликованный префикс: первые size элементов таблицы
+    struct View {
+        std::shared_ptr<const Table> table;
+        size_t size = 0;
+    };
+
+    AppendOnlyLog() : table_(std::make_shared<const Table>()) {}
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        const size_t size = size_.load(std::memory_order_relaxed);
+        auto table = table_.load(std::memory_order_relaxed);
+        if (size == table->size() * SegmentSize) {
+            auto grown = std::make_shared<Table>(*table);
+            grown->push_back(std::make_shared<Segment>());
+            table = grown;
+            table_.store(std::move(grown), std::memory_order_release);
+        }
+        Segment &segment = *table->back();
+        std::construct_at(segment.items_ + size % SegmentSize, std::forward<Args>(args)...);
+        ++segment.count_;
+        size_.store(size + 1, std::memory_order_release);
+    }
+
+    // Размер загружается раньше таблицы: таблица публикуется до размера, поэтому содержит все его сегменты
+    View Load() const {
+        const size_t size = size_.load(std::memory_order_acquire);
+        return View{table_.load(std::memory_order_acquire), size};
+    }
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<std::shared_ptr<const Table>> table_;
+    std::atomic<size_t> size_ = 0;
+};
+
+}  // namespace detail
+
+// База книг для одновременного пополнения и чтения. Писатели добавляют книги и заносят авторов в словарь
+// под общим мьютексом, читатели берут снимок (GetSnapshot) без блокировок: книги лежат в сегментах,
+// которые не перемещаются, а снимок фиксирует число опубликованных книг и авторов.
+// Снимок неизменяем, удерживает свои сегменты и словарь и может жить дольше базы.
+// Книги только добавляются: изменения и удаление не поддерживаются
+class ConcurrentBookDatabase {
+public:
+    static constexpr size_t kSegmentBooks = 16384;
+    static constexpr size_t kSegmentAuthors = 4096;
+
+    using BookLog = detail::AppendOnlyLog<Book, kSegmentBooks>;
+    using AuthorLog = detail::AppendOnlyLog<std::string_view, kSegmentAuthors>;
+
+    class Snapshot {
+    public:
+        class Iterator {
+        public:
+            using iterator_concept = std::random_access_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = Book;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Book *;
+            using reference = const Book &;
+
+            Iterator() = default;
+
+            reference operator*() const { return (*(*table_)[row_ / kSegmentBooks])[row_ % kSegmentBooks]; }
+
+            pointer operator->() const { return &**this; }
+
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            Iterator &operator++() {
+                ++row_;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                auto copy = *this;
+                ++row_;
+                return copy;
+            }
+
+            Iterator &operator--() {
+                --row_;
+                return *this;
+            }
+
+            Iterator operator--(int) {
+                auto copy = *this;
+                --row_;
+                return copy;
+            }
+
+            Iterator &operator+=(difference_type n) {
+                row_ = static_cast<size_t>(static_cast<difference_type>(row_) + n);
+                return *this;
+            }
+
+            Iterator &operator-=(difference_type n) { return *this += -n; }
+
+            friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+
+            friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+
+            friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+
+            friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) {
+                return static_cast<difference_type>(lhs.row_) - static_cast<difference_type>(rhs.row_);
+            }
+
+            bool operator==(const Iterator &other) const { return row_ == other.row_; }
+
+            std::strong_ordering operator<=>(const Iterator &other) const { return row_ <=> other.row_; }
+
+        private:
+            friend Snapshot;
+
+            Iterator(const BookLog::Table *table, size_t row) : table_(table), row_(row) {}
+
+            const BookLog::Table *table_ = nullptr;
+            size_t row_ = 0;
+        };
+
+        using const_iterator = Iterator;
+        using size_type = size_t;
+
+        Snapshot() = default;
+
+        size_type size() const { return books_.size; }
+
+        bool empty() const { return books_.size == 0; }
+
+        const Book &operator[](size_type row) const { return begin()[static_cast<std::ptrdiff_t>(row)]; }
+
+        Iterator begin() const { return Iterator{books_.table.get(), 0}; }
+
+        Iterator end() const { return Iterator{books_.table.get(), books_.size}; }
+
+        Iterator cbegin() const { return begin(); }
+
+        Iterator cend() const { return end(); }
+
+        // Авторы, известные на момент снимка: идентификаторы всех книг снимка меньше AuthorCount()
+        size_type AuthorCount() const { return authors_.size; }
+
+        std::string_view AuthorName(AuthorId id) const {
+            return (*(*authors_.table)[id / kSegmentAuthors])[id % kSegmentAuthors];
+        }
+
+    private:
+        friend ConcurrentBookDatabase;
+
+        Snapshot(BookLog::View books, AuthorLog::View authors, std::shared_ptr<const AuthorDictionary> dictionary)
+            : books_(std::move(books)), authors_(std::move(authors)), dictionary_(std::move(dictionary)) {}
+
+        BookLog::View books_;
+        AuthorLog::View authors_;
+        // Символы имён авторов, на которые ссылаются книги
+        std::shared_ptr<const AuthorDictionary> dictionary_;
+    };
+
+    ConcurrentBookDatabase() : dictionary_(std::make_shared<AuthorDictionary>()) {}
+
+    ConcurrentBookDatabase(const ConcurrentBookDatabase &) = delete;
+    ConcurrentBookDatabase &operator=(const ConcurrentBookDatabase &) = delete;
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        PushBack(Book{std::forward<Args>(args)...});
+    }
+
+    // Имя автора нового в словаре публикуется раньше книги, поэтому снимок с книгой всегда знает её автора
+    template <BookRef BookRef>
+    void PushBack(BookRef &&book) {
+        Book stored{std::forward<BookRef>(book)};
+        std::lock_guard lock{write_mutex_};
+        const size_t known = dictionary_->size();
+        stored.author_id = dictionary_->Add(stored.author);
+        stored.author = dictionary_->Name(stored.author_id);
+        if (dictionary_->size() != known) {
+            authors_.EmplaceBack(stored.author);
+        }
+        books_.EmplaceBack(std::move(stored));
+    }
+
+    // Книги загружаются раньше авторов (см. PushBack)
+    Snapshot GetSnapshot() const {
+        auto books = books_.Load();
+        return Snapshot{std::move(books), authors_.Load(), dictionary_};
+    }
+
+    // Количество опубликованных книг
+    size_t size() const { return books_.size(); }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    std::mutex write_mutex_;
+    // Словарь используется только писателями под мьютексом, читатели получают имена из authors_
+    std::shared_ptr<AuthorDictionary> dictionary_;
+    AuthorLog authors_;
+    BookLog books_;
+};
+
+// Гистограмма авторов снимка: счётчики по идентификатору, имена - из снимка
+inline HistogramContainer buildAuthorHistogramFlat(const ConcurrentBookDatabase::Snapshot &snapshot) {
+    std::vector<size_t> counts(snapshot.AuthorCount());
+    std::ranges::for_each(snapshot, [&](const Book &book) { counts[book.author_id]++; });
+    return detail::resolveAuthorHistogram(counts, [&](AuthorId id) { return snapshot.AuthorName(id); });
+}
+
+}  // namespace bookdb
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "memory_policy.hpp"
+#include "write_ahead_log.hpp"
+
+namespace bookdb {
+
+// BookDatabase с журналом предзаписи (см. write_ahead_log.hpp). При открытии база восстанавливается
+// из журнала, каждая добавленная книга сначала пишется в журнал, затем в базу. Журнал содержит только
+// добавления, поэтому база доступна для изменения лишь через EmplaceBack и PushBack; запросы выполняются
+// над GetDatabase(). Как и BookDatabase, класс не потокобезопасен
+template <BookContainerLike T = std::vector<Book>, MemoryPolicyLike P = HeapMemoryPolicy>
+class DurableBookDatabase {
+public:
+    using Database = BookDatabase<T, P>;
+    using size_type = typename Database::size_type;
+
+    explicit DurableBookDatabase(const std::filesystem::path &log_path, const WalOptions &options = {})
+        : log_(log_path, options, [this](const WalRecord &record) {
+              db_.EmplaceBack(record.author, record.title, record.year, record.genre, record.rating,
+                              record.read_count);
+          }) {}
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        PushBack(Book{std::forward<Args>(args)...});
+    }
+
+    // Если запись в журнал не удалась, книга в базу не добавляется
+    template <BookRef BookRef>
+    void PushBack(BookRef &&book) {
+        log_.Append(static_cast<const Book &>(book));
+        db_.PushBack(std::forward<BookRef>(book));
+    }
+
+    // Сбрасывает на диск все добавленные книги независимо от политики журнала
+    void Sync() { log_.Sync(); }
+
+    const Database &GetDatabase() const { return db_; }
+
+    const WriteAheadLog &GetLog() const { return log_; }
+
+    size_type size() const { return db_.size(); }
+
+    bool empty() const { return db_.empty(); }
+
+private:
+    // База объявлена раньше журнала: восстановление из конструктора журнала заполняет уже созданную базу
+    Database db_;
+    WriteAheadLog log_;
+};
+
+}  // namespace bookdb
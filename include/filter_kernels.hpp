@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "book.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BOOKDB_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace bookdb::simd {
+
+// Результат проверки предиката над блоком книг: i-й бит слова out[i / 64] равен 1, если i-я книга подходит
+using MaskWord = uint64_t;
+
+constexpr size_t kMaskWordBits = 64;
+
+// Размер блока, который фильтры обрабатывают за один вызов ядра
+constexpr size_t kBlockSize = 1024;
+constexpr size_t kBlockWords = kBlockSize / kMaskWordBits;
+
+constexpr size_t MaskWords(size_t count) { return (count + kMaskWordBits - 1) / kMaskWordBits; }
+
+enum class Level { Scalar, SSE2, AVX2 };
+
+// Набор ядер для одного уровня SIMD. Каждое ядро записывает MaskWords(count) слов в out
+struct Kernels {
+    // from <= value < to
+    void (*year_between)(const int *values, size_t count, int from, int to, MaskWord *out);
+    // value > above
+    void (*rating_above)(const double *values, size_t count, double above, MaskWord *out);
+    // value == genre
+    void (*genre_is)(const Genre *values, size_t count, Genre genre, MaskWord *out);
+};
+
+namespace detail {
+
+static_assert(sizeof(Genre) == sizeof(int32_t), "Genre kernels compare the enum as a 32-bit integer");
+
+inline void YearBetweenScalar(const int *values, size_t count, int from, int to, MaskWord *out) {
+    for (size_t word = 0; word < MaskWords(count); ++word) {
+        const size_t first = word * kMaskWordBits;
+        const size_t last = std::min(count, first + kMaskWordBits);
+        MaskWord bits = 0;
+        for (size_t i = first; i < last; ++i) {
+            bits |= MaskWord{values[i] >= from && values[i] < to} << (i - first);
+        }
+        out[word] = bits;
+    }
+}
+
+inline void RatingAboveScalar(const double *values, size_t count, double above, MaskWord *out) {
+    for (size_t word = 0; word < MaskWords(count); ++word) {
+        const size_t first = word * kMaskWordBits;
+        const size_t last = std::min(count, first + kMaskWordBits);
+        MaskWord bits = 0;
+        for (size_t i = first; i < last; ++i) {
+            bits |= MaskWord{values[i] > above} << (i - first);
+        }
+        out[word] = bits;
+    }
+}
+
+inline void GenreIsScalar(const Genre *values, size_t count, Genre genre, MaskWord *out) {
+    for (size_t word = 0; word < MaskWords(count); ++word) {
+        const size_t first = word * kMaskWordBits;
+        const size_t last = std::min(count, first + kMaskWordBits);
+        MaskWord bits = 0;
+        for (size_t i = first; i < last; ++i) {
+            bits |= MaskWord{values[i] == genre} << (i - first);
+        }
+        out[word] = bits;
+    }
+}
+
+#ifdef BOOKDB_SIMD_X86
+
+// Полные слова считаются векторно, хвост короче 64 элементов - скалярным ядром
+
+inline void YearBetweenSSE2(const int *values, size_t count, int from, int to, MaskWord *out) {
+    const __m128i lo = _mm_set1_epi32(from);
+    const __m128i hi = _mm_set1_epi32(to);
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const int *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            const __m128i match = _mm_andnot_si128(_mm_cmplt_epi32(v, lo), _mm_cmplt_epi32(v, hi));
+            bits |= static_cast<MaskWord>(_mm_movemask_ps(_mm_castsi128_ps(match))) << i;
+        }
+        out[word] = bits;
+    }
+    YearBetweenScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, from, to, out + full_words);
+}
+
+inline void RatingAboveSSE2(const double *values, size_t count, double above, MaskWord *out) {
+    const __m128d threshold = _mm_set1_pd(above);
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const double *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 2) {
+            const __m128d match = _mm_cmpgt_pd(_mm_loadu_pd(src + i), threshold);
+            bits |= static_cast<MaskWord>(_mm_movemask_pd(match)) << i;
+        }
+        out[word] = bits;
+    }
+    RatingAboveScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, above, out + full_words);
+}
+
+inline void GenreIsSSE2(const Genre *values, size_t count, Genre genre, MaskWord *out) {
+    const __m128i expected = _mm_set1_epi32(static_cast<int32_t>(genre));
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const Genre *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            bits |= static_cast<MaskWord>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, expected)))) << i;
+        }
+        out[word] = bits;
+    }
+    GenreIsScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, genre, out + full_words);
+}
+
+__attribute__((target("avx2"))) inline void YearBetweenAVX2(const int *values, size_t count, int from, int to,
+                                                            MaskWord *out) {
+    const __m256i lo = _mm256_set1_epi32(from);
+    const __m256i hi = _mm256_set1_epi32(to);
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const int *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            // from <= v && v < to  <=>  !(from > v) && (to > v)
+            const __m256i match = _mm256_andnot_si256(_mm256_cmpgt_epi32(lo, v), _mm256_cmpgt_epi32(hi, v));
+            bits |= static_cast<MaskWord>(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(match)))) << i;
+        }
+        out[word] = bits;
+    }
+    YearBetweenScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, from, to, out + full_words);
+}
+
+__attribute__((target("avx2"))) inline void RatingAboveAVX2(const double *values, size_t count, double above,
+                                                            MaskWord *out) {
+    const __m256d threshold = _mm256_set1_pd(above);
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const double *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 4) {
+            const __m256d match = _mm256_cmp_pd(_mm256_loadu_pd(src + i), threshold, _CMP_GT_OQ);
+            bits |= static_cast<MaskWord>(static_cast<uint32_t>(_mm256_movemask_pd(match))) << i;
+        }
+        out[word] = bits;
+    }
+    RatingAboveScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, above, out + full_words);
+}
+
+__attribute__((target("avx2"))) inline void GenreIsAVX2(const Genre *values, size_t count, Genre genre,
+                                                        MaskWord *out) {
+    const __m256i expected = _mm256_set1_epi32(static_cast<int32_t>(genre));
+    const size_t full_words = count / kMaskWordBits;
+
+    for (size_t word = 0; word < full_words; ++word) {
+        const Genre *src = values + word * kMaskWordBits;
+        MaskWord bits = 0;
+        for (size_t i = 0; i < kMaskWordBits; i += 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            const __m256i match = _mm256_cmpeq_epi32(v, expected);
+            bits |= static_cast<MaskWord>(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(match)))) << i;
+        }
+        out[word] = bits;
+    }
+    GenreIsScalar(values + full_words * kMaskWordBits, count % kMaskWordBits, genre, out + full_words);
+}
+
+#endif
+
+}  // namespace detail
+
+inline bool IsSupported(Level level) {
+    switch (level) {
+    case Level::Scalar:
+        return true;
+#ifdef BOOKDB_SIMD_X86
+    case Level::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case Level::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+inline const Kernels &KernelsFor(Level level) {
+    static constexpr Kernels scalar{detail::YearBetweenScalar, detail::RatingAboveScalar, detail::GenreIsScalar};
+#ifdef BOOKDB_SIMD_X86
+    static constexpr Kernels sse2{detail::YearBetweenSSE2, detail::RatingAboveSSE2, detail::GenreIsSSE2};
+    static constexpr Kernels avx2{detail::YearBetweenAVX2, detail::RatingAboveAVX2, detail::GenreIsAVX2};
+
+    if (level == Level::AVX2 && IsSupported(Level::AVX2)) {
+        return avx2;
+    }
+    if (level >= Level::SSE2 && IsSupported(Level::SSE2)) {
+        return sse2;
+    }
+#endif
+    return scalar;
+}
+
+// Лучший доступный уровень определяется один раз при первом обращении
+inline Level ActiveLevel() {
+    static const Level level = IsSupported(Level::AVX2)   ? Level::AVX2
+                               : IsSupported(Level::SSE2) ? Level::SSE2
+                                                          : Level::Scalar;
+    return level;
+}
+
+inline const Kernels &ActiveKernels() {
+    static const Kernels &kernels = KernelsFor(ActiveLevel());
+    return kernels;
+}
+
+// Маска, в которой установлены первые count бит
+inline void FillMask(size_t count, MaskWord *out) {
+    std::fill_n(out, count / kMaskWordBits, ~MaskWord{0});
+    if (count % kMaskWordBits != 0) {
+        out[count / kMaskWordBits] = (MaskWord{1} << (count % kMaskWordBits)) - 1;
+    }
+}
+
+inline bool MaskIsEmpty(const MaskWord *mask, size_t words) {
+    for (size_t word = 0; word < words; ++word) {
+        if (mask[word] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Вызывает fn(i) для каждого установленного бита маски из count элементов
+template <typename Fn>
+void ForEachSetBit(const MaskWord *mask, size_t count, Fn &&fn) {
+    for (size_t word = 0; word < MaskWords(count); ++word) {
+        for (MaskWord bits = mask[word]; bits != 0; bits &= bits - 1) {
+            fn(word * kMaskWordBits + static_cast<size_t>(std::countr_zero(bits)));
+        }
+    }
+}
+
+}  // namespace bookdb::simd
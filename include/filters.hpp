@@ -1,32 +1,481 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <functional>
+#include <optional>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "book.hpp"
+#include "book_database.hpp"
+#include "compact_book.hpp"
 #include "concepts.hpp"
+#include "filter_kernels.hpp"
+#include "query_profiler.hpp"
 
 namespace bookdb {
 
-auto GenreIs = [](const std::string_view genre) {
-    return [genre](const Book &book) { return book.genre == ConvertGenre(genre); };
+namespace detail {
+
+// Проверка блока из count <= simd::kBlockSize книг. Если у фильтра нет векторного ядра,
+// маска собирается построчным вызовом предиката
+template <typename Filter, BookIterator It>
+void evalMask(const Filter &filter, It first, size_t count, simd::MaskWord *out) {
+    if constexpr (BookMaskPredicate<Filter, It>) {
+        filter.EvalMask(first, count, out);
+    } else {
+        std::fill_n(out, simd::MaskWords(count), 0);
+        for (size_t i = 0; i < count; ++i) {
+            out[i / simd::kMaskWordBits] |= simd::MaskWord{filter(first[i])} << (i % simd::kMaskWordBits);
+        }
+    }
+}
+
+template <typename Filter, BookColumnsLike Columns>
+void evalMask(const Filter &filter, const Columns &columns, size_t first, size_t count, simd::MaskWord *out) {
+    if constexpr (BookColumnMaskPredicate<Filter, Columns>) {
+        filter.EvalMask(columns, first, count, out);
+    } else {
+        std::fill_n(out, simd::MaskWords(count), 0);
+        for (size_t i = 0; i < count; ++i) {
+            out[i / simd::kMaskWordBits] |= simd::MaskWord{filter(columns, first + i)} << (i % simd::kMaskWordBits);
+        }
+    }
+}
+
+// Объединяет маски фильтров побитовым И (Conjunction) или ИЛИ. eval(filter, out) считает маску одного фильтра
+template <bool Conjunction, typename Tuple, typename Eval>
+void combineMasks(const Tuple &filters, size_t count, simd::MaskWord *out, Eval eval) {
+    const size_t words = simd::MaskWords(count);
+
+    if constexpr (std::tuple_size_v<Tuple> == 0) {
+        if constexpr (Conjunction) {
+            simd::FillMask(count, out);
+        } else {
+            std::fill_n(out, words, 0);
+        }
+    } else {
+        std::apply(
+            [&](const auto &head, const auto &...tail) {
+                eval(head, out);
+
+                std::array<simd::MaskWord, simd::kBlockWords> tmp;
+                auto combine = [&](const auto &filter) {
+                    // В блоке не осталось подходящих книг, остальные фильтры можно не считать
+                    if (Conjunction && simd::MaskIsEmpty(out, words)) {
+                        return;
+                    }
+                    eval(filter, tmp.data());
+                    for (size_t word = 0; word < words; ++word) {
+                        out[word] = Conjunction ? out[word] & tmp[word] : out[word] | tmp[word];
+                    }
+                };
+                (combine(tail), ...);
+            },
+            filters);
+    }
+}
+
+}  // namespace detail
+
+// Предикаты умеют проверять объект Book, компактную запись CompactBook и строку колоночного хранилища.
+// EvalMask проверяет блок из count <= simd::kBlockSize книг векторным ядром и пишет результат в битовую маску
+struct GenreFilter {
+    Genre genre;
+
+    bool operator()(const Book &book) const { return book.genre == genre; }
+
+    bool operator()(const CompactBook &book) const { return book.GetGenre() == genre; }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t row) const {
+        return columns.Genres()[row] == genre;
+    }
+
+    template <BookColumnsLike Columns>
+    void EvalMask(const Columns &columns, size_t first, size_t count, simd::MaskWord *out) const {
+        simd::ActiveKernels().genre_is(columns.Genres().data() + first, count, genre, out);
+    }
+
+    template <BookIterator It>
+    void EvalMask(It first, size_t count, simd::MaskWord *out) const {
+        std::array<Genre, simd::kBlockSize> genres;
+        for (size_t i = 0; i < count; ++i) {
+            genres[i] = first[i].genre;
+        }
+        simd::ActiveKernels().genre_is(genres.data(), count, genre, out);
+    }
+};
+
+struct YearFilter {
+    int from;
+    int to;
+
+    bool operator()(const Book &book) const { return book.year >= from && book.year < to; }
+
+    bool operator()(const CompactBook &book) const { return book.Year() >= from && book.Year() < to; }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t row) const {
+        const int year = columns.Years()[row];
+        return year >= from && year < to;
+    }
+
+    template <BookColumnsLike Columns>
+    void EvalMask(const Columns &columns, size_t first, size_t count, simd::MaskWord *out) const {
+        simd::ActiveKernels().year_between(columns.Years().data() + first, count, from, to, out);
+    }
+
+    template <BookIterator It>
+    void EvalMask(It first, size_t count, simd::MaskWord *out) const {
+        std::array<int, simd::kBlockSize> years;
+        for (size_t i = 0; i < count; ++i) {
+            years[i] = first[i].year;
+        }
+        simd::ActiveKernels().year_between(years.data(), count, from, to, out);
+    }
+};
+
+struct RatingFilter {
+    double above;
+
+    bool operator()(const Book &book) const { return book.rating > above; }
+
+    bool operator()(const CompactBook &book) const { return book.Rating() > above; }
+
+    template <BookColumnsLike Columns>
+    bool operator()(const Columns &columns, size_t row) const {
+        return columns.Ratings()[row] > above;
+    }
+
+    template <BookColumnsLike Columns>
+    void EvalMask(const Columns &columns, size_t first, size_t count, simd::MaskWord *out) const {
+        simd::ActiveKernels().rating_above(columns.Ratings().data() + first, count, above, out);
+    }
+
+    template <BookIterator It>
+    void EvalMask(It first, size_t count, simd::MaskWord *out) const {
+        std::array<double, simd::kBlockSize> ratings;
+        for (size_t i = 0; i < count; ++i) {
+            ratings[i] = first[i].rating;
+        }
+        simd::ActiveKernels().rating_above(ratings.data(), count, above, out);
+    }
+};
+
+template <typename... Filters>
+struct AllOf {
+    std::tuple<Filters...> filters;
+
+    bool operator()(const Book &book) const {
+        return std::apply([&](const auto &...filter) { return (filter(book) && ...); }, filters);
+    }
+
+    bool operator()(const CompactBook &book) const
+        requires(std::predicate<const Filters &, const CompactBook &> && ...)
+    {
+        return std::apply([&](const auto &...filter) { return (filter(book) && ...); }, filters);
+    }
+
+    template <BookColumnsLike Columns>
+        requires(BookColumnPredicate<Filters, Columns> && ...)
+    bool operator()(const Columns &columns, size_t row) const {
+        return std::apply([&](const auto &...filter) { return (filter(columns, row) && ...); }, filters);
+    }
+
+    template <BookColumnsLike Columns>
+        requires(BookColumnPredicate<Filters, Columns> && ...)
+    void EvalMask(const Columns &columns, size_t first, size_t count, simd::MaskWord *out) const {
+        detail::combineMasks<true>(filters, count, out, [&](const auto &filter, simd::MaskWord *mask) {
+            detail::evalMask(filter, columns, first, count, mask);
+        });
+    }
+
+    template <BookIterator It>
+    void EvalMask(It first, size_t count, simd::MaskWord *out) const {
+        detail::combineMasks<true>(filters, count, out, [&](const auto &filter, simd::MaskWord *mask) {
+            detail::evalMask(filter, first, count, mask);
+        });
+    }
+};
+
+template <typename... Filters>
+struct AnyOf {
+    std::tuple<Filters...> filters;
+
+    bool operator()(const Book &book) const {
+        return std::apply([&](const auto &...filter) { return (filter(book) || ...); }, filters);
+    }
+
+    bool operator()(const CompactBook &book) const
+        requires(std::predicate<const Filters &, const CompactBook &> && ...)
+    {
+        return std::apply([&](const auto &...filter) { return (filter(book) || ...); }, filters);
+    }
+
+    template <BookColumnsLike Columns>
+        requires(BookColumnPredicate<Filters, Columns> && ...)
+    bool operator()(const Columns &columns, size_t row) const {
+        return std::apply([&](const auto &...filter) { return (filter(columns, row) || ...); }, filters);
+    }
+
+    template <BookColumnsLike Columns>
+        requires(BookColumnPredicate<Filters, Columns> && ...)
+    void EvalMask(const Columns &columns, size_t first, size_t count, simd::MaskWord *out) const {
+        detail::combineMasks<false>(filters, count, out, [&](const auto &filter, simd::MaskWord *mask) {
+            detail::evalMask(filter, columns, first, count, mask);
+        });
+    }
+
+    template <BookIterator It>
+    void EvalMask(It first, size_t count, simd::MaskWord *out) const {
+        detail::combineMasks<false>(filters, count, out, [&](const auto &filter, simd::MaskWord *mask) {
+            detail::evalMask(filter, first, count, mask);
+        });
+    }
+};
+
+// Жанр переводится в Genre один раз при создании фильтра, а не для каждой книги
+inline constexpr auto GenreIs = [](const std::string_view genre) { return GenreFilter{ConvertGenre(genre)}; };
+
+inline constexpr auto YearBetween = [](int from, int to) { return YearFilter{from, to}; };
+
+inline constexpr auto RatingAbove = [](double above) { return RatingFilter{above}; };
+
+// Фильтры хранятся по значению, поэтому составной предикат можно вернуть из функции
+inline constexpr auto all_of = [](auto &&...filters) {
+    return AllOf<std::decay_t<decltype(filters)>...>{{std::forward<decltype(filters)>(filters)...}};
 };
 
-auto YearBetween = [](int from, int to) {
-    return [from, to](const Book &book) { return book.year >= from && book.year < to; };
+inline constexpr auto any_of = [](auto &&...filters) {
+    return AnyOf<std::decay_t<decltype(filters)>...>{{std::forward<decltype(filters)>(filters)...}};
 };
 
-auto RatingAbove = [](double above) { return [above](const Book &book) { return book.rating > above; }; };
+namespace detail {
+
+// Проверка блока базы по метаданным зоны (см. zone_map.hpp).
+// Для предикатов без правила (например, собственных лямбд) блок всегда сканируется
+template <typename Pred>
+ZoneMatch zoneMatch(const Pred &, const ZoneStats &) {
+    return ZoneMatch::Partial;
+}
+
+inline ZoneMatch zoneMatch(const GenreFilter &filter, const ZoneStats &zone) {
+    if (!zone.genres.test(static_cast<size_t>(filter.genre))) {
+        return ZoneMatch::None;
+    }
+    return zone.OnlyGenre(filter.genre) ? ZoneMatch::All : ZoneMatch::Partial;
+}
 
-auto all_of = [](auto &&...filters) { return [&](const Book &book) { return (filters(book) && ...); }; };
+inline ZoneMatch zoneMatch(const YearFilter &filter, const ZoneStats &zone) {
+    if (zone.max_year < filter.from || zone.min_year >= filter.to) {
+        return ZoneMatch::None;
+    }
+    return zone.min_year >= filter.from && zone.max_year < filter.to ? ZoneMatch::All : ZoneMatch::Partial;
+}
 
-auto any_of = [](auto &&...filters) { return [&](const Book &book) { return (filters(book) || ...); }; };
+inline ZoneMatch zoneMatch(const RatingFilter &filter, const ZoneStats &zone) {
+    if (!(zone.max_rating > filter.above)) {
+        return ZoneMatch::None;
+    }
+    return zone.min_rating > filter.above ? ZoneMatch::All : ZoneMatch::Partial;
+}
+
+template <typename... Filters>
+ZoneMatch zoneMatch(const AnyOf<Filters...> &filter, const ZoneStats &zone);
+
+template <typename... Filters>
+ZoneMatch zoneMatch(const AllOf<Filters...> &filter, const ZoneStats &zone) {
+    return std::apply(
+        [&](const auto &...children) {
+            ZoneMatch result = ZoneMatch::All;
+            ((result = std::min(result, zoneMatch(children, zone))), ...);
+            return result;
+        },
+        filter.filters);
+}
+
+template <typename... Filters>
+ZoneMatch zoneMatch(const AnyOf<Filters...> &filter, const ZoneStats &zone) {
+    return std::apply(
+        [&](const auto &...children) {
+            ZoneMatch result = ZoneMatch::None;
+            ((result = std::max(result, zoneMatch(children, zone))), ...);
+            return result;
+        },
+        filter.filters);
+}
+
+// Обходит зоны базы, которые могут содержать подходящие книги: on_zone(match, zone, first, last)
+// получает метаданные зоны и её строки [first, last). Пропущенные и принятые целиком зоны подсчитываются
+template <BookContainerLike T, MemoryPolicyLike P, typename Pred, typename OnZone>
+void scanZones(const BookDatabase<T, P> &db, const Pred &pred, OnZone on_zone) {
+    const auto &zones = db.GetZoneMap();
+    for (size_t zone = 0; zone < zones.size(); ++zone) {
+        const ZoneMatch match = zoneMatch(pred, zones[zone]);
+        zones.Count(match);
+        if (match != ZoneMatch::None) {
+            const size_t first = zone * ZoneMap::kZoneRows;
+            on_zone(match, zones[zone], first, std::min(first + ZoneMap::kZoneRows, db.size()));
+        }
+    }
+}
+
+// Предикаты с векторными ядрами проверяются блоками по simd::kBlockSize книг,
+// результат собирается из итоговой битовой маски блока
+template <BookIterator It, BookPredicate Pred>
+void appendMatches(It begin, It end, const Pred &pred, std::vector<std::reference_wrapper<const Book>> &res) {
+    if constexpr (BookMaskPredicate<Pred, It>) {
+        const size_t size = std::distance(begin, end);
+        std::array<simd::MaskWord, simd::kBlockWords> mask;
+
+        for (size_t first = 0; first < size; first += simd::kBlockSize) {
+            const size_t count = std::min(simd::kBlockSize, size - first);
+            pred.EvalMask(begin + first, count, mask.data());
+            simd::ForEachSetBit(mask.data(), count, [&](size_t i) { res.emplace_back(begin[first + i]); });
+        }
+    } else {
+        std::ranges::copy_if(begin, end, std::back_inserter(res), pred);
+    }
+}
+
+}  // namespace detail
 
 template <BookIterator It, BookPredicate Pred>
 auto filterBooks(It begin, It end, Pred pred) {
+    QueryProbe probe{QueryKind::FilterBooks};
     std::vector<std::reference_wrapper<const Book>> res;
-    std::ranges::copy_if(begin, end, std::back_inserter(res), pred);
+    detail::appendMatches(begin, end, pred, res);
+    probe.Scanned(static_cast<size_t>(end - begin));
+    probe.Matched(res.size());
     return res;
 };
 
+namespace detail {
+
+// Номера строк-кандидатов из вторичных индексов базы или nullopt, если предикат нельзя ответить по индексу
+template <BookContainerLike T, MemoryPolicyLike P, typename Pred>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &, const Pred &) {
+    return std::nullopt;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &db, const YearFilter &filter) {
+    if (const auto *index = db.GetYearIndex()) {
+        return index->Between(filter.from, filter.to);
+    }
+    return std::nullopt;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &db, const RatingFilter &filter) {
+    if (const auto *index = db.GetRatingIndex()) {
+        return index->Above(filter.above);
+    }
+    return std::nullopt;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, typename... Filters>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &db, const AnyOf<Filters...> &filter);
+
+// Для конъюнкции достаточно кандидатов первого фильтра, который можно ответить по индексу
+template <BookContainerLike T, MemoryPolicyLike P, typename... Filters>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &db, const AllOf<Filters...> &filter) {
+    std::optional<std::vector<size_t>> candidates;
+    auto try_filter = [&](const auto &child) {
+        if (!candidates) {
+            candidates = indexCandidates(db, child);
+        }
+    };
+    std::apply([&](const auto &...children) { (try_filter(children), ...); }, filter.filters);
+    return candidates;
+}
+
+// Для дизъюнкции по индексу должны отвечаться все фильтры, кандидаты объединяются
+template <BookContainerLike T, MemoryPolicyLike P, typename... Filters>
+std::optional<std::vector<size_t>> indexCandidates(const BookDatabase<T, P> &db, const AnyOf<Filters...> &filter) {
+    if constexpr (sizeof...(Filters) == 0) {
+        return std::vector<size_t>{};
+    } else {
+        std::optional<std::vector<size_t>> candidates{std::in_place};
+        auto add_filter = [&](const auto &child) {
+            if (!candidates) {
+                return;
+            }
+            auto rows = indexCandidates(db, child);
+            if (!rows) {
+                candidates.reset();
+                return;
+            }
+            candidates->insert(candidates->end(), rows->begin(), rows->end());
+        };
+        std::apply([&](const auto &...children) { (add_filter(children), ...); }, filter.filters);
+
+        if (candidates) {
+            std::ranges::sort(*candidates);
+            candidates->erase(std::ranges::unique(*candidates).begin(), candidates->end());
+        }
+        return candidates;
+    }
+}
+
+}  // namespace detail
+
+// Если в базе созданы подходящие вторичные индексы, YearBetween и RatingAbove (в том числе внутри all_of/any_of)
+// отвечаются по индексу за O(log n + k) без полного сканирования. Иначе сканируются только зоны,
+// которые могут содержать подходящие книги. Порядок результата совпадает с порядком книг в базе
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+auto filterBooks(const BookDatabase<T, P> &db, Pred pred) {
+    QueryProbe probe{QueryKind::FilterBooks};
+    const auto &books = db.GetBooks();
+    std::vector<std::reference_wrapper<const Book>> res;
+
+    // Просмотренными считаются строки, которые проверялись предикатом
+    auto candidates = detail::indexCandidates(db, pred);
+    if (!candidates) {
+        detail::scanZones(db, pred, [&](ZoneMatch match, const ZoneStats &, size_t first, size_t last) {
+            if (match == ZoneMatch::All) {
+                std::for_each(books.cbegin() + first, books.cbegin() + last,
+                              [&](const Book &book) { res.emplace_back(book); });
+            } else {
+                detail::appendMatches(books.cbegin() + first, books.cbegin() + last, pred, res);
+                probe.Scanned(last - first);
+            }
+        });
+        probe.Matched(res.size());
+        return res;
+    }
+
+    std::ranges::sort(*candidates);
+    for (size_t row : *candidates) {
+        if (pred(books[row])) {
+            res.emplace_back(books[row]);
+        }
+    }
+    probe.Scanned(candidates->size());
+    probe.Matched(res.size());
+    return res;
+};
+
+// Сканирование колонок, возвращает номера подходящих строк
+template <BookColumnsLike Columns, BookColumnPredicate<Columns> Pred>
+std::vector<size_t> filterBooks(const Columns &columns, Pred pred) {
+    QueryProbe probe{QueryKind::FilterBooks};
+    std::vector<size_t> rows;
+    std::array<simd::MaskWord, simd::kBlockWords> mask;
+
+    for (size_t first = 0; first < columns.size(); first += simd::kBlockSize) {
+        const size_t count = std::min(simd::kBlockSize, columns.size() - first);
+        detail::evalMask(pred, columns, first, count, mask.data());
+        simd::ForEachSetBit(mask.data(), count, [&](size_t i) { rows.push_back(first + i); });
+    }
+
+    probe.Scanned(columns.size());
+    probe.Matched(rows.size());
+    return rows;
+};
+
 }  // namespace bookdb
\ No newline at end of file
@@ -0,0 +1,533 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <boost/container/flat_map.hpp>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "query_profiler.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+
+namespace bookdb {
+
+// Группировка с агрегатами: groupBy(books, group::ByGenre{}, agg::Count{}, agg::Avg{&Book::rating})
+// возвращает для каждого жанра кортеж (число книг, средний рейтинг). Агрегаты собираются на этапе компиляции
+// в кортеж состояний группы, поэтому одна группировка считает их все за один проход.
+// Таблица групп выбирается по ключу: ключи с малой плотной областью значений (жанр, год, десятилетие) лежат
+// в массиве по номеру, остальные (автор, собственные ключи group::By) - в хеш-таблице с открытой адресацией
+
+// Ключ группировки: key(book) возвращает упорядочиваемое значение, для которого есть std::hash
+template <typename K>
+concept GroupKey = requires(const K key, const Book &book) {
+    { key(book) } -> std::totally_ordered;
+    { std::hash<std::remove_cvref_t<decltype(key(book))>>{}(key(book)) } -> std::convertible_to<size_t>;
+};
+
+template <GroupKey K>
+using GroupKeyType = std::remove_cvref_t<std::invoke_result_t<const K &, const Book &>>;
+
+// Плотный ключ дополнительно переводит значение в целый номер и обратно: соседние значения - соседние номера
+template <typename K>
+concept DenseGroupKey = GroupKey<K> && requires(const K key, const GroupKeyType<K> &value, int64_t ordinal) {
+    { key.Ordinal(value) } -> std::same_as<int64_t>;
+    { key.FromOrdinal(ordinal) } -> std::same_as<GroupKeyType<K>>;
+};
+
+// Агрегат: состояние State{} - пустая группа, Add добавляет книгу, Merge объединяет частичные состояния
+template <typename A>
+concept Aggregator =
+    requires(const A agg, typename A::State &state, const typename A::State &other, const Book &book) {
+        agg.Add(state, book);
+        agg.Merge(state, other);
+        agg.Result(other);
+    };
+
+namespace group {
+
+struct ByGenre {
+    Genre operator()(const Book &book) const { return book.genre; }
+
+    int64_t Ordinal(Genre genre) const { return static_cast<int64_t>(genre); }
+
+    Genre FromOrdinal(int64_t ordinal) const { return static_cast<Genre>(ordinal); }
+};
+
+struct ByYear {
+    int operator()(const Book &book) const { return book.year; }
+
+    int64_t Ordinal(int year) const { return year; }
+
+    int FromOrdinal(int64_t ordinal) const { return static_cast<int>(ordinal); }
+};
+
+// Первый год десятилетия: 1949 -> 1940, -5 -> -10
+struct ByDecade {
+    int operator()(const Book &book) const { return static_cast<int>(Ordinal(book.year) * 10); }
+
+    int64_t Ordinal(int year) const { return year >= 0 ? year / 10 : (year - 9) / 10; }
+
+    int FromOrdinal(int64_t ordinal) const { return static_cast<int>(ordinal * 10); }
+};
+
+// Имя автора: авторов много, поэтому группы лежат в хеш-таблице. Хеш считается по символам имени,
+// которые лежат в словаре авторов вне массива книг
+struct ByAuthor {
+    std::string_view operator()(const Book &book) const { return book.author; }
+};
+
+// Идентификатор автора книги базы (см. AuthorDictionary): хешируется целое число без чтения имени,
+// имя группы - db.GetAuthors().Name(id). У книг вне базы идентификатор не назначен (kNoAuthorId)
+struct ByAuthorId {
+    AuthorId operator()(const Book &book) const { return book.author_id; }
+};
+
+// Собственный ключ: group::By{[](const Book &book) { return book.read_count / 1000; }}
+template <typename Fn>
+struct By {
+    Fn key;
+
+    auto operator()(const Book &book) const { return std::invoke(key, book); }
+};
+
+}  // namespace group
+
+namespace agg {
+
+// Поле книги для агрегата: указатель на член (&Book::rating) или функция от книги
+template <typename Field>
+using FieldValue = std::remove_cvref_t<std::invoke_result_t<const Field &, const Book &>>;
+
+// Сумма целых полей копится в int64_t, дробных - в double
+template <typename Field>
+using SumType = std::conditional_t<std::is_floating_point_v<FieldValue<Field>>, double, int64_t>;
+
+struct Count {
+    using State = size_t;
+
+    void Add(State &count, const Book &) const { ++count; }
+
+    void Merge(State &count, const State &other) const { count += other; }
+
+    size_t Result(const State &count) const { return count; }
+};
+
+template <typename Field>
+struct Sum {
+    using State = SumType<Field>;
+
+    Field field;
+
+    void Add(State &sum, const Book &book) const { sum += static_cast<State>(std::invoke(field, book)); }
+
+    void Merge(State &sum, const State &other) const { sum += other; }
+
+    State Result(const State &sum) const { return sum; }
+};
+
+template <typename Field>
+struct Avg {
+    struct State {
+        SumType<Field> sum = 0;
+        size_t count = 0;
+    };
+
+    Field field;
+
+    void Add(State &state, const Book &book) const {
+        state.sum += static_cast<SumType<Field>>(std::invoke(field, book));
+        ++state.count;
+    }
+
+    void Merge(State &state, const State &other) const {
+        state.sum += other.sum;
+        state.count += other.count;
+    }
+
+    double Result(const State &state) const {
+        return state.count == 0 ? 0.0 : static_cast<double>(state.sum) / static_cast<double>(state.count);
+    }
+};
+
+template <typename Field>
+struct Min {
+    using State = std::optional<FieldValue<Field>>;
+
+    Field field;
+
+    void Add(State &min, const Book &book) const {
+        auto value = std::invoke(field, book);
+        if (!min || value < *min) {
+            min = std::move(value);
+        }
+    }
+
+    void Merge(State &min, const State &other) const {
+        if (other && (!min || *other < *min)) {
+            min = other;
+        }
+    }
+
+    FieldValue<Field> Result(const State &min) const { return min.value_or(FieldValue<Field>{}); }
+};
+
+template <typename Field>
+struct Max {
+    using State = std::optional<FieldValue<Field>>;
+
+    Field field;
+
+    void Add(State &max, const Book &book) const {
+        auto value = std::invoke(field, book);
+        if (!max || *max < value) {
+            max = std::move(value);
+        }
+    }
+
+    void Merge(State &max, const State &other) const {
+        if (other && (!max || *max < *other)) {
+            max = other;
+        }
+    }
+
+    FieldValue<Field> Result(const State &max) const { return max.value_or(FieldValue<Field>{}); }
+};
+
+// Дисперсия генеральной совокупности. Состояние по Уэлфорду (число, среднее, сумма квадратов отклонений)
+// не теряет точность на больших средних, частичные состояния объединяются по формуле Чана
+template <typename Field>
+struct Variance {
+    struct State {
+        size_t count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+    };
+
+    Field field;
+
+    void Add(State &state, const Book &book) const {
+        const auto value = static_cast<double>(std::invoke(field, book));
+        ++state.count;
+        const double delta = value - state.mean;
+        state.mean += delta / static_cast<double>(state.count);
+        state.m2 += delta * (value - state.mean);
+    }
+
+    void Merge(State &state, const State &other) const {
+        if (other.count == 0) {
+            return;
+        }
+        const auto lhs = static_cast<double>(state.count);
+        const auto rhs = static_cast<double>(other.count);
+        const double delta = other.mean - state.mean;
+        state.mean += delta * rhs / (lhs + rhs);
+        state.m2 += other.m2 + delta * delta * lhs * rhs / (lhs + rhs);
+        state.count += other.count;
+    }
+
+    double Result(const State &state) const {
+        return state.count == 0 ? 0.0 : state.m2 / static_cast<double>(state.count);
+    }
+};
+
+}  // namespace agg
+
+template <GroupKey K, Aggregator... Aggs>
+using GroupByResult =
+    boost::container::flat_map<GroupKeyType<K>, std::tuple<decltype(std::declval<const Aggs &>().Result(
+                                                    std::declval<const typename Aggs::State &>()))...>>;
+
+namespace detail {
+
+// Хеш-таблица групп с линейным пробированием: хеш, ключ и состояние лежат в одной ячейке массива, без узлов.
+// Сохранённый хеш отсекает несовпадающие ключи без их сравнения (для строк - без memcmp), 0 - пустая ячейка
+template <typename Key, typename State>
+class FlatGroupTable {
+public:
+    State &operator[](const Key &key) {
+        if ((size_ + 1) * 4 > slots_.size() * 3) {
+            Rehash(std::max<size_t>(16, slots_.size() * 2));
+        }
+        const size_t hash = Hash(key);
+        const size_t mask = slots_.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+            auto &slot = slots_[pos];
+            if (slot.hash == 0) {
+                slot.hash = hash;
+                slot.key = key;
+                ++size_;
+                return slot.state;
+            }
+            if (slot.hash == hash && slot.key == key) {
+                return slot.state;
+            }
+        }
+    }
+
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        for (const auto &slot : slots_) {
+            if (slot.hash != 0) {
+                fn(slot.key, slot.state);
+            }
+        }
+    }
+
+    size_t size() const { return size_; }
+
+private:
+    struct Slot {
+        size_t hash = 0;
+        Key key{};
+        State state{};
+    };
+
+    // std::hash для целых - тождественная функция, поэтому биты перемешиваются (финализатор MurmurHash3)
+    static size_t Hash(const Key &key) {
+        uint64_t hash = std::hash<Key>{}(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return static_cast<size_t>(hash | 1);
+    }
+
+    void Rehash(size_t capacity) {
+        auto slots = std::exchange(slots_, std::vector<Slot>(capacity));
+        const size_t mask = capacity - 1;
+        for (auto &slot : slots) {
+            if (slot.hash == 0) {
+                continue;
+            }
+            size_t pos = slot.hash & mask;
+            while (slots_[pos].hash != 0) {
+                pos = (pos + 1) & mask;
+            }
+            slots_[pos] = std::move(slot);
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+};
+
+// Массив групп по номеру ключа в окне [base_, base_ + size). Окно растёт с запасом под новые номера,
+// но не шире kMaxDenseSlots: номера за его пределами (выбросы вроде года 0) уходят в хеш-таблицу
+template <typename State>
+class DenseGroupTable {
+public:
+    static constexpr int64_t kMaxDenseSlots = 4096;
+
+    State *Find(int64_t ordinal) {
+        if (ordinal < base_ || ordinal >= base_ + static_cast<int64_t>(states_.size())) {
+            if (!Grow(ordinal)) {
+                return nullptr;
+            }
+        }
+        const auto slot = static_cast<size_t>(ordinal - base_);
+        used_[slot] = 1;
+        return &states_[slot];
+    }
+
+    // fn(ordinal, state) по возрастанию номеров
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        for (size_t slot = 0; slot < states_.size(); ++slot) {
+            if (used_[slot]) {
+                fn(base_ + static_cast<int64_t>(slot), states_[slot]);
+            }
+        }
+    }
+
+private:
+    bool Grow(int64_t ordinal) {
+        if (states_.empty()) {
+            Resize(ordinal, ordinal + 1);
+            return true;
+        }
+        const int64_t low = std::min(ordinal, base_);
+        const int64_t high = std::max(ordinal + 1, base_ + static_cast<int64_t>(states_.size()));
+        if (high - low > kMaxDenseSlots) {
+            return false;
+        }
+        // Запас в половину окна в сторону роста, чтобы последовательные номера не копировали массив каждый раз
+        const int64_t slack = std::min((high - low) / 2, kMaxDenseSlots - (high - low));
+        Resize(ordinal < base_ ? low - slack : low, ordinal < base_ ? high : high + slack);
+        return true;
+    }
+
+    void Resize(int64_t low, int64_t high) {
+        std::vector<State> states(static_cast<size_t>(high - low));
+        std::vector<uint8_t> used(states.size());
+        for (size_t slot = 0; slot < states_.size(); ++slot) {
+            const auto moved = static_cast<size_t>(base_ - low) + slot;
+            states[moved] = std::move(states_[slot]);
+            used[moved] = used_[slot];
+        }
+        states_ = std::move(states);
+        used_ = std::move(used);
+        base_ = low;
+    }
+
+    int64_t base_ = 0;
+    std::vector<State> states_;
+    std::vector<uint8_t> used_;
+};
+
+// Таблица групп с накопленными состояниями всех агрегатов
+template <GroupKey K, Aggregator... Aggs>
+class GroupTable {
+public:
+    using Key = GroupKeyType<K>;
+    using States = std::tuple<typename Aggs::State...>;
+
+    GroupTable(const K &key, const std::tuple<Aggs...> &aggs) : key_(&key), aggs_(&aggs) {}
+
+    void Add(const Book &book) {
+        auto &states = At((*key_)(book));
+        AddTo(states, book, std::index_sequence_for<Aggs...>{});
+    }
+
+    void Merge(const GroupTable &other) {
+        other.ForEach([&](const Key &key, const States &states) {
+            MergeInto(At(key), states, std::index_sequence_for<Aggs...>{});
+        });
+    }
+
+    // fn(key, states) без определённого порядка
+    template <typename Fn>
+    void ForEach(Fn &&fn) const {
+        if constexpr (DenseGroupKey<K>) {
+            dense_.ForEach([&](int64_t ordinal, const States &states) { fn(key_->FromOrdinal(ordinal), states); });
+        }
+        hashed_.ForEach(fn);
+    }
+
+    GroupByResult<K, Aggs...> Result() const {
+        typename GroupByResult<K, Aggs...>::sequence_type items;
+        ForEach([&](const Key &key, const States &states) {
+            items.emplace_back(key, ResultOf(states, std::index_sequence_for<Aggs...>{}));
+        });
+        std::ranges::sort(items, {}, [](const auto &item) -> const Key & { return item.first; });
+
+        GroupByResult<K, Aggs...> result;
+        result.adopt_sequence(boost::container::ordered_unique_range, std::move(items));
+        return result;
+    }
+
+private:
+    States &At(const Key &key) {
+        if constexpr (DenseGroupKey<K>) {
+            if (auto *states = dense_.Find(key_->Ordinal(key))) {
+                return *states;
+            }
+        }
+        return hashed_[key];
+    }
+
+    template <size_t... I>
+    void AddTo(States &states, const Book &book, std::index_sequence<I...>) const {
+        (std::get<I>(*aggs_).Add(std::get<I>(states), book), ...);
+    }
+
+    template <size_t... I>
+    void MergeInto(States &states, const States &other, std::index_sequence<I...>) const {
+        (std::get<I>(*aggs_).Merge(std::get<I>(states), std::get<I>(other)), ...);
+    }
+
+    template <size_t... I>
+    auto ResultOf(const States &states, std::index_sequence<I...>) const {
+        return std::tuple{std::get<I>(*aggs_).Result(std::get<I>(states))...};
+    }
+
+    const K *key_;
+    const std::tuple<Aggs...> *aggs_;
+    [[no_unique_address]] std::conditional_t<DenseGroupKey<K>, DenseGroupTable<States>, std::monostate> dense_;
+    FlatGroupTable<Key, States> hashed_;
+};
+
+}  // namespace detail
+
+// Книги с одинаковым key(book) объединяются в группу, для каждой группы считаются все агрегаты aggs.
+// Результат упорядочен по ключу, значение - кортеж результатов агрегатов в порядке аргументов
+template <BookIterator It, GroupKey K, Aggregator... Aggs>
+GroupByResult<K, Aggs...> groupBy(It begin, It end, K key, Aggs... aggs) {
+    QueryProbe probe{QueryKind::GroupBy};
+    const std::tuple<Aggs...> aggregates{aggs...};
+    detail::GroupTable<K, Aggs...> table{key, aggregates};
+    std::for_each(begin, end, [&](const Book &book) { table.Add(book); });
+
+    auto result = table.Result();
+    probe.Scanned(static_cast<size_t>(std::distance(begin, end)));
+    probe.Matched(result.size());
+    return result;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, GroupKey K, Aggregator... Aggs>
+GroupByResult<K, Aggs...> groupBy(const BookDatabase<T, P> &cont, K key, Aggs... aggs) {
+    return groupBy(cont.cbegin(), cont.cend(), std::move(key), std::move(aggs)...);
+}
+
+// Ленивый диапазон, например filterView(db, pred): группируются только выданные им книги
+template <BookRange R, GroupKey K, Aggregator... Aggs>
+GroupByResult<K, Aggs...> groupBy(R &&books, K key, Aggs... aggs) {
+    QueryProbe probe{QueryKind::GroupBy};
+    const std::tuple<Aggs...> aggregates{aggs...};
+    detail::GroupTable<K, Aggs...> table{key, aggregates};
+    size_t scanned = 0;
+    for (const Book &book : books) {
+        table.Add(book);
+        ++scanned;
+    }
+
+    auto result = table.Result();
+    probe.Scanned(scanned);
+    probe.Matched(result.size());
+    return result;
+}
+
+// Параллельная версия: каждая часть диапазона строит свою таблицу частичных агрегатов, затем таблицы
+// объединяются через Merge агрегатов. Как и в statsistics.hpp, дробные суммы складываются в другом порядке
+// и могут отличаться от последовательных на ошибку округления
+template <BookIterator It, GroupKey K, Aggregator... Aggs>
+GroupByResult<K, Aggs...> groupBy(It begin, It end, ThreadPool &pool, K key, Aggs... aggs) {
+    const auto size = static_cast<size_t>(std::distance(begin, end));
+    const std::tuple<Aggs...> aggregates{aggs...};
+    std::vector<std::optional<detail::GroupTable<K, Aggs...>>> partials(parallelParts(size, pool));
+    QueryProbe probe{QueryKind::GroupBy, partials.size()};
+
+    pool.ParallelFor(size, partials.size(), [&](size_t part, size_t first, size_t last) {
+        auto &table = partials[part].emplace(key, aggregates);
+        std::for_each(begin + first, begin + last, [&](const Book &book) { table.Add(book); });
+    });
+
+    // Частичные таблицы вливаются в первую
+    auto &table = *partials.front();
+    std::for_each(partials.begin() + 1, partials.end(), [&](const auto &partial) { table.Merge(*partial); });
+
+    auto result = table.Result();
+    probe.Scanned(size);
+    probe.Matched(result.size());
+    return result;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, GroupKey K, Aggregator... Aggs>
+GroupByResult<K, Aggs...> groupBy(const BookDatabase<T, P> &cont, ThreadPool &pool, K key, Aggs... aggs) {
+    return groupBy(cont.cbegin(), cont.cend(), pool, std::move(key), std::move(aggs)...);
+}
+
+}  // namespace bookdb
@@ -9,18 +9,18 @@ namespace bookdb {
 
 struct TransparentStringLess {
     using is_transparent = void;
-    bool operator()(std::string_view lhs, std::string_view rhs) { return lhs < rhs; };
-    bool operator()(const std::string &lhs, std::string_view rhs) { return lhs < rhs; };
-    bool operator()(std::string_view lhs, const std::string &rhs) { return lhs < rhs; };
-    bool operator()(const std::string &lhs, const std::string &rhs) { return lhs < rhs; };
+    bool operator()(std::string_view lhs, std::string_view rhs) const { return lhs < rhs; };
+    bool operator()(const std::string &lhs, std::string_view rhs) const { return lhs < rhs; };
+    bool operator()(std::string_view lhs, const std::string &rhs) const { return lhs < rhs; };
+    bool operator()(const std::string &lhs, const std::string &rhs) const { return lhs < rhs; };
 };
 
 struct TransparentStringEqual {
     using is_transparent = void;
-    bool operator()(std::string_view lhs, std::string_view rhs) { return lhs == rhs; };
-    bool operator()(const std::string &lhs, std::string_view rhs) { return lhs == rhs; };
-    bool operator()(std::string_view lhs, const std::string &rhs) { return lhs == rhs; };
-    bool operator()(const std::string &lhs, const std::string &rhs) { return lhs == rhs; };
+    bool operator()(std::string_view lhs, std::string_view rhs) const { return lhs == rhs; };
+    bool operator()(const std::string &lhs, std::string_view rhs) const { return lhs == rhs; };
+    bool operator()(std::string_view lhs, const std::string &rhs) const { return lhs == rhs; };
+    bool operator()(const std::string &lhs, const std::string &rhs) const { return lhs == rhs; };
 };
 
 struct TransparentStringHash {
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bookdb {
+
+// Файл, отображённый в память только для чтения. Страницы подгружаются операционной системой
+// при первом обращении, поэтому открытие не зависит от размера файла
+class MappedFile {
+public:
+    static MappedFile Open(const std::filesystem::path &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), "Unable to open " + path.string()};
+        }
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Unable to stat " + path.string()};
+        }
+
+        // Пустой файл отобразить нельзя, он представляется пустым диапазоном
+        const auto size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return MappedFile{};
+        }
+
+        void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::system_error{error, std::generic_category(), "Unable to map " + path.string()};
+        }
+
+        return MappedFile{static_cast<const std::byte *>(data), size};
+    }
+
+    MappedFile() = default;
+
+    MappedFile(MappedFile &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            Unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() { Unmap(); }
+
+    // Подсказка ядру, что файл будет читаться последовательно
+    void AdviseSequential() const {
+        if (data_ != nullptr) {
+            ::madvise(const_cast<std::byte *>(data_), size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    const std::byte *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    std::span<const std::byte> Bytes() const { return {data_, size_}; }
+
+    std::string_view Text() const { return {reinterpret_cast<const char *>(data_), size_}; }
+
+private:
+    MappedFile(const std::byte *data, size_t size) : data_(data), size_(size) {}
+
+    void Unmap() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<std::byte *>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    const std::byte *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace bookdb
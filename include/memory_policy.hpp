@@ -0,0 +1,79 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace bookdb {
+
+// Политика памяти BookDatabase: источник памяти для заголовков книг, имён авторов и (для pmr-контейнеров) самих книг.
+// Политика, для которой kBulkRelease == true, умеет освободить всю выделенную память одним вызовом release()
+template <typename P>
+concept MemoryPolicyLike = std::default_initializable<P> && requires(P p) {
+    { p.resource() } -> std::same_as<std::pmr::memory_resource *>;
+    { P::kBulkRelease } -> std::convertible_to<bool>;
+    p.release();
+};
+
+// Обычная куча: каждая строка длиннее SSO - отдельное выделение через new/delete
+struct HeapMemoryPolicy {
+    static constexpr bool kBulkRelease = false;
+
+    std::pmr::memory_resource *resource() const { return std::pmr::get_default_resource(); }
+
+    void release() {}
+};
+
+// Монотонная арена: выделение - сдвиг указателя внутри большого блока, освобождение отдельных строк не происходит.
+// Подходит для баз, которые только пополняются и очищаются целиком
+class MonotonicArenaPolicy {
+public:
+    static constexpr bool kBulkRelease = true;
+
+    MonotonicArenaPolicy() = default;
+
+    // Арена уходит вместе с политикой, исходная политика получает новую и остаётся рабочей
+    MonotonicArenaPolicy(MonotonicArenaPolicy &&other) : arena_(std::exchange(other.arena_, MakeArena())) {}
+
+    // Ресурс хранится по указателю, чтобы перемещение базы не инвалидировало аллокаторы контейнеров
+    std::pmr::memory_resource *resource() const { return arena_.get(); }
+
+    void release() { arena_->release(); }
+
+private:
+    static constexpr size_t kInitialBlockSize = 64 * 1024;
+
+    static std::unique_ptr<std::pmr::monotonic_buffer_resource> MakeArena() {
+        return std::make_unique<std::pmr::monotonic_buffer_resource>(kInitialBlockSize);
+    }
+
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_ = MakeArena();
+};
+
+// Пул блоков фиксированных размеров: освобождённая память переиспользуется, крупные блоки выделяются редко
+class PoolMemoryPolicy {
+public:
+    static constexpr bool kBulkRelease = true;
+
+    PoolMemoryPolicy() = default;
+
+    // Как и у MonotonicArenaPolicy, исходная политика получает новый пул
+    PoolMemoryPolicy(PoolMemoryPolicy &&other)
+        : pool_(std::exchange(other.pool_, std::make_unique<std::pmr::unsynchronized_pool_resource>())) {}
+
+    std::pmr::memory_resource *resource() const { return pool_.get(); }
+
+    void release() { pool_->release(); }
+
+private:
+    std::unique_ptr<std::pmr::unsynchronized_pool_resource> pool_ =
+        std::make_unique<std::pmr::unsynchronized_pool_resource>();
+};
+
+static_assert(MemoryPolicyLike<HeapMemoryPolicy>);
+static_assert(MemoryPolicyLike<MonotonicArenaPolicy>);
+static_assert(MemoryPolicyLike<PoolMemoryPolicy>);
+
+}  // namespace bookdb
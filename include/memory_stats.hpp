@@ -0,0 +1,310 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+
+#include "memory_policy.hpp"
+
+namespace bookdb {
+
+// Учёт памяти: CountingMemoryResource и CountingMemoryPolicy считают выделения ресурса базы (заголовки, имена
+// авторов, книги pmr-контейнера), перехватчики operator new (BOOKDB_DEFINE_ALLOCATION_HOOKS) - выделения кучи,
+// в том числе буферы результатов filterBooks и статистик. AllocationScope показывает, сколько выделений сделала
+// одна операция, BookDatabase::MemoryStats() - из чего складывается память базы
+
+// Накопленные счётчики источника памяти. bytes_in_use и peak_bytes - живые байты сейчас и их максимум
+struct AllocationCounters {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_in_use = 0;
+    size_t peak_bytes = 0;
+};
+
+// Выделения за время операции. retained_bytes - прирост живых байт: память, которую операция оставила
+// за собой (буферы результата, рост базы); отрицательна, если операция освободила больше, чем выделила
+struct AllocationDelta {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+    ptrdiff_t retained_bytes = 0;
+};
+
+inline AllocationDelta operator-(const AllocationCounters &after, const AllocationCounters &before) {
+    return {after.allocations - before.allocations, after.deallocations - before.deallocations,
+            after.bytes_allocated - before.bytes_allocated,
+            static_cast<ptrdiff_t>(after.bytes_in_use) - static_cast<ptrdiff_t>(before.bytes_in_use)};
+}
+
+namespace detail {
+
+// Счётчики на атомиках с relaxed-порядком: выделять память могут потоки пула, точная синхронизация не нужна
+class AllocationTally {
+public:
+    void OnAllocate(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+        const size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+        while (peak < in_use && !peak_bytes_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+        }
+    }
+
+    void OnDeallocate(size_t bytes) noexcept {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    // Ресурс вернул всю память разом (release() арены), отдельных освобождений не будет
+    void OnRelease() noexcept { bytes_in_use_.store(0, std::memory_order_relaxed); }
+
+    AllocationCounters Snapshot() const noexcept {
+        return {allocations_.load(std::memory_order_relaxed), deallocations_.load(std::memory_order_relaxed),
+                bytes_allocated_.load(std::memory_order_relaxed), bytes_in_use_.load(std::memory_order_relaxed),
+                peak_bytes_.load(std::memory_order_relaxed)};
+    }
+
+    // Накопленные счётчики обнуляются, живые байты сохраняются и становятся новым пиком
+    void Reset() noexcept {
+        allocations_.store(0, std::memory_order_relaxed);
+        deallocations_.store(0, std::memory_order_relaxed);
+        bytes_allocated_.store(0, std::memory_order_relaxed);
+        peak_bytes_.store(bytes_in_use_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> allocations_ = 0;
+    std::atomic<size_t> deallocations_ = 0;
+    std::atomic<size_t> bytes_allocated_ = 0;
+    std::atomic<size_t> bytes_in_use_ = 0;
+    std::atomic<size_t> peak_bytes_ = 0;
+};
+
+// Счётчики кучи, пополняются перехватчиками operator new / delete
+inline AllocationTally &heapTally() noexcept {
+    static AllocationTally tally;
+    return tally;
+}
+
+inline std::atomic<bool> &heapHooksInstalled() noexcept {
+    static std::atomic<bool> installed = false;
+    return installed;
+}
+
+}  // namespace detail
+
+// Ресурс-посредник: передаёт выделения upstream и считает их. Байты считаются по запрошенному размеру
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : upstream_(upstream) {}
+
+    std::pmr::memory_resource *upstream_resource() const { return upstream_; }
+
+    AllocationCounters Counters() const { return tally_.Snapshot(); }
+
+    void ResetCounters() { tally_.Reset(); }
+
+    // Upstream освободил всю память одним вызовом (release() арены или пула)
+    void OnRelease() { tally_.OnRelease(); }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        void *ptr = upstream_->allocate(bytes, alignment);
+        tally_.OnAllocate(bytes);
+        return ptr;
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(ptr, bytes, alignment);
+        tally_.OnDeallocate(bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource *upstream_;
+    detail::AllocationTally tally_;
+};
+
+// Политика памяти, считающая выделения политики Inner: BookDatabase<std::vector<Book>, CountingMemoryPolicy<>>
+// ведёт себя как база с HeapMemoryPolicy, а GetMemoryPolicy().Counters() показывает выделения её ресурса
+template <MemoryPolicyLike Inner = HeapMemoryPolicy>
+class CountingMemoryPolicy {
+public:
+    static constexpr bool kBulkRelease = Inner::kBulkRelease;
+
+    CountingMemoryPolicy() = default;
+
+    // Счётчик уходит вместе с ресурсом внутренней политики, исходная политика считает выделения нового ресурса
+    CountingMemoryPolicy(CountingMemoryPolicy &&other)
+        : inner_(std::move(other.inner_)),
+          counter_(std::exchange(other.counter_, std::make_unique<CountingMemoryResource>(other.inner_.resource()))) {}
+
+    // Как и в MonotonicArenaPolicy, ресурс хранится по указателю и переживает перемещение политики
+    std::pmr::memory_resource *resource() const { return counter_.get(); }
+
+    void release() {
+        inner_.release();
+        if constexpr (kBulkRelease) {
+            counter_->OnRelease();
+        }
+    }
+
+    AllocationCounters Counters() const { return counter_->Counters(); }
+
+    void ResetCounters() { counter_->ResetCounters(); }
+
+    // Для замера одной операции: AllocationScope{db.GetMemoryPolicy().Counter()}
+    const CountingMemoryResource &Counter() const { return *counter_; }
+
+    const Inner &GetInner() const { return inner_; }
+
+private:
+    // Внутренняя политика объявлена первой: её ресурс - upstream счётчика
+    Inner inner_;
+    std::unique_ptr<CountingMemoryResource> counter_ = std::make_unique<CountingMemoryResource>(inner_.resource());
+};
+
+static_assert(MemoryPolicyLike<CountingMemoryPolicy<>>);
+static_assert(MemoryPolicyLike<CountingMemoryPolicy<MonotonicArenaPolicy>>);
+
+// Счётчики кучи процесса; нули, если перехватчики operator new не подключены
+inline AllocationCounters heapAllocationCounters() { return detail::heapTally().Snapshot(); }
+
+inline bool heapAllocationHooksInstalled() { return detail::heapHooksInstalled().load(std::memory_order_relaxed); }
+
+// Выделения между созданием объекта и вызовом Delta(): кучи процесса (нужны перехватчики operator new)
+// или переданного ресурса. Счётчики кучи общие для всех потоков, поэтому на время замера
+// другие потоки не должны выделять память, иначе их выделения попадут в результат
+class AllocationScope {
+public:
+    AllocationScope() : resource_(nullptr), before_(heapAllocationCounters()) {
+        if (!heapAllocationHooksInstalled()) {
+            throw std::logic_error{"Heap allocation hooks are not installed, define BOOKDB_DEFINE_ALLOCATION_HOOKS"};
+        }
+    }
+
+    explicit AllocationScope(const CountingMemoryResource &resource)
+        : resource_(&resource), before_(resource.Counters()) {}
+
+    AllocationDelta Delta() const { return Current() - before_; }
+
+    // Начинает новый замер с текущих значений счётчиков
+    void Restart() { before_ = Current(); }
+
+private:
+    AllocationCounters Current() const { return resource_ ? resource_->Counters() : heapAllocationCounters(); }
+
+    const CountingMemoryResource *resource_;
+    AllocationCounters before_;
+};
+
+// Разбивка памяти базы по структурам, в байтах кучи (без размера самих объектов).
+// Размеры узловых контейнеров (индексы, хеш-таблицы) оцениваются по устройству узлов libstdc++
+struct MemoryStats {
+    // Массив книг (вместимость, а не размер)
+    size_t book_storage = 0;
+    // Заголовки, не поместившиеся в буфер короткой строки
+    size_t title_heap = 0;
+    // Словарь авторов: имена, массив имён и хеш-таблица
+    size_t author_set = 0;
+    // Вторичные индексы, упорядоченный индекс авторов, полнотекстовый индекс
+    size_t indexes = 0;
+    // Агрегаты, карта зон, скетчи
+    size_t derived = 0;
+
+    size_t Total() const { return book_storage + title_heap + author_set + indexes + derived; }
+
+    MemoryStats &operator+=(const MemoryStats &other) {
+        book_storage += other.book_storage;
+        title_heap += other.title_heap;
+        author_set += other.author_set;
+        indexes += other.indexes;
+        derived += other.derived;
+        return *this;
+    }
+};
+
+namespace detail {
+
+// Узел красно-чёрного дерева: цвет и три указателя перед значением
+template <typename Value>
+constexpr size_t treeNodeBytes() {
+    return 4 * sizeof(void *) + sizeof(Value);
+}
+
+// Хеш-таблица: массив корзин и узлы из указателя на следующий, значения и сохранённого хеша
+template <typename Map>
+size_t hashTableBytes(const Map &map) {
+    return map.bucket_count() * sizeof(void *) + map.size() * (2 * sizeof(void *) + sizeof(typename Map::value_type));
+}
+
+// Символы строки вне объекта; короткая строка хранится в самом объекте и памяти не занимает
+template <typename String>
+size_t stringHeapBytes(const String &str) {
+    const auto *object = reinterpret_cast<const char *>(&str);
+    const bool inline_buffer = str.data() >= object && str.data() < object + sizeof(String);
+    return inline_buffer ? 0 : str.capacity() + 1;
+}
+
+}  // namespace detail
+
+}  // namespace bookdb
+
+// Перехватчики глобальных operator new / delete для счётчиков кучи. Определяются ровно в одной единице
+// трансляции программы: #define BOOKDB_DEFINE_ALLOCATION_HOOKS перед первым включением этого заголовка.
+// Размер блока берётся из malloc_usable_size (glibc), поэтому учитывается и округление malloc
+#ifdef BOOKDB_DEFINE_ALLOCATION_HOOKS
+
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace bookdb::detail {
+
+inline void *trackHeapAllocation(void *ptr) {
+    if (ptr == nullptr) {
+        throw std::bad_alloc{};
+    }
+    heapTally().OnAllocate(malloc_usable_size(ptr));
+    return ptr;
+}
+
+inline void freeHeapAllocation(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        heapTally().OnDeallocate(malloc_usable_size(ptr));
+        std::free(ptr);
+    }
+}
+
+inline const bool kHeapHooksRegistered = (heapHooksInstalled().store(true), true);
+
+}  // namespace bookdb::detail
+
+void *operator new(size_t size) { return bookdb::detail::trackHeapAllocation(std::malloc(size == 0 ? 1 : size)); }
+
+// std::pmr::new_delete_resource выделяет память через выровненную форму operator new
+void *operator new(size_t size, std::align_val_t align) {
+    const auto alignment = static_cast<size_t>(align);
+    return bookdb::detail::trackHeapAllocation(
+        std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment));
+}
+
+// GCC не видит, что память для operator delete выделена через malloc в нашем же operator new
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *ptr) noexcept { bookdb::detail::freeHeapAllocation(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { bookdb::detail::freeHeapAllocation(ptr); }
+
+void operator delete(void *ptr, std::align_val_t) noexcept { bookdb::detail::freeHeapAllocation(ptr); }
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { bookdb::detail::freeHeapAllocation(ptr); }
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "filter_kernels.hpp"
+#include "filters.hpp"
+#include "query_profiler.hpp"
+
+namespace bookdb {
+
+// Владеющее дерево предиката: листья - GenreFilter, YearFilter, RatingFilter, узлы - конъюнкция и дизъюнкция.
+// Константы (например, название жанра) переводятся при построении дерева, а не при проверке каждой книги
+class Query {
+public:
+    enum class Kind { Leaf, And, Or };
+    using Leaf = std::variant<GenreFilter, YearFilter, RatingFilter>;
+
+    static Query Genre(bookdb::Genre genre) { return Query{GenreFilter{genre}}; }
+
+    static Query Genre(std::string_view genre) { return Query{GenreFilter{ConvertGenre(genre)}}; }
+
+    static Query Year(int from, int to) { return Query{YearFilter{from, to}}; }
+
+    static Query Rating(double above) { return Query{RatingFilter{above}}; }
+
+    static Query And(std::vector<Query> children) { return Query{Kind::And, std::move(children)}; }
+
+    static Query Or(std::vector<Query> children) { return Query{Kind::Or, std::move(children)}; }
+
+    // Перевод составного предиката из filters.hpp (GenreIs, YearBetween, RatingAbove, all_of, any_of)
+    static Query From(const GenreFilter &filter) { return Query{filter}; }
+
+    static Query From(const YearFilter &filter) { return Query{filter}; }
+
+    static Query From(const RatingFilter &filter) { return Query{filter}; }
+
+    template <typename... Filters>
+    static Query From(const AllOf<Filters...> &filter) {
+        return And(std::apply([](const auto &...children) { return std::vector<Query>{From(children)...}; },
+                              filter.filters));
+    }
+
+    template <typename... Filters>
+    static Query From(const AnyOf<Filters...> &filter) {
+        return Or(std::apply([](const auto &...children) { return std::vector<Query>{From(children)...}; },
+                             filter.filters));
+    }
+
+    Kind GetKind() const { return kind_; }
+
+    const Leaf &GetLeaf() const { return leaf_; }
+
+    const std::vector<Query> &GetChildren() const { return children_; }
+
+private:
+    explicit Query(Leaf leaf) : kind_(Kind::Leaf), leaf_(leaf) {}
+
+    Query(Kind kind, std::vector<Query> children) : kind_(kind), children_(std::move(children)) {}
+
+    Kind kind_;
+    Leaf leaf_{};
+    std::vector<Query> children_;
+};
+
+// Равноширинная гистограмма значений колонки, оценивает долю значений в полуинтервале [lo, hi)
+class EquiWidthHistogram {
+public:
+    static constexpr size_t kBuckets = 64;
+
+    EquiWidthHistogram() = default;
+
+    // Значения лежат в [min, max); для целых колонок max - наибольшее значение + 1
+    EquiWidthHistogram(double min, double max) : min_(min), max_(std::max(max, min)) {}
+
+    void Add(double value) {
+        buckets_[Bucket(value)]++;
+        total_++;
+    }
+
+    double FractionBetween(double lo, double hi) const {
+        lo = std::max(lo, min_);
+        hi = std::min(hi, max_);
+        if (total_ == 0 || !(lo < hi)) {
+            return 0.0;
+        }
+        if (max_ == min_) {
+            return 1.0;
+        }
+
+        // Внутри корзины значения считаются распределёнными равномерно
+        const double width = (max_ - min_) / kBuckets;
+        double count = 0.0;
+        for (size_t bucket = Bucket(lo); bucket <= Bucket(hi) && bucket < kBuckets; ++bucket) {
+            const double bucket_lo = min_ + bucket * width;
+            const double overlap = std::min(hi, bucket_lo + width) - std::max(lo, bucket_lo);
+            count += buckets_[bucket] * std::clamp(overlap / width, 0.0, 1.0);
+        }
+        return std::clamp(count / total_, 0.0, 1.0);
+    }
+
+private:
+    size_t Bucket(double value) const {
+        if (max_ == min_) {
+            return 0;
+        }
+        const auto bucket = static_cast<ptrdiff_t>((value - min_) / (max_ - min_) * kBuckets);
+        return static_cast<size_t>(std::clamp<ptrdiff_t>(bucket, 0, kBuckets - 1));
+    }
+
+    double min_ = 0.0;
+    double max_ = 0.0;
+    std::array<size_t, kBuckets> buckets_{};
+    size_t total_ = 0;
+};
+
+// Статистика колонок для оценки селективности предикатов. Собирается за два прохода по колонкам
+// и может переиспользоваться для многих запросов, пока распределение данных существенно не изменилось
+class ColumnStatistics {
+public:
+    template <BookColumnsLike Columns>
+    static ColumnStatistics Collect(const Columns &columns) {
+        return Collect(columns.size(), [&](size_t row) {
+            return std::tuple{columns.Years()[row], columns.Genres()[row], columns.Ratings()[row]};
+        });
+    }
+
+    template <BookContainerLike T, MemoryPolicyLike P>
+    static ColumnStatistics Collect(const BookDatabase<T, P> &db) {
+        const auto &books = db.GetBooks();
+        return Collect(books.size(), [&](size_t row) {
+            const Book &book = books[row];
+            return std::tuple{book.year, book.genre, book.rating};
+        });
+    }
+
+    size_t Rows() const { return rows_; }
+
+    double Selectivity(const GenreFilter &filter) const {
+        return rows_ == 0 ? 0.0 : static_cast<double>(genre_counts_[static_cast<size_t>(filter.genre)]) / rows_;
+    }
+
+    double Selectivity(const YearFilter &filter) const { return years_.FractionBetween(filter.from, filter.to); }
+
+    double Selectivity(const RatingFilter &filter) const {
+        return ratings_.FractionBetween(std::nextafter(filter.above, std::numeric_limits<double>::infinity()),
+                                        std::numeric_limits<double>::infinity());
+    }
+
+private:
+    template <typename Row>
+    static ColumnStatistics Collect(size_t rows, Row row) {
+        ColumnStatistics stats;
+        stats.rows_ = rows;
+        if (rows == 0) {
+            return stats;
+        }
+
+        auto [min_year, first_genre, min_rating] = row(0);
+        int max_year = min_year;
+        double max_rating = min_rating;
+        for (size_t i = 0; i < rows; ++i) {
+            const auto [year, genre, rating] = row(i);
+            min_year = std::min(min_year, year);
+            max_year = std::max(max_year, year);
+            min_rating = std::min(min_rating, rating);
+            max_rating = std::max(max_rating, rating);
+        }
+
+        // Верхняя граница рейтинга сдвигается, чтобы максимальное значение попало в диапазон [min, max)
+        stats.years_ = EquiWidthHistogram{static_cast<double>(min_year), static_cast<double>(max_year) + 1.0};
+        stats.ratings_ = EquiWidthHistogram{min_rating, std::nextafter(max_rating, max_rating + 1.0)};
+        for (size_t i = 0; i < rows; ++i) {
+            const auto [year, genre, rating] = row(i);
+            stats.years_.Add(year);
+            stats.ratings_.Add(rating);
+            stats.genre_counts_[genreIndex(genre)]++;
+        }
+        return stats;
+    }
+
+    size_t rows_ = 0;
+    std::array<size_t, kGenreCount> genre_counts_{};
+    EquiWidthHistogram years_;
+    EquiWidthHistogram ratings_;
+};
+
+// Узел плана: дерево запроса после упрощения и переупорядочивания, с оценками
+// selectivity - оценка доли строк, проходящих узел (в предположении независимости предикатов),
+// cost - ожидаемое число проверок листьев на одну входящую в узел строку
+struct PlanNode {
+    Query::Kind kind;
+    Query::Leaf leaf;
+    std::vector<PlanNode> children;
+    double selectivity = 1.0;
+    double cost = 0.0;
+};
+
+class QueryPlan {
+public:
+    explicit QueryPlan(PlanNode root) : root_(std::move(root)) {}
+
+    const PlanNode &Root() const { return root_; }
+
+    double Selectivity() const { return root_.selectivity; }
+
+    double Cost() const { return root_.cost; }
+
+    // Текстовое представление плана: узлы в порядке выполнения с оценками
+    std::string Explain() const {
+        std::string out;
+        Explain(root_, 0, out);
+        return out;
+    }
+
+private:
+    static void Explain(const PlanNode &node, size_t depth, std::string &out) {
+        std::string label;
+        if (node.kind == Query::Kind::Leaf) {
+            label = std::visit(
+                [](const auto &filter) -> std::string {
+                    using Filter = std::decay_t<decltype(filter)>;
+                    if constexpr (std::is_same_v<Filter, GenreFilter>) {
+                        return std::format("genre == {}", ConvertGenre(filter.genre));
+                    } else if constexpr (std::is_same_v<Filter, YearFilter>) {
+                        return std::format("year in [{}, {})", filter.from, filter.to);
+                    } else {
+                        return std::format("rating > {}", filter.above);
+                    }
+                },
+                node.leaf);
+        } else {
+            label = node.kind == Query::Kind::And ? "AND" : "OR";
+        }
+        out += std::format("{:{}}{} (selectivity {:.3f}, cost {:.2f})\n", "", depth * 2, label, node.selectivity,
+                           node.cost);
+        std::ranges::for_each(node.children, [&](const PlanNode &child) { Explain(child, depth + 1, out); });
+    }
+
+    PlanNode root_;
+};
+
+namespace detail {
+
+// Стоимость проверки листа на строку: диапазон лет - два сравнения, остальные - одно
+inline double leafCost(const Query::Leaf &leaf) { return std::holds_alternative<YearFilter>(leaf) ? 1.2 : 1.0; }
+
+// Порядок потомков выбирается по классическому правилу для независимых предикатов:
+// в конъюнкции раньше идут дешёвые и отсекающие (по возрастанию cost / (1 - selectivity)),
+// в дизъюнкции - дешёвые и пропускающие (по возрастанию cost / selectivity)
+inline double rank(const PlanNode &node, Query::Kind parent) {
+    const double pass = parent == Query::Kind::And ? 1.0 - node.selectivity : node.selectivity;
+    return pass <= 0.0 ? std::numeric_limits<double>::infinity() : node.cost / pass;
+}
+
+inline PlanNode planNode(const Query &query, const ColumnStatistics &stats) {
+    if (query.GetKind() == Query::Kind::Leaf) {
+        PlanNode node{Query::Kind::Leaf, query.GetLeaf(), {}};
+        node.selectivity = std::visit([&](const auto &filter) { return stats.Selectivity(filter); }, query.GetLeaf());
+        node.cost = leafCost(query.GetLeaf());
+        return node;
+    }
+
+    const auto kind = query.GetKind();
+    PlanNode node{kind, {}, {}};
+    for (const Query &child : query.GetChildren()) {
+        auto planned = planNode(child, stats);
+        // Вложенные узлы того же вида раскрываются: AND(a, AND(b, c)) == AND(a, b, c)
+        if (planned.kind == kind) {
+            std::ranges::move(planned.children, std::back_inserter(node.children));
+        } else {
+            node.children.push_back(std::move(planned));
+        }
+    }
+
+    // Узел из одного потомка заменяется потомком
+    if (node.children.size() == 1) {
+        return std::move(node.children.front());
+    }
+
+    std::ranges::stable_sort(node.children, {}, [&](const PlanNode &child) { return rank(child, kind); });
+
+    // Пустая конъюнкция истинна, пустая дизъюнкция ложна
+    double reach = 1.0;
+    node.selectivity = kind == Query::Kind::And ? 1.0 : 0.0;
+    for (const PlanNode &child : node.children) {
+        node.cost += reach * child.cost;
+        if (kind == Query::Kind::And) {
+            node.selectivity *= child.selectivity;
+            reach *= child.selectivity;
+        } else {
+            node.selectivity += (1.0 - node.selectivity) * child.selectivity;
+            reach *= 1.0 - child.selectivity;
+        }
+    }
+    return node;
+}
+
+// Источники строк для выполнения плана: Test проверяет лист на одной строке,
+// EvalMask - на всём блоке векторным ядром фильтра
+template <BookColumnsLike Columns>
+struct ColumnRows {
+    const Columns &columns;
+
+    size_t size() const { return columns.size(); }
+
+    template <typename Filter>
+    bool Test(const Filter &filter, size_t row) const {
+        return filter(columns, row);
+    }
+
+    template <typename Filter>
+    void EvalMask(const Filter &filter, size_t first, size_t count, simd::MaskWord *out) const {
+        evalMask(filter, columns, first, count, out);
+    }
+};
+
+template <typename Books>
+struct BookRows {
+    const Books &books;
+
+    size_t size() const { return books.size(); }
+
+    template <typename Filter>
+    bool Test(const Filter &filter, size_t row) const {
+        return filter(books[row]);
+    }
+
+    template <typename Filter>
+    void EvalMask(const Filter &filter, size_t first, size_t count, simd::MaskWord *out) const {
+        evalMask(filter, books.cbegin() + first, count, out);
+    }
+};
+
+// Блок строк: sel - номера строк блока, оставшихся после предыдущих узлов
+struct PlanBlock {
+    size_t first;
+    size_t count;
+};
+
+// Выполнение узла над блоком: в sel остаются только подходящие строки (в исходном порядке),
+// возвращается их количество
+template <typename Rows>
+size_t selectRows(const PlanNode &node, const Rows &rows, PlanBlock block, size_t *sel, size_t count) {
+    switch (node.kind) {
+    case Query::Kind::Leaf:
+        return std::visit(
+            [&](const auto &filter) {
+                size_t out = 0;
+                // Плотная выборка проверяется векторным ядром по всему блоку, разреженная - построчно.
+                // В обоих случаях без ветвлений: строка записывается всегда, а позиция сдвигается только для подходящих
+                if (count * 4 >= block.count) {
+                    std::array<simd::MaskWord, simd::kBlockWords> mask;
+                    rows.EvalMask(filter, block.first, block.count, mask.data());
+                    for (size_t i = 0; i < count; ++i) {
+                        const size_t bit = sel[i] - block.first;
+                        sel[out] = sel[i];
+                        out += (mask[bit / simd::kMaskWordBits] >> (bit % simd::kMaskWordBits)) & 1;
+                    }
+                } else {
+                    for (size_t i = 0; i < count; ++i) {
+                        sel[out] = sel[i];
+                        out += rows.Test(filter, sel[i]) ? 1 : 0;
+                    }
+                }
+                return out;
+            },
+            node.leaf);
+
+    case Query::Kind::And:
+        for (const PlanNode &child : node.children) {
+            if (count == 0) {
+                break;
+            }
+            count = selectRows(child, rows, block, sel, count);
+        }
+        return count;
+
+    case Query::Kind::Or: {
+        // Каждый следующий потомок проверяет только строки, не принятые предыдущими
+        std::array<bool, simd::kBlockSize> accepted{};
+        std::array<size_t, simd::kBlockSize> pending;
+        std::array<size_t, simd::kBlockSize> passed;
+        std::copy_n(sel, count, pending.begin());
+        size_t pending_count = count;
+
+        for (const PlanNode &child : node.children) {
+            if (pending_count == 0) {
+                break;
+            }
+            std::copy_n(pending.begin(), pending_count, passed.begin());
+            const size_t matched = selectRows(child, rows, block, passed.data(), pending_count);
+            for (size_t i = 0; i < matched; ++i) {
+                accepted[passed[i] - block.first] = true;
+            }
+
+            size_t out = 0;
+            for (size_t i = 0; i < pending_count; ++i) {
+                pending[out] = pending[i];
+                out += accepted[pending[i] - block.first] ? 0 : 1;
+            }
+            pending_count = out;
+        }
+
+        size_t out = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sel[out] = sel[i];
+            out += accepted[sel[i] - block.first] ? 1 : 0;
+        }
+        return out;
+    }
+    }
+    return 0;
+}
+
+template <typename Rows>
+std::vector<size_t> executePlan(const QueryPlan &plan, const Rows &rows) {
+    QueryProbe probe{QueryKind::ExecuteQuery};
+    std::vector<size_t> result;
+    std::array<size_t, simd::kBlockSize> sel;
+
+    for (size_t first = 0; first < rows.size(); first += simd::kBlockSize) {
+        const PlanBlock block{first, std::min(simd::kBlockSize, rows.size() - first)};
+        for (size_t i = 0; i < block.count; ++i) {
+            sel[i] = first + i;
+        }
+        const size_t matched = selectRows(plan.Root(), rows, block, sel.data(), block.count);
+        result.insert(result.end(), sel.begin(), sel.begin() + matched);
+    }
+    probe.Scanned(rows.size());
+    probe.Matched(result.size());
+    return result;
+}
+
+}  // namespace detail
+
+// Строит план: оценивает селективность и стоимость узлов по статистике, упрощает дерево
+// и переупорядочивает потомков для наиболее раннего завершения проверок
+inline QueryPlan planQuery(const Query &query, const ColumnStatistics &stats) {
+    return QueryPlan{detail::planNode(query, stats)};
+}
+
+// Выполняет план за один проход блоками по simd::kBlockSize строк: первые узлы конъюнкции проверяются
+// векторными ядрами, следующие - только на оставшихся строках. Возвращает номера подходящих строк по возрастанию
+template <BookColumnsLike Columns>
+std::vector<size_t> executeQuery(const Columns &columns, const QueryPlan &plan) {
+    return detail::executePlan(plan, detail::ColumnRows<Columns>{columns});
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> executeQuery(const BookDatabase<T, P> &db, const QueryPlan &plan) {
+    return detail::executePlan(plan, detail::BookRows<T>{db.GetBooks()});
+}
+
+}  // namespace bookdb
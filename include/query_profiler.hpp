@@ -0,0 +1,423 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace bookdb {
+
+// Профилирование запросов: filterBooks, getTopNBy, calculateGenreRatings и другие точки входа записывают
+// число просмотренных и подошедших строк, время выполнения и число потоков в гистограммы задержек своего потока.
+// Включается макросом BOOKDB_PROFILING для всей программы: все единицы трансляции должны видеть одно значение,
+// иначе инлайновые функции запросов будут определены по-разному. Без макроса QueryProbe - пустой класс
+// с пустыми инлайновыми методами, и замеры исчезают при компиляции.
+// Запросы ShardedBookDatabase не замеряются целиком: запрос каждого шарда записывается в профиль потока пула
+#ifdef BOOKDB_PROFILING
+constexpr bool kProfilingEnabled = true;
+#else
+constexpr bool kProfilingEnabled = false;
+#endif
+
+enum class QueryKind {
+    FilterBooks,
+    TopN,
+    GenreRatings,
+    AverageRating,
+    AuthorHistogram,
+    SampleBooks,
+    ExecuteQuery,
+    SearchBooks,
+    GroupBy,
+};
+
+constexpr size_t kQueryKindCount = static_cast<size_t>(QueryKind::GroupBy) + 1;
+
+constexpr std::string_view queryKindName(QueryKind kind) {
+    constexpr std::array<std::string_view, kQueryKindCount> kNames{
+        "filterBooks", "getTopNBy", "calculateGenreRatings", "calculateAverageRating", "buildAuthorHistogram",
+        "sampleRandomBooks", "executeQuery", "searchBooks", "groupBy"};
+    return kNames[static_cast<size_t>(kind)];
+}
+
+// Гистограмма задержек в наносекундах в стиле HdrHistogram: значения меньше 2^kSubBucketBits хранятся точно,
+// каждая следующая степень двойки делится на 2^(kSubBucketBits - 1) равных корзин. Квантиль - середина корзины,
+// относительная ошибка не больше 2^-kSubBucketBits (1.6%), память не зависит от числа замеров
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 6;
+    // Значения больше 2^kMaxBits - 1 нс (около 4.9 часа) попадают в последнюю корзину
+    static constexpr unsigned kMaxBits = 44;
+    static constexpr size_t kHalfBuckets = size_t{1} << (kSubBucketBits - 1);
+    static constexpr size_t kBucketCount = (kMaxBits - kSubBucketBits + 2) * kHalfBuckets;
+
+    static size_t BucketOf(uint64_t value) {
+        value = std::min(value, (uint64_t{1} << kMaxBits) - 1);
+        const unsigned shift = std::max<int>(std::bit_width(value) - static_cast<int>(kSubBucketBits), 0);
+        return shift * kHalfBuckets + static_cast<size_t>(value >> shift);
+    }
+
+    // Границы [low, high] значений корзины
+    static uint64_t BucketLow(size_t bucket) {
+        const size_t shift = bucket < 2 * kHalfBuckets ? 0 : bucket / kHalfBuckets - 1;
+        return static_cast<uint64_t>(bucket - shift * kHalfBuckets) << shift;
+    }
+
+    static uint64_t BucketHigh(size_t bucket) {
+        const size_t shift = bucket < 2 * kHalfBuckets ? 0 : bucket / kHalfBuckets - 1;
+        return BucketLow(bucket) + (uint64_t{1} << shift) - 1;
+    }
+
+    void Record(uint64_t value) { AddBucket(BucketOf(value), 1, value); }
+
+    // count значений корзины bucket, max_value - наибольшее из них
+    void AddBucket(size_t bucket, uint64_t count, uint64_t max_value) {
+        if (count == 0) {
+            return;
+        }
+        counts_[bucket] += count;
+        count_ += count;
+        max_ = std::max(max_, max_value);
+    }
+
+    void Merge(const LatencyHistogram &other) {
+        std::ranges::transform(counts_, other.counts_, counts_.begin(), std::plus{});
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void Clear() { *this = {}; }
+
+    uint64_t Count() const { return count_; }
+
+    uint64_t Max() const { return max_; }
+
+    // Значение квантиля q из [0, 1]; 0 для пустой гистограммы. Максимум хранится точно
+    uint64_t Quantile(double q) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        if (q >= 1.0) {
+            return max_;
+        }
+        const auto rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count_ - 1));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+            seen += counts_[bucket];
+            if (seen > rank) {
+                return std::min(BucketLow(bucket) + (BucketHigh(bucket) - BucketLow(bucket)) / 2, max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    std::array<uint64_t, kBucketCount> counts_{};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+// Один замер запроса
+struct QuerySample {
+    uint64_t rows_scanned = 0;
+    uint64_t rows_matched = 0;
+    uint64_t elapsed_ns = 0;
+    uint64_t threads = 1;
+};
+
+// Сводка по одному виду запросов
+struct QueryProfile {
+    QueryKind kind = QueryKind::FilterBooks;
+    uint64_t calls = 0;
+    uint64_t rows_scanned = 0;
+    uint64_t rows_matched = 0;
+    // Сумма потоков по вызовам: среднее - threads / calls
+    uint64_t threads = 0;
+    uint64_t total_ns = 0;
+    LatencyHistogram latency;
+
+    uint64_t P50() const { return latency.Quantile(0.5); }
+
+    uint64_t P99() const { return latency.Quantile(0.99); }
+
+    uint64_t Max() const { return latency.Max(); }
+};
+
+struct ProfileSnapshot {
+    std::array<QueryProfile, kQueryKindCount> queries;
+
+    const QueryProfile &operator[](QueryKind kind) const { return queries[static_cast<size_t>(kind)]; }
+};
+
+namespace detail {
+
+// Счётчики вида запросов в профиле потока. Пишет только поток-владелец, поэтому вместо атомарного
+// read-modify-write достаточно load + store: снимок из другого потока читает их без блокировок
+struct QueryCounters {
+    std::array<std::atomic<uint64_t>, LatencyHistogram::kBucketCount> latency{};
+    std::atomic<uint64_t> calls = 0;
+    std::atomic<uint64_t> rows_scanned = 0;
+    std::atomic<uint64_t> rows_matched = 0;
+    std::atomic<uint64_t> threads = 0;
+    std::atomic<uint64_t> total_ns = 0;
+    std::atomic<uint64_t> max_ns = 0;
+};
+
+inline void addOwned(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+class ThreadProfile {
+public:
+    void Record(QueryKind kind, const QuerySample &sample) {
+        auto &counters = kinds_[static_cast<size_t>(kind)];
+        addOwned(counters.latency[LatencyHistogram::BucketOf(sample.elapsed_ns)], 1);
+        addOwned(counters.calls, 1);
+        addOwned(counters.rows_scanned, sample.rows_scanned);
+        addOwned(counters.rows_matched, sample.rows_matched);
+        addOwned(counters.threads, sample.threads);
+        addOwned(counters.total_ns, sample.elapsed_ns);
+        if (sample.elapsed_ns > counters.max_ns.load(std::memory_order_relaxed)) {
+            counters.max_ns.store(sample.elapsed_ns, std::memory_order_relaxed);
+        }
+    }
+
+    void AddTo(ProfileSnapshot &snapshot) const {
+        for (size_t kind = 0; kind < kQueryKindCount; ++kind) {
+            const auto &counters = kinds_[kind];
+            auto &profile = snapshot.queries[kind];
+            profile.calls += counters.calls.load(std::memory_order_relaxed);
+            profile.rows_scanned += counters.rows_scanned.load(std::memory_order_relaxed);
+            profile.rows_matched += counters.rows_matched.load(std::memory_order_relaxed);
+            profile.threads += counters.threads.load(std::memory_order_relaxed);
+            profile.total_ns += counters.total_ns.load(std::memory_order_relaxed);
+            LatencyHistogram latency;
+            const uint64_t max_ns = counters.max_ns.load(std::memory_order_relaxed);
+            for (size_t bucket = 0; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+                const uint64_t count = counters.latency[bucket].load(std::memory_order_relaxed);
+                latency.AddBucket(bucket, count, std::min(LatencyHistogram::BucketHigh(bucket), max_ns));
+            }
+            profile.latency.Merge(latency);
+        }
+    }
+
+    // Добавляет замеры other. Профиль завершившихся потоков пишется только под мьютексом реестра
+    void Absorb(const ThreadProfile &other) {
+        for (size_t kind = 0; kind < kQueryKindCount; ++kind) {
+            auto &counters = kinds_[kind];
+            const auto &source = other.kinds_[kind];
+            for (size_t bucket = 0; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+                addOwned(counters.latency[bucket], source.latency[bucket].load(std::memory_order_relaxed));
+            }
+            addOwned(counters.calls, source.calls.load(std::memory_order_relaxed));
+            addOwned(counters.rows_scanned, source.rows_scanned.load(std::memory_order_relaxed));
+            addOwned(counters.rows_matched, source.rows_matched.load(std::memory_order_relaxed));
+            addOwned(counters.threads, source.threads.load(std::memory_order_relaxed));
+            addOwned(counters.total_ns, source.total_ns.load(std::memory_order_relaxed));
+            counters.max_ns.store(std::max(counters.max_ns.load(std::memory_order_relaxed),
+                                           source.max_ns.load(std::memory_order_relaxed)),
+                                  std::memory_order_relaxed);
+        }
+    }
+
+    void Reset() {
+        for (auto &counters : kinds_) {
+            std::ranges::for_each(counters.latency, [](auto &count) { count.store(0, std::memory_order_relaxed); });
+            for (auto *counter : {&counters.calls, &counters.rows_scanned, &counters.rows_matched, &counters.threads,
+                                  &counters.total_ns, &counters.max_ns}) {
+                counter->store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    std::array<QueryCounters, kQueryKindCount> kinds_;
+};
+
+}  // namespace detail
+
+// Реестр профилей потоков. Поток получает профиль под мьютексом один раз, при первом замере,
+// дальше пишет в него без синхронизации. При завершении потока его замеры переносятся в общий профиль
+// завершившихся потоков, а обнулённый профиль возвращается в реестр и достаётся следующему новому потоку:
+// память реестра ограничена числом одновременно работающих потоков, а не числом созданных за всё время
+class QueryProfiler {
+public:
+    static void Record(QueryKind kind, const QuerySample &sample) { Local().Record(kind, sample); }
+
+    // Сумма профилей всех потоков. Замеры, записываемые во время снятия, могут попасть в снимок частично
+    static ProfileSnapshot Snapshot() {
+        ProfileSnapshot snapshot;
+        for (size_t kind = 0; kind < kQueryKindCount; ++kind) {
+            snapshot.queries[kind].kind = static_cast<QueryKind>(kind);
+        }
+        auto &registry = GetRegistry();
+        std::lock_guard lock{registry.mutex};
+        std::ranges::for_each(registry.profiles, [&](const auto &profile) { profile->AddTo(snapshot); });
+        registry.retired.AddTo(snapshot);
+        return snapshot;
+    }
+
+    // Обнуляет профили; запросы, идущие во время сброса, могут сохранить часть своих замеров
+    static void Reset() {
+        auto &registry = GetRegistry();
+        std::lock_guard lock{registry.mutex};
+        std::ranges::for_each(registry.profiles, [](const auto &profile) { profile->Reset(); });
+        registry.retired.Reset();
+    }
+
+    // Число профилей в реестре: работающие потоки, делавшие замеры, и свободные профили завершившихся
+    static size_t ProfileCount() {
+        auto &registry = GetRegistry();
+        std::lock_guard lock{registry.mutex};
+        return registry.profiles.size();
+    }
+
+private:
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<detail::ThreadProfile>> profiles;
+        std::vector<detail::ThreadProfile *> free;
+        detail::ThreadProfile retired;
+    };
+
+    // Профиль потока: берётся из реестра при первом замере и возвращается в него при завершении потока.
+    // Реестр создаётся раньше профиля и поэтому переживает его, в том числе для главного потока
+    class LocalProfile {
+    public:
+        LocalProfile() {
+            auto &registry = GetRegistry();
+            std::lock_guard lock{registry.mutex};
+            if (registry.free.empty()) {
+                profile_ = registry.profiles.emplace_back(std::make_unique<detail::ThreadProfile>()).get();
+            } else {
+                profile_ = registry.free.back();
+                registry.free.pop_back();
+            }
+        }
+
+        LocalProfile(const LocalProfile &) = delete;
+        LocalProfile &operator=(const LocalProfile &) = delete;
+
+        ~LocalProfile() {
+            auto &registry = GetRegistry();
+            std::lock_guard lock{registry.mutex};
+            registry.retired.Absorb(*profile_);
+            profile_->Reset();
+            registry.free.push_back(profile_);
+        }
+
+        detail::ThreadProfile &Get() { return *profile_; }
+
+    private:
+        detail::ThreadProfile *profile_;
+    };
+
+    static Registry &GetRegistry() {
+        static Registry registry;
+        return registry;
+    }
+
+    static detail::ThreadProfile &Local() {
+        thread_local LocalProfile profile;
+        return profile.Get();
+    }
+};
+
+#ifdef BOOKDB_PROFILING
+
+// Замер одного запроса от создания до разрушения. Вложенные замеры (calculateGenreRatings(db) вызывает
+// версию с итераторами) добавляют свои строки к внешнему, в профиль записывается только внешний
+class QueryProbe {
+public:
+    explicit QueryProbe(QueryKind kind, size_t threads = 1)
+        : kind_(kind), parent_(Active()), start_(std::chrono::steady_clock::now()) {
+        sample_.threads = threads;
+        if (parent_ == nullptr) {
+            Active() = this;
+        }
+    }
+
+    QueryProbe(const QueryProbe &) = delete;
+    QueryProbe &operator=(const QueryProbe &) = delete;
+
+    ~QueryProbe() {
+        if (parent_ != nullptr) {
+            parent_->sample_.rows_scanned += sample_.rows_scanned;
+            parent_->sample_.rows_matched += sample_.rows_matched;
+            parent_->sample_.threads = std::max(parent_->sample_.threads, sample_.threads);
+            return;
+        }
+        Active() = nullptr;
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        sample_.elapsed_ns =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        QueryProfiler::Record(kind_, sample_);
+    }
+
+    void Scanned(size_t rows) { sample_.rows_scanned += rows; }
+
+    void Matched(size_t rows) { sample_.rows_matched += rows; }
+
+private:
+    static QueryProbe *&Active() {
+        thread_local QueryProbe *active = nullptr;
+        return active;
+    }
+
+    QueryKind kind_;
+    QueryProbe *parent_;
+    std::chrono::steady_clock::time_point start_;
+    QuerySample sample_;
+};
+
+#else
+
+class QueryProbe {
+public:
+    explicit QueryProbe(QueryKind, size_t = 1) {}
+
+    void Scanned(size_t) {}
+
+    void Matched(size_t) {}
+};
+
+static_assert(std::is_empty_v<QueryProbe>);
+
+#endif
+
+}  // namespace bookdb
+
+namespace std {
+template <>
+struct formatter<bookdb::ProfileSnapshot> {
+    template <typename FormatContext>
+    auto format(const bookdb::ProfileSnapshot &snapshot, FormatContext &fc) const {
+        format_to(fc.out(), "\033[4m|{:^24}|{:^10}|{:^12}|{:^12}|{:^12}|{:^14}|{:^14}|{:^8}|\033[0m\n", "QUERY",
+                  "CALLS", "P50 US", "P99 US", "MAX US", "SCANNED", "MATCHED", "THREADS");
+        for (const auto &query : snapshot.queries) {
+            if (query.calls == 0) {
+                continue;
+            }
+            format_to(fc.out(), "|{:^24}|{:^10}|{:^12.1f}|{:^12.1f}|{:^12.1f}|{:^14}|{:^14}|{:^8.1f}|\n",
+                      bookdb::queryKindName(query.kind), query.calls, static_cast<double>(query.P50()) / 1e3,
+                      static_cast<double>(query.P99()) / 1e3, static_cast<double>(query.Max()) / 1e3,
+                      query.rows_scanned, query.rows_matched,
+                      static_cast<double>(query.threads) / static_cast<double>(query.calls));
+        }
+        return fc.out();
+    }
+
+    constexpr auto parse(format_parse_context &ctx) {
+        return ctx.begin();  // Просто игнорируем пользовательский формат
+    }
+};
+}  // namespace std
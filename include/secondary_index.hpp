@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "memory_stats.hpp"
+
+namespace bookdb {
+
+// Поля книги, по которым BookDatabase может поддерживать вторичные индексы
+enum class IndexedField { Year, Rating, ReadCount };
+
+// Упорядоченный индекс "значение поля -> номер строки в базе".
+// Записи упорядочены по паре (ключ, строка): вставка и удаление за O(log n) даже при многих равных ключах,
+// запросы по диапазону за O(log n + k). Строки возвращаются в порядке возрастания ключа,
+// строки с равным ключом - по возрастанию номера
+template <typename Key>
+class SecondaryIndex {
+public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    void Insert(Key key, size_type row) { entries_.emplace_hint(entries_.end(), key, row); }
+
+    // Удаляет запись строки row с ключом key
+    void Erase(Key key, size_type row) { entries_.erase({key, row}); }
+
+    void Clear() { entries_.clear(); }
+
+    size_type size() const { return entries_.size(); }
+
+    bool empty() const { return entries_.empty(); }
+
+    // Оценка памяти узлов дерева
+    size_t MemoryBytes() const { return entries_.size() * detail::treeNodeBytes<typename Container::value_type>(); }
+
+    // Строки с ключом из [from, to)
+    std::vector<size_type> Between(Key from, Key to) const {
+        if (!(from < to)) {
+            return {};
+        }
+        return Collect(entries_.lower_bound({from, 0}), entries_.lower_bound({to, 0}));
+    }
+
+    // Строки с ключом больше key
+    std::vector<size_type> Above(Key key) const {
+        return Collect(entries_.upper_bound({key, std::numeric_limits<size_type>::max()}), entries_.end());
+    }
+
+private:
+    using Container = std::set<std::pair<Key, size_type>>;
+
+    static std::vector<size_type> Collect(typename Container::const_iterator first,
+                                          typename Container::const_iterator last) {
+        std::vector<size_type> rows;
+        for (; first != last; ++first) {
+            rows.push_back(first->second);
+        }
+        return rows;
+    }
+
+    Container entries_;
+};
+
+}  // namespace bookdb
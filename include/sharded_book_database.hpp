@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "book_aggregates.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "filters.hpp"
+#include "memory_policy.hpp"
+#include "sketches.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+
+namespace bookdb {
+
+// Книги, распределённые по N независимым BookDatabase (шардам) по хешу имени автора.
+// Запросы выполняются scatter-gather: каждый шард считает частичный результат в своей задаче пула
+// (по потоку на шард), затем результаты объединяются. Все книги автора лежат в одном шарде,
+// поэтому гистограммы авторов шардов не пересекаются. Книги без общего порядка: результаты
+// filterBooks идут по шардам, внутри шарда - в порядке добавления
+template <BookContainerLike T = std::vector<Book>, MemoryPolicyLike P = HeapMemoryPolicy>
+class ShardedBookDatabase {
+public:
+    using Shard = BookDatabase<T, P>;
+    using size_type = size_t;
+
+    explicit ShardedBookDatabase(size_t shards = std::max(1u, std::thread::hardware_concurrency()))
+        : shards_(CheckShardCount(shards)), pool_(shards) {}
+
+    ShardedBookDatabase(const ShardedBookDatabase &) = delete;
+    ShardedBookDatabase &operator=(const ShardedBookDatabase &) = delete;
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...args) {
+        PushBack(Book{std::forward<Args>(args)...});
+    }
+
+    template <BookRef BookRef>
+    void PushBack(BookRef &&book) {
+        const Book &ref = book;
+        shards_[ShardOf(ref.author)].PushBack(std::forward<BookRef>(book));
+    }
+
+    // Пакетное добавление: книги раскладываются по шардам, шарды пополняются параллельно
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>, const Book &>
+    void Append(R &&books) {
+        if constexpr (!std::is_lvalue_reference_v<std::ranges::range_reference_t<R>>) {
+            // Диапазон выдаёт временные книги, указатели на них не переживут итерацию: сначала собираем их
+            std::vector<Book> materialized;
+            for (auto &&book : books) {
+                materialized.push_back(std::forward<decltype(book)>(book));
+            }
+            Append(materialized);
+        } else {
+            std::vector<std::vector<const Book *>> parts(shards_.size());
+            for (const Book &book : books) {
+                parts[ShardOf(book.author)].push_back(&book);
+            }
+            Scatter([&](size_t shard, Shard &db) {
+                db.Reserve(db.size() + parts[shard].size());
+                std::ranges::for_each(parts[shard], [&](const Book *book) { db.PushBack(*book); });
+                return 0;
+            });
+        }
+    }
+
+    size_t ShardOf(std::string_view author) const { return std::hash<std::string_view>{}(author) % shards_.size(); }
+
+    size_t ShardCount() const { return shards_.size(); }
+
+    const Shard &GetShard(size_t shard) const { return shards_[shard]; }
+
+    // Настройка шарда (индексы, агрегаты); книги должны попадать в шард только через ShardedBookDatabase
+    Shard &GetShard(size_t shard) { return shards_[shard]; }
+
+    size_type size() const {
+        return std::transform_reduce(shards_.begin(), shards_.end(), size_t{0}, std::plus<>{},
+                                     [](const Shard &db) { return db.size(); });
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Сумма разбивок памяти шардов
+    bookdb::MemoryStats MemoryStats() const {
+        bookdb::MemoryStats stats;
+        std::ranges::for_each(shards_, [&](const Shard &db) { stats += db.MemoryStats(); });
+        return stats;
+    }
+
+    void Clear() {
+        std::ranges::for_each(shards_, &Shard::Clear);
+    }
+
+    // fn(shard, db) для каждого шарда в своей задаче пула, результаты - в порядке шардов
+    template <typename Fn>
+    auto Scatter(Fn &&fn) const {
+        using Result = std::invoke_result_t<Fn &, size_t, const Shard &>;
+        std::vector<Result> results(shards_.size());
+        pool_.ParallelFor(shards_.size(), shards_.size(),
+                          [&](size_t shard, size_t, size_t) { results[shard] = fn(shard, shards_[shard]); });
+        return results;
+    }
+
+    template <typename Fn>
+    auto Scatter(Fn &&fn) {
+        using Result = std::invoke_result_t<Fn &, size_t, Shard &>;
+        std::vector<Result> results(shards_.size());
+        pool_.ParallelFor(shards_.size(), shards_.size(),
+                          [&](size_t shard, size_t, size_t) { results[shard] = fn(shard, shards_[shard]); });
+        return results;
+    }
+
+private:
+    // Без шардов ShardOf делил бы на ноль, а Scatter писал бы в пустой вектор результатов
+    static size_t CheckShardCount(size_t shards) {
+        if (shards == 0) {
+            throw std::invalid_argument{"ShardedBookDatabase needs at least one shard"};
+        }
+        return shards;
+    }
+
+    std::vector<Shard> shards_;
+    mutable ThreadPool pool_;
+};
+
+namespace detail {
+
+// Суммы рейтингов по жанрам каждого шарда: из агрегатов шарда, если они включены, иначе по карте зон
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+std::array<RatingSum, kGenreCount> shardedRatingSums(const ShardedBookDatabase<T, P> &db, const Pred &pred) {
+    auto partials = db.Scatter([&](size_t, const BookDatabase<T, P> &shard) {
+        const auto *aggregates = shard.GetAggregates();
+        if (aggregates == nullptr || !std::is_same_v<Pred, AllOf<>>) {
+            return genreRatingSums(shard, pred);
+        }
+        std::array<RatingSum, kGenreCount> sums{};
+        for (size_t genre = 0; genre < kGenreCount; ++genre) {
+            sums[genre] = aggregates->ByGenre(static_cast<Genre>(genre));
+        }
+        return sums;
+    });
+
+    // Средние объединяются взвешенно: складываются суммы и количества, а не средние шардов
+    std::array<RatingSum, kGenreCount> sums{};
+    for (const auto &partial : partials) {
+        for (size_t genre = 0; genre < kGenreCount; ++genre) {
+            sums[genre].sum += partial[genre].sum;
+            sums[genre].count += partial[genre].count;
+        }
+    }
+    return sums;
+}
+
+}  // namespace detail
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+std::vector<std::reference_wrapper<const Book>> filterBooks(const ShardedBookDatabase<T, P> &db, Pred pred) {
+    auto partials = db.Scatter([&](size_t, const BookDatabase<T, P> &shard) { return filterBooks(shard, pred); });
+
+    std::vector<std::reference_wrapper<const Book>> books;
+    books.reserve(std::transform_reduce(partials.begin(), partials.end(), size_t{0}, std::plus<>{},
+                                        [](const auto &partial) { return partial.size(); }));
+    for (const auto &partial : partials) {
+        books.insert(books.end(), partial.begin(), partial.end());
+    }
+    return books;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+GenreStatsContainer calculateGenreRatings(const ShardedBookDatabase<T, P> &db, Pred pred) {
+    const auto sums = detail::shardedRatingSums(db, pred);
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sums[genre].count != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sums[genre].Avg());
+        }
+    }
+    return ratings_avg;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+GenreStatsContainer calculateGenreRatings(const ShardedBookDatabase<T, P> &db) {
+    return calculateGenreRatings(db, all_of());
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+double calculateAverageRating(const ShardedBookDatabase<T, P> &db, Pred pred) {
+    RatingSum total;
+    for (const auto &sum : detail::shardedRatingSums(db, pred)) {
+        total.sum += sum.sum;
+        total.count += sum.count;
+    }
+    return total.Avg();
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+double calculateAverageRating(const ShardedBookDatabase<T, P> &db) {
+    return calculateAverageRating(db, all_of());
+}
+
+// Авторы шардов не пересекаются, поэтому упорядоченные гистограммы шардов только сливаются
+template <BookContainerLike T, MemoryPolicyLike P>
+HistogramContainer buildAuthorHistogramFlat(const ShardedBookDatabase<T, P> &db) {
+    auto partials =
+        db.Scatter([](size_t, const BookDatabase<T, P> &shard) { return buildAuthorHistogramFlat(shard); });
+
+    HistogramContainer::sequence_type items;
+    for (auto &partial : partials) {
+        const auto middle = static_cast<std::ptrdiff_t>(items.size());
+        items.insert(items.end(), partial.begin(), partial.end());
+        std::inplace_merge(items.begin(), items.begin() + middle, items.end(),
+                           [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    }
+
+    HistogramContainer histogram;
+    histogram.adopt_sequence(boost::container::ordered_unique_range, std::move(items));
+    return histogram;
+}
+
+// Скетчи всей базы: шарды со включёнными скетчами отдают готовые, остальные строят их сканированием с options.
+// Скетчи шардов должны быть построены с теми же параметрами, иначе Merge бросает std::invalid_argument
+template <BookContainerLike T, MemoryPolicyLike P>
+BookSketches mergeSketches(const ShardedBookDatabase<T, P> &db, const SketchOptions &options = {}) {
+    auto partials = db.Scatter([&](size_t, const BookDatabase<T, P> &shard) {
+        if (const auto *sketches = shard.GetSketches()) {
+            return *sketches;
+        }
+        BookSketches sketches{options};
+        std::ranges::for_each(shard.GetBooks(), [&](const Book &book) { sketches.Add(book); });
+        return sketches;
+    });
+
+    BookSketches merged{options};
+    std::ranges::for_each(partials, [&](const BookSketches &partial) { merged.Merge(partial); });
+    return merged;
+}
+
+// Каждый шард отбирает свои count лучших книг, списки объединяются кучей по их текущим головам.
+// При равных ключах раньше идёт книга шарда с меньшим номером
+template <BookContainerLike T, MemoryPolicyLike P, BookComparator Comp>
+std::vector<std::reference_wrapper<const Book>> getTopNBy(const ShardedBookDatabase<T, P> &db, size_t count,
+                                                          const Comp comp) {
+    auto partials = db.Scatter([&](size_t, const BookDatabase<T, P> &shard) {
+        return getTopNBy(shard.cbegin(), shard.cend(), count, comp);
+    });
+
+    // Голова списка шарда: (шард, позиция в списке); в вершине кучи - лучшая книга
+    using Head = std::pair<size_t, size_t>;
+    auto worse = [&](const Head &lhs, const Head &rhs) {
+        const Book &l = partials[lhs.first][lhs.second];
+        const Book &r = partials[rhs.first][rhs.second];
+        return comp(r, l) || (!comp(l, r) && lhs.first > rhs.first);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(worse)> heads{worse};
+    for (size_t shard = 0; shard < partials.size(); ++shard) {
+        if (!partials[shard].empty()) {
+            heads.emplace(shard, 0);
+        }
+    }
+
+    std::vector<std::reference_wrapper<const Book>> result;
+    result.reserve(count);
+    while (result.size() < count && !heads.empty()) {
+        auto [shard, pos] = heads.top();
+        heads.pop();
+        result.push_back(partials[shard][pos]);
+        if (pos + 1 < partials[shard].size()) {
+            heads.emplace(shard, pos + 1);
+        }
+    }
+    return result;
+}
+
+// Равномерная выборка без повторов по всей базе: номера книг выбираются алгоритмом Флойда
+// среди всех книг, поэтому каждый шард получает долю выборки пропорционально своему размеру
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<std::reference_wrapper<const Book>> sampleRandomBooks(const ShardedBookDatabase<T, P> &db, size_t count) {
+    std::vector<size_t> offsets{0};
+    for (size_t shard = 0; shard < db.ShardCount(); ++shard) {
+        offsets.push_back(offsets.back() + db.GetShard(shard).size());
+    }
+    const size_t total = offsets.back();
+    count = std::min(count, total);
+
+    std::mt19937 gen{std::random_device{}()};
+    std::unordered_set<size_t> picked;
+    picked.reserve(count);
+    for (size_t j = total - count; j < total; ++j) {
+        const size_t pos = std::uniform_int_distribution<size_t>{0, j}(gen);
+        picked.insert(picked.contains(pos) ? j : pos);
+    }
+
+    std::vector<size_t> positions(picked.begin(), picked.end());
+    std::ranges::sort(positions);
+    std::vector<std::reference_wrapper<const Book>> books;
+    books.reserve(positions.size());
+    size_t shard = 0;
+    for (size_t pos : positions) {
+        while (pos >= offsets[shard + 1]) {
+            ++shard;
+        }
+        books.emplace_back(db.GetShard(shard).GetBooks()[pos - offsets[shard]]);
+    }
+    return books;
+}
+
+}  // namespace bookdb
@@ -1,14 +1,25 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <functional>
 #include <iterator>
+#include <numeric>
+#include <optional>
 #include <random>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "author_dictionary.hpp"
 #include "book.hpp"
 #include "book_database.hpp"
 #include "concepts.hpp"
+#include "filters.hpp"
 #include "heterogeneous_lookup.hpp"
+#include "query_profiler.hpp"
+#include "thread_pool.hpp"
+#include "top_n.hpp"
 
 #include <print>
 
@@ -17,17 +28,60 @@ namespace bookdb {
 using HistogramContainer = boost::container::flat_map<std::string_view, size_t>;
 using GenreStatsContainer = boost::container::flat_map<Genre, double>;
 
-template <BookContainerLike T>
-HistogramContainer buildAuthorHistogramFlat(const BookDatabase<T> &cont) {
+// Количество книг каждого автора, индексированное плотным идентификатором автора.
+// Имена подставляются только при выводе или при переводе в HistogramContainer
+struct AuthorHistogram {
+    const AuthorDictionary *authors = nullptr;
+    std::vector<size_t> counts;
+};
+
+namespace detail {
+
+// Переводит плотную гистограмму в упорядоченную по имени автора, name_of(id) возвращает имя
+template <typename NameOf>
+HistogramContainer resolveAuthorHistogram(const std::vector<size_t> &counts, NameOf name_of) {
+
+    HistogramContainer::sequence_type items;
+    items.reserve(counts.size());
+    for (AuthorId id = 0; id < counts.size(); ++id) {
+        if (counts[id] != 0) {
+            items.emplace_back(name_of(id), counts[id]);
+        }
+    }
+    std::ranges::sort(items, {}, &HistogramContainer::value_type::first);
 
     HistogramContainer histogram;
-    histogram.reserve(cont.GetAuthors().size());
+    histogram.adopt_sequence(boost::container::ordered_unique_range, std::move(items));
+    return histogram;
+}
+
+}  // namespace detail
 
-    std::ranges::for_each(cont.cbegin(), cont.cend(), [&](const Book &book) { histogram[book.author]++; });
+// Если в базе включены агрегаты, количество книг авторов берётся из них без сканирования книг
+template <BookContainerLike T, MemoryPolicyLike P>
+AuthorHistogram buildAuthorHistogram(const BookDatabase<T, P> &cont) {
+    QueryProbe probe{QueryKind::AuthorHistogram};
+
+    AuthorHistogram histogram{&cont.GetAuthors(), std::vector<size_t>(cont.GetAuthors().size())};
+    probe.Matched(cont.size());
+    if (const auto *aggregates = cont.GetAggregates()) {
+        std::ranges::copy(aggregates->AuthorCounts(), histogram.counts.begin());
+        return histogram;
+    }
+    std::ranges::for_each(cont.cbegin(), cont.cend(), [&](const Book &book) { histogram.counts[book.author_id]++; });
+    probe.Scanned(cont.size());
 
     return histogram;
 }
 
+template <BookContainerLike T, MemoryPolicyLike P>
+HistogramContainer buildAuthorHistogramFlat(const BookDatabase<T, P> &cont) {
+    QueryProbe probe{QueryKind::AuthorHistogram};
+    const auto &authors = cont.GetAuthors();
+    return detail::resolveAuthorHistogram(buildAuthorHistogram(cont).counts,
+                                          [&](AuthorId id) { return authors.Name(id); });
+}
+
 struct rating_sum_item {
     double sum_ratings = 0.0;
     size_t count_book = 0;
@@ -36,6 +90,7 @@ struct rating_sum_item {
 
 template <BookIterator It, BookSentinel<It> S>
 GenreStatsContainer calculateGenreRatings(It begin, S end) {
+    QueryProbe probe{QueryKind::GenreRatings};
 
     boost::container::flat_map<Genre, rating_sum_item> sum_ratings;
 
@@ -52,6 +107,8 @@ GenreStatsContainer calculateGenreRatings(It begin, S end) {
     std::ranges::for_each(sum_ratings, [&](auto &item) {
         auto [genre, stat] = item;
         ratings_avg[genre] = stat.Avg();
+        probe.Scanned(stat.count_book);
+        probe.Matched(stat.count_book);
     });
 
     return ratings_avg;
@@ -59,32 +116,465 @@ GenreStatsContainer calculateGenreRatings(It begin, S end) {
 
 template <BookIterator It>
 double calculateAverageRating(It begin, It end) {
+    QueryProbe probe{QueryKind::AverageRating};
     size_t size = std::distance(begin, end);
+    probe.Scanned(size);
+    probe.Matched(size);
     if (size == 0) {
         return 0.0;
     }
     return std::reduce(begin, end, 0.0, TransparentRatingSum{}) / size;
 }
 
+// ################### Запросы по базе ###################
+//
+// Если в базе включены агрегаты, ответ строится из них за O(число жанров) или O(1), иначе база сканируется
+
+template <BookContainerLike T, MemoryPolicyLike P>
+GenreStatsContainer calculateGenreRatings(const BookDatabase<T, P> &cont) {
+    QueryProbe probe{QueryKind::GenreRatings};
+    const auto *aggregates = cont.GetAggregates();
+    if (aggregates == nullptr) {
+        return calculateGenreRatings(cont.cbegin(), cont.cend());
+    }
+    probe.Matched(aggregates->Total().count);
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        const auto item = aggregates->ByGenre(static_cast<Genre>(genre));
+        if (item.count != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), item.Avg());
+        }
+    }
+    return ratings_avg;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+double calculateAverageRating(const BookDatabase<T, P> &cont) {
+    QueryProbe probe{QueryKind::AverageRating};
+    if (const auto *aggregates = cont.GetAggregates()) {
+        probe.Matched(aggregates->Total().count);
+        return aggregates->Total().Avg();
+    }
+    return calculateAverageRating(cont.cbegin(), cont.cend());
+}
+
+// Статистика по книгам, удовлетворяющим pred. Зоны, в которых нет подходящих книг, пропускаются,
+// для зон, подходящих целиком, берутся суммы рейтингов из карты зон без сканирования книг
+
+namespace detail {
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+std::array<RatingSum, kGenreCount> genreRatingSums(const BookDatabase<T, P> &cont, const Pred &pred) {
+    // Вложенный замер: строки засчитываются вызывающему запросу
+    QueryProbe probe{QueryKind::GenreRatings};
+    std::array<RatingSum, kGenreCount> sums{};
+    const auto &books = cont.GetBooks();
+    scanZones(cont, pred, [&](ZoneMatch match, const ZoneStats &zone, size_t first, size_t last) {
+        if (match == ZoneMatch::All) {
+            for (size_t genre = 0; genre < kGenreCount; ++genre) {
+                const auto zone_sum = zone.ratings[genre].Value();
+                sums[genre].sum += zone_sum.sum;
+                sums[genre].count += zone_sum.count;
+            }
+            return;
+        }
+        std::for_each(books.cbegin() + first, books.cbegin() + last, [&](const Book &book) {
+            if (pred(book)) {
+                sums[static_cast<size_t>(book.genre)].Add(book.rating);
+            }
+        });
+        probe.Scanned(last - first);
+    });
+    probe.Matched(std::transform_reduce(sums.begin(), sums.end(), size_t{0}, std::plus{},
+                                        [](const RatingSum &sum) { return sum.count; }));
+    return sums;
+}
+
+}  // namespace detail
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+GenreStatsContainer calculateGenreRatings(const BookDatabase<T, P> &cont, Pred pred) {
+    QueryProbe probe{QueryKind::GenreRatings};
+    const auto sums = detail::genreRatingSums(cont, pred);
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sums[genre].count != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sums[genre].Avg());
+        }
+    }
+    return ratings_avg;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P, BookPredicate Pred>
+double calculateAverageRating(const BookDatabase<T, P> &cont, Pred pred) {
+    QueryProbe probe{QueryKind::AverageRating};
+    RatingSum total;
+    for (const auto &sum : detail::genreRatingSums(cont, pred)) {
+        total.sum += sum.sum;
+        total.count += sum.count;
+    }
+    return total.Avg();
+}
+
+namespace detail {
+
+// better(lhs, rhs) для позиций диапазона: при равных ключах раньше стоит меньшая позиция,
+// поэтому результат не зависит от способа обхода и совпадает у последовательной и параллельной версий
+template <typename Less>
+auto positionTieBreak(Less less) {
+    return [less](size_t lhs, size_t rhs) { return less(lhs, rhs) || (!less(rhs, lhs) && lhs < rhs); };
+}
+
+template <BookIterator It, BookComparator Comp>
+auto topNPositions(It begin, size_t first, size_t last, size_t count, const Comp &comp) {
+    auto better = positionTieBreak([&comp, begin](size_t lhs, size_t rhs) { return comp(begin[lhs], begin[rhs]); });
+    BoundedTopN<size_t, decltype(better)> top{count, better};
+
+    // Позиции идут по возрастанию, поэтому книга с равным худшей отобранной ключом не проходит:
+    // для отказа достаточно одного сравнения с закешированной худшей книгой
+    size_t pos = first;
+    for (; pos < last && top.size() < count; ++pos) {
+        top.Offer(pos);
+    }
+    if (pos == last || top.empty()) {
+        return top;
+    }
+    // Итератор может возвращать не Book, а, например, reference_wrapper из результата filterBooks
+    auto book_at = [begin](size_t pos) -> const Book * { return &static_cast<const Book &>(begin[pos]); };
+    const Book *worst = book_at(*top.Worst());
+    for (; pos < last; ++pos) {
+        if (comp(begin[pos], *worst)) {
+            top.Offer(pos);
+            worst = book_at(*top.Worst());
+        }
+    }
+    return top;
+}
+
+template <BookIterator It>
+std::vector<std::reference_wrapper<const Book>> booksAt(It begin, const std::vector<size_t> &positions) {
+    std::vector<std::reference_wrapper<const Book>> books;
+    books.reserve(positions.size());
+    std::ranges::for_each(positions, [&](size_t pos) { books.emplace_back(begin[pos]); });
+    return books;
+}
+
+}  // namespace detail
+
+// count лучших книг по comp, от лучшей к худшей. Диапазон не изменяется: отбор идёт ограниченной кучей
+// позиций за O(n log count), поэтому функция работает и на константной базе
 template <BookIterator It, BookComparator Comp>
 auto getTopNBy(It begin, It end, size_t count, const Comp comp) {
+    QueryProbe probe{QueryKind::TopN};
+    const auto size = static_cast<size_t>(std::distance(begin, end));
+    auto result = detail::booksAt(begin, detail::topNPositions(begin, 0, size, count, comp).TakeSorted());
+    probe.Scanned(size);
+    probe.Matched(result.size());
+    return result;
+}
 
-    count = std::min(count, static_cast<size_t>(std::distance(begin, end)));
+// ################### Ленивые диапазоны ###################
+//
+// Книги перебираются один раз по мере обхода, без промежуточного вектора (см. book_view.hpp).
+// Профилировщик считает просмотренными книги, которые выдал диапазон, а не строки базы под ним
+
+template <BookRange R>
+GenreStatsContainer calculateGenreRatings(R &&books) {
+    QueryProbe probe{QueryKind::GenreRatings};
+    std::array<RatingSum, kGenreCount> sums{};
+    for (const Book &book : books) {
+        sums[static_cast<size_t>(book.genre)].Add(book.rating);
+    }
 
-    auto middle = std::next(begin, count);
-    std::partial_sort(begin, middle, end, comp);
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sums[genre].count != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sums[genre].Avg());
+        }
+        probe.Scanned(sums[genre].count);
+        probe.Matched(sums[genre].count);
+    }
+    return ratings_avg;
+}
 
-    return std::vector<std::reference_wrapper<const Book>>(begin, middle);
+template <BookRange R>
+double calculateAverageRating(R &&books) {
+    QueryProbe probe{QueryKind::AverageRating};
+    RatingSum total;
+    for (const Book &book : books) {
+        total.Add(book.rating);
+    }
+    probe.Scanned(total.count);
+    probe.Matched(total.count);
+    return total.Avg();
+}
+
+// Книги с равным ключом упорядочены по порядку обхода. Диапазон должен возвращать ссылки на книги,
+// которые живут дольше результата (например, книги базы)
+template <BookRange R, BookComparator Comp>
+    requires std::is_lvalue_reference_v<std::ranges::range_reference_t<R>>
+std::vector<std::reference_wrapper<const Book>> getTopNBy(R &&books, size_t count, const Comp comp) {
+    struct Entry {
+        const Book *book;
+        size_t sequence;
+    };
+    auto better = [&comp](const Entry &lhs, const Entry &rhs) {
+        return comp(*lhs.book, *rhs.book) || (!comp(*rhs.book, *lhs.book) && lhs.sequence < rhs.sequence);
+    };
+    BoundedTopN<Entry, decltype(better)> top{count, better};
+    QueryProbe probe{QueryKind::TopN};
+
+    // Пришедшая позже книга с ключом, равным худшей отобранной, не проходит
+    size_t sequence = 0;
+    for (const Book &book : books) {
+        if (top.size() < count || (count != 0 && comp(book, *top.Worst()->book))) {
+            top.Offer(Entry{&book, sequence});
+        }
+        ++sequence;
+    }
+
+    std::vector<std::reference_wrapper<const Book>> result;
+    result.reserve(top.size());
+    std::ranges::for_each(std::move(top).TakeSorted(), [&](const Entry &entry) { result.emplace_back(*entry.book); });
+    probe.Scanned(sequence);
+    probe.Matched(result.size());
+    return result;
 }
 
 template <BookIterator It>
 auto sampleRandomBooks(It begin, It end, size_t count) {
+    QueryProbe probe{QueryKind::SampleBooks};
 
     count = std::min(count, static_cast<size_t>(std::distance(begin, end)));
     std::vector<std::reference_wrapper<const Book>> dest;
 
     std::ranges::sample(begin, end, std::back_inserter(dest), count, std::mt19937{std::random_device{}()});
+    probe.Scanned(static_cast<size_t>(std::distance(begin, end)));
+    probe.Matched(dest.size());
+
+    return dest;
+}
+
+// ################### Параллельные версии ###################
+//
+// Диапазон делится на части по числу потоков пула, каждая часть считает свой частичный агрегат,
+// затем частичные агрегаты объединяются. Гистограмма совпадает с последовательной точно.
+// Суммы рейтингов складываются в другом порядке, поэтому могут отличаться от последовательных на ошибку
+// округления: сумма - не больше 2 * n * eps * max|rating| для n книг (eps = 2^-52), т.е. ~2e-8 для 10M книг
+// с рейтингом до 5; среднее (сумма / n) - не больше 2 * eps * max|rating|, ~2e-15 при любом n.
+
+// Меньше этого числа книг на поток распараллеливание не окупается
+constexpr size_t kParallelMinBooksPerTask = 16384;
+
+inline size_t parallelParts(size_t count, const ThreadPool &pool) {
+    return std::clamp<size_t>(count / kParallelMinBooksPerTask, 1, pool.size());
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+AuthorHistogram buildAuthorHistogram(const BookDatabase<T, P> &cont, ThreadPool &pool) {
+
+    const auto &books = cont.GetBooks();
+    const size_t authors = cont.GetAuthors().size();
+    std::vector<std::vector<size_t>> partials(parallelParts(books.size(), pool));
+    QueryProbe probe{QueryKind::AuthorHistogram, partials.size()};
+    probe.Scanned(books.size());
+    probe.Matched(books.size());
+
+    pool.ParallelFor(books.size(), partials.size(), [&](size_t part, size_t first, size_t last) {
+        std::vector<size_t> counts(authors);
+        std::for_each(books.begin() + first, books.begin() + last, [&](const Book &book) { counts[book.author_id]++; });
+        partials[part] = std::move(counts);
+    });
+
+    AuthorHistogram histogram{&cont.GetAuthors(), std::vector<size_t>(authors)};
+    for (const auto &partial : partials) {
+        std::ranges::transform(histogram.counts, partial, histogram.counts.begin(), std::plus{});
+    }
 
+    return histogram;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+HistogramContainer buildAuthorHistogramFlat(const BookDatabase<T, P> &cont, ThreadPool &pool) {
+    QueryProbe probe{QueryKind::AuthorHistogram};
+    const auto &authors = cont.GetAuthors();
+    return detail::resolveAuthorHistogram(buildAuthorHistogram(cont, pool).counts,
+                                          [&](AuthorId id) { return authors.Name(id); });
+}
+
+template <BookIterator It>
+GenreStatsContainer calculateGenreRatings(It begin, It end, ThreadPool &pool) {
+
+    const size_t size = std::distance(begin, end);
+    std::vector<std::array<rating_sum_item, kGenreCount>> partials(parallelParts(size, pool));
+    QueryProbe probe{QueryKind::GenreRatings, partials.size()};
+    probe.Scanned(size);
+    probe.Matched(size);
+
+    pool.ParallelFor(size, partials.size(), [&](size_t part, size_t first, size_t last) {
+        // Считаем в локальном массиве, чтобы соседние части не делили строки кэша
+        std::array<rating_sum_item, kGenreCount> sum_ratings{};
+        std::for_each(begin + first, begin + last, [&](const Book &book) {
+            auto &item = sum_ratings[static_cast<size_t>(book.genre)];
+            item.sum_ratings += book.rating;
+            item.count_book++;
+        });
+        partials[part] = sum_ratings;
+    });
+
+    std::array<rating_sum_item, kGenreCount> sum_ratings{};
+    for (const auto &partial : partials) {
+        for (size_t genre = 0; genre < kGenreCount; ++genre) {
+            sum_ratings[genre].sum_ratings += partial[genre].sum_ratings;
+            sum_ratings[genre].count_book += partial[genre].count_book;
+        }
+    }
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sum_ratings[genre].count_book != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sum_ratings[genre].Avg());
+        }
+    }
+
+    return ratings_avg;
+}
+
+template <BookIterator It>
+double calculateAverageRating(It begin, It end, ThreadPool &pool) {
+    const size_t size = std::distance(begin, end);
+    if (size == 0) {
+        return 0.0;
+    }
+
+    std::vector<double> partials(parallelParts(size, pool));
+    QueryProbe probe{QueryKind::AverageRating, partials.size()};
+    probe.Scanned(size);
+    probe.Matched(size);
+    pool.ParallelFor(size, partials.size(), [&](size_t part, size_t first, size_t last) {
+        partials[part] = std::reduce(begin + first, begin + last, 0.0, TransparentRatingSum{});
+    });
+
+    return std::reduce(partials.begin(), partials.end(), 0.0) / size;
+}
+
+// Каждая часть диапазона отбирает свои count лучших позиций, затем кучи частей объединяются
+template <BookIterator It, BookComparator Comp>
+auto getTopNBy(It begin, It end, size_t count, const Comp comp, ThreadPool &pool) {
+    const auto size = static_cast<size_t>(std::distance(begin, end));
+    using Top = decltype(detail::topNPositions(begin, 0, 0, count, comp));
+
+    std::vector<std::optional<Top>> partials(parallelParts(size, pool));
+    QueryProbe probe{QueryKind::TopN, partials.size()};
+    probe.Scanned(size);
+    pool.ParallelFor(size, partials.size(), [&](size_t part, size_t first, size_t last) {
+        partials[part].emplace(detail::topNPositions(begin, first, last, count, comp));
+    });
+
+    auto top = detail::topNPositions(begin, 0, 0, count, comp);
+    std::ranges::for_each(partials, [&](auto &partial) { top.Merge(std::move(*partial)); });
+    auto result = detail::booksAt(begin, std::move(top).TakeSorted());
+    probe.Matched(result.size());
+    return result;
+}
+
+// ################### Сканирование колоночного хранилища ###################
+
+template <BookColumnsLike Columns>
+HistogramContainer buildAuthorHistogramFlat(const Columns &columns) {
+    QueryProbe probe{QueryKind::AuthorHistogram};
+
+    std::vector<size_t> counts(columns.AuthorCount());
+    std::ranges::for_each(columns.AuthorIds(), [&](AuthorId id) { counts[id]++; });
+    probe.Scanned(columns.size());
+    probe.Matched(columns.size());
+
+    return detail::resolveAuthorHistogram(counts, [&](AuthorId id) { return columns.AuthorName(id); });
+}
+
+template <BookColumnsLike Columns>
+GenreStatsContainer calculateGenreRatings(const Columns &columns) {
+    QueryProbe probe{QueryKind::GenreRatings};
+
+    std::array<rating_sum_item, kGenreCount> sum_ratings{};
+    const auto genres = columns.Genres();
+    const auto ratings = columns.Ratings();
+    probe.Scanned(genres.size());
+    probe.Matched(genres.size());
+
+    for (size_t row = 0; row < genres.size(); ++row) {
+        auto &item = sum_ratings[genreIndex(genres[row])];
+        item.sum_ratings += ratings[row];
+        item.count_book++;
+    }
+
+    GenreStatsContainer ratings_avg;
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        if (sum_ratings[genre].count_book != 0) {
+            ratings_avg.emplace_hint(ratings_avg.end(), static_cast<Genre>(genre), sum_ratings[genre].Avg());
+        }
+    }
+
+    return ratings_avg;
+}
+
+template <BookColumnsLike Columns>
+double calculateAverageRating(const Columns &columns) {
+    QueryProbe probe{QueryKind::AverageRating};
+    const auto ratings = columns.Ratings();
+    probe.Scanned(ratings.size());
+    probe.Matched(ratings.size());
+    if (ratings.empty()) {
+        return 0.0;
+    }
+    return std::reduce(ratings.begin(), ratings.end(), 0.0) / ratings.size();
+}
+
+// Номера count лучших строк по компаратору comp(columns, lhs_row, rhs_row), см. comparators.hpp
+template <BookColumnsLike Columns, BookColumnComparator<Columns> Comp>
+std::vector<size_t> getTopNBy(const Columns &columns, size_t count, const Comp comp) {
+    QueryProbe probe{QueryKind::TopN};
+    if (count == 0) {
+        return {};
+    }
+
+    auto better = detail::positionTieBreak([&](size_t lhs, size_t rhs) { return comp(columns, lhs, rhs); });
+    BoundedTopN<size_t, decltype(better)> top{count, better};
+    for (size_t row = 0; row < columns.size(); ++row) {
+        // Строки идут по возрастанию, строка с равным худшей отобранной ключом не проходит
+        if (top.size() < count || comp(columns, row, *top.Worst())) {
+            top.Offer(row);
+        }
+    }
+
+    probe.Scanned(columns.size());
+    probe.Matched(top.size());
+    return std::move(top).TakeSorted();
+}
+
+template <BookColumnsLike Columns>
+std::vector<size_t> sampleRandomBooks(const Columns &columns, size_t count) {
+    QueryProbe probe{QueryKind::SampleBooks};
+
+    const size_t size = columns.size();
+    size_t needed = std::min(count, size);
+
+    std::vector<size_t> dest;
+    dest.reserve(needed);
+
+    // Выборка без повторений за один проход (алгоритм S), порядок строк сохраняется
+    std::mt19937 gen{std::random_device{}()};
+    for (size_t row = 0; row < size && needed != 0; ++row) {
+        if (std::uniform_int_distribution<size_t>{0, size - row - 1}(gen) < needed) {
+            dest.push_back(row);
+            --needed;
+        }
+    }
+
+    probe.Scanned(size);
+    probe.Matched(dest.size());
     return dest;
 }
 
@@ -110,6 +600,28 @@ struct formatter<bookdb::HistogramContainer> {
     }
 };
 
+template <>
+struct formatter<bookdb::AuthorHistogram> {
+    template <typename FormatContext>
+    auto format(const bookdb::AuthorHistogram &histogram, FormatContext &fc) const {
+
+        format_to(fc.out(), "\033[4m|{:^20}|{:^20}|\033[0m\n", "AUTHOR", "BOOKS");
+
+        for (bookdb::AuthorId id = 0; id < histogram.counts.size(); ++id) {
+            if (histogram.counts[id] != 0) {
+                format_to(fc.out(), "\033[4m|{:^20}|{:^20}|\033[0m\n", histogram.authors->Name(id),
+                          histogram.counts[id]);
+            }
+        }
+
+        return fc.out();
+    }
+
+    constexpr auto parse(format_parse_context &ctx) {
+        return ctx.begin();  // Просто игнорируем пользовательский формат
+    }
+};
+
 template <>
 struct formatter<bookdb::GenreStatsContainer> {
     template <typename FormatContext>
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "memory_stats.hpp"
+
+namespace bookdb {
+
+// Текстовые поля книги, по которым строится полнотекстовый индекс
+enum class TextField { Title, Author, Any };
+
+struct TextIndexOptions {
+    // Индекс триграмм для поиска подстрок (TextQuery::Substring). Без него подстрока ищется сканированием
+    bool trigrams = false;
+};
+
+namespace detail {
+
+inline char asciiLower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+// Символ слова: латинская буква, цифра или байт UTF-8 (многобайтные символы не разбиваются)
+inline bool isTokenChar(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+inline std::string lowerText(std::string_view text) {
+    std::string lower(text);
+    std::ranges::transform(lower, lower.begin(), asciiLower);
+    return lower;
+}
+
+// Разбивает текст на слова в нижнем регистре (ASCII): fn(token, position), position - номер слова в тексте
+template <typename Fn>
+void forEachToken(std::string_view text, Fn fn) {
+    std::string token;
+    uint32_t position = 0;
+    for (size_t i = 0; i < text.size();) {
+        if (!isTokenChar(text[i])) {
+            ++i;
+            continue;
+        }
+        token.clear();
+        for (; i < text.size() && isTokenChar(text[i]); ++i) {
+            token.push_back(asciiLower(text[i]));
+        }
+        fn(std::string_view{token}, position++);
+    }
+}
+
+inline std::vector<std::string> tokenize(std::string_view text) {
+    std::vector<std::string> tokens;
+    forEachToken(text, [&](std::string_view token, uint32_t) { tokens.emplace_back(token); });
+    return tokens;
+}
+
+// Триграммы текста в нижнем регистре, упакованные в uint32_t, без повторов
+inline std::vector<uint32_t> trigrams(std::string_view lower) {
+    std::vector<uint32_t> grams;
+    for (size_t i = 0; i + 3 <= lower.size(); ++i) {
+        grams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(lower[i])) << 16 |
+                        static_cast<uint32_t>(static_cast<unsigned char>(lower[i + 1])) << 8 |
+                        static_cast<uint32_t>(static_cast<unsigned char>(lower[i + 2])));
+    }
+    std::ranges::sort(grams);
+    grams.erase(std::ranges::unique(grams).begin(), grams.end());
+    return grams;
+}
+
+inline void appendVarint(std::vector<uint8_t> &bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t readVarint(const uint8_t *&p) {
+    if (*p < 0x80) {
+        return *p++;
+    }
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+inline void skipVarint(const uint8_t *&p) {
+    while (*p++ >= 0x80) {
+    }
+}
+
+}  // namespace detail
+
+// Сжатый список вхождений термина: номера строк по возрастанию и позиции термина в поле строки.
+// Хранится последовательностью varint: разность номера строки с предыдущей, число позиций, разности позиций.
+// Каждая kSkipInterval-я запись попадает в таблицу пропусков, по которой курсор перескакивает к нужной строке.
+// Строки добавляются только в конец, поэтому список поддерживается при добавлении книг без перестроения
+class PostingList {
+public:
+    // Последовательный обход списка с декодированием
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList &list)
+            : list_(&list), p_(list.bytes_.data()), end_(list.bytes_.data() + list.bytes_.size()) {
+            Next();
+        }
+
+        bool Valid() const { return valid_; }
+
+        size_t Row() const { return row_; }
+
+        // Позиции декодируются при первом обращении: пересечение строк их не читает
+        std::span<const uint32_t> Positions() const {
+            if (positions_at_ != nullptr) {
+                const uint8_t *p = positions_at_;
+                positions_.resize(detail::readVarint(p));
+                uint32_t position = 0;
+                for (auto &value : positions_) {
+                    position += static_cast<uint32_t>(detail::readVarint(p));
+                    value = position;
+                }
+                positions_at_ = nullptr;
+            }
+            return positions_;
+        }
+
+        void Next() {
+            valid_ = p_ != end_;
+            if (!valid_) {
+                return;
+            }
+            row_ += detail::readVarint(p_);
+            positions_at_ = p_;
+            for (uint64_t count = detail::readVarint(p_); count > 0; --count) {
+                detail::skipVarint(p_);
+            }
+        }
+
+        // Переходит к первой строке не меньше row. Далёкие строки находятся по точкам пропуска
+        // (галопом от последней использованной), декодируется не больше kSkipInterval записей
+        void Seek(size_t row) {
+            if (!valid_ || row_ >= row) {
+                return;
+            }
+            const auto &skips = list_->skips_;
+            if (skip_ < skips.size() && skips[skip_].row <= row) {
+                size_t step = 1;
+                size_t last = skip_;
+                while (last + step < skips.size() && skips[last + step].row <= row) {
+                    last += step;
+                    step *= 2;
+                }
+                const auto first = skips.begin() + static_cast<std::ptrdiff_t>(last);
+                const auto bound = skips.begin() + static_cast<std::ptrdiff_t>(std::min(last + step, skips.size()));
+                const auto it = std::ranges::upper_bound(first, bound, row, {}, &Skip::row) - 1;
+                skip_ = static_cast<size_t>(it - skips.begin()) + 1;
+                if (it->row > row_) {
+                    p_ = list_->bytes_.data() + it->offset;
+                    row_ = it->base;
+                    Next();
+                }
+            }
+            while (valid_ && row_ < row) {
+                Next();
+            }
+        }
+
+    private:
+        const PostingList *list_;
+        const uint8_t *p_;
+        const uint8_t *end_;
+        bool valid_ = false;
+        size_t row_ = 0;
+        size_t skip_ = 0;
+        mutable const uint8_t *positions_at_ = nullptr;
+        mutable std::vector<uint32_t> positions_;
+    };
+
+    // row должен быть больше всех добавленных ранее строк
+    void Append(size_t row, std::span<const uint32_t> positions) {
+        if (size_ % kSkipInterval == 0) {
+            skips_.push_back({row, last_row_, bytes_.size()});
+        }
+        detail::appendVarint(bytes_, row - last_row_);
+        detail::appendVarint(bytes_, positions.size());
+        uint32_t previous = 0;
+        for (uint32_t position : positions) {
+            detail::appendVarint(bytes_, position - previous);
+            previous = position;
+        }
+        last_row_ = row;
+        size_++;
+    }
+
+    // Номера строк по возрастанию
+    std::vector<size_t> Rows() const {
+        std::vector<size_t> rows;
+        rows.reserve(size_);
+        const uint8_t *p = bytes_.data();
+        const uint8_t *end = p + bytes_.size();
+        size_t row = 0;
+        while (p != end) {
+            row += detail::readVarint(p);
+            rows.push_back(row);
+            for (uint64_t count = detail::readVarint(p); count > 0; --count) {
+                detail::skipVarint(p);
+            }
+        }
+        return rows;
+    }
+
+    Cursor Begin() const { return Cursor{*this}; }
+
+    // Количество строк в списке
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t Bytes() const { return bytes_.size() + skips_.size() * sizeof(Skip); }
+
+    // Память под список с учётом запаса вместимости
+    size_t MemoryBytes() const { return bytes_.capacity() + skips_.capacity() * sizeof(Skip); }
+
+private:
+    // Точка пропуска: строка записи, строка предыдущей записи (база разности) и смещение записи в байтах
+    struct Skip {
+        size_t row;
+        size_t base;
+        size_t offset;
+    };
+
+    static constexpr size_t kSkipInterval = 16;
+
+    std::vector<uint8_t> bytes_;
+    std::vector<Skip> skips_;
+    size_t last_row_ = 0;
+    size_t size_ = 0;
+};
+
+// Инвертированный индекс одного текстового поля: термин -> список вхождений.
+// Термины упорядочены, поэтому поиск по префиксу - это обход диапазона словаря
+class TextIndex {
+public:
+    explicit TextIndex(const TextIndexOptions &options = {}) : options_(options) {}
+
+    void Add(size_t row, std::string_view text) {
+        // Позиции каждого термина собираются до добавления: строка попадает в список термина один раз
+        std::vector<std::pair<std::string, uint32_t>> tokens;
+        detail::forEachToken(text,
+                             [&](std::string_view token, uint32_t position) { tokens.emplace_back(token, position); });
+        std::ranges::stable_sort(tokens, {}, &std::pair<std::string, uint32_t>::first);
+
+        std::vector<uint32_t> positions;
+        for (size_t i = 0; i < tokens.size();) {
+            positions.clear();
+            size_t j = i;
+            for (; j < tokens.size() && tokens[j].first == tokens[i].first; ++j) {
+                positions.push_back(tokens[j].second);
+            }
+            auto it = terms_.find(tokens[i].first);
+            if (it == terms_.end()) {
+                it = terms_.emplace(std::move(tokens[i].first), PostingList{}).first;
+            }
+            it->second.Append(row, positions);
+            i = j;
+        }
+
+        if (options_.trigrams) {
+            for (uint32_t gram : detail::trigrams(detail::lowerText(text))) {
+                trigrams_[gram].Append(row, {});
+            }
+        }
+    }
+
+    void Clear() {
+        terms_.clear();
+        trigrams_.clear();
+    }
+
+    // Список вхождений термина в нижнем регистре, nullptr, если термин не встречается
+    const PostingList *Find(std::string_view term) const {
+        auto it = terms_.find(term);
+        return it == terms_.end() ? nullptr : &it->second;
+    }
+
+    // fn(term, list) для каждого термина, начинающегося с prefix, в порядке возрастания терминов
+    template <typename Fn>
+    void ForEachPrefix(std::string_view prefix, Fn fn) const {
+        for (auto it = terms_.lower_bound(prefix); it != terms_.end() && it->first.starts_with(prefix); ++it) {
+            fn(std::string_view{it->first}, it->second);
+        }
+    }
+
+    bool HasTrigrams() const { return options_.trigrams; }
+
+    const PostingList *FindTrigram(uint32_t gram) const {
+        auto it = trigrams_.find(gram);
+        return it == trigrams_.end() ? nullptr : &it->second;
+    }
+
+    size_t TermCount() const { return terms_.size(); }
+
+    // Размер сжатых списков в байтах
+    size_t Bytes() const {
+        size_t bytes = 0;
+        std::ranges::for_each(terms_, [&](const auto &entry) { bytes += entry.second.Bytes(); });
+        std::ranges::for_each(trigrams_, [&](const auto &entry) { bytes += entry.second.Bytes(); });
+        return bytes;
+    }
+
+    // Сжатые списки, узлы словаря терминов и таблица триграмм
+    size_t MemoryBytes() const {
+        size_t bytes = terms_.size() * detail::treeNodeBytes<decltype(terms_)::value_type>() +
+                       detail::hashTableBytes(trigrams_);
+        std::ranges::for_each(terms_, [&](const auto &entry) {
+            bytes += detail::stringHeapBytes(entry.first) + entry.second.MemoryBytes();
+        });
+        std::ranges::for_each(trigrams_, [&](const auto &entry) { bytes += entry.second.MemoryBytes(); });
+        return bytes;
+    }
+
+private:
+    TextIndexOptions options_;
+    std::map<std::string, PostingList, std::less<>> terms_;
+    std::unordered_map<uint32_t, PostingList> trigrams_;
+};
+
+// Полнотекстовый индекс книг базы: отдельные индексы по заголовкам и по именам авторов
+class BookTextIndex {
+public:
+    explicit BookTextIndex(const TextIndexOptions &options = {}) : title_(options), author_(options) {}
+
+    void Add(size_t row, const Book &book) {
+        title_.Add(row, book.title);
+        author_.Add(row, book.author);
+    }
+
+    void Clear() {
+        title_.Clear();
+        author_.Clear();
+    }
+
+    // Индекс поля Title или Author
+    const TextIndex &Field(TextField field) const { return field == TextField::Author ? author_ : title_; }
+
+    size_t MemoryBytes() const { return title_.MemoryBytes() + author_.MemoryBytes(); }
+
+private:
+    TextIndex title_;
+    TextIndex author_;
+};
+
+}  // namespace bookdb
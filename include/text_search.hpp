@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "query_profiler.hpp"
+#include "text_index.hpp"
+
+namespace bookdb {
+
+// Полнотекстовый запрос: листья - слово, префикс слова, фраза и подстрока в поле, узлы - конъюнкция и дизъюнкция.
+// Слова сравниваются без учёта регистра латиницы, текст запроса нормализуется при построении
+class TextQuery {
+public:
+    enum class Kind { Term, Prefix, Phrase, Substring, And, Or };
+
+    static TextQuery Term(TextField field, std::string_view word) {
+        return TextQuery{Kind::Term, field, {detail::lowerText(word)}};
+    }
+
+    static TextQuery Prefix(TextField field, std::string_view prefix) {
+        return TextQuery{Kind::Prefix, field, {detail::lowerText(prefix)}};
+    }
+
+    // Слова фразы должны идти в поле подряд
+    static TextQuery Phrase(TextField field, std::string_view phrase) {
+        return TextQuery{Kind::Phrase, field, detail::tokenize(phrase)};
+    }
+
+    static TextQuery Substring(TextField field, std::string_view text) {
+        return TextQuery{Kind::Substring, field, {detail::lowerText(text)}};
+    }
+
+    static TextQuery And(std::vector<TextQuery> children) { return TextQuery{Kind::And, std::move(children)}; }
+
+    static TextQuery Or(std::vector<TextQuery> children) { return TextQuery{Kind::Or, std::move(children)}; }
+
+    Kind GetKind() const { return kind_; }
+
+    TextField GetField() const { return field_; }
+
+    // Нормализованные слова листа: одно для Term, Prefix и Substring, слова фразы для Phrase
+    const std::vector<std::string> &GetWords() const { return words_; }
+
+    const std::vector<TextQuery> &GetChildren() const { return children_; }
+
+private:
+    TextQuery(Kind kind, TextField field, std::vector<std::string> words)
+        : kind_(kind), field_(field), words_(std::move(words)) {}
+
+    TextQuery(Kind kind, std::vector<TextQuery> children) : kind_(kind), children_(std::move(children)) {}
+
+    Kind kind_;
+    TextField field_ = TextField::Any;
+    std::vector<std::string> words_;
+    std::vector<TextQuery> children_;
+};
+
+namespace detail {
+
+inline std::string_view fieldText(const Book &book, TextField field) {
+    return field == TextField::Author ? std::string_view{book.author} : std::string_view{book.title};
+}
+
+// Проверка листа запроса на тексте одного поля
+inline bool leafMatches(const TextQuery &query, std::string_view text) {
+    const auto &words = query.GetWords();
+    switch (query.GetKind()) {
+    case TextQuery::Kind::Term:
+    case TextQuery::Kind::Prefix: {
+        bool found = false;
+        forEachToken(text, [&](std::string_view token, uint32_t) {
+            found = found || (query.GetKind() == TextQuery::Kind::Term ? token == words.front()
+                                                                      : token.starts_with(words.front()));
+        });
+        return found;
+    }
+    case TextQuery::Kind::Phrase: {
+        const auto tokens = tokenize(text);
+        return !words.empty() && std::ranges::search(tokens, words).begin() != tokens.end();
+    }
+    case TextQuery::Kind::Substring:
+        return lowerText(text).find(words.front()) != std::string::npos;
+    default:
+        return false;
+    }
+}
+
+// Проверка запроса на книге без индекса
+inline bool textMatches(const TextQuery &query, const Book &book) {
+    switch (query.GetKind()) {
+    case TextQuery::Kind::And:
+        return std::ranges::all_of(query.GetChildren(),
+                                   [&](const TextQuery &child) { return textMatches(child, book); });
+    case TextQuery::Kind::Or:
+        return std::ranges::any_of(query.GetChildren(),
+                                   [&](const TextQuery &child) { return textMatches(child, book); });
+    default:
+        if (query.GetField() == TextField::Any) {
+            return leafMatches(query, book.title) || leafMatches(query, book.author);
+        }
+        return leafMatches(query, fieldText(book, query.GetField()));
+    }
+}
+
+inline std::vector<size_t> intersectRows(const std::vector<size_t> &lhs, const std::vector<size_t> &rhs) {
+    std::vector<size_t> rows;
+    std::ranges::set_intersection(lhs, rhs, std::back_inserter(rows));
+    return rows;
+}
+
+inline std::vector<size_t> uniteRows(const std::vector<size_t> &lhs, const std::vector<size_t> &rhs) {
+    std::vector<size_t> rows;
+    rows.reserve(lhs.size() + rhs.size());
+    std::ranges::set_union(lhs, rhs, std::back_inserter(rows));
+    return rows;
+}
+
+// Строки rows, входящие в список: курсор перескакивает по точкам пропуска, длинный список не декодируется целиком
+inline std::vector<size_t> seekRows(const std::vector<size_t> &rows, const PostingList &list) {
+    std::vector<size_t> result;
+    auto cursor = list.Begin();
+    for (size_t row : rows) {
+        cursor.Seek(row);
+        if (!cursor.Valid()) {
+            break;
+        }
+        if (cursor.Row() == row) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
+// Строки, в которых слова фразы идут подряд: строки самого короткого списка проверяются курсорами
+// по спискам остальных слов, на общих строках сравниваются позиции
+inline std::vector<size_t> phraseRows(const TextIndex &index, const std::vector<std::string> &words) {
+    std::vector<const PostingList *> lists;
+    for (const auto &word : words) {
+        const PostingList *list = index.Find(word);
+        if (list == nullptr) {
+            return {};
+        }
+        lists.push_back(list);
+    }
+    if (lists.empty()) {
+        return {};
+    }
+
+    std::vector<PostingList::Cursor> cursors;
+    std::ranges::transform(lists, std::back_inserter(cursors), &PostingList::Begin);
+    const size_t driver = static_cast<size_t>(std::ranges::min_element(lists, {}, &PostingList::size) - lists.begin());
+
+    std::vector<size_t> rows;
+    for (; cursors[driver].Valid(); cursors[driver].Next()) {
+        const size_t row = cursors[driver].Row();
+        bool common = true;
+        for (auto &cursor : cursors) {
+            cursor.Seek(row);
+            if (!cursor.Valid()) {
+                return rows;
+            }
+            common = common && cursor.Row() == row;
+        }
+        if (!common) {
+            continue;
+        }
+
+        const bool found = std::ranges::any_of(cursors.front().Positions(), [&](uint32_t start) {
+            for (size_t i = 1; i < cursors.size(); ++i) {
+                if (!std::ranges::binary_search(cursors[i].Positions(), start + static_cast<uint32_t>(i))) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        if (found) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> scanRows(const BookDatabase<T, P> &db, const TextQuery &query) {
+    std::vector<size_t> rows;
+    const auto &books = db.GetBooks();
+    for (size_t row = 0; row < books.size(); ++row) {
+        if (textMatches(query, books[row])) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+// Кандидаты по триграммам подстроки проверяются по тексту книги
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> substringRows(const BookDatabase<T, P> &db, const TextIndex &index, const TextQuery &query) {
+    const auto grams = trigrams(query.GetWords().front());
+    if (!index.HasTrigrams() || grams.empty()) {
+        return scanRows(db, query);
+    }
+
+    std::vector<const PostingList *> lists;
+    for (uint32_t gram : grams) {
+        const PostingList *list = index.FindTrigram(gram);
+        if (list == nullptr) {
+            return {};
+        }
+        lists.push_back(list);
+    }
+    std::ranges::sort(lists, {}, &PostingList::size);
+
+    auto candidates = lists.front()->Rows();
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        candidates = intersectRows(candidates, lists[i]->Rows());
+    }
+    std::erase_if(candidates, [&](size_t row) { return !textMatches(query, db.GetBooks()[row]); });
+    return candidates;
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> fieldRows(const BookDatabase<T, P> &db, const TextIndex &index, const TextQuery &query) {
+    switch (query.GetKind()) {
+    case TextQuery::Kind::Term: {
+        const PostingList *list = index.Find(query.GetWords().front());
+        return list == nullptr ? std::vector<size_t>{} : list->Rows();
+    }
+    case TextQuery::Kind::Prefix: {
+        std::vector<size_t> rows;
+        index.ForEachPrefix(query.GetWords().front(), [&](std::string_view, const PostingList &list) {
+            auto term_rows = list.Rows();
+            rows.insert(rows.end(), term_rows.begin(), term_rows.end());
+        });
+        std::ranges::sort(rows);
+        rows.erase(std::ranges::unique(rows).begin(), rows.end());
+        return rows;
+    }
+    case TextQuery::Kind::Phrase:
+        return phraseRows(index, query.GetWords());
+    default:
+        return substringRows(db, index, query);
+    }
+}
+
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> indexRows(const BookDatabase<T, P> &db, const BookTextIndex &index, const TextQuery &query) {
+    switch (query.GetKind()) {
+    case TextQuery::Kind::And: {
+        // Слова в конкретном поле не разворачиваются: кандидаты проверяются курсором по списку слова
+        std::vector<const PostingList *> terms;
+        std::vector<std::vector<size_t>> parts;
+        for (const TextQuery &child : query.GetChildren()) {
+            if (child.GetKind() == TextQuery::Kind::Term && child.GetField() != TextField::Any) {
+                const PostingList *list = index.Field(child.GetField()).Find(child.GetWords().front());
+                if (list == nullptr) {
+                    return {};
+                }
+                terms.push_back(list);
+            } else {
+                parts.push_back(indexRows(db, index, child));
+            }
+        }
+        std::ranges::sort(terms, {}, &PostingList::size);
+        auto shortest = [&] { return std::ranges::min(parts, {}, &std::vector<size_t>::size).size(); };
+        if (!terms.empty() && (parts.empty() || terms.front()->size() < shortest())) {
+            parts.push_back(terms.front()->Rows());
+            terms.erase(terms.begin());
+        }
+        if (parts.empty()) {
+            std::vector<size_t> rows(db.size());
+            std::iota(rows.begin(), rows.end(), size_t{0});
+            return rows;
+        }
+        // Пересечение начинается с самого короткого списка
+        std::ranges::sort(parts, {}, &std::vector<size_t>::size);
+        auto rows = std::move(parts.front());
+        for (size_t i = 1; i < parts.size() && !rows.empty(); ++i) {
+            rows = intersectRows(rows, parts[i]);
+        }
+        for (const PostingList *list : terms) {
+            rows = seekRows(rows, *list);
+        }
+        return rows;
+    }
+    case TextQuery::Kind::Or: {
+        std::vector<size_t> rows;
+        for (const TextQuery &child : query.GetChildren()) {
+            rows = uniteRows(rows, indexRows(db, index, child));
+        }
+        return rows;
+    }
+    default:
+        if (query.GetField() == TextField::Any) {
+            return uniteRows(fieldRows(db, index.Field(TextField::Title), query),
+                             fieldRows(db, index.Field(TextField::Author), query));
+        }
+        return fieldRows(db, index.Field(query.GetField()), query);
+    }
+}
+
+}  // namespace detail
+
+// Номера строк книг, удовлетворяющих запросу, по возрастанию.
+// Если полнотекстовый индекс не включён (EnableTextIndex), база сканируется.
+// Профилировщик считает просмотренными строки только при сканировании, ответ по индексу их не просматривает
+template <BookContainerLike T, MemoryPolicyLike P>
+std::vector<size_t> searchBooks(const BookDatabase<T, P> &db, const TextQuery &query) {
+    QueryProbe probe{QueryKind::SearchBooks};
+    std::vector<size_t> rows;
+    if (const auto *index = db.GetTextIndex()) {
+        rows = detail::indexRows(db, *index, query);
+    } else {
+        rows = detail::scanRows(db, query);
+        probe.Scanned(db.size());
+    }
+    probe.Matched(rows.size());
+    return rows;
+}
+
+}  // namespace bookdb
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bookdb {
+
+// Пул потоков фиксированного размера с общей очередью задач
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+        if (threads == 0) {
+            throw std::logic_error("ThreadPool requires at least one thread");
+        }
+        workers_.reserve(threads);
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this](std::stop_token stop) { Work(stop); });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        for (auto &worker : workers_) {
+            worker.request_stop();
+        }
+        ready_.notify_all();
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    template <typename Fn>
+    std::future<std::invoke_result_t<Fn>> Submit(Fn &&fn) {
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Fn>()>>(std::forward<Fn>(fn));
+        auto result = task->get_future();
+        {
+            std::lock_guard lock{mutex_};
+            tasks_.emplace([task] { (*task)(); });
+        }
+        ready_.notify_one();
+        return result;
+    }
+
+    // Делит [0, count) на parts непрерывных частей и вызывает fn(part, first, last) для каждой из них в пуле.
+    // Возвращает управление, когда все части обработаны; исключение из любой части пробрасывается вызывающему
+    template <typename Fn>
+    void ParallelFor(size_t count, size_t parts, Fn &&fn) {
+        parts = std::clamp<size_t>(parts, 1, std::max<size_t>(count, 1));
+
+        std::vector<std::future<void>> results;
+        results.reserve(parts);
+
+        // Части ссылаются на fn и стек вызывающего, поэтому до выхода, в том числе по исключению,
+        // дожидаемся всех отправленных частей
+        struct WaitAll {
+            std::vector<std::future<void>> &futures;
+            ~WaitAll() {
+                std::ranges::for_each(futures, [](auto &future) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                });
+            }
+        } wait_all{results};
+
+        for (size_t part = 0; part < parts; ++part) {
+            const size_t first = count * part / parts;
+            const size_t last = count * (part + 1) / parts;
+            results.push_back(Submit([&fn, part, first, last] { fn(part, first, last); }));
+        }
+        std::ranges::for_each(results, [](auto &result) { result.wait(); });
+        std::ranges::for_each(results, [](auto &result) { result.get(); });
+    }
+
+private:
+    void Work(std::stop_token stop) {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{mutex_};
+                ready_.wait(lock, stop, [this] { return !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;  // остановка пула
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable_any ready_;
+    std::queue<std::function<void()>> tasks_;
+    // Потоки объявлены последними, чтобы остановиться раньше, чем разрушится очередь
+    std::vector<std::jthread> workers_;
+};
+
+}  // namespace bookdb
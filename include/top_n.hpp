@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "concepts.hpp"
+
+namespace bookdb {
+
+// Ограниченная куча: хранит не больше capacity лучших из предложенных значений.
+// better(a, b) == true, если a должно стоять в результате раньше b; в вершине кучи - худшее из отобранных,
+// поэтому проверка нового значения стоит одно сравнение, а вставка - O(log capacity)
+template <typename T, typename Better>
+class BoundedTopN {
+public:
+    BoundedTopN(size_t capacity, Better better) : capacity_(capacity), better_(std::move(better)) {
+        heap_.reserve(std::min(capacity_, kMaxReserve));
+    }
+
+    // true, если значение попало в число лучших
+    bool Offer(T value) {
+        if (heap_.size() < capacity_) {
+            heap_.push_back(std::move(value));
+            std::push_heap(heap_.begin(), heap_.end(), better_);
+            return true;
+        }
+        if (capacity_ == 0 || !better_(value, heap_.front())) {
+            return false;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), better_);
+        heap_.back() = std::move(value);
+        std::push_heap(heap_.begin(), heap_.end(), better_);
+        return true;
+    }
+
+    // Объединение с кучей другой части диапазона
+    void Merge(BoundedTopN &&other) {
+        std::ranges::for_each(other.heap_, [&](T &value) { Offer(std::move(value)); });
+        other.heap_.clear();
+    }
+
+    // Отобранные значения, от лучшего к худшему
+    std::vector<T> Sorted() const {
+        auto sorted = heap_;
+        std::sort_heap(sorted.begin(), sorted.end(), better_);
+        return sorted;
+    }
+
+    std::vector<T> TakeSorted() && {
+        std::sort_heap(heap_.begin(), heap_.end(), better_);
+        return std::move(heap_);
+    }
+
+    // Худшее из отобранных значений, nullptr для пустой кучи
+    const T *Worst() const { return heap_.empty() ? nullptr : &heap_.front(); }
+
+    size_t size() const { return heap_.size(); }
+
+    size_t capacity() const { return capacity_; }
+
+    bool empty() const { return heap_.empty(); }
+
+private:
+    // Большие capacity (например, count == размер базы) не резервируются заранее целиком
+    static constexpr size_t kMaxReserve = 4096;
+
+    size_t capacity_;
+    Better better_;
+    std::vector<T> heap_;
+};
+
+// Потоковый top-N: книги предлагаются по мере добавления, отобранные книги копируются
+// (автор копируется как string_view, имя должно жить дольше трекера - например, в словаре базы).
+// Книги с равным ключом упорядочены по порядку поступления, как и в getTopNBy
+template <BookComparator Comp>
+class StreamingTopN {
+public:
+    explicit StreamingTopN(size_t count, Comp comp = {}) : comp_(comp), top_(count, Better{std::move(comp)}) {}
+
+    // O(1), если книга не лучше худшей из отобранных, иначе O(log count) и копия книги
+    bool Offer(const Book &book) {
+        const uint64_t sequence = next_sequence_++;
+        // Кандидат сравнивается с худшей книгой до копирования: пришедшая позже книга с равным ключом не лучше
+        if (top_.size() == top_.capacity() && (top_.capacity() == 0 || !comp_(book, top_.Worst()->book))) {
+            return false;
+        }
+        return top_.Offer(Entry{book, sequence});
+    }
+
+    // Отобранные книги, от лучшей к худшей
+    std::vector<Book> Top() const {
+        std::vector<Book> books;
+        books.reserve(top_.size());
+        std::ranges::for_each(top_.Sorted(), [&](const Entry &entry) { books.push_back(entry.book); });
+        return books;
+    }
+
+    size_t size() const { return top_.size(); }
+
+    size_t capacity() const { return top_.capacity(); }
+
+private:
+    struct Entry {
+        Book book;
+        uint64_t sequence;
+    };
+
+    struct Better {
+        Comp comp;
+
+        bool operator()(const Entry &lhs, const Entry &rhs) const {
+            if (comp(lhs.book, rhs.book)) {
+                return true;
+            }
+            return !comp(rhs.book, lhs.book) && lhs.sequence < rhs.sequence;
+        }
+    };
+
+    Comp comp_;
+    BoundedTopN<Entry, Better> top_;
+    uint64_t next_sequence_ = 0;
+};
+
+}  // namespace bookdb
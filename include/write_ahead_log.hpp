@@ -0,0 +1,402 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "book.hpp"
+#include "mapped_file.hpp"
+
+namespace bookdb {
+
+// Журнал предзаписи (WAL) добавленных книг.
+//
+// Формат (числа в порядке байт машины, записавшей журнал, проверяется по kWalEndianTag):
+//     WalHeader
+//     записи: uint32 размер данных, uint32 CRC-32C данных, данные
+//     данные: uint8 тип, int32 год, int32 жанр, double рейтинг, int32 прочтения,
+//             uint32 длина имени автора, uint32 длина заголовка, имя автора, заголовок
+// При открытии журнал читается до первой неполной или испорченной записи, хвост после неё
+// (оборванная при сбое запись) отрезается.
+
+inline constexpr std::array<char, 8> kWalMagic{'B', 'O', 'O', 'K', 'W', 'A', 'L', '\0'};
+inline constexpr uint32_t kWalVersion = 1;
+inline constexpr uint32_t kWalEndianTag = 0x01020304;
+
+struct WalHeader {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t endian_tag;
+};
+
+static_assert(std::is_trivially_copyable_v<WalHeader>);
+
+// Когда записи журнала сбрасываются на диск (fdatasync)
+enum class WalSync {
+    // Только при Sync() и закрытии: записи попадают в кэш ОС пачками, сбой ОС теряет несброшенное
+    None,
+    // Групповая фиксация: фоновый поток сбрасывает накопленные записи одним fdatasync раз в group_commit_delay
+    // или по накоплении group_commit_bytes. Append не ждёт диска, при сбое теряется не больше одной группы
+    Group,
+    // Append возвращается только после fdatasync своей записи; записи одновременных писателей
+    // сбрасываются общим fdatasync
+    Always,
+};
+
+struct WalOptions {
+    WalSync sync = WalSync::Group;
+    std::chrono::microseconds group_commit_delay{2000};
+    size_t group_commit_bytes = size_t{1} << 20;
+};
+
+// Запись журнала: строки ссылаются на отображённый файл и действительны только внутри обработчика
+struct WalRecord {
+    std::string_view author;
+    std::string_view title;
+    int year;
+    Genre genre;
+    double rating;
+    int read_count;
+};
+
+namespace detail {
+
+inline constexpr std::array<uint32_t, 256> kCrc32cTable = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78u : 0u);
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+// CRC-32C (Castagnoli)
+inline uint32_t crc32c(const void *data, size_t size) {
+    uint32_t crc = ~0u;
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCrc32cTable[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline constexpr uint8_t kWalInsert = 1;
+inline constexpr size_t kWalRecordHeader = 2 * sizeof(uint32_t);
+// Тип, год, жанр, прочтения, рейтинг и длины строк
+inline constexpr size_t kWalFixedPayload =
+    sizeof(uint8_t) + 3 * sizeof(int32_t) + sizeof(double) + 2 * sizeof(uint32_t);
+
+template <typename T>
+void putRaw(char *&out, const T &value) {
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template <typename T>
+T getRaw(const char *&in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+// Дописывает запись в конец буфера
+inline void encodeWalRecord(std::vector<char> &buffer, const WalRecord &record) {
+    const size_t payload = kWalFixedPayload + record.author.size() + record.title.size();
+    const size_t start = buffer.size();
+    buffer.resize(start + kWalRecordHeader + payload);
+
+    char *out = buffer.data() + start + kWalRecordHeader;
+    putRaw(out, kWalInsert);
+    putRaw(out, static_cast<int32_t>(record.year));
+    putRaw(out, static_cast<int32_t>(record.genre));
+    putRaw(out, record.rating);
+    putRaw(out, static_cast<int32_t>(record.read_count));
+    putRaw(out, static_cast<uint32_t>(record.author.size()));
+    putRaw(out, static_cast<uint32_t>(record.title.size()));
+    std::memcpy(out, record.author.data(), record.author.size());
+    std::memcpy(out + record.author.size(), record.title.data(), record.title.size());
+
+    char *header = buffer.data() + start;
+    putRaw(header, static_cast<uint32_t>(payload));
+    putRaw(header, crc32c(buffer.data() + start + kWalRecordHeader, payload));
+}
+
+// Перебирает целые записи с верной контрольной суммой: on_record(record).
+// Возвращает смещение конца последней такой записи
+template <typename OnRecord>
+size_t scanWalRecords(std::string_view bytes, size_t offset, OnRecord &&on_record) {
+    while (bytes.size() - offset >= kWalRecordHeader) {
+        const char *in = bytes.data() + offset;
+        const auto payload = getRaw<uint32_t>(in);
+        const auto crc = getRaw<uint32_t>(in);
+        if (payload < kWalFixedPayload || payload > bytes.size() - offset - kWalRecordHeader ||
+            crc32c(in, payload) != crc) {
+            break;
+        }
+        const char *end = in + payload;
+        if (getRaw<uint8_t>(in) != kWalInsert) {
+            break;
+        }
+        WalRecord record{};
+        record.year = getRaw<int32_t>(in);
+        record.genre = static_cast<Genre>(getRaw<int32_t>(in));
+        record.rating = getRaw<double>(in);
+        record.read_count = getRaw<int32_t>(in);
+        const auto author_size = getRaw<uint32_t>(in);
+        const auto title_size = getRaw<uint32_t>(in);
+        if (uint64_t{author_size} + title_size != static_cast<uint64_t>(end - in)) {
+            break;
+        }
+        record.author = {in, author_size};
+        record.title = {in + author_size, title_size};
+        on_record(record);
+        offset += kWalRecordHeader + payload;
+    }
+    return offset;
+}
+
+}  // namespace detail
+
+// Журнал для дозаписи книг. Append кодирует запись в буфер памяти под мьютексом и возвращает её номер (LSN),
+// фоновый поток пишет накопленные буферы в файл одним write и сбрасывает их на диск по политике WalSync,
+// пока писатели заполняют следующий буфер. Append безопасен для вызова из нескольких потоков.
+// Ошибка записи сохраняется и бросается из следующего Append или Sync
+class WriteAheadLog {
+public:
+    explicit WriteAheadLog(const std::filesystem::path &path, const WalOptions &options = {})
+        : WriteAheadLog(path, options, [](const WalRecord &) {}) {}
+
+    // Восстановление: on_record(record) вызывается для каждой целой записи журнала по порядку,
+    // оборванный или испорченный хвост отрезается, новые записи дописываются после последней целой
+    template <typename OnRecord>
+    WriteAheadLog(const std::filesystem::path &path, const WalOptions &options, OnRecord on_record)
+        : options_(options) {
+        size_t valid_end = 0;
+        size_t file_size = 0;
+        if (std::filesystem::exists(path)) {
+            const auto file = MappedFile::Open(path);
+            file_size = file.size();
+            valid_end = Recover(file.Text(), on_record);
+        }
+
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::system_error{errno, std::generic_category(), "Unable to open " + path.string()};
+        }
+        try {
+            if (valid_end < file_size) {
+                truncated_bytes_ = file_size - valid_end;
+                Check(::ftruncate(fd_, static_cast<off_t>(valid_end)), "truncate");
+            }
+            Check(::lseek(fd_, static_cast<off_t>(valid_end), SEEK_SET), "seek");
+            if (valid_end == 0) {
+                const WalHeader header{kWalMagic, kWalVersion, kWalEndianTag};
+                WriteAll(reinterpret_cast<const char *>(&header), sizeof(header));
+                Check(::fdatasync(fd_), "sync");
+            }
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+        flusher_ = std::jthread([this](std::stop_token stop) { Flush(stop); });
+    }
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    // Дописывает оставшиеся записи и сбрасывает их на диск
+    ~WriteAheadLog() {
+        flusher_.request_stop();
+        wake_.notify_all();
+        flusher_.join();
+        ::fdatasync(fd_);
+        ::close(fd_);
+    }
+
+    // Номер записи (с 1). При WalSync::Always возвращается после сброса записи на диск
+    uint64_t Append(const WalRecord &record) {
+        std::unique_lock lock{mutex_};
+        // Писатель, обгоняющий диск, ждёт, пока буфер не уменьшится
+        done_.wait(lock, [&] { return pending_.size() < 4 * options_.group_commit_bytes || error_; });
+        ThrowIfFailed();
+        detail::encodeWalRecord(pending_, record);
+        const uint64_t lsn = ++appended_;
+        if (options_.sync == WalSync::Always) {
+            WaitDurable(lock, lsn);
+        } else if (pending_.size() >= options_.group_commit_bytes) {
+            wake_.notify_one();
+        }
+        return lsn;
+    }
+
+    uint64_t Append(const Book &book) {
+        return Append(WalRecord{book.author, book.title, book.year, book.genre, book.rating, book.read_count});
+    }
+
+    // Записывает и сбрасывает на диск все добавленные записи независимо от политики
+    void Sync() {
+        std::unique_lock lock{mutex_};
+        WaitDurable(lock, appended_);
+    }
+
+    // Количество добавленных в журнал записей (без восстановленных)
+    uint64_t AppendedLsn() const {
+        std::lock_guard lock{mutex_};
+        return appended_;
+    }
+
+    // Номер последней записи, сброшенной на диск
+    uint64_t DurableLsn() const {
+        std::lock_guard lock{mutex_};
+        return durable_;
+    }
+
+    size_t RecoveredRecords() const { return recovered_records_; }
+
+    // Размер отрезанного при открытии хвоста в байтах
+    size_t TruncatedBytes() const { return truncated_bytes_; }
+
+private:
+    template <typename OnRecord>
+    size_t Recover(std::string_view bytes, OnRecord &on_record) {
+        // Оборванный заголовок пустого журнала записывается заново
+        if (bytes.size() < sizeof(WalHeader)) {
+            return 0;
+        }
+        WalHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != kWalMagic) {
+            throw std::runtime_error{"Not a write-ahead log"};
+        }
+        if (header.version != kWalVersion) {
+            throw std::runtime_error{"Unsupported write-ahead log version " + std::to_string(header.version)};
+        }
+        if (header.endian_tag != kWalEndianTag) {
+            throw std::runtime_error{"Write-ahead log was written with a different byte order"};
+        }
+        return detail::scanWalRecords(bytes, sizeof(WalHeader), [&](const WalRecord &record) {
+            on_record(record);
+            ++recovered_records_;
+        });
+    }
+
+    // Вызывающий держит lock
+    void WaitDurable(std::unique_lock<std::mutex> &lock, uint64_t lsn) {
+        ++sync_waiters_;
+        wake_.notify_one();
+        done_.wait(lock, [&] { return durable_ >= lsn || error_; });
+        --sync_waiters_;
+        ThrowIfFailed();
+    }
+
+    void ThrowIfFailed() const {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    // Фоновый поток групповой фиксации
+    void Flush(std::stop_token stop) {
+        std::vector<char> batch;
+        std::unique_lock lock{mutex_};
+        // Есть что записать или кто-то ждёт сброса ещё не сброшенных записей
+        auto has_work = [&] { return !pending_.empty() || (sync_waiters_ > 0 && durable_ < appended_); };
+        while (true) {
+            wake_.wait_for(lock, options_.group_commit_delay, [&] {
+                return stop.stop_requested() || pending_.size() >= options_.group_commit_bytes ||
+                       (sync_waiters_ > 0 && has_work());
+            });
+            if (!has_work()) {
+                if (stop.stop_requested()) {
+                    return;
+                }
+                continue;
+            }
+
+            batch.swap(pending_);
+            const uint64_t lsn = appended_;
+            const bool sync = options_.sync != WalSync::None || sync_waiters_ > 0;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                WriteAll(batch.data(), batch.size());
+                if (sync) {
+                    Check(::fdatasync(fd_), "sync");
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            batch.clear();
+            lock.lock();
+
+            // После ошибки записи журнал не продолжается: следующие записи шли бы после потерянной группы
+            if (error) {
+                error_ = error;
+                done_.notify_all();
+                return;
+            }
+            if (sync) {
+                durable_ = lsn;
+            }
+            done_.notify_all();
+        }
+    }
+
+    void WriteAll(const char *data, size_t size) {
+        while (size > 0) {
+            const ssize_t written = ::write(fd_, data, size);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            Check(written, "write");
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    static void Check(long result, const char *what) {
+        if (result < 0) {
+            throw std::system_error{errno, std::generic_category(), std::string{"Write-ahead log "} + what};
+        }
+    }
+
+    WalOptions options_;
+    int fd_ = -1;
+    size_t recovered_records_ = 0;
+    size_t truncated_bytes_ = 0;
+
+    mutable std::mutex mutex_;
+    // Будит фоновый поток; done_ - писателей, ждущих сброса на диск или места в буфере
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::vector<char> pending_;
+    uint64_t appended_ = 0;
+    uint64_t durable_ = 0;
+    size_t sync_waiters_ = 0;
+    std::exception_ptr error_;
+    std::jthread flusher_;
+};
+
+}  // namespace bookdb
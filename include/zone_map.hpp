@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "book.hpp"
+#include "book_aggregates.hpp"
+
+namespace bookdb {
+
+// Метаданные блока строк: границы значений полей, присутствующие жанры и суммы рейтингов по жанрам.
+// Границы только расширяются: после удаления или изменения книги они остаются верными, но могут быть шире реальных.
+// Суммы компенсированные, как в BookAggregates, чтобы длинная серия Modify не уводила их от сканирования
+struct ZoneStats {
+    int min_year = std::numeric_limits<int>::max();
+    int max_year = std::numeric_limits<int>::min();
+    double min_rating = std::numeric_limits<double>::infinity();
+    double max_rating = -std::numeric_limits<double>::infinity();
+    int min_read_count = std::numeric_limits<int>::max();
+    int max_read_count = std::numeric_limits<int>::min();
+    std::bitset<kGenreCount> genres;
+    std::array<CompensatedRatingSum, kGenreCount> ratings{};
+
+    void Add(const Book &book) {
+        min_year = std::min(min_year, book.year);
+        max_year = std::max(max_year, book.year);
+        // NaN не проходит ни одно сравнение: блок с NaN не может целиком удовлетворять условию на рейтинг
+        if (std::isnan(book.rating)) {
+            min_rating = -std::numeric_limits<double>::infinity();
+        } else {
+            min_rating = std::min(min_rating, book.rating);
+            max_rating = std::max(max_rating, book.rating);
+        }
+        min_read_count = std::min(min_read_count, book.read_count);
+        max_read_count = std::max(max_read_count, book.read_count);
+        genres.set(static_cast<size_t>(book.genre));
+        ratings[static_cast<size_t>(book.genre)].Add(book.rating);
+    }
+
+    void Remove(const Book &book) {
+        auto &sum = ratings[static_cast<size_t>(book.genre)];
+        sum.Remove(book.rating);
+        if (sum.count == 0) {
+            genres.reset(static_cast<size_t>(book.genre));
+            sum = {};
+        }
+    }
+
+    // Единственный жанр блока
+    bool OnlyGenre(Genre genre) const { return genres.count() == 1 && genres.test(static_cast<size_t>(genre)); }
+};
+
+// Результат проверки блока по его метаданным
+enum class ZoneMatch {
+    None,     // ни одна строка блока не подходит, блок пропускается
+    Partial,  // блок нужно просканировать
+    All,      // подходят все строки блока
+};
+
+// Карта зон: ZoneStats для каждого блока из kZoneRows строк, поддерживается при добавлении книг.
+// Счётчики показывают, сколько блоков запросы пропустили, просканировали и приняли целиком
+class ZoneMap {
+public:
+    static constexpr size_t kZoneRows = 4096;
+
+    struct Counters {
+        size_t skipped = 0;
+        size_t scanned = 0;
+        size_t full = 0;
+    };
+
+    ZoneMap() = default;
+
+    ZoneMap(const ZoneMap &other) : zones_(other.zones_) {}
+
+    ZoneMap &operator=(const ZoneMap &other) {
+        zones_ = other.zones_;
+        return *this;
+    }
+
+    void Add(size_t row, const Book &book) {
+        if (row / kZoneRows >= zones_.size()) {
+            zones_.resize(row / kZoneRows + 1);
+        }
+        zones_[row / kZoneRows].Add(book);
+    }
+
+    void Remove(size_t row, const Book &book) { zones_[row / kZoneRows].Remove(book); }
+
+    void Clear() { zones_.clear(); }
+
+    size_t size() const { return zones_.size(); }
+
+    bool empty() const { return zones_.empty(); }
+
+    size_t MemoryBytes() const { return zones_.capacity() * sizeof(ZoneStats); }
+
+    const ZoneStats &operator[](size_t zone) const { return zones_[zone]; }
+
+    // Счётчики обновляются из константных запросов, в том числе параллельных
+    void Count(ZoneMatch match) const {
+        switch (match) {
+        case ZoneMatch::None:
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case ZoneMatch::Partial:
+            scanned_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case ZoneMatch::All:
+            full_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+    }
+
+    Counters GetCounters() const {
+        return {skipped_.load(std::memory_order_relaxed), scanned_.load(std::memory_order_relaxed),
+                full_.load(std::memory_order_relaxed)};
+    }
+
+    void ResetCounters() const {
+        skipped_.store(0, std::memory_order_relaxed);
+        scanned_.store(0, std::memory_order_relaxed);
+        full_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<ZoneStats> zones_;
+    mutable std::atomic<size_t> skipped_ = 0;
+    mutable std::atomic<size_t> scanned_ = 0;
+    mutable std::atomic<size_t> full_ = 0;
+};
+
+}  // namespace bookdb
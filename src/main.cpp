@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <utility>
 
 #include "book_database.hpp"
 #include "comparators.hpp"
@@ -34,10 +35,10 @@ int main() {
     std::print("Books: {}\n\n", db);
 
     // Sorts
-    std::sort(db.begin(), db.end(), comp::LessByAuthor{});
+    std::ranges::sort(db.MutableRange(), comp::LessByAuthor{});
     std::print("Books sorted by author: {}\n\n==================\n", db);
 
-    std::sort(db.begin(), db.end(), comp::LessByPopularity{});
+    std::ranges::sort(db.MutableRange(), comp::LessByPopularity{});
     std::print("Books sorted by popularity: {}\n\n==================\n", db);
 
     // Author histogram
@@ -63,8 +64,15 @@ int main() {
     std::for_each(filtered_any_off.cbegin(), filtered_any_off.cend(),
                   [](const auto &v) { std::print("{}\n", v.get()); });
 
+    // Filter with secondary index
+    db.CreateIndex(IndexedField::Year);
+    auto filtered_indexed = filterBooks(std::as_const(db), YearBetween(1930, 1950));
+    std::print("\n\nBooks from 1930-1949 (year index):\n");
+    std::for_each(filtered_indexed.cbegin(), filtered_indexed.cend(),
+                  [](const auto &v) { std::print("{}\n", v.get()); });
+
     // Top 3 books
-    auto topBooks = getTopNBy(db.begin(), db.end(), 3, comp::LessByRating{});
+    auto topBooks = getTopNBy(db.cbegin(), db.cend(), 3, comp::LessByRating{});
     std::print("\n\nTop 3 books by rating:\n");
     std::for_each(topBooks.cbegin(), topBooks.cend(), [](const auto &v) { std::print("{}\n", v.get()); });
 
@@ -73,9 +81,9 @@ int main() {
     std::print("\n\nRandom 3 books:\n");
     std::for_each(randomBooks.cbegin(), randomBooks.cend(), [](const auto &v) { std::print("{}\n", v.get()); });
 
-    auto orwellBookIt = std::find_if(db.begin(), db.end(), [](const auto &v) { return v.author == "George Orwell"; });
-    if (orwellBookIt != db.end()) {
-        std::print("\n\nTransparent lookup by authors. Found Orwell's book: \n{}\n", *orwellBookIt);
+    auto orwellBooks = db.GetBooksByAuthor("George Orwell");
+    if (!orwellBooks.empty()) {
+        std::print("\n\nTransparent lookup by authors. Found Orwell's book: \n{}\n", orwellBooks.front().get());
     }
 
     return 0;
@@ -0,0 +1,80 @@
+#include "author_dictionary.hpp"
+#include "book_database.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+// ################ Словарь авторов ###################
+TEST(TestAuthorDictionary, DenseIds) {
+    AuthorDictionary authors;
+    EXPECT_TRUE(authors.empty());
+
+    EXPECT_EQ(authors.Add("Tolstoy"), 0);
+    EXPECT_EQ(authors.Add("Dostoevsky"), 1);
+    EXPECT_EQ(authors.Add("Tolstoy"), 0);
+    EXPECT_EQ(authors.size(), 2);
+
+    EXPECT_EQ(authors.Name(1), "Dostoevsky"sv);
+    EXPECT_EQ(authors.Find("Tolstoy"), 0);
+    EXPECT_FALSE(authors.Find("Chekhov").has_value());
+    EXPECT_TRUE(std::ranges::equal(authors, std::vector<std::string_view>{"Tolstoy", "Dostoevsky"}));
+
+    authors.clear();
+    EXPECT_TRUE(authors.empty());
+    EXPECT_EQ(authors.Add("Chekhov"), 0);
+}
+
+TEST(TestAuthorDictionary, NamesAreStable) {
+    // Ссылки на имена не инвалидируются при добавлении новых авторов
+    AuthorDictionary authors;
+    auto first = authors.Name(authors.Add("First"));
+    for (int i = 0; i < 10000; ++i) {
+        authors.Add("Author" + std::to_string(i));
+    }
+    EXPECT_EQ(first, "First"sv);
+    EXPECT_EQ(first.data(), authors.Name(0).data());
+}
+// ################ Словарь авторов ###################
+
+// ################ Идентификаторы авторов в базе ###################
+TEST(TestAuthorIds, AssignedOnInsert) {
+    BookDatabase<std::deque<Book>> db;
+    const Book &first = db.EmplaceBack("Tolstoy", "War and Peace", 1869, Genre::Fiction, 4.8, 100);
+    db.PushBack(Book{"Dostoevsky", "Idiot", 1869, Genre::Fiction, 4.6, 90});
+    db.EmplaceBack("Tolstoy", "Anna Karenina", 1878, Genre::Fiction, 4.7, 95);
+
+    EXPECT_EQ(first.author_id, 0);
+    EXPECT_EQ(db.back().author_id, 0);
+    EXPECT_EQ(db.GetBooks()[1].author_id, 1);
+    EXPECT_EQ(db.GetAuthors().Name(db.back().author_id), "Tolstoy"sv);
+
+    // Книга вне базы равна книге в базе, несмотря на идентификатор
+    EXPECT_EQ(db.back(), (Book{"Tolstoy", "Anna Karenina", 1878, Genre::Fiction, 4.7, 95}));
+}
+
+TEST(TestAuthorIds, DenseHistogram) {
+    BookDatabase<std::vector<Book>> db{{"B", "1", 1900, Genre::Fiction, 1.0, 1},
+                                       {"A", "2", 1900, Genre::Fiction, 1.0, 1},
+                                       {"B", "3", 1900, Genre::Fiction, 1.0, 1}};
+
+    auto histogram = buildAuthorHistogram(db);
+    EXPECT_EQ(histogram.authors, &db.GetAuthors());
+    EXPECT_EQ(histogram.counts, (std::vector<size_t>{2, 1}));
+
+    // Упорядоченная гистограмма получается из плотной подстановкой имён
+    auto flat = buildAuthorHistogramFlat(db);
+    EXPECT_EQ(flat.size(), 2);
+    EXPECT_EQ(flat.begin()->first, "A"sv);
+    EXPECT_EQ(flat["B"], 2);
+
+    std::stringstream output;
+    EXPECT_NO_THROW(std::print(output, "{}", histogram));
+}
+// ################ Идентификаторы авторов в базе ###################
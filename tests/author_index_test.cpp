@@ -0,0 +1,173 @@
+#include "author_dictionary.hpp"
+#include "author_index.hpp"
+#include "book.hpp"
+#include "book_database.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+using TestContainer = BookDatabase<std::deque<Book>>;
+
+namespace {
+
+std::vector<std::string_view> names(std::span<const AuthorIndex::Entry> entries) {
+    std::vector<std::string_view> result;
+    std::ranges::transform(entries, std::back_inserter(result), &AuthorIndex::Entry::name);
+    return result;
+}
+
+std::vector<std::string_view> titles(const std::vector<std::reference_wrapper<const Book>> &books) {
+    std::vector<std::string_view> result;
+    std::ranges::transform(books, std::back_inserter(result),
+                           [](const Book &book) -> std::string_view { return book.title; });
+    return result;
+}
+
+}  // namespace
+
+// ################ Индекс авторов ###################
+TEST(TestAuthorIndex, Lookups) {
+    AuthorDictionary authors;
+    for (auto name : {"Tolstoy", "Dostoevsky", "Tolkien", "Chekhov", "Toll", "Austen"}) {
+        authors.Add(name);
+    }
+    AuthorIndex index;
+    index.Sync(authors);
+    EXPECT_EQ(names(index.Authors()),
+              (std::vector<std::string_view>{"Austen", "Chekhov", "Dostoevsky", "Tolkien", "Toll", "Tolstoy"}));
+
+    EXPECT_EQ(names(index.Find("Tolkien")), (std::vector<std::string_view>{"Tolkien"}));
+    EXPECT_TRUE(index.Find("Tol").empty());
+    EXPECT_EQ(names(index.Prefix("Tol")), (std::vector<std::string_view>{"Tolkien", "Toll", "Tolstoy"}));
+    EXPECT_EQ(names(index.Prefix("Toll")), (std::vector<std::string_view>{"Toll"}));
+    EXPECT_TRUE(index.Prefix("Z").empty());
+    EXPECT_EQ(index.Prefix("").size(), authors.size());
+    EXPECT_EQ(names(index.Range("A", "D")), (std::vector<std::string_view>{"Austen", "Chekhov"}));
+    EXPECT_EQ(names(index.Range("Chekhov", "Tolkien")), (std::vector<std::string_view>{"Chekhov", "Dostoevsky"}));
+    EXPECT_TRUE(index.Range("D", "A").empty());
+
+    // Новые авторы сливаются с упорядоченными
+    authors.Add("Bulgakov");
+    authors.Add("Turgenev");
+    index.Sync(authors);
+    EXPECT_TRUE(std::ranges::is_sorted(names(index.Authors())));
+    EXPECT_EQ(names(index.Range("B", "C")), (std::vector<std::string_view>{"Bulgakov"}));
+    EXPECT_EQ(index.Find("Turgenev").front().id, 7);
+}
+
+TEST(TestAuthorIndex, Rows) {
+    AuthorIndex index;
+    index.Add(0, 1);
+    index.Add(3, 0);
+    index.Add(5, 1);
+    index.Add(2, 1);
+    EXPECT_TRUE(std::ranges::equal(index.Rows(1), std::vector<size_t>{0, 2, 5}));
+    index.Remove(2, 1);
+    index.Remove(4, 1);
+    EXPECT_TRUE(std::ranges::equal(index.Rows(1), std::vector<size_t>{0, 5}));
+    EXPECT_TRUE(index.Rows(7).empty());
+}
+
+class TestAuthorIndexBookDatabase : public ::testing::Test {
+protected:
+    void SetUp() override {
+        db.EmplaceBack("George Orwell", "1984", 1949, Genre::SciFi, 4., 190);
+        db.EmplaceBack("J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203);
+        db.EmplaceBack("George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156);
+        db.EmplaceBack("George Eliot", "Middlemarch", 1871, Genre::Fiction, 4.1, 80);
+        db.EmplaceBack("J.R.R. Tolkien", "The Lord of the Rings", 1954, Genre::Fiction, 4.9, 203);
+    }
+
+    TestContainer db;
+};
+
+TEST_F(TestAuthorIndexBookDatabase, GetBooksByAuthor) {
+    EXPECT_EQ(titles(db.GetBooksByAuthor("George Orwell")), (std::vector<std::string_view>{"1984", "Animal Farm"}));
+    EXPECT_TRUE(db.GetBooksByAuthor("George").empty());
+    EXPECT_EQ(titles(db.GetBooksByAuthorPrefix("George")),
+              (std::vector<std::string_view>{"1984", "Animal Farm", "Middlemarch"}));
+    EXPECT_EQ(titles(db.GetBooksByAuthorRange("H", "K")),
+              (std::vector<std::string_view>{"The Hobbit", "To Kill a Mockingbird", "The Lord of the Rings"}));
+    EXPECT_EQ(names(db.GetAuthorIndex().Prefix("J")), (std::vector<std::string_view>{"J.R.R. Tolkien"}));
+}
+
+TEST_F(TestAuthorIndexBookDatabase, ModifyAndCopy) {
+    db.Modify(0, [](Book &book) { book.author = "Harper Lee"; });
+    EXPECT_EQ(titles(db.GetBooksByAuthor("George Orwell")), (std::vector<std::string_view>{"Animal Farm"}));
+    EXPECT_EQ(titles(db.GetBooksByAuthor("Harper Lee")),
+              (std::vector<std::string_view>{"1984", "To Kill a Mockingbird"}));
+
+    // Копия ссылается на имена собственного словаря
+    TestContainer copy{db};
+    db.Clear();
+    copy.EmplaceBack("Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.3, 120);
+    EXPECT_EQ(names(copy.GetAuthorIndex().Range("A", "H")),
+              (std::vector<std::string_view>{"Aldous Huxley", "George Eliot", "George Orwell"}));
+    EXPECT_EQ(titles(copy.GetBooksByAuthorPrefix("Ald")), (std::vector<std::string_view>{"Brave New World"}));
+    EXPECT_TRUE(db.GetBooksByAuthorPrefix("").empty());
+    EXPECT_TRUE(db.GetAuthorIndex().empty());
+
+    // Изменяемый доступ через MutableRange(): списки перестраиваются при следующем обращении
+    std::ranges::reverse(copy.MutableRange());
+    EXPECT_EQ(titles(copy.GetBooksByAuthor("J.R.R. Tolkien")),
+              (std::vector<std::string_view>{"The Lord of the Rings", "The Hobbit"}));
+}
+
+TEST(TestAuthorIndexRandom, SameAsScan) {
+    TestContainer db;
+    std::mt19937 gen{42};
+    for (int i = 0; i < 5000; ++i) {
+        db.EmplaceBack("Author" + std::to_string(gen() % 700), "Title", 1900, Genre::Fiction, 4.0, 1);
+        if (i % 500 == 0) {
+            db.GetAuthorIndex();  // упорядочивание порциями
+        }
+    }
+    for (std::string_view prefix : {"Author1"sv, "Author55"sv, "Author699"sv, "Author7"sv, "B"sv}) {
+        std::vector<const Book *> expected;
+        for (const Book &book : db.GetBooks()) {
+            if (book.author.starts_with(prefix)) {
+                expected.push_back(&book);
+            }
+        }
+        auto books = db.GetBooksByAuthorPrefix(prefix);
+        ASSERT_EQ(books.size(), expected.size()) << prefix;
+        EXPECT_TRUE(std::ranges::equal(books, expected, {}, [](const Book &book) { return &book; }));
+    }
+}
+
+TEST(TestAuthorIndexRandom, ConcurrentReaders) {
+    // Новые авторы ещё не упорядочены: слияние запрашивают оба читателя, выполняет его только первый
+    TestContainer db;
+    for (int i = 0; i < 3000; ++i) {
+        db.EmplaceBack("Author" + std::to_string(i % 900), "Title", 1900, Genre::Fiction, 4.0, 1);
+    }
+    const TestContainer &reader = db;
+
+    std::vector<size_t> found(2);
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < found.size(); ++thread) {
+        threads.emplace_back([&, thread] {
+            for (int i = 0; i < 50; ++i) {
+                found[thread] += reader.GetBooksByAuthorPrefix("Author1").size();
+            }
+        });
+    }
+    std::ranges::for_each(threads, [](std::thread &thread) { thread.join(); });
+
+    const auto expected = static_cast<size_t>(std::ranges::count_if(
+        db.GetBooks(), [](const Book &book) { return book.author.starts_with("Author1"); }));
+    EXPECT_EQ(found[0], 50 * expected);
+    EXPECT_EQ(found[1], 50 * expected);
+    EXPECT_EQ(reader.GetAuthorIndex().Authors().size(), 900);
+    EXPECT_TRUE(std::ranges::is_sorted(names(reader.GetAuthorIndex().Authors())));
+}
+// ################ Индекс авторов ###################
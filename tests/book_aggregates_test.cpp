@@ -0,0 +1,166 @@
+#include "book.hpp"
+#include "book_aggregates.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+using TestContainer = bookdb::BookDatabase<std::deque<Book>>;
+
+namespace {
+
+// Агрегаты должны совпадать со сканирующими функциями с точностью до ошибки округления
+void expectSameAsScan(const TestContainer &db) {
+    const auto aggregated = calculateGenreRatings(db);
+    const auto scanned = calculateGenreRatings(db.cbegin(), db.cend());
+    ASSERT_EQ(aggregated.size(), scanned.size());
+    for (const auto &[genre, avg] : scanned) {
+        EXPECT_NEAR(aggregated.at(genre), avg, 1e-9);
+    }
+
+    EXPECT_NEAR(calculateAverageRating(db), calculateAverageRating(db.cbegin(), db.cend()), 1e-9);
+
+    TestContainer copy;
+    std::ranges::for_each(db.GetBooks(), [&](const Book &book) { copy.PushBack(book); });
+    EXPECT_EQ(buildAuthorHistogramFlat(db), buildAuthorHistogramFlat(copy));
+}
+
+}  // namespace
+
+// ################ Материализованные агрегаты ###################
+TEST(TestBookAggregates, AddRemove) {
+    BookAggregates aggregates;
+    Book book{"Author", "Title", 2000, Genre::SciFi, 4.0, 1};
+    book.author_id = 2;
+
+    aggregates.Add(book);
+    aggregates.Add(book);
+    EXPECT_EQ(aggregates.ByGenre(Genre::SciFi).count, 2);
+    EXPECT_DOUBLE_EQ(aggregates.Total().Avg(), 4.0);
+    EXPECT_EQ(aggregates.AuthorCounts().size(), 3);
+    EXPECT_EQ(aggregates.AuthorCounts()[2], 2);
+
+    aggregates.Remove(book);
+    EXPECT_EQ(aggregates.ByGenre(Genre::SciFi).count, 1);
+    EXPECT_EQ(aggregates.AuthorCounts()[2], 1);
+    EXPECT_EQ(aggregates.ByGenre(Genre::Fiction).Avg(), 0.0);
+}
+
+class TestAggregatedBookDatabase : public ::testing::Test {
+protected:
+    void SetUp() override {
+        db.EnableAggregates();
+        for (size_t i = 0; i < 1000; ++i) {
+            AddRandomBook();
+        }
+    }
+
+    void AddRandomBook() {
+        db.EmplaceBack("Author" + std::to_string(gen() % 50), "Title", 1800 + static_cast<int>(gen() % 220),
+                       static_cast<Genre>(gen() % kGenreCount), static_cast<double>(gen() % 50) / 10.0,
+                       static_cast<int>(gen() % 1000));
+    }
+
+    std::mt19937 gen{42};
+    TestContainer db;
+};
+
+TEST_F(TestAggregatedBookDatabase, InsertsMatchScan) {
+    EXPECT_TRUE(db.HasAggregates());
+    EXPECT_EQ(db.GetAggregates()->Total().count, db.size());
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, ModifyMatchesScan) {
+    // Случайные изменения жанра, рейтинга и автора
+    for (size_t i = 0; i < 500; ++i) {
+        const size_t row = gen() % db.size();
+        const auto author = "Author" + std::to_string(gen() % 60);
+        db.Modify(row, [&](Book &book) {
+            book.genre = static_cast<Genre>(gen() % kGenreCount);
+            book.rating = static_cast<double>(gen() % 50) / 10.0;
+            book.author = author;
+        });
+    }
+    expectSameAsScan(db);
+
+    // Автор указывает на имя в словаре базы, а не на временную строку
+    EXPECT_EQ(db[0].author.data(), db.GetAuthors().Name(db[0].author_id).data());
+}
+
+TEST_F(TestAggregatedBookDatabase, LongModifySeriesDoesNotDrift) {
+    // Сотни тысяч вычитаний и добавлений: суммы совпадают с посчитанными заново до последних битов
+    for (size_t i = 0; i < 200000; ++i) {
+        db.Modify(gen() % db.size(), [&](Book &book) {
+            book.genre = static_cast<Genre>(gen() % kGenreCount);
+            book.rating = static_cast<double>(gen() % 50) / 10.0 + static_cast<double>(gen() % 1000) * 1e-7;
+        });
+    }
+
+    BookAggregates rebuilt;
+    std::ranges::for_each(db.GetBooks(), [&](const Book &book) { rebuilt.Add(book); });
+    const auto *aggregates = db.GetAggregates();
+    EXPECT_EQ(aggregates->Total().count, rebuilt.Total().count);
+    EXPECT_DOUBLE_EQ(aggregates->Total().sum, rebuilt.Total().sum);
+    for (size_t genre = 0; genre < kGenreCount; ++genre) {
+        EXPECT_DOUBLE_EQ(aggregates->ByGenre(static_cast<Genre>(genre)).sum,
+                         rebuilt.ByGenre(static_cast<Genre>(genre)).sum);
+    }
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, ReplaceMatchesScan) {
+    db.Replace(3, Book{"Replaced", "New title", 1999, Genre::Biography, 5.0, 1});
+    EXPECT_EQ(db[3].title, "New title");
+    EXPECT_EQ(buildAuthorHistogramFlat(db).at("Replaced"), 1);
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, MutableIteratorsRecompute) {
+    {
+        auto books = db.MutableRange();
+        std::ranges::sort(books, comp::LessByRating{});
+        books.begin()->genre = Genre::Mystery;
+    }
+    AddRandomBook();
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, ModifyThrows) {
+    EXPECT_THROW(db.Modify(0,
+                           [](Book &book) {
+                               book.rating = 100.0;
+                               throw std::runtime_error{"error"};
+                           }),
+                 std::runtime_error);
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, ClearAndCopy) {
+    TestContainer copy{db};
+    EXPECT_TRUE(copy.HasAggregates());
+    expectSameAsScan(copy);
+
+    db.Clear();
+    EXPECT_EQ(db.GetAggregates()->Total().count, 0);
+    EXPECT_TRUE(calculateGenreRatings(db).empty());
+    AddRandomBook();
+    expectSameAsScan(db);
+}
+
+TEST_F(TestAggregatedBookDatabase, Disable) {
+    db.DisableAggregates();
+    EXPECT_EQ(db.GetAggregates(), nullptr);
+    db.Modify(0, [](Book &book) { book.rating = 0.0; });
+    expectSameAsScan(db);
+}
+// ################ Материализованные агрегаты ###################
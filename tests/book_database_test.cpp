@@ -121,7 +121,8 @@ TEST_F(TestBookDataBase, PushBack) {
 }
 
 TEST_F(TestBookDataBase, Iterator) {
-    EXPECT_EQ(std::distance<TestContainer::iterator>(db.begin(), db.end()), db.size());
+    auto books = db.MutableRange();
+    EXPECT_EQ(std::distance<TestContainer::iterator>(books.begin(), books.end()), db.size());
 }
 
 TEST_F(TestBookDataBase, Const_iterator) {
@@ -129,7 +130,8 @@ TEST_F(TestBookDataBase, Const_iterator) {
 }
 
 TEST_F(TestBookDataBase, Reverse_iterator) {
-    EXPECT_EQ(std::distance<TestContainer::reverse_iterator>(db.rbegin(), db.rend()), db.size());
+    auto books = db.MutableRange();
+    EXPECT_EQ(std::distance<TestContainer::reverse_iterator>(books.rbegin(), books.rend()), db.size());
 }
 
 TEST_F(TestBookDataBase, Const_reverse_iterator) {
@@ -0,0 +1,179 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "book_snapshot.hpp"
+#include "columnar_book_database.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+namespace {
+
+const std::vector<Book> snapshot_books{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120},
+    {"Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156},
+    {"Jane Austen", "Pride and Prejudice", 1813, Genre::Fiction, 4.7, 178},
+    {"J.D. Salinger", "The Catcher in the Rye", 1951, Genre::Fiction, 4.3, 112},
+    {"Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.5, 98},
+    {"Charlotte Brontë", "Jane Eyre", 1847, Genre::Fiction, 4.6, 110},
+    {"J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203},
+    {"William Golding", "", 1954, Genre::Mystery, 4.2, 89}};
+
+}  // namespace
+
+class TestBookSnapshot : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = std::filesystem::temp_directory_path() /
+               ("bookdb_snapshot_" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()});
+        std::ranges::for_each(snapshot_books, [&](const Book &book) { columns.PushBack(book); });
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    SnapshotHeader ReadHeader() const {
+        SnapshotHeader header{};
+        std::ifstream file{path, std::ios::binary};
+        file.read(reinterpret_cast<char *>(&header), sizeof(header));
+        return header;
+    }
+
+    // Записывает value поверх байт снимка, начиная с offset
+    template <typename T>
+    void Overwrite(uint64_t offset, T value) const {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    std::filesystem::path path;
+    ColumnarBookDatabase columns;
+};
+
+// ################ Снимок базы ###################
+TEST_F(TestBookSnapshot, RoundTripColumnar) {
+    saveSnapshot(columns, path);
+    const auto snapshot = BookSnapshot::Open(path);
+
+    ASSERT_EQ(snapshot.size(), columns.size());
+    EXPECT_EQ(snapshot.AuthorCount(), columns.AuthorCount());
+    for (size_t row = 0; row < snapshot.size(); ++row) {
+        EXPECT_EQ(snapshot.GetBook(row), snapshot_books[row]);
+        EXPECT_EQ(snapshot.AuthorIds()[row], columns.AuthorIds()[row]);
+    }
+    EXPECT_EQ(snapshot.Title(9), ""sv);
+}
+
+TEST_F(TestBookSnapshot, RoundTripBookDatabase) {
+    BookDatabase<> db;
+    std::ranges::for_each(snapshot_books, [&](const Book &book) { db.PushBack(book); });
+    saveSnapshot(db, path);
+
+    const auto snapshot = BookSnapshot::Open(path);
+    ASSERT_EQ(snapshot.size(), db.size());
+    EXPECT_EQ(snapshot.AuthorCount(), db.GetAuthors().size());
+    for (size_t row = 0; row < snapshot.size(); ++row) {
+        EXPECT_EQ(snapshot.GetBook(row), db[row]);
+    }
+}
+
+TEST_F(TestBookSnapshot, QueriesMatchColumnar) {
+    saveSnapshot(columns, path);
+    const auto snapshot = BookSnapshot::Open(path);
+
+    EXPECT_EQ(buildAuthorHistogramFlat(snapshot), buildAuthorHistogramFlat(columns));
+    EXPECT_EQ(calculateGenreRatings(snapshot), calculateGenreRatings(columns));
+    EXPECT_DOUBLE_EQ(calculateAverageRating(snapshot), calculateAverageRating(columns));
+
+    auto filter = all_of(YearBetween(1900, 1950), RatingAbove(4.4));
+    EXPECT_EQ(filterBooks(snapshot, filter), filterBooks(columns, filter));
+
+    EXPECT_EQ(getTopNBy(snapshot, 3, comp::LessByRating{}), getTopNBy(columns, 3, comp::LessByRating{}));
+    EXPECT_EQ(getTopNBy(snapshot, 3, comp::LessByRating{}), (std::vector<size_t>{8, 3, 4}));
+}
+
+TEST_F(TestBookSnapshot, EmptyDatabase) {
+    saveSnapshot(ColumnarBookDatabase{}, path);
+    const auto snapshot = BookSnapshot::Open(path);
+    EXPECT_TRUE(snapshot.empty());
+    EXPECT_EQ(snapshot.AuthorCount(), 0);
+    EXPECT_DOUBLE_EQ(calculateAverageRating(snapshot), 0.0);
+}
+
+TEST_F(TestBookSnapshot, MoveKeepsMapping) {
+    saveSnapshot(columns, path);
+    auto snapshot = BookSnapshot::Open(path);
+    BookSnapshot moved{std::move(snapshot)};
+    EXPECT_EQ(moved.Author(0), "George Orwell"sv);
+
+    saveSnapshot(ColumnarBookDatabase{}, path);
+    moved = BookSnapshot::Open(path);
+    EXPECT_TRUE(moved.empty());
+}
+
+TEST_F(TestBookSnapshot, MissingFile) { EXPECT_THROW(BookSnapshot::Open(path), std::system_error); }
+// ################ Снимок базы ###################
+
+// ################ Некорректные входные данные ###################
+TEST_F(TestBookSnapshot, BadMagic) {
+    saveSnapshot(columns, path);
+    {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.write("NOTABOOK", 8);
+    }
+    EXPECT_THROW(BookSnapshot::Open(path), std::runtime_error);
+}
+
+TEST_F(TestBookSnapshot, Truncated) {
+    saveSnapshot(columns, path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    EXPECT_THROW(BookSnapshot::Open(path), std::runtime_error);
+
+    std::filesystem::resize_file(path, 10);
+    EXPECT_THROW(BookSnapshot::Open(path), std::runtime_error);
+}
+
+TEST_F(TestBookSnapshot, OpenChecksOffsetBounds) {
+    saveSnapshot(columns, path);
+    Overwrite(ReadHeader().title_offsets.offset, uint64_t{1});
+    EXPECT_THROW(BookSnapshot::Open(path), std::runtime_error);
+}
+
+TEST_F(TestBookSnapshot, VerifyRejectsCorruptedColumns) {
+    saveSnapshot(columns, path);
+    const auto header = ReadHeader();
+    EXPECT_NO_THROW(BookSnapshot::Open(path).Verify());
+
+    // Смещение второго заголовка больше длины кучи, а крайние остаются верными: Open этого не замечает
+    Overwrite(header.title_offsets.offset + sizeof(uint64_t), header.title_heap.size + 1);
+    EXPECT_THROW(BookSnapshot::Open(path).Verify(), std::runtime_error);
+
+    saveSnapshot(columns, path);
+    Overwrite(header.author_ids.offset, static_cast<AuthorId>(header.author_count));
+    EXPECT_THROW(BookSnapshot::Open(path).Verify(), std::runtime_error);
+}
+
+TEST_F(TestBookSnapshot, CorruptedGenre) {
+    saveSnapshot(columns, path);
+    Overwrite(ReadHeader().genres.offset, uint8_t{0xff});
+
+    const auto snapshot = BookSnapshot::Open(path);
+    EXPECT_THROW(snapshot.Verify(), std::runtime_error);
+
+    // Без Verify неизвестный жанр учитывается как Unknown, а не пишется за границу массива
+    const auto ratings = calculateGenreRatings(snapshot);
+    EXPECT_DOUBLE_EQ(ratings.at(Genre::Unknown), snapshot_books[0].rating);
+}
+// ################ Некорректные входные данные ###################
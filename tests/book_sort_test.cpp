@@ -0,0 +1,119 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "book_sort.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста.
+// Среди имён есть не-ASCII и общий префикс, чтобы ранги авторов совпадали с посимвольным сравнением
+const std::vector<std::string> &sortAuthorNames() {
+    static const std::vector<std::string> names{"George Orwell", "Charlotte Brontë", "Charlotte Bronte", "Émile Zola",
+                                                "Aldous Huxley", "Aldous",           "",                 "Jane Austen"};
+    return names;
+}
+
+// Много совпадающих ключей, отрицательные годы и рейтинги, -0.0 рядом с 0.0
+template <typename Db>
+Db makeSortDatabase(size_t count) {
+    std::mt19937 gen{7};
+    const std::vector<double> ratings{4.5, -1.25, 0., -0., 3., 4.5000001, -1e300, 1e-300};
+    Db db;
+    for (size_t row = 0; row < count; ++row) {
+        db.EmplaceBack(sortAuthorNames()[gen() % sortAuthorNames().size()], "Title" + std::to_string(row),
+                       static_cast<int>(gen() % 300) - 100, static_cast<Genre>(gen() % kGenreCount),
+                       ratings[gen() % ratings.size()], static_cast<int>(gen() % 50) - 10);
+    }
+    return db;
+}
+
+template <typename Db, typename Comp>
+std::vector<size_t> stableRows(const Db &db, Comp comp) {
+    std::vector<size_t> rows(db.size());
+    std::iota(rows.begin(), rows.end(), size_t{0});
+    std::ranges::stable_sort(rows, [&](size_t lhs, size_t rhs) { return comp(db[lhs], db[rhs]); });
+    return rows;
+}
+
+}  // namespace
+
+// ################ Сортировка перестановки ###################
+template <typename Container>
+class TestBookSort : public ::testing::Test {};
+
+using SortContainers = ::testing::Types<std::vector<Book>, std::deque<Book>>;
+TYPED_TEST_SUITE(TestBookSort, SortContainers);
+
+TYPED_TEST(TestBookSort, RowsMatchStableSort) {
+    const auto db = makeSortDatabase<BookDatabase<TypeParam>>(3000);
+    EXPECT_EQ(sortedRows(db, comp::LessByRating{}), stableRows(db, comp::LessByRating{}));
+    EXPECT_EQ(sortedRows(db, comp::LessByPopularity{}), stableRows(db, comp::LessByPopularity{}));
+    EXPECT_EQ(sortedRows(db, comp::LessByYear{}), stableRows(db, comp::LessByYear{}));
+    EXPECT_EQ(sortedRows(db, comp::LessByAuthor{}), stableRows(db, comp::LessByAuthor{}));
+
+    // Компаратор без поразрядного ключа сортируется сравнениями
+    auto by_title = [](const Book &lhs, const Book &rhs) { return lhs.title < rhs.title; };
+    EXPECT_EQ(sortedRows(db, by_title), stableRows(db, by_title));
+}
+
+TYPED_TEST(TestBookSort, SortBooksInPlace) {
+    auto db = makeSortDatabase<BookDatabase<TypeParam>>(1000);
+    std::vector<Book> expected(db.cbegin(), db.cend());
+    std::ranges::stable_sort(expected, comp::LessByAuthor{});
+
+    sortBooks(db, comp::LessByAuthor{});
+    EXPECT_TRUE(std::ranges::equal(db.GetBooks(), expected));
+
+    // Индексы и агрегаты перестраиваются по новому порядку строк
+    const auto orwell = db.GetBooksByAuthor("George Orwell");
+    EXPECT_EQ(orwell.size(), std::ranges::count(expected, std::string_view{"George Orwell"}, &Book::author));
+    EXPECT_TRUE(std::ranges::all_of(orwell, [](const Book &book) { return book.author == "George Orwell"; }));
+    EXPECT_EQ(filterBooks(db, YearBetween(0, 50)).size(),
+              static_cast<size_t>(std::ranges::count_if(expected, YearBetween(0, 50))));
+}
+
+TEST(TestBookSortEdgeCases, EmptyAndSingle) {
+    BookDatabase<> db;
+    EXPECT_TRUE(sortedRows(db, comp::LessByRating{}).empty());
+    sortBooks(db, comp::LessByAuthor{});
+    EXPECT_TRUE(db.empty());
+
+    db.EmplaceBack("George Orwell", "1984", 1949, Genre::SciFi, 4., 190);
+    EXPECT_EQ(sortedRows(db, comp::LessByPopularity{}), std::vector<size_t>{0});
+}
+
+TEST(TestBookSortEdgeCases, ExtremeKeys) {
+    BookDatabase<> db;
+    db.EmplaceBack("A", "max", 2000, Genre::SciFi, 1e308, std::numeric_limits<int>::max());
+    db.EmplaceBack("A", "min", 2000, Genre::SciFi, -1e308, std::numeric_limits<int>::min());
+    db.EmplaceBack("A", "zero", 2000, Genre::SciFi, 0., 0);
+    EXPECT_EQ(sortedRows(db, comp::LessByRating{}), (std::vector<size_t>{0, 2, 1}));
+    EXPECT_EQ(sortedRows(db, comp::LessByPopularity{}), (std::vector<size_t>{0, 2, 1}));
+}
+
+TEST(TestBookSortEdgeCases, ApplyPermutation) {
+    auto db = makeSortDatabase<BookDatabase<>>(5);
+    const std::vector<Book> before(db.cbegin(), db.cend());
+    const std::vector<size_t> rows{3, 0, 4, 1, 2};
+    applyPermutation(db, rows);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(db[i], before[rows[i]]);
+    }
+
+    EXPECT_THROW(applyPermutation(db, std::vector<size_t>{0, 1, 2}), std::invalid_argument);
+    EXPECT_THROW(applyPermutation(db, std::vector<size_t>{0, 1, 2, 3, 3}), std::invalid_argument);
+    EXPECT_THROW(applyPermutation(db, std::vector<size_t>{0, 1, 2, 3, 5}), std::invalid_argument);
+}
+// ################ Сортировка перестановки ###################
@@ -0,0 +1,169 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "book_view.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+
+using TestContainer = BookDatabase<std::deque<Book>>;
+
+static_assert(std::ranges::view<FilterView<std::deque<Book>, HeapMemoryPolicy, RatingFilter>>);
+static_assert(std::ranges::forward_range<FilterView<std::deque<Book>, HeapMemoryPolicy, RatingFilter>>);
+
+namespace {
+
+bool sameBooks(const std::vector<std::reference_wrapper<const Book>> &lhs,
+               const std::vector<std::reference_wrapper<const Book>> &rhs) {
+    return std::ranges::equal(lhs, rhs, [](const Book &l, const Book &r) { return &l == &r; });
+}
+
+}  // namespace
+
+// ################ Ленивые представления ###################
+class TestFilterView : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < 3 * ZoneMap::kZoneRows + 100; ++i) {
+            db.EmplaceBack("Author" + std::to_string(gen() % 50), "Title" + std::to_string(i),
+                           1800 + static_cast<int>(i / 100), static_cast<Genre>(gen() % kGenreCount),
+                           static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000));
+        }
+        db.GetZoneMap().ResetCounters();
+    }
+
+    TestContainer db;
+};
+
+TEST_F(TestFilterView, SameAsFilterBooks) {
+    auto pred = all_of(GenreIs("SciFi"), RatingAbove(2.5));
+    std::vector<std::reference_wrapper<const Book>> viewed;
+    std::ranges::copy(filterView(db, pred), std::back_inserter(viewed));
+    EXPECT_TRUE(sameBooks(viewed, filterBooks(db.cbegin(), db.cend(), pred)));
+
+    // Пропуск зон по метаданным
+    std::vector<std::reference_wrapper<const Book>> years;
+    std::ranges::copy(filterView(db, YearBetween(1850, 1860)), std::back_inserter(years));
+    EXPECT_TRUE(sameBooks(years, filterBooks(db.cbegin(), db.cend(), YearBetween(1850, 1860))));
+
+    // Собственная лямбда проверяется построчно
+    auto odd = [](const Book &book) { return book.read_count % 2 == 1; };
+    std::vector<std::reference_wrapper<const Book>> odd_books;
+    std::ranges::copy(filterView(db, odd), std::back_inserter(odd_books));
+    EXPECT_TRUE(sameBooks(odd_books, filterBooks(db.cbegin(), db.cend(), odd)));
+
+    EXPECT_TRUE(std::ranges::empty(filterView(db, YearBetween(2000, 2100))));
+    EXPECT_TRUE(std::ranges::empty(filterView(TestContainer{}, RatingAbove(0.0))));
+}
+
+TEST_F(TestFilterView, ChainedViews) {
+    auto titles = filterView(db, GenreIs("Mystery")) |
+                  std::views::filter([](const Book &book) { return book.rating > 4.0; }) |
+                  std::views::transform([](const Book &book) { return std::string{book.title}; }) |
+                  std::views::take(5);
+
+    std::vector<std::string> expected;
+    for (const Book &book : db.GetBooks()) {
+        if (book.genre == Genre::Mystery && book.rating > 4.0 && expected.size() < 5) {
+            expected.emplace_back(book.title);
+        }
+    }
+    std::vector<std::string> viewed;
+    std::ranges::copy(titles, std::back_inserter(viewed));
+    EXPECT_EQ(viewed, expected);
+}
+
+TEST_F(TestFilterView, TakeStopsEarly) {
+    auto first = filterView(db, RatingAbove(1.0)) | std::views::take(3);
+    EXPECT_EQ(std::ranges::distance(first), 3);
+
+    // Все подходящие книги нашлись в первой зоне, остальные не проверялись
+    const auto counters = db.GetZoneMap().GetCounters();
+    EXPECT_EQ(counters.skipped + counters.scanned + counters.full, 1);
+}
+
+TEST_F(TestFilterView, CursorPagination) {
+    auto view = filterView(db, GenreIs("Fiction"));
+    auto all = filterBooks(db.cbegin(), db.cend(), GenreIs("Fiction"));
+
+    std::vector<std::reference_wrapper<const Book>> paged;
+    std::optional<size_t> cursor = 0;
+    size_t pages = 0;
+    while (cursor) {
+        auto page = view.Page(*cursor, 100);
+        EXPECT_LE(page.books.size(), 100);
+        paged.insert(paged.end(), page.books.begin(), page.books.end());
+        cursor = page.next;
+        ++pages;
+    }
+    EXPECT_TRUE(sameBooks(paged, all));
+    EXPECT_EQ(pages, (all.size() + 99) / 100);
+}
+
+TEST_F(TestFilterView, OffsetPagination) {
+    auto view = filterView(db, GenreIs("Fiction"));
+    auto all = filterBooks(db.cbegin(), db.cend(), GenreIs("Fiction"));
+
+    auto page = view.PageAt(20, 10);
+    ASSERT_EQ(page.books.size(), 10);
+    EXPECT_EQ(&page.books.front().get(), &all[20].get());
+    EXPECT_EQ(&page.books.back().get(), &all[29].get());
+    ASSERT_TRUE(page.next);
+    EXPECT_EQ(&db.GetBooks()[*page.next], &all[30].get());
+
+    EXPECT_TRUE(view.PageAt(all.size(), 10).books.empty());
+    EXPECT_FALSE(view.PageAt(all.size() - 5, 10).next);
+    EXPECT_EQ(view.PageAt(all.size() - 5, 10).books.size(), 5);
+}
+
+TEST_F(TestFilterView, Statistics) {
+    auto pred = YearBetween(1810, 1850);
+    auto matched = filterBooks(db.cbegin(), db.cend(), pred);
+    std::vector<Book> books(matched.begin(), matched.end());
+
+    auto ratings = calculateGenreRatings(filterView(db, pred));
+    auto expected = calculateGenreRatings(books.cbegin(), books.cend());
+    ASSERT_EQ(ratings.size(), expected.size());
+    for (const auto &[genre, avg] : expected) {
+        EXPECT_NEAR(ratings.at(genre), avg, 1e-9);
+    }
+    EXPECT_NEAR(calculateAverageRating(filterView(db, pred)), calculateAverageRating(books.cbegin(), books.cend()),
+                1e-9);
+    EXPECT_EQ(calculateAverageRating(filterView(db, YearBetween(2000, 2100))), 0.0);
+}
+
+TEST_F(TestFilterView, TopN) {
+    auto pred = GenreIs("SciFi");
+    auto top = getTopNBy(filterView(db, pred), 10, comp::LessByRating{});
+    auto matched = filterBooks(db.cbegin(), db.cend(), pred);
+    std::vector<Book> books(matched.begin(), matched.end());
+    auto expected = getTopNBy(books.cbegin(), books.cend(), 10, comp::LessByRating{});
+
+    ASSERT_EQ(top.size(), expected.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        EXPECT_EQ(top[i].get().title, expected[i].get().title);
+    }
+    EXPECT_TRUE(getTopNBy(filterView(db, pred), 0, comp::LessByRating{}).empty());
+}
+
+TEST_F(TestFilterView, AssignWithCapturingLambda) {
+    const auto above = [](double rating) { return [rating](const Book &book) { return book.rating > rating; }; };
+    auto view = filterView(db, above(4.0));
+    const auto other = filterView(db, above(2.0));
+
+    view = other;
+    EXPECT_EQ(std::ranges::distance(view), std::ranges::count_if(db.cbegin(), db.cend(), above(2.0)));
+
+    view = filterView(db, above(4.5));
+    EXPECT_EQ(std::ranges::distance(view), std::ranges::count_if(db.cbegin(), db.cend(), above(4.5)));
+}
+// ################ Ленивые представления ###################
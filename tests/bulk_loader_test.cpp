@@ -0,0 +1,142 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "bulk_loader.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+namespace {
+
+const std::vector<Book> loader_books{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120},
+    {"Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156},
+    {"Jane Austen", "Pride and Prejudice", 1813, Genre::NonFiction, 4.7, 178},
+    {"J.D. Salinger", "The Catcher in the Rye", 1951, Genre::Mystery, 4.3, 112},
+    {"Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.5, 98},
+    {"Charlotte Brontë", "Jane Eyre", 1847, Genre::Biography, 4.6, 110},
+    {"J.R.R. Tolkien", "The Hobbit", 1937, Genre::Unknown, 4.9, 203},
+    {"William Golding", "Lord of the Flies", 1954, Genre::Fiction, 4.2, 89}};
+
+std::string toText(const std::vector<Book> &books, char delimiter, std::string_view eol = "\n") {
+    std::string text;
+    for (const auto &book : books) {
+        text += std::format("{1}{0}{2}{0}{3}{0}{4}{0}{5}{0}{6}{7}", delimiter, book.author,
+                            std::string_view{book.title}, book.year, ConvertGenre(book.genre), book.rating,
+                            book.read_count, eol);
+    }
+    return text;
+}
+
+}  // namespace
+
+class TestBulkLoader : public ::testing::TestWithParam<size_t> {
+protected:
+    ThreadPool pool{GetParam()};
+};
+
+// ################ Массовая загрузка ###################
+TEST_P(TestBulkLoader, Csv) {
+    BookDatabase<> db;
+    const auto stats = loadBooksFromBuffer(db, toText(loader_books, ','), pool);
+
+    EXPECT_EQ(stats.rows, loader_books.size());
+    EXPECT_EQ(stats.malformed, 0);
+    EXPECT_TRUE(std::ranges::equal(db, loader_books));
+    EXPECT_EQ(db.GetAuthors().size(), 9);
+}
+
+TEST_P(TestBulkLoader, TsvWithHeaderAndCrLf) {
+    BookDatabase<> db;
+    LoadOptions options{.delimiter = '\t', .skip_header = true};
+    const auto text = "author\ttitle\tyear\tgenre\trating\tread_count\r\n" + toText(loader_books, '\t', "\r\n");
+    const auto stats = loadBooksFromBuffer(db, text, pool, options);
+
+    EXPECT_EQ(stats.rows, loader_books.size());
+    EXPECT_EQ(stats.malformed, 0);
+    EXPECT_TRUE(std::ranges::equal(db, loader_books));
+}
+
+TEST_P(TestBulkLoader, SmallChunksKeepOrderAndAuthors) {
+    // Много кусков: каждый со своим локальным словарём авторов
+    BookDatabase<> db;
+    LoadOptions options{.chunk_bytes = 16};
+    loadBooksFromBuffer(db, toText(loader_books, ','), pool, options);
+
+    EXPECT_TRUE(std::ranges::equal(db, loader_books));
+    EXPECT_EQ(db[0].author_id, db[1].author_id);
+    EXPECT_EQ(db.GetAuthors().size(), 9);
+    EXPECT_EQ(buildAuthorHistogramFlat(db).at("George Orwell"), 2);
+}
+
+TEST_P(TestBulkLoader, MalformedRows) {
+    BookDatabase<> db;
+    const std::string text = "A,T,1999,Fiction,4.5,10\n"
+                             "\n"
+                             "A,T,19x9,Fiction,4.5,10\n"   // год не число
+                             "A,T,1999,Poetry,4.5,10\n"    // неизвестный жанр
+                             "A,T,1999,Fiction,4.5\n"      // не хватает поля
+                             "A,T,1999,Fiction,4.5,10,7\n" // лишнее поле
+                             "A,T,1999,Fiction,,10\n"      // пустой рейтинг
+                             "B,T,2000,SciFi,3,1";         // последняя строка без перевода строки
+    const auto stats = loadBooksFromBuffer(db, text, pool);
+
+    EXPECT_EQ(stats.rows, 2);
+    EXPECT_EQ(stats.malformed, 5);
+    EXPECT_EQ(stats.bytes, text.size());
+    ASSERT_EQ(db.size(), 2);
+    EXPECT_EQ(db[1], (Book{"B", "T", 2000, Genre::SciFi, 3., 1}));
+}
+
+TEST_P(TestBulkLoader, AppendsAndUpdatesIndexes) {
+    BookDatabase<> db{loader_books.front()};
+    db.CreateIndex(IndexedField::Year);
+    loadBooksFromBuffer(db, toText(loader_books, ','), pool);
+
+    EXPECT_EQ(db.size(), loader_books.size() + 1);
+    EXPECT_EQ(db.GetAuthors().size(), 9);
+    EXPECT_EQ(db.GetYearIndex()->size(), db.size());
+    EXPECT_EQ(filterBooks(std::as_const(db), YearBetween(1949, 1950)).size(), 2);
+}
+
+TEST_P(TestBulkLoader, File) {
+    const auto path = std::filesystem::temp_directory_path() / "bookdb_bulk_loader_test.csv";
+    std::ofstream{path} << toText(loader_books, ',');
+
+    BookDatabase<std::deque<Book>> db;
+    const auto stats = loadBooks(db, path, pool);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(stats.rows, loader_books.size());
+    EXPECT_TRUE(std::ranges::equal(db, loader_books));
+    EXPECT_GT(stats.RowsPerSecond(), 0);
+}
+
+TEST_P(TestBulkLoader, EmptyInput) {
+    BookDatabase<> db;
+    const auto stats = loadBooksFromBuffer(db, "", pool);
+    EXPECT_EQ(stats.rows, 0);
+    EXPECT_TRUE(db.empty());
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, TestBulkLoader, ::testing::Values(1, 4));
+// ################ Массовая загрузка ###################
+
+// ################ Некорректные входные данные ###################
+TEST(TestBulkLoaderIncorrect, MissingFile) {
+    ThreadPool pool{1};
+    BookDatabase<> db;
+    EXPECT_THROW(loadBooks(db, "/nonexistent/books.csv", pool), std::system_error);
+}
+// ################ Некорректные входные данные ###################
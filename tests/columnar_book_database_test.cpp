@@ -0,0 +1,108 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "columnar_book_database.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+using namespace std::literals;
+
+const std::initializer_list<Book> books_list{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120},
+    {"Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156},
+    {"Jane Austen", "Pride and Prejudice", 1813, Genre::Fiction, 4.7, 178},
+    {"J.D. Salinger", "The Catcher in the Rye", 1951, Genre::Fiction, 4.3, 112},
+    {"Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.5, 98},
+    {"Charlotte Brontë", "Jane Eyre", 1847, Genre::Fiction, 4.6, 110},
+    {"J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203},
+    {"William Golding", "Lord of the Flies", 1954, Genre::Fiction, 4.2, 89}};
+
+class TestColumnarBookDatabase : public ::testing::Test {
+protected:
+    ColumnarBookDatabase columns{books_list};
+    BookDatabase<std::vector<Book>> rows{books_list};
+};
+
+// ################ Тесты колоночного хранилища ###################
+TEST(TestEmptyColumnarBookDatabase, Empty) {
+    ColumnarBookDatabase db;
+    EXPECT_TRUE(db.empty());
+    EXPECT_EQ(db.size(), 0);
+    EXPECT_EQ(db.AuthorCount(), 0);
+    EXPECT_TRUE(buildAuthorHistogramFlat(db).empty());
+    EXPECT_TRUE(calculateGenreRatings(db).empty());
+    EXPECT_DOUBLE_EQ(calculateAverageRating(db), 0.0);
+}
+
+TEST_F(TestColumnarBookDatabase, SizeAndAuthors) {
+    EXPECT_EQ(columns.size(), 10);
+    EXPECT_EQ(columns.AuthorCount(), 9);
+    EXPECT_EQ(columns.AuthorIds()[0], columns.AuthorIds()[1]);
+}
+
+TEST_F(TestColumnarBookDatabase, GetBook) {
+    // Книга, собранная из колонок, совпадает с исходной
+    std::vector<Book> example{books_list};
+    for (size_t row = 0; row < example.size(); ++row) {
+        EXPECT_EQ(columns.GetBook(row), example[row]);
+        EXPECT_EQ(columns.Title(row), example[row].title);
+    }
+}
+
+TEST_F(TestColumnarBookDatabase, EmplaceBackAndClear) {
+    columns.EmplaceBack("Author", "Title", 1999, Genre::Biography, 0.1, 1);
+    columns.PushBack(Book{"Author", "Other title", 2000, Genre::Mystery, 0.2, 2});
+    EXPECT_EQ(columns.size(), 12);
+    EXPECT_EQ(columns.AuthorCount(), 10);
+    EXPECT_EQ(columns.Title(11), "Other title"sv);
+
+    columns.Clear();
+    EXPECT_TRUE(columns.empty());
+    EXPECT_EQ(columns.AuthorCount(), 0);
+}
+
+TEST_F(TestColumnarBookDatabase, SameStatisticsAsRowStorage) {
+    // Сканирование колонок должно давать тот же результат, что и обход книг
+    EXPECT_EQ(buildAuthorHistogramFlat(columns), buildAuthorHistogramFlat(rows));
+    EXPECT_EQ(calculateGenreRatings(columns), calculateGenreRatings(rows.begin(), rows.end()));
+    EXPECT_DOUBLE_EQ(calculateAverageRating(columns), calculateAverageRating(rows.begin(), rows.end()));
+}
+
+TEST_F(TestColumnarBookDatabase, FilterBooks) {
+    auto pred = any_of(GenreIs("SciFi"), all_of(YearBetween(1900, 1999), RatingAbove(4.5)));
+
+    auto filtered_rows = filterBooks(columns, pred);
+    auto expected = filterBooks(rows.begin(), rows.end(), pred);
+
+    ASSERT_EQ(filtered_rows.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(columns.GetBook(filtered_rows[i]), expected[i].get());
+    }
+}
+
+TEST_F(TestColumnarBookDatabase, TopN) {
+    const auto top = getTopNBy(columns, 3, comp::LessByRating{});
+    ASSERT_EQ(top.size(), 3);
+    EXPECT_EQ(columns.Title(top[0]), "The Hobbit"sv);
+    EXPECT_EQ(columns.Title(top[1]), "To Kill a Mockingbird"sv);
+    EXPECT_EQ(columns.Title(top[2]), "Pride and Prejudice"sv);
+    EXPECT_EQ(getTopNBy(columns, 100, comp::LessByRating{}).size(), columns.size());
+    EXPECT_TRUE(getTopNBy(columns, 0, comp::LessByRating{}).empty());
+    EXPECT_TRUE(getTopNBy(ColumnarBookDatabase{}, 0, comp::LessByRating{}).empty());
+}
+
+TEST_F(TestColumnarBookDatabase, SampleRandomBooks) {
+    auto sample = sampleRandomBooks(columns, 3);
+    EXPECT_EQ(sample.size(), 3);
+    EXPECT_TRUE(std::ranges::all_of(sample, [&](size_t row) { return row < columns.size(); }));
+    EXPECT_EQ(sampleRandomBooks(columns, 100).size(), columns.size());
+}
+// ################ Тесты колоночного хранилища ###################
@@ -0,0 +1,134 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "compact_book.hpp"
+#include "compact_book_database.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+const std::vector<Book> compact_books{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120},
+    {"Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156},
+    {"Jane Austen", "Pride and Prejudice", 1813, Genre::Fiction, 4.7, 178},
+    {"J.D. Salinger", "The Catcher in the Rye", 1951, Genre::Fiction, 4.3, 112},
+    {"Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.5, 98},
+    {"Charlotte Brontë", "Jane Eyre", 1847, Genre::Fiction, 4.6, 110},
+    {"J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203},
+    {"William Golding", "", 1954, Genre::Mystery, 4.2, 89}};
+
+CompactBookDatabase makeCompact() {
+    CompactBookDatabase db;
+    std::ranges::for_each(compact_books, [&](const Book &book) { db.PushBack(book); });
+    return db;
+}
+
+BookDatabase<> makeDatabase() {
+    BookDatabase<> db;
+    std::ranges::for_each(compact_books, [&](const Book &book) { db.PushBack(book); });
+    return db;
+}
+
+}  // namespace
+
+// ################ Компактные записи ###################
+TEST(TestCompactBookDatabase, RecordIsSmall) {
+    EXPECT_LE(sizeof(CompactBook), 24);
+    EXPECT_LT(sizeof(CompactBook), sizeof(Book));
+
+    const CompactBook book{3, 7, 1949, Genre::SciFi, 4.5, 190};
+    EXPECT_EQ(book.Author(), 3);
+    EXPECT_EQ(book.Title(), 7);
+    EXPECT_EQ(book.Year(), 1949);
+    EXPECT_EQ(book.GetGenre(), Genre::SciFi);
+    EXPECT_EQ(book.Rating(), 4.5);
+    EXPECT_EQ(book.ReadCount(), 190);
+    EXPECT_THROW((CompactBook{0, 0, -1, Genre::SciFi, 0., 0}), std::out_of_range);
+    EXPECT_THROW((CompactBook{0, 0, 70000, Genre::SciFi, 0., 0}), std::out_of_range);
+}
+
+TEST(TestCompactBookDatabase, RoundTrip) {
+    auto db = makeCompact();
+    ASSERT_EQ(db.size(), compact_books.size());
+    EXPECT_EQ(db.GetAuthors().size(), 9);
+    for (size_t row = 0; row < db.size(); ++row) {
+        EXPECT_EQ(db.GetBook(row), compact_books[row]);
+        EXPECT_EQ(db.Title(row), std::string_view{compact_books[row].title});
+        EXPECT_EQ(db.Author(row), compact_books[row].author);
+    }
+    EXPECT_EQ(db.HotBytes(), db.size() * sizeof(CompactBook));
+    EXPECT_GT(db.ColdBytes(), 0);
+
+    db.Clear();
+    EXPECT_TRUE(db.empty());
+    db.EmplaceBack("Harper Lee", "Go Set a Watchman", 2015, Genre::Fiction, 3.9, 40);
+    EXPECT_EQ(db.GetBook(0).title, "Go Set a Watchman");
+}
+
+TEST(TestCompactBookDatabase, FiltersWorkOnRecords) {
+    const auto compact = makeCompact();
+    const auto db = makeDatabase();
+    auto pred = all_of(GenreIs("Fiction"), any_of(YearBetween(1900, 1950), RatingAbove(4.75)));
+
+    std::vector<std::string> expected;
+    std::ranges::for_each(filterBooks(db, pred), [&](const Book &book) { expected.emplace_back(book.title); });
+    std::vector<std::string> actual;
+    std::ranges::for_each(filterBooks(compact, pred), [&](size_t row) { actual.emplace_back(compact.Title(row)); });
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(filterBooks(compact, GenreIs("Mystery")), std::vector<size_t>{9});
+}
+
+TEST(TestCompactBookDatabase, StatisticsMatchBookDatabase) {
+    const auto compact = makeCompact();
+    const auto db = makeDatabase();
+    EXPECT_EQ(calculateGenreRatings(compact), calculateGenreRatings(db));
+    EXPECT_DOUBLE_EQ(calculateAverageRating(compact), calculateAverageRating(db));
+    EXPECT_DOUBLE_EQ(calculateAverageRating(compact, GenreIs("SciFi")), calculateAverageRating(db, GenreIs("SciFi")));
+    EXPECT_EQ(calculateGenreRatings(compact, YearBetween(1900, 1950)),
+              calculateGenreRatings(db, YearBetween(1900, 1950)));
+    EXPECT_EQ(buildAuthorHistogramFlat(compact), buildAuthorHistogramFlat(db));
+}
+
+TEST(TestCompactBookDatabase, TopNWithComparators) {
+    const auto compact = makeCompact();
+    const auto top = getTopNBy(compact, 3, comp::LessByRating{});
+    ASSERT_EQ(top.size(), 3);
+    EXPECT_EQ(compact.Title(top[0]), "The Hobbit");
+    EXPECT_EQ(compact.Title(top[1]), "To Kill a Mockingbird");
+    EXPECT_EQ(compact.Title(top[2]), "Pride and Prejudice");
+    EXPECT_EQ(compact.Title(getTopNBy(compact, 1, comp::LessByPopularity{}).front()), "The Hobbit");
+    EXPECT_EQ(getTopNBy(compact, 100, comp::LessByRating{}).size(), compact.size());
+    EXPECT_TRUE(getTopNBy(compact, 0, comp::LessByRating{}).empty());
+    EXPECT_TRUE(getTopNBy(CompactBookDatabase{}, 0, comp::LessByRating{}).empty());
+}
+
+TEST(TestCompactBookDatabase, SortKeepsTitlesAttached) {
+    auto compact = makeCompact();
+    auto db = makeDatabase();
+
+    compact.Sort(comp::LessByPopularity{});
+    std::ranges::sort(db.MutableRange(), comp::LessByPopularity{});
+    for (size_t row = 0; row < compact.size(); ++row) {
+        EXPECT_EQ(compact.GetBook(row), db[row]);
+    }
+
+    compact.Sort(comp::LessByAuthor{});
+    EXPECT_TRUE(std::ranges::is_sorted(compact.GetBooks(), [&](const CompactBook &lhs, const CompactBook &rhs) {
+        return comp::LessByAuthor{}(compact.GetBook(&lhs - compact.GetBooks().data()),
+                                    compact.GetBook(&rhs - compact.GetBooks().data()));
+    }));
+    EXPECT_EQ(compact.Author(0), "Aldous Huxley");
+    EXPECT_EQ(compact.Title(0), "Brave New World");
+    EXPECT_EQ(compact.Author(compact.size() - 1), "William Golding");
+}
+// ################ Компактные записи ###################
@@ -33,7 +33,7 @@ protected:
 
 TEST_F(TestComparators, LessByAuthor) {
     // Сотрировка по автору
-    std::sort(db.begin(), db.end(), LessByAuthor{});
+    std::ranges::sort(db.MutableRange(), LessByAuthor{});
     // Пробегаемся по результату сортировки и проверяем
     EXPECT_EQ(std::ranges::adjacent_find(db,
                                          [](const Book &lhs, const Book &rhs) {
@@ -44,12 +44,19 @@ TEST_F(TestComparators, LessByAuthor) {
 
 TEST_F(TestComparators, LessByPopularity) {
     // Сотритовка по популярности
-    std::sort(db.begin(), db.end(), LessByPopularity{});
+    std::ranges::sort(db.MutableRange(), LessByPopularity{});
     // Проверка результата
     EXPECT_EQ(std::ranges::adjacent_find(
                   db, [](const Book &lhs, const Book &rhs) { return lhs.read_count <= rhs.read_count; }),
               db.end());
 }
+
+TEST_F(TestComparators, LessByYear) {
+    // Сортировка по году издания, старые книги первыми
+    std::ranges::sort(db.MutableRange(), LessByYear{});
+    EXPECT_TRUE(std::ranges::is_sorted(db.GetBooks(), {}, &Book::year));
+    EXPECT_EQ(db[0].year, 1813);
+}
 // ############################# Тесты на заполненной базе #################################
 
 // ############################# Тесты на пустой базе #################################
@@ -60,7 +67,7 @@ protected:
 
 TEST_F(TestComparatorsEmptyDb, LessByAuthor) {
     // Сотрировка по автору
-    std::sort(db.begin(), db.end(), LessByAuthor{});
+    std::ranges::sort(db.MutableRange(), LessByAuthor{});
     // Пробегаемся по результату сортировки и проверяем
     EXPECT_EQ(std::ranges::adjacent_find(db,
                                          [](const Book &lhs, const Book &rhs) {
@@ -71,7 +78,7 @@ TEST_F(TestComparatorsEmptyDb, LessByAuthor) {
 
 TEST_F(TestComparatorsEmptyDb, LessByPopularity) {
     // Сотритовка по популярности
-    std::sort(db.begin(), db.end(), LessByPopularity{});
+    std::ranges::sort(db.MutableRange(), LessByPopularity{});
     // Проверка результата
     EXPECT_EQ(std::ranges::adjacent_find(
                   db, [](const Book &lhs, const Book &rhs) { return lhs.read_count <= rhs.read_count; }),
@@ -0,0 +1,160 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "concurrent_book_database.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace bookdb;
+
+static_assert(std::random_access_iterator<ConcurrentBookDatabase::Snapshot::Iterator>);
+static_assert(BookIterator<ConcurrentBookDatabase::Snapshot::Iterator>);
+
+namespace {
+
+// Поля книги однозначно восстанавливаются по номеру строки, поэтому читатель может проверить любую книгу снимка
+void appendBook(ConcurrentBookDatabase &db, size_t row) {
+    db.EmplaceBack("Author" + std::to_string(row % 257), "Title" + std::to_string(row),
+                   1900 + static_cast<int>(row % 100), static_cast<Genre>(row % kGenreCount),
+                   static_cast<double>(row % 50) / 10.0, static_cast<int>(row % 1000));
+}
+
+bool isValid(const ConcurrentBookDatabase::Snapshot &snapshot, size_t row) {
+    const Book &book = snapshot[row];
+    return book.year == 1900 + static_cast<int>(row % 100) && book.read_count == static_cast<int>(row % 1000) &&
+           book.author_id < snapshot.AuthorCount() && snapshot.AuthorName(book.author_id) == book.author &&
+           book.author == "Author" + std::to_string(row % 257) &&
+           std::string_view{book.title} == "Title" + std::to_string(row);
+}
+
+}  // namespace
+
+// ################ Конкурентная база ###################
+TEST(TestConcurrentBookDatabase, SnapshotIsImmutable) {
+    ConcurrentBookDatabase db;
+    EXPECT_TRUE(db.GetSnapshot().empty());
+    for (size_t row = 0; row < 100; ++row) {
+        appendBook(db, row);
+    }
+    auto snapshot = db.GetSnapshot();
+    for (size_t row = 100; row < 2 * ConcurrentBookDatabase::kSegmentBooks + 10; ++row) {
+        appendBook(db, row);
+    }
+    EXPECT_EQ(snapshot.size(), 100);
+    EXPECT_EQ(std::ranges::distance(snapshot), 100);
+    EXPECT_EQ(db.size(), 2 * ConcurrentBookDatabase::kSegmentBooks + 10);
+
+    auto latest = db.GetSnapshot();
+    EXPECT_EQ(latest.size(), db.size());
+    EXPECT_EQ(latest.AuthorCount(), 257);
+    for (size_t row = 0; row < latest.size(); row += 997) {
+        EXPECT_TRUE(isValid(latest, row)) << row;
+    }
+    EXPECT_TRUE(isValid(latest, latest.size() - 1));
+}
+
+TEST(TestConcurrentBookDatabase, SameStatisticsAsBookDatabase) {
+    ConcurrentBookDatabase db;
+    BookDatabase<std::vector<Book>> expected;
+    for (size_t row = 0; row < ConcurrentBookDatabase::kSegmentBooks + 500; ++row) {
+        appendBook(db, row);
+        expected.PushBack(db.GetSnapshot()[row]);
+    }
+    auto snapshot = db.GetSnapshot();
+
+    EXPECT_EQ(buildAuthorHistogramFlat(snapshot), buildAuthorHistogramFlat(expected));
+    EXPECT_EQ(calculateGenreRatings(snapshot.begin(), snapshot.end()),
+              calculateGenreRatings(expected.cbegin(), expected.cend()));
+    EXPECT_DOUBLE_EQ(calculateAverageRating(snapshot.begin(), snapshot.end()),
+                     calculateAverageRating(expected.cbegin(), expected.cend()));
+
+    auto pred = all_of(GenreIs("SciFi"), YearBetween(1950, 1960));
+    auto filtered = filterBooks(snapshot.begin(), snapshot.end(), pred);
+    auto expected_filtered = filterBooks(expected.cbegin(), expected.cend(), pred);
+    EXPECT_TRUE(std::ranges::equal(filtered, expected_filtered, std::equal_to<Book>{}));
+
+    auto top = getTopNBy(snapshot.begin(), snapshot.end(), 10, comp::LessByRating{});
+    auto expected_top = getTopNBy(expected.cbegin(), expected.cend(), 10, comp::LessByRating{});
+    EXPECT_TRUE(std::ranges::equal(top, expected_top, std::equal_to<Book>{}));
+}
+
+TEST(TestConcurrentBookDatabase, SnapshotOutlivesDatabase) {
+    ConcurrentBookDatabase::Snapshot snapshot;
+    {
+        ConcurrentBookDatabase db;
+        for (size_t row = 0; row < 1000; ++row) {
+            appendBook(db, row);
+        }
+        snapshot = db.GetSnapshot();
+    }
+    ASSERT_EQ(snapshot.size(), 1000);
+    EXPECT_TRUE(isValid(snapshot, 0));
+    EXPECT_TRUE(isValid(snapshot, 999));
+}
+
+// Писатели добавляют книги, читатели одновременно берут снимки и проверяют их согласованность
+TEST(TestConcurrentBookDatabase, StressConcurrentReadersAndWriters) {
+    constexpr size_t kWriters = 2;
+    constexpr size_t kReaders = 3;
+    constexpr size_t kBooksPerWriter = 60000;
+
+    ConcurrentBookDatabase db;
+    std::atomic<size_t> next_row = 0;
+    std::atomic<size_t> writers_done = 0;
+    std::atomic<size_t> failures = 0;
+    std::atomic<size_t> snapshots = 0;
+
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < kWriters; ++i) {
+        threads.emplace_back([&] {
+            for (size_t j = 0; j < kBooksPerWriter; ++j) {
+                // Строка книги - её порядковый номер: номер выдаётся под тем же порядком, что и добавление
+                static std::mutex order;
+                std::lock_guard lock{order};
+                appendBook(db, next_row++);
+            }
+            ++writers_done;
+        });
+    }
+    for (size_t i = 0; i < kReaders; ++i) {
+        threads.emplace_back([&] {
+            size_t previous = 0;
+            do {
+                auto snapshot = db.GetSnapshot();
+                failures += snapshot.size() < previous;
+                previous = snapshot.size();
+
+                auto histogram = buildAuthorHistogramFlat(snapshot);
+                const size_t total = std::accumulate(histogram.begin(), histogram.end(), size_t{0},
+                                                     [](size_t sum, const auto &entry) { return sum + entry.second; });
+                failures += total != snapshot.size();
+                for (size_t row = 0; row < snapshot.size(); row += 101) {
+                    failures += !isValid(snapshot, row);
+                }
+                if (!snapshot.empty()) {
+                    failures += !isValid(snapshot, snapshot.size() - 1);
+                }
+                ++snapshots;
+            } while (writers_done.load() < kWriters);
+        });
+    }
+    threads.clear();
+
+    EXPECT_EQ(failures.load(), 0);
+    EXPECT_GT(snapshots.load(), 0);
+    auto snapshot = db.GetSnapshot();
+    ASSERT_EQ(snapshot.size(), kWriters * kBooksPerWriter);
+    for (size_t row = 0; row < snapshot.size(); ++row) {
+        ASSERT_TRUE(isValid(snapshot, row)) << row;
+    }
+}
+// ################ Конкурентная база ###################
@@ -0,0 +1,159 @@
+#include "book.hpp"
+#include "columnar_book_database.hpp"
+#include "filter_kernels.hpp"
+#include "filters.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <deque>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace bookdb;
+using namespace bookdb::simd;
+
+namespace {
+
+// Длина не кратна ни размеру слова маски, ни ширине векторного регистра
+constexpr size_t kCount = 1000;
+
+std::vector<MaskWord> runYearBetween(const Kernels &kernels, const std::vector<int> &values, int from, int to) {
+    std::vector<MaskWord> mask(MaskWords(values.size()));
+    kernels.year_between(values.data(), values.size(), from, to, mask.data());
+    return mask;
+}
+
+std::vector<MaskWord> runRatingAbove(const Kernels &kernels, const std::vector<double> &values, double above) {
+    std::vector<MaskWord> mask(MaskWords(values.size()));
+    kernels.rating_above(values.data(), values.size(), above, mask.data());
+    return mask;
+}
+
+std::vector<MaskWord> runGenreIs(const Kernels &kernels, const std::vector<Genre> &values, Genre genre) {
+    std::vector<MaskWord> mask(MaskWords(values.size()));
+    kernels.genre_is(values.data(), values.size(), genre, mask.data());
+    return mask;
+}
+
+}  // namespace
+
+// ################ Векторные ядра совпадают со скалярными ###################
+class TestFilterKernels : public ::testing::TestWithParam<Level> {
+protected:
+    void SetUp() override {
+        if (!IsSupported(GetParam())) {
+            GTEST_SKIP() << "SIMD level is not supported by this CPU";
+        }
+
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < kCount; ++i) {
+            years.push_back(1800 + static_cast<int>(gen() % 250));
+            ratings.push_back(static_cast<double>(gen() % 100) / 10.0);
+            genres.push_back(static_cast<Genre>(gen() % kGenreCount));
+        }
+        // Граничные значения
+        years[0] = INT_MIN;
+        years[1] = INT_MAX;
+        ratings[0] = std::numeric_limits<double>::quiet_NaN();
+        ratings[1] = 4.5;
+    }
+
+    const Kernels &scalar = KernelsFor(Level::Scalar);
+    std::vector<int> years;
+    std::vector<double> ratings;
+    std::vector<Genre> genres;
+};
+
+TEST_P(TestFilterKernels, YearBetween) {
+    const Kernels &kernels = KernelsFor(GetParam());
+    EXPECT_EQ(runYearBetween(kernels, years, 1900, 1999), runYearBetween(scalar, years, 1900, 1999));
+    EXPECT_EQ(runYearBetween(kernels, years, INT_MIN, 1900), runYearBetween(scalar, years, INT_MIN, 1900));
+    EXPECT_EQ(runYearBetween(kernels, years, 2000, 1900), runYearBetween(scalar, years, 2000, 1900));
+}
+
+TEST_P(TestFilterKernels, RatingAbove) {
+    const Kernels &kernels = KernelsFor(GetParam());
+    EXPECT_EQ(runRatingAbove(kernels, ratings, 4.5), runRatingAbove(scalar, ratings, 4.5));
+    EXPECT_EQ(runRatingAbove(kernels, ratings, -1.0), runRatingAbove(scalar, ratings, -1.0));
+}
+
+TEST_P(TestFilterKernels, GenreIs) {
+    const Kernels &kernels = KernelsFor(GetParam());
+    EXPECT_EQ(runGenreIs(kernels, genres, Genre::SciFi), runGenreIs(scalar, genres, Genre::SciFi));
+    EXPECT_EQ(runGenreIs(kernels, genres, Genre::Unknown), runGenreIs(scalar, genres, Genre::Unknown));
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLevels, TestFilterKernels, ::testing::Values(Level::Scalar, Level::SSE2, Level::AVX2));
+// ################ Векторные ядра совпадают со скалярными ###################
+
+// ################ Скалярные ядра ###################
+TEST(TestScalarKernels, BitsMatchValues) {
+    std::vector<int> years{1899, 1900, 1950, 1999, 2000};
+    auto mask = runYearBetween(KernelsFor(Level::Scalar), years, 1900, 1999);
+    EXPECT_EQ(mask.size(), 1);
+    EXPECT_EQ(mask[0], 0b00110);
+
+    std::vector<size_t> rows;
+    ForEachSetBit(mask.data(), years.size(), [&](size_t i) { rows.push_back(i); });
+    EXPECT_EQ(rows, (std::vector<size_t>{1, 2}));
+}
+
+TEST(TestScalarKernels, FillMask) {
+    std::vector<MaskWord> mask(2);
+    FillMask(70, mask.data());
+    EXPECT_EQ(mask[0], ~MaskWord{0});
+    EXPECT_EQ(mask[1], 0b111111);
+}
+// ################ Скалярные ядра ###################
+
+// ################ Фильтрация блоками ###################
+class TestMaskFilterBooks : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen{7};
+        for (size_t i = 0; i < 3 * kBlockSize + 17; ++i) {
+            Book book{"Author", "Title", 1850 + static_cast<int>(gen() % 200), static_cast<Genre>(gen() % kGenreCount),
+                      static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000)};
+            books.push_back(book);
+            columns.PushBack(book);
+        }
+    }
+
+    std::deque<Book> books;
+    ColumnarBookDatabase columns;
+};
+
+TEST_F(TestMaskFilterBooks, SameAsBranchyPredicate) {
+    // Собственная лямбда без EvalMask проверяется построчно, результат должен совпасть с маской
+    auto branchy = [](const Book &book) {
+        return book.genre == Genre::SciFi || (book.year >= 1900 && book.year < 1999 && book.rating > 2.5);
+    };
+    auto masked = filterBooks(books.begin(), books.end(),
+                              any_of(GenreIs("SciFi"), all_of(YearBetween(1900, 1999), RatingAbove(2.5))));
+    auto expected = filterBooks(books.begin(), books.end(), branchy);
+
+    ASSERT_EQ(masked.size(), expected.size());
+    EXPECT_TRUE(std::ranges::equal(masked, expected, [](const Book &lhs, const Book &rhs) { return &lhs == &rhs; }));
+
+    auto rows = filterBooks(columns, any_of(GenreIs("SciFi"), all_of(YearBetween(1900, 1999), RatingAbove(2.5))));
+    ASSERT_EQ(rows.size(), expected.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(columns.GetBook(rows[i]), expected[i].get());
+    }
+}
+
+TEST_F(TestMaskFilterBooks, MixedWithCustomPredicate) {
+    auto popular = [](const Book &book) { return book.read_count > 500; };
+    auto masked = filterBooks(books.begin(), books.end(), all_of(RatingAbove(2.5), popular));
+    auto expected =
+        filterBooks(books.begin(), books.end(), [&](const Book &book) { return book.rating > 2.5 && popular(book); });
+    EXPECT_EQ(masked.size(), expected.size());
+}
+
+TEST_F(TestMaskFilterBooks, EmptyComposition) {
+    EXPECT_EQ(filterBooks(books.begin(), books.end(), all_of()).size(), books.size());
+    EXPECT_TRUE(filterBooks(books.begin(), books.end(), any_of()).empty());
+}
+// ################ Фильтрация блоками ###################
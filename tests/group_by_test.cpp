@@ -0,0 +1,167 @@
+#include "group_by.hpp"
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "book_view.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста
+const std::vector<std::string> &groupAuthorNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (size_t author = 0; author < 700; ++author) {
+            result.push_back("Grouped Author " + std::to_string(author));
+        }
+        return result;
+    }();
+    return names;
+}
+
+BookDatabase<> groupDatabase(size_t count) {
+    BookDatabase<> db;
+    for (size_t row = 0; row < count; ++row) {
+        db.EmplaceBack(groupAuthorNames()[row * 7 % groupAuthorNames().size()], "Title",
+                       1850 + static_cast<int>(row * 13 % 170), static_cast<Genre>(row % kGenreCount),
+                       static_cast<double>(row * 31 % 50) / 10., static_cast<int>(row * 97 % 10007));
+    }
+    return db;
+}
+
+}  // namespace
+
+// ################ Группировка ###################
+TEST(TestGroupBy, MatchesGenreRatingsAndAuthorHistogram) {
+    const auto db = groupDatabase(5000);
+
+    const auto by_genre = groupBy(db, group::ByGenre{}, agg::Count{}, agg::Avg{&Book::rating});
+    const auto ratings = calculateGenreRatings(db);
+    ASSERT_EQ(by_genre.size(), ratings.size());
+    size_t books = 0;
+    for (const auto &[genre, stats] : by_genre) {
+        EXPECT_NEAR(std::get<1>(stats), ratings.at(genre), 1e-12);
+        books += std::get<0>(stats);
+    }
+    EXPECT_EQ(books, db.size());
+
+    const auto by_author = groupBy(db, group::ByAuthor{}, agg::Count{});
+    const auto histogram = buildAuthorHistogramFlat(db);
+    ASSERT_EQ(by_author.size(), histogram.size());
+    for (const auto &[author, count] : histogram) {
+        EXPECT_EQ(std::get<0>(by_author.at(author)), count);
+    }
+
+    const auto by_author_id = groupBy(db, group::ByAuthorId{}, agg::Count{});
+    ASSERT_EQ(by_author_id.size(), histogram.size());
+    for (const auto &[id, stats] : by_author_id) {
+        EXPECT_EQ(std::get<0>(stats), histogram.at(db.GetAuthors().Name(id)));
+    }
+}
+
+TEST(TestGroupBy, ComposesAggregates) {
+    const auto db = groupDatabase(3000);
+    const auto by_decade = groupBy(db, group::ByDecade{}, agg::Count{}, agg::Sum{&Book::read_count},
+                                   agg::Min{&Book::read_count}, agg::Max{&Book::rating},
+                                   agg::Variance{&Book::rating});
+
+    // Наивный подсчёт по десятилетиям
+    std::map<int, std::vector<const Book *>> expected;
+    std::for_each(db.cbegin(), db.cend(), [&](const Book &book) { expected[book.year / 10 * 10].push_back(&book); });
+    ASSERT_EQ(by_decade.size(), expected.size());
+    for (const auto &[decade, books] : expected) {
+        const auto &[count, sum, min, max, variance] = by_decade.at(decade);
+        EXPECT_EQ(count, books.size());
+
+        int64_t read_sum = 0;
+        double rating_sum = 0;
+        for (const Book *book : books) {
+            read_sum += book->read_count;
+            rating_sum += book->rating;
+        }
+        const double mean = rating_sum / static_cast<double>(books.size());
+        double squares = 0;
+        for (const Book *book : books) {
+            squares += (book->rating - mean) * (book->rating - mean);
+        }
+        EXPECT_EQ(sum, read_sum);
+        EXPECT_EQ(min, (*std::ranges::min_element(books, {}, &Book::read_count))->read_count);
+        EXPECT_EQ(max, (*std::ranges::max_element(books, {}, &Book::rating))->rating);
+        EXPECT_NEAR(variance, squares / static_cast<double>(books.size()), 1e-9);
+    }
+}
+
+TEST(TestGroupBy, DenseKeysSpillOutliersToHashTable) {
+    // Годы далеко за окном плотного массива попадают в хеш-таблицу, результат от этого не меняется
+    BookDatabase<> db;
+    for (int year : {1990, 1991, -5000, 1990, 2000000, 0, 1991, -5000, 1995}) {
+        db.EmplaceBack(groupAuthorNames()[0], "Title", year, Genre::Fiction, 4., year);
+    }
+    const auto by_year = groupBy(db, group::ByYear{}, agg::Count{}, agg::Max{&Book::read_count});
+    const std::vector<int> years{-5000, 0, 1990, 1991, 1995, 2000000};
+    ASSERT_EQ(by_year.size(), years.size());
+    for (size_t i = 0; i < years.size(); ++i) {
+        EXPECT_EQ((by_year.begin() + i)->first, years[i]);
+        EXPECT_EQ(std::get<1>((by_year.begin() + i)->second), years[i]);
+    }
+    EXPECT_EQ(std::get<0>(by_year.at(1990)), 2);
+    EXPECT_EQ(std::get<0>(by_year.at(-5000)), 2);
+
+    // Отрицательные годы относятся к десятилетию, начинающемуся раньше
+    const auto by_decade = groupBy(db, group::ByDecade{}, agg::Count{});
+    EXPECT_EQ(std::get<0>(by_decade.at(-5000)), 2);
+    EXPECT_EQ(std::get<0>(by_decade.at(1990)), 5);
+}
+
+TEST(TestGroupBy, CustomKeysAndRanges) {
+    const auto db = groupDatabase(2000);
+    const auto by_popularity =
+        groupBy(db, group::By{[](const Book &book) { return book.read_count / 1000; }}, agg::Count{});
+    std::map<int, size_t> expected;
+    std::for_each(db.cbegin(), db.cend(), [&](const Book &book) { expected[book.read_count / 1000]++; });
+    ASSERT_EQ(by_popularity.size(), expected.size());
+    for (const auto &[thousands, count] : expected) {
+        EXPECT_EQ(std::get<0>(by_popularity.at(thousands)), count);
+    }
+
+    // Группируются только книги, выданные представлением
+    const auto filtered = groupBy(filterView(db, GenreIs("SciFi")), group::ByGenre{}, agg::Count{});
+    ASSERT_EQ(filtered.size(), 1);
+    EXPECT_EQ(std::get<0>(filtered.at(Genre::SciFi)), filterBooks(db, GenreIs("SciFi")).size());
+
+    EXPECT_TRUE(groupBy(BookDatabase<>{}, group::ByAuthor{}, agg::Count{}).empty());
+}
+
+TEST(TestGroupBy, ParallelMergesPartialAggregates) {
+    const auto db = groupDatabase(4 * kParallelMinBooksPerTask + 123);
+    ThreadPool pool{4};
+
+    const auto sequential = groupBy(db, group::ByAuthor{}, agg::Count{}, agg::Sum{&Book::read_count},
+                                    agg::Avg{&Book::rating}, agg::Variance{&Book::rating});
+    const auto parallel = groupBy(db, pool, group::ByAuthor{}, agg::Count{}, agg::Sum{&Book::read_count},
+                                  agg::Avg{&Book::rating}, agg::Variance{&Book::rating});
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (const auto &[author, stats] : sequential) {
+        const auto &merged = parallel.at(author);
+        EXPECT_EQ(std::get<0>(merged), std::get<0>(stats));
+        EXPECT_EQ(std::get<1>(merged), std::get<1>(stats));
+        EXPECT_NEAR(std::get<2>(merged), std::get<2>(stats), 1e-9);
+        EXPECT_NEAR(std::get<3>(merged), std::get<3>(stats), 1e-9);
+    }
+
+    const auto by_genre = groupBy(db.cbegin(), db.cend(), pool, group::ByGenre{}, agg::Count{});
+    const auto fiction = std::ranges::count(db.cbegin(), db.cend(), Genre::Fiction, &Book::genre);
+    EXPECT_EQ(std::get<0>(by_genre.at(Genre::Fiction)), static_cast<size_t>(fiction));
+}
+// ################ Группировка ###################
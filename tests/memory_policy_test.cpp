@@ -0,0 +1,145 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "memory_policy.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace bookdb;
+using namespace std::string_view_literals;
+
+namespace {
+
+const std::vector<Book> policy_books{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"Jane Austen", "Pride and Prejudice: a title longer than the small string buffer", 1813, Genre::Fiction, 4.7,
+     178},
+    {"J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203}};
+
+template <typename Db>
+void fill(Db &db) {
+    std::ranges::for_each(policy_books, [&](const Book &book) { db.PushBack(book); });
+    db.EmplaceBack("Aldous Huxley", "Brave New World", 1932, Genre::SciFi, 4.5, 98);
+}
+
+// Автор каждой книги должен указывать на имя из словаря той же базы
+template <typename Db>
+bool authorsPointIntoDictionary(const Db &db) {
+    return std::ranges::all_of(db.GetBooks(), [&](const Book &book) {
+        return book.author.data() == db.GetAuthors().Name(book.author_id).data();
+    });
+}
+
+}  // namespace
+
+// ################ Политики памяти ###################
+template <typename Db>
+class TestMemoryPolicy : public ::testing::Test {};
+
+using PolicyDatabases =
+    ::testing::Types<BookDatabase<>, BookDatabase<std::vector<Book>, MonotonicArenaPolicy>,
+                     BookDatabase<std::deque<Book>, PoolMemoryPolicy>,
+                     BookDatabase<std::pmr::vector<Book>, MonotonicArenaPolicy>>;
+TYPED_TEST_SUITE(TestMemoryPolicy, PolicyDatabases);
+
+TYPED_TEST(TestMemoryPolicy, SameContentAsHeap) {
+    TypeParam db;
+    fill(db);
+
+    BookDatabase<> heap;
+    fill(heap);
+
+    EXPECT_TRUE(std::ranges::equal(db, heap));
+    EXPECT_EQ(db.GetAuthors().size(), 4);
+    EXPECT_TRUE(authorsPointIntoDictionary(db));
+}
+
+TYPED_TEST(TestMemoryPolicy, TitlesUsePolicyResource) {
+    TypeParam db;
+    fill(db);
+    EXPECT_TRUE(std::ranges::all_of(db.GetBooks(), [&](const Book &book) {
+        return book.title.get_allocator().resource() == db.GetMemoryResource();
+    }));
+}
+
+TYPED_TEST(TestMemoryPolicy, ClearAndRefill) {
+    TypeParam db;
+    fill(db);
+    db.Clear();
+    EXPECT_TRUE(db.empty());
+    EXPECT_TRUE(db.GetAuthors().empty());
+
+    fill(db);
+    EXPECT_EQ(db.size(), policy_books.size() + 1);
+    EXPECT_EQ(db.GetAuthors().Name(0), "George Orwell"sv);
+    EXPECT_TRUE(authorsPointIntoDictionary(db));
+}
+
+TYPED_TEST(TestMemoryPolicy, CopyOwnsItsStrings) {
+    auto source = std::make_unique<TypeParam>();
+    fill(*source);
+
+    TypeParam copy{*source};
+    source.reset();
+
+    EXPECT_EQ(copy.size(), policy_books.size() + 1);
+    EXPECT_EQ(copy[2], policy_books[2]);
+    EXPECT_TRUE(authorsPointIntoDictionary(copy));
+    EXPECT_EQ(buildAuthorHistogramFlat(copy).at("George Orwell"), 2);
+}
+
+TYPED_TEST(TestMemoryPolicy, MoveAndAssign) {
+    // Перемещающее присваивание пересоздаёт объект на месте, это безопасно только без исключений
+    static_assert(std::is_nothrow_move_constructible_v<TypeParam>);
+    static_assert(std::is_nothrow_move_assignable_v<TypeParam>);
+
+    TypeParam db;
+    fill(db);
+
+    TypeParam moved{std::move(db)};
+    EXPECT_EQ(moved.size(), policy_books.size() + 1);
+    EXPECT_TRUE(authorsPointIntoDictionary(moved));
+
+    // Исходная база пуста и работает на собственном ресурсе, а не на ресурсе перемещённой
+    EXPECT_TRUE(db.empty());
+    EXPECT_TRUE(db.GetAuthors().empty());
+    EXPECT_NE(db.GetMemoryResource(), nullptr);
+    if (moved.GetMemoryResource() != std::pmr::get_default_resource()) {
+        EXPECT_NE(db.GetMemoryResource(), moved.GetMemoryResource());
+    }
+    fill(db);
+    EXPECT_TRUE(std::ranges::equal(db, moved));
+    EXPECT_TRUE(authorsPointIntoDictionary(db));
+    db.Clear();
+    EXPECT_TRUE(db.empty());
+
+    TypeParam assigned;
+    assigned.EmplaceBack("Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156);
+    assigned = moved;
+    EXPECT_TRUE(std::ranges::equal(assigned, moved));
+    EXPECT_TRUE(authorsPointIntoDictionary(assigned));
+
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.size(), policy_books.size() + 1);
+    EXPECT_TRUE(authorsPointIntoDictionary(assigned));
+}
+
+TEST(TestMemoryPolicy, AuthorDictionaryUsesResource) {
+    // Имена авторов выделяются из переданного ресурса и освобождаются вместе с ним
+    std::pmr::monotonic_buffer_resource arena;
+    AuthorDictionary authors{&arena};
+    authors.Add("A very long author name that does not fit into any small buffer");
+    EXPECT_EQ(authors.get_allocator().resource(), &arena);
+
+    AuthorDictionary copy{authors};
+    EXPECT_NE(copy.Name(0).data(), authors.Name(0).data());
+    EXPECT_EQ(copy.Find(authors.Name(0)), 0);
+}
+// ################ Политики памяти ###################
@@ -0,0 +1,148 @@
+// Счётчики кучи нужны тестам AllocationScope: перехватчики operator new определяются в этой единице трансляции
+#define BOOKDB_DEFINE_ALLOCATION_HOOKS
+#include "memory_stats.hpp"
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "filters.hpp"
+#include "sharded_book_database.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста
+const std::vector<std::string> &statsAuthorNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (size_t author = 0; author < 300; ++author) {
+            result.push_back("Memory Stats Author " + std::to_string(author));
+        }
+        return result;
+    }();
+    return names;
+}
+
+// Каждый второй заголовок длиннее буфера короткой строки
+template <typename Db>
+void fillStats(Db &db, size_t count) {
+    for (size_t row = 0; row < count; ++row) {
+        const std::string title =
+            row % 2 == 0 ? "Short" : "A title that does not fit the SSO buffer " + std::to_string(row);
+        db.EmplaceBack(statsAuthorNames()[row % statsAuthorNames().size()], title,
+                       1900 + static_cast<int>(row % 120), static_cast<Genre>(row % kGenreCount),
+                       static_cast<double>(row % 50) / 10., static_cast<int>(row));
+    }
+}
+
+}  // namespace
+
+// ################ Учёт памяти ###################
+TEST(TestCountingMemoryResource, CountsUpstreamAllocations) {
+    std::pmr::monotonic_buffer_resource arena;
+    CountingMemoryResource counter{&arena};
+    EXPECT_EQ(counter.upstream_resource(), &arena);
+    {
+        std::pmr::vector<int> values{&counter};
+        values.reserve(100);
+        std::pmr::string text{"a string that needs its own buffer", &counter};
+        const auto counters = counter.Counters();
+        EXPECT_EQ(counters.allocations, 2);
+        EXPECT_EQ(counters.bytes_in_use, counters.bytes_allocated);
+        EXPECT_GE(counters.bytes_allocated, 100 * sizeof(int));
+    }
+    const auto counters = counter.Counters();
+    EXPECT_EQ(counters.deallocations, 2);
+    EXPECT_EQ(counters.bytes_in_use, 0);
+    EXPECT_EQ(counters.peak_bytes, counters.bytes_allocated);
+
+    counter.ResetCounters();
+    EXPECT_EQ(counter.Counters().allocations, 0);
+    EXPECT_EQ(counter.Counters().peak_bytes, 0);
+}
+
+TEST(TestCountingMemoryPolicy, MatchesMemoryStats) {
+    // Книги, заголовки и словарь авторов выделяются из ресурса политики, поэтому его живые байты
+    // совпадают с оценкой MemoryStats для этих частей
+    BookDatabase<std::pmr::vector<Book>, CountingMemoryPolicy<>> db;
+    fillStats(db, 2000);
+    const auto stats = db.MemoryStats();
+    const auto counters = db.GetMemoryPolicy().Counters();
+    EXPECT_GT(stats.title_heap, 0);
+    EXPECT_GE(stats.book_storage, 2000 * sizeof(Book));
+    EXPECT_EQ(stats.book_storage + stats.title_heap + stats.author_set, counters.bytes_in_use);
+    EXPECT_GE(counters.peak_bytes, counters.bytes_in_use);
+
+    // Одна вставка: заголовок длиннее SSO, автор уже в словаре, массив не растёт
+    db.Reserve(db.size() + 1);
+    AllocationScope scope{db.GetMemoryPolicy().Counter()};
+    db.EmplaceBack(statsAuthorNames()[0], "Another title that does not fit the SSO buffer", 2000, Genre::SciFi, 4., 1);
+    EXPECT_EQ(scope.Delta().allocations, 1);
+    EXPECT_GT(scope.Delta().retained_bytes, 0);
+
+    // Арена возвращает память разом, живых байт не остаётся
+    BookDatabase<std::vector<Book>, CountingMemoryPolicy<MonotonicArenaPolicy>> arena_db;
+    fillStats(arena_db, 500);
+    EXPECT_GT(arena_db.GetMemoryPolicy().Counters().bytes_in_use, 0);
+    arena_db.Clear();
+    EXPECT_EQ(arena_db.GetMemoryPolicy().Counters().bytes_in_use, 0);
+}
+
+TEST(TestMemoryStats, BreakdownFollowsDerivedStructures) {
+    BookDatabase<> db;
+    fillStats(db, 5000);
+    // Индекс авторов упорядочивает новых авторов лениво, при первом обращении
+    const size_t author_index_bytes = db.GetAuthorIndex().MemoryBytes();
+    const auto plain = db.MemoryStats();
+    EXPECT_EQ(plain.indexes, author_index_bytes);
+    EXPECT_EQ(plain.Total(),
+              plain.book_storage + plain.title_heap + plain.author_set + plain.indexes + plain.derived);
+
+    db.CreateIndex(IndexedField::Year);
+    db.EnableTextIndex();
+    const auto indexed = db.MemoryStats();
+    EXPECT_GE(indexed.indexes, plain.indexes + 5000 * sizeof(std::pair<const int, size_t>));
+    EXPECT_EQ(indexed.derived, plain.derived);
+
+    db.EnableAggregates();
+    db.EnableSketches();
+    EXPECT_GE(db.MemoryStats().derived, plain.derived + db.GetSketches()->MemoryBytes());
+
+    ShardedBookDatabase<> sharded{4};
+    std::vector<Book> books(db.cbegin(), db.cend());
+    sharded.Append(books);
+    const auto sharded_stats = sharded.MemoryStats();
+    EXPECT_EQ(sharded_stats.title_heap, plain.title_heap);
+    EXPECT_GE(sharded_stats.book_storage, 5000 * sizeof(Book));
+}
+
+TEST(TestAllocationScope, CountsQueryAllocations) {
+    ASSERT_TRUE(heapAllocationHooksInstalled());
+    BookDatabase<> db;
+    fillStats(db, 3000);
+
+    AllocationScope scope;
+    const auto histogram = buildAuthorHistogramFlat(db);
+    const auto delta = scope.Delta();
+    EXPECT_EQ(histogram.size(), statsAuthorNames().size());
+    EXPECT_GT(delta.allocations, 0);
+    EXPECT_GT(delta.retained_bytes, 0);
+
+    // Результат фильтра - единственный буфер, который операция оставляет за собой
+    scope.Restart();
+    {
+        const auto found = filterBooks(db, GenreIs("SciFi"));
+        EXPECT_EQ(found.size(), 500);
+        EXPECT_GE(scope.Delta().retained_bytes, static_cast<ptrdiff_t>(found.size() * sizeof(found[0])));
+    }
+    EXPECT_EQ(scope.Delta().retained_bytes, 0);
+    EXPECT_EQ(scope.Delta().allocations, scope.Delta().deallocations);
+}
+// ################ Учёт памяти ###################
@@ -0,0 +1,160 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "columnar_book_database.hpp"
+#include "filters.hpp"
+#include "query_planner.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Случайный предикат глубины не больше depth
+Query randomQuery(std::mt19937 &gen, int depth) {
+    const auto kind = depth == 0 ? gen() % 3 : gen() % 5;
+    switch (kind) {
+    case 0:
+        return Query::Genre(static_cast<Genre>(gen() % kGenreCount));
+    case 1: {
+        const int from = 1850 + static_cast<int>(gen() % 200);
+        return Query::Year(from, from + static_cast<int>(gen() % 60));
+    }
+    case 2:
+        return Query::Rating(static_cast<double>(gen() % 50) / 10.0);
+    default: {
+        std::vector<Query> children;
+        for (size_t i = 0, count = 1 + gen() % 4; i < count; ++i) {
+            children.push_back(randomQuery(gen, depth - 1));
+        }
+        return kind == 3 ? Query::And(std::move(children)) : Query::Or(std::move(children));
+    }
+    }
+}
+
+// Построчная проверка дерева без планирования
+bool matches(const Query &query, const Book &book) {
+    switch (query.GetKind()) {
+    case Query::Kind::Leaf:
+        return std::visit([&](const auto &filter) { return filter(book); }, query.GetLeaf());
+    case Query::Kind::And:
+        return std::ranges::all_of(query.GetChildren(), [&](const Query &child) { return matches(child, book); });
+    case Query::Kind::Or:
+        return std::ranges::any_of(query.GetChildren(), [&](const Query &child) { return matches(child, book); });
+    }
+    return false;
+}
+
+}  // namespace
+
+// ################ Планировщик запросов ###################
+class TestQueryPlanner : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < 3 * simd::kBlockSize + 17; ++i) {
+            // Половина книг - художественная литература, остальные жанры встречаются реже
+            const auto genre = gen() % 2 == 0 ? Genre::Fiction : static_cast<Genre>(gen() % kGenreCount);
+            Book book{"Author", "Title", 1850 + static_cast<int>(gen() % 200), genre,
+                      static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000)};
+            db.PushBack(book);
+            columns.PushBack(book);
+        }
+        stats = ColumnStatistics::Collect(columns);
+    }
+
+    std::vector<size_t> expected(const Query &query) const {
+        std::vector<size_t> rows;
+        for (size_t row = 0; row < db.size(); ++row) {
+            if (matches(query, db.GetBooks()[row])) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    BookDatabase<std::vector<Book>> db;
+    ColumnarBookDatabase columns;
+    ColumnStatistics stats;
+};
+
+TEST_F(TestQueryPlanner, Statistics) {
+    EXPECT_EQ(stats.Rows(), columns.size());
+    EXPECT_EQ(ColumnStatistics::Collect(db).Rows(), db.size());
+
+    // Жанры считаются точно
+    const auto fiction = filterBooks(columns, GenreIs("Fiction")).size();
+    EXPECT_DOUBLE_EQ(stats.Selectivity(GenreFilter{Genre::Fiction}), static_cast<double>(fiction) / columns.size());
+
+    // Гистограммы дают приближённую оценку
+    const auto years = filterBooks(columns, YearBetween(1900, 1950)).size();
+    EXPECT_NEAR(stats.Selectivity(YearFilter{1900, 1950}), static_cast<double>(years) / columns.size(), 0.02);
+    const auto ratings = filterBooks(columns, RatingAbove(4.0)).size();
+    EXPECT_NEAR(stats.Selectivity(RatingFilter{4.0}), static_cast<double>(ratings) / columns.size(), 0.02);
+
+    EXPECT_DOUBLE_EQ(stats.Selectivity(YearFilter{1950, 1900}), 0.0);
+    EXPECT_DOUBLE_EQ(stats.Selectivity(YearFilter{0, 3000}), 1.0);
+    EXPECT_DOUBLE_EQ(stats.Selectivity(RatingFilter{10.0}), 0.0);
+}
+
+TEST_F(TestQueryPlanner, MostSelectiveFirstInConjunction) {
+    auto plan = planQuery(Query::And({Query::Genre("Fiction"), Query::Rating(1.0), Query::Year(1900, 1910)}), stats);
+    const auto &children = plan.Root().children;
+    ASSERT_EQ(children.size(), 3);
+    EXPECT_TRUE(std::holds_alternative<YearFilter>(children[0].leaf));
+    EXPECT_TRUE(std::holds_alternative<GenreFilter>(children[1].leaf));
+    EXPECT_TRUE(std::holds_alternative<RatingFilter>(children[2].leaf));
+    EXPECT_LT(plan.Cost(), 1.2 + 1.0 + 1.0);
+}
+
+TEST_F(TestQueryPlanner, LeastSelectiveFirstInDisjunction) {
+    auto plan = planQuery(Query::Or({Query::Year(1900, 1910), Query::Genre("Fiction")}), stats);
+    const auto &children = plan.Root().children;
+    ASSERT_EQ(children.size(), 2);
+    EXPECT_TRUE(std::holds_alternative<GenreFilter>(children[0].leaf));
+    EXPECT_TRUE(std::holds_alternative<YearFilter>(children[1].leaf));
+}
+
+TEST_F(TestQueryPlanner, FlattensNestedNodes) {
+    auto plan = planQuery(
+        Query::And({Query::Genre("Fiction"), Query::And({Query::Rating(1.0), Query::Or({Query::Year(1900, 1910)})})}),
+        stats);
+    EXPECT_EQ(plan.Root().kind, Query::Kind::And);
+    ASSERT_EQ(plan.Root().children.size(), 3);
+    EXPECT_TRUE(std::ranges::all_of(plan.Root().children,
+                                    [](const PlanNode &child) { return child.kind == Query::Kind::Leaf; }));
+}
+
+TEST_F(TestQueryPlanner, SameAsFilterBooks) {
+    auto pred = any_of(GenreIs("SciFi"), all_of(YearBetween(1900, 1999), RatingAbove(2.5)));
+    auto plan = planQuery(Query::From(pred), stats);
+    EXPECT_EQ(executeQuery(columns, plan), filterBooks(columns, pred));
+    EXPECT_EQ(executeQuery(db, plan), filterBooks(columns, pred));
+}
+
+TEST_F(TestQueryPlanner, RandomQueries) {
+    std::mt19937 gen{7};
+    for (int i = 0; i < 200; ++i) {
+        const auto query = randomQuery(gen, 3);
+        const auto plan = planQuery(query, stats);
+        const auto rows = expected(query);
+        ASSERT_EQ(executeQuery(columns, plan), rows) << plan.Explain();
+        ASSERT_EQ(executeQuery(db, plan), rows) << plan.Explain();
+    }
+}
+
+TEST_F(TestQueryPlanner, EmptyNodes) {
+    EXPECT_EQ(executeQuery(columns, planQuery(Query::And({}), stats)).size(), columns.size());
+    EXPECT_TRUE(executeQuery(columns, planQuery(Query::Or({}), stats)).empty());
+    EXPECT_TRUE(executeQuery(ColumnarBookDatabase{}, planQuery(Query::Genre("SciFi"), stats)).empty());
+}
+
+TEST_F(TestQueryPlanner, Explain) {
+    auto plan = planQuery(Query::And({Query::Rating(4.5), Query::Genre("SciFi")}), stats);
+    auto explain = plan.Explain();
+    EXPECT_TRUE(explain.starts_with("AND (selectivity "));
+    EXPECT_NE(explain.find("\n  genre == SciFi (selectivity "), std::string::npos);
+    EXPECT_NE(explain.find("\n  rating > 4.5 (selectivity "), std::string::npos);
+}
+// ################ Планировщик запросов ###################
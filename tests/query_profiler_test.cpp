@@ -0,0 +1,200 @@
+#include "query_profiler.hpp"
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <format>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста
+const std::vector<std::string> &profiledAuthorNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (size_t author = 0; author < 50; ++author) {
+            result.push_back("Profiled Author " + std::to_string(author));
+        }
+        return result;
+    }();
+    return names;
+}
+
+BookDatabase<> profiledDatabase(size_t count) {
+    BookDatabase<> db;
+    for (size_t row = 0; row < count; ++row) {
+        db.EmplaceBack(profiledAuthorNames()[row % profiledAuthorNames().size()], "Title " + std::to_string(row),
+                       1900 + static_cast<int>(row % 120), static_cast<Genre>(row % kGenreCount),
+                       static_cast<double>(row % 50) / 10., static_cast<int>(row));
+    }
+    return db;
+}
+
+}  // namespace
+
+// ################ Профилирование запросов ###################
+TEST(TestLatencyHistogram, BucketBounds) {
+    // Малые значения хранятся точно, дальше ширина корзины растёт вдвое на каждой степени двойки
+    for (uint64_t value : {0ull, 1ull, 63ull, 64ull, 65ull, 1000ull, 123456789ull, (1ull << 44) - 1}) {
+        const size_t bucket = LatencyHistogram::BucketOf(value);
+        EXPECT_LT(bucket, LatencyHistogram::kBucketCount);
+        EXPECT_LE(LatencyHistogram::BucketLow(bucket), value);
+        EXPECT_GE(LatencyHistogram::BucketHigh(bucket), value);
+    }
+    EXPECT_EQ(LatencyHistogram::BucketLow(LatencyHistogram::BucketOf(63)), 63);
+    EXPECT_EQ(LatencyHistogram::BucketHigh(LatencyHistogram::BucketOf(63)), 63);
+    EXPECT_EQ(LatencyHistogram::BucketOf(1ull << 60), LatencyHistogram::kBucketCount - 1);
+
+    // Корзины идут подряд, без пропусков и пересечений
+    for (size_t bucket = 1; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+        EXPECT_EQ(LatencyHistogram::BucketLow(bucket), LatencyHistogram::BucketHigh(bucket - 1) + 1);
+    }
+}
+
+TEST(TestLatencyHistogram, QuantilesWithinRelativeError) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.Quantile(0.5), 0);
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.Record(value);
+    }
+    EXPECT_EQ(histogram.Count(), 100000);
+    EXPECT_EQ(histogram.Max(), 100000);
+    EXPECT_NEAR(static_cast<double>(histogram.Quantile(0.5)), 50000., 50000. / 64);
+    EXPECT_NEAR(static_cast<double>(histogram.Quantile(0.99)), 99000., 99000. / 64);
+    EXPECT_EQ(histogram.Quantile(1.), 100000);
+
+    LatencyHistogram other;
+    other.Record(5'000'000);
+    histogram.Merge(other);
+    EXPECT_EQ(histogram.Count(), 100001);
+    EXPECT_EQ(histogram.Max(), 5'000'000);
+    histogram.Clear();
+    EXPECT_EQ(histogram.Count(), 0);
+}
+
+TEST(TestQueryProfiler, RecordsRowsPerQuery) {
+    static_assert(kProfilingEnabled);
+    const auto db = profiledDatabase(1000);
+    QueryProfiler::Reset();
+
+    const auto found = filterBooks(db.cbegin(), db.cend(), GenreIs("SciFi"));
+    const auto top = getTopNBy(db.cbegin(), db.cend(), 10, comp::LessByRating{});
+    calculateGenreRatings(db);
+    calculateGenreRatings(db);
+
+    const auto snapshot = QueryProfiler::Snapshot();
+    const auto &filter = snapshot[QueryKind::FilterBooks];
+    EXPECT_EQ(filter.calls, 1);
+    EXPECT_EQ(filter.rows_scanned, 1000);
+    EXPECT_EQ(filter.rows_matched, found.size());
+    EXPECT_EQ(filter.threads, 1);
+    EXPECT_EQ(filter.latency.Count(), 1);
+    EXPECT_LE(filter.P50(), filter.Max());
+    EXPECT_LE(filter.Max(), filter.total_ns);
+
+    EXPECT_EQ(snapshot[QueryKind::TopN].calls, 1);
+    EXPECT_EQ(snapshot[QueryKind::TopN].rows_scanned, 1000);
+    EXPECT_EQ(snapshot[QueryKind::TopN].rows_matched, top.size());
+
+    // calculateGenreRatings(db) вызывает версию с итераторами: вложенный замер не записывается отдельно
+    const auto &ratings = snapshot[QueryKind::GenreRatings];
+    EXPECT_EQ(ratings.calls, 2);
+    EXPECT_EQ(ratings.rows_scanned, 2000);
+    EXPECT_EQ(ratings.latency.Count(), 2);
+    EXPECT_EQ(snapshot[QueryKind::SampleBooks].calls, 0);
+
+    EXPECT_TRUE(std::format("{}", snapshot).contains("calculateGenreRatings"));
+    EXPECT_FALSE(std::format("{}", snapshot).contains("sampleRandomBooks"));
+}
+
+TEST(TestQueryProfiler, SkippedZonesAreNotScanned) {
+    auto db = profiledDatabase(5000);
+    db.EnableAggregates();
+    QueryProfiler::Reset();
+
+    // Ответ из агрегатов не просматривает книги
+    calculateGenreRatings(db);
+    EXPECT_EQ(QueryProfiler::Snapshot()[QueryKind::GenreRatings].rows_scanned, 0);
+    EXPECT_EQ(QueryProfiler::Snapshot()[QueryKind::GenreRatings].rows_matched, 5000);
+
+    // Годы растут с номером строки, карта зон отсекает зоны вне диапазона
+    BookDatabase<> by_year;
+    for (size_t row = 0; row < 3 * ZoneMap::kZoneRows; ++row) {
+        by_year.EmplaceBack(profiledAuthorNames()[0], "Title", static_cast<int>(row), Genre::Fiction, 4., 1);
+    }
+    const auto found = filterBooks(by_year, YearBetween(100, 200));
+    const auto snapshot = QueryProfiler::Snapshot();
+    const auto &filter = snapshot[QueryKind::FilterBooks];
+    EXPECT_EQ(found.size(), 100);
+    EXPECT_EQ(filter.rows_matched, 100);
+    EXPECT_EQ(filter.rows_scanned, ZoneMap::kZoneRows);
+}
+
+TEST(TestQueryProfiler, RecordsThreadsOfParallelQueries) {
+    const auto db = profiledDatabase(4 * kParallelMinBooksPerTask);
+    ThreadPool pool{4};
+    QueryProfiler::Reset();
+
+    calculateGenreRatings(db.cbegin(), db.cend(), pool);
+    const auto snapshot = QueryProfiler::Snapshot();
+    const auto &ratings = snapshot[QueryKind::GenreRatings];
+    EXPECT_EQ(ratings.calls, 1);
+    EXPECT_EQ(ratings.threads, 4);
+    EXPECT_EQ(ratings.rows_scanned, db.size());
+}
+
+TEST(TestQueryProfiler, MergesThreadProfiles) {
+    const auto db = profiledDatabase(500);
+    QueryProfiler::Reset();
+
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&] {
+            for (size_t call = 0; call < 25; ++call) {
+                calculateAverageRating(db.cbegin(), db.cend());
+            }
+        });
+    }
+    std::ranges::for_each(threads, [](std::thread &thread) { thread.join(); });
+
+    const auto snapshot = QueryProfiler::Snapshot();
+    const auto &average = snapshot[QueryKind::AverageRating];
+    EXPECT_EQ(average.calls, 100);
+    EXPECT_EQ(average.rows_scanned, 100 * 500);
+    EXPECT_EQ(average.latency.Count(), 100);
+
+    QueryProfiler::Reset();
+    EXPECT_EQ(QueryProfiler::Snapshot()[QueryKind::AverageRating].calls, 0);
+    EXPECT_EQ(QueryProfiler::Snapshot()[QueryKind::AverageRating].Max(), 0);
+}
+
+TEST(TestQueryProfiler, ReusesProfilesOfFinishedThreads) {
+    const auto db = profiledDatabase(100);
+    calculateAverageRating(db.cbegin(), db.cend());
+    QueryProfiler::Reset();
+    const size_t profiles = QueryProfiler::ProfileCount();
+
+    // Потоки идут по очереди: каждый следующий получает профиль завершившегося, замеры при этом сохраняются
+    for (size_t thread = 0; thread < 20; ++thread) {
+        std::thread{[&] { calculateAverageRating(db.cbegin(), db.cend()); }}.join();
+    }
+    EXPECT_LE(QueryProfiler::ProfileCount(), profiles + 1);
+
+    const auto snapshot = QueryProfiler::Snapshot();
+    EXPECT_EQ(snapshot[QueryKind::AverageRating].calls, 20);
+    EXPECT_EQ(snapshot[QueryKind::AverageRating].rows_scanned, 20 * 100);
+    EXPECT_EQ(snapshot[QueryKind::AverageRating].latency.Count(), 20);
+
+    QueryProfiler::Reset();
+    EXPECT_EQ(QueryProfiler::Snapshot()[QueryKind::AverageRating].calls, 0);
+}
+// ################ Профилирование запросов ###################
@@ -0,0 +1,149 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "secondary_index.hpp"
+#include <algorithm>
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+using namespace bookdb;
+
+using TestContainer = bookdb::BookDatabase<std::deque<Book>>;
+
+namespace {
+
+// Результат фильтрации по индексу должен совпадать с полным сканированием, включая порядок
+template <typename Pred>
+void expectSameAsScan(TestContainer &db, Pred pred) {
+    const auto &books = db.GetBooks();
+    auto indexed = filterBooks(std::as_const(db), pred);
+    auto scanned = filterBooks(books.cbegin(), books.cend(), pred);
+    ASSERT_EQ(indexed.size(), scanned.size());
+    EXPECT_TRUE(std::ranges::equal(indexed, scanned, [](const Book &lhs, const Book &rhs) { return &lhs == &rhs; }));
+}
+
+}  // namespace
+
+// ################ Индекс ###################
+TEST(TestSecondaryIndex, RangeQueries) {
+    SecondaryIndex<int> index;
+    index.Insert(1950, 0);
+    index.Insert(1900, 1);
+    index.Insert(1950, 2);
+    index.Insert(2000, 3);
+
+    EXPECT_EQ(index.size(), 4);
+    EXPECT_EQ(index.Between(1900, 1951), (std::vector<size_t>{1, 0, 2}));
+    EXPECT_EQ(index.Between(1950, 1950), std::vector<size_t>{});
+    EXPECT_EQ(index.Between(2000, 1900), std::vector<size_t>{});
+    EXPECT_EQ(index.Above(1950), std::vector<size_t>{3});
+
+    index.Erase(1950, 0);
+    index.Erase(1950, 7);
+    EXPECT_EQ(index.Between(1900, 1951), (std::vector<size_t>{1, 2}));
+
+    index.Clear();
+    EXPECT_TRUE(index.empty());
+}
+
+TEST(TestSecondaryIndex, EraseAmongEqualKeys) {
+    // Строки с равным ключом упорядочены по номеру, удаление не перебирает соседей
+    SecondaryIndex<int> index;
+    for (size_t row = 0; row < 1000; ++row) {
+        index.Insert(1984, row);
+    }
+    for (size_t row = 0; row < 1000; row += 2) {
+        index.Erase(1984, row);
+    }
+    index.Insert(1984, 0);
+
+    std::vector<size_t> expected{0};
+    for (size_t row = 1; row < 1000; row += 2) {
+        expected.push_back(row);
+    }
+    EXPECT_EQ(index.size(), expected.size());
+    EXPECT_EQ(index.Between(1984, 1985), expected);
+    EXPECT_EQ(index.Above(1983), expected);
+    EXPECT_TRUE(index.Above(1984).empty());
+}
+// ################ Индекс ###################
+
+// ################ Индексы в базе ###################
+class TestIndexedBookDatabase : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < 5000; ++i) {
+            db.EmplaceBack("Author", "Title", 1800 + static_cast<int>(gen() % 220), static_cast<Genre>(gen() % 6),
+                           static_cast<double>(gen() % 50) / 10.0, static_cast<int>(gen() % 1000));
+        }
+        db.CreateIndex(IndexedField::Year);
+        db.CreateIndex(IndexedField::Rating);
+    }
+
+    TestContainer db;
+};
+
+TEST_F(TestIndexedBookDatabase, CreateAndDrop) {
+    EXPECT_TRUE(db.HasIndex(IndexedField::Year));
+    EXPECT_FALSE(db.HasIndex(IndexedField::ReadCount));
+    EXPECT_EQ(std::as_const(db).GetReadCountIndex(), nullptr);
+
+    db.CreateIndex(IndexedField::ReadCount);
+    ASSERT_NE(std::as_const(db).GetReadCountIndex(), nullptr);
+    EXPECT_EQ(std::as_const(db).GetReadCountIndex()->size(), db.size());
+
+    db.DropIndex(IndexedField::Year);
+    EXPECT_EQ(std::as_const(db).GetYearIndex(), nullptr);
+}
+
+TEST_F(TestIndexedBookDatabase, FilterUsesIndexes) {
+    expectSameAsScan(db, YearBetween(1900, 1999));
+    expectSameAsScan(db, RatingAbove(4.5));
+    expectSameAsScan(db, all_of(GenreIs("SciFi"), YearBetween(1950, 1960), RatingAbove(2.5)));
+    expectSameAsScan(db, any_of(YearBetween(1800, 1810), RatingAbove(4.8)));
+    // Жанр не индексирован, any_of выполняется полным сканированием
+    expectSameAsScan(db, any_of(YearBetween(1800, 1810), GenreIs("SciFi")));
+}
+
+TEST_F(TestIndexedBookDatabase, IncrementalInsert) {
+    db.EmplaceBack("Author", "Title", 3000, Genre::SciFi, 10.0, 1);
+    db.PushBack(Book{"Author", "Title", 3001, Genre::SciFi, 10.0, 1});
+
+    EXPECT_EQ(std::as_const(db).GetYearIndex()->Between(3000, 3002), (std::vector<size_t>{5000, 5001}));
+    EXPECT_EQ(std::as_const(db).GetRatingIndex()->Above(9.0).size(), 2);
+    expectSameAsScan(db, YearBetween(2999, 3005));
+}
+
+TEST_F(TestIndexedBookDatabase, RebuildAfterMutableAccess) {
+    // Сортировка через изменяемые итераторы меняет номера строк, индексы перестраиваются при следующем запросе
+    std::ranges::sort(db.MutableRange(), comp::LessByRating{});
+    expectSameAsScan(db, YearBetween(1900, 1999));
+
+    db.Modify(0, [](Book &book) { book.year = 5000; });
+    EXPECT_EQ(std::as_const(db).GetYearIndex()->Between(5000, 5001), std::vector<size_t>{0});
+}
+
+TEST_F(TestIndexedBookDatabase, ModifyUpdatesIndexes) {
+    const int year = db[10].year;
+    db.Modify(10, [](Book &book) {
+        book.year = 5000;
+        book.rating = 100.0;
+    });
+
+    EXPECT_EQ(std::as_const(db).GetYearIndex()->Between(5000, 5001), std::vector<size_t>{10});
+    EXPECT_EQ(std::as_const(db).GetRatingIndex()->Above(99.0), std::vector<size_t>{10});
+    EXPECT_EQ(std::ranges::count(std::as_const(db).GetYearIndex()->Between(year, year + 1), 10), 0);
+    expectSameAsScan(db, YearBetween(1900, 1999));
+}
+
+TEST_F(TestIndexedBookDatabase, Clear) {
+    db.Clear();
+    EXPECT_TRUE(db.HasIndex(IndexedField::Year));
+    EXPECT_TRUE(std::as_const(db).GetYearIndex()->empty());
+    EXPECT_TRUE(filterBooks(std::as_const(db), YearBetween(1900, 1999)).empty());
+}
+// ################ Индексы в базе ###################
@@ -0,0 +1,207 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "sharded_book_database.hpp"
+#include "statsistics.hpp"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <ranges>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста
+const std::vector<std::string> &authorNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (size_t author = 0; author < 97; ++author) {
+            result.push_back("Author" + std::to_string(author));
+        }
+        return result;
+    }();
+    return names;
+}
+
+Book makeBook(size_t row) {
+    return Book{authorNames()[row % 97],
+                "Title" + std::to_string(row),
+                1900 + static_cast<int>(row % 120),
+                static_cast<Genre>(row % kGenreCount),
+                static_cast<double>(row * 7 % 50) / 10.0,
+                static_cast<int>(row * 13 % 1000)};
+}
+
+// Одни и те же книги в обычной и в шардированной базе
+struct Fixture {
+    explicit Fixture(size_t shards, size_t count = 5000) : sharded(shards) {
+        for (size_t row = 0; row < count; ++row) {
+            single.PushBack(makeBook(row));
+            sharded.PushBack(makeBook(row));
+        }
+    }
+
+    BookDatabase<> single;
+    ShardedBookDatabase<> sharded;
+};
+
+std::multiset<std::string> titles(const std::vector<std::reference_wrapper<const Book>> &books) {
+    std::multiset<std::string> result;
+    std::ranges::for_each(books, [&](const Book &book) { result.emplace(std::string_view{book.title}); });
+    return result;
+}
+
+}  // namespace
+
+// ################ Шардированная база ###################
+TEST(TestShardedBookDatabase, RoutesAuthorsToOneShard) {
+    Fixture fixture{4};
+    EXPECT_EQ(fixture.sharded.ShardCount(), 4);
+    EXPECT_EQ(fixture.sharded.size(), fixture.single.size());
+    EXPECT_FALSE(fixture.sharded.empty());
+
+    size_t total = 0;
+    for (size_t shard = 0; shard < fixture.sharded.ShardCount(); ++shard) {
+        const auto &db = fixture.sharded.GetShard(shard);
+        total += db.size();
+        EXPECT_GT(db.size(), 0);
+        for (const Book &book : db.GetBooks()) {
+            EXPECT_EQ(fixture.sharded.ShardOf(book.author), shard);
+        }
+    }
+    EXPECT_EQ(total, fixture.single.size());
+
+    fixture.sharded.Clear();
+    EXPECT_TRUE(fixture.sharded.empty());
+}
+
+TEST(TestShardedBookDatabase, AppendMatchesPushBack) {
+    std::vector<Book> books;
+    for (size_t row = 0; row < 1000; ++row) {
+        books.push_back(makeBook(row));
+    }
+    ShardedBookDatabase<> appended{3};
+    appended.Append(books);
+    ShardedBookDatabase<> pushed{3};
+    std::ranges::for_each(books, [&](const Book &book) { pushed.PushBack(book); });
+
+    ASSERT_EQ(appended.size(), books.size());
+    for (size_t shard = 0; shard < appended.ShardCount(); ++shard) {
+        ASSERT_EQ(appended.GetShard(shard).size(), pushed.GetShard(shard).size());
+        EXPECT_TRUE(std::ranges::equal(appended.GetShard(shard).GetBooks(), pushed.GetShard(shard).GetBooks(), {},
+                                       [](const Book &book) { return std::string_view{book.title}; },
+                                       [](const Book &book) { return std::string_view{book.title}; }));
+    }
+}
+
+TEST(TestShardedBookDatabase, AppendTemporaryBooks) {
+    // Диапазон выдаёт книги по значению: они копируются до раскладки по шардам
+    ShardedBookDatabase<> appended{3};
+    appended.Append(std::views::iota(size_t{0}, size_t{500}) | std::views::transform(makeBook));
+    ShardedBookDatabase<> pushed{3};
+    for (size_t row = 0; row < 500; ++row) {
+        pushed.PushBack(makeBook(row));
+    }
+
+    ASSERT_EQ(appended.size(), 500);
+    for (size_t shard = 0; shard < appended.ShardCount(); ++shard) {
+        EXPECT_TRUE(std::ranges::equal(appended.GetShard(shard).GetBooks(), pushed.GetShard(shard).GetBooks()));
+    }
+}
+
+TEST(TestShardedBookDatabase, FilterBooksMatchesSingleDatabase) {
+    Fixture fixture{4};
+    auto pred = all_of(YearBetween(1950, 2000), RatingAbove(2.5));
+    auto expected = filterBooks(fixture.single, pred);
+    auto actual = filterBooks(fixture.sharded, pred);
+    EXPECT_EQ(actual.size(), expected.size());
+    EXPECT_EQ(titles(actual), titles(expected));
+    EXPECT_EQ(filterBooks(fixture.sharded, all_of()).size(), fixture.single.size());
+}
+
+TEST(TestShardedBookDatabase, GenreRatingsAreWeighted) {
+    Fixture fixture{5};
+    auto expected = calculateGenreRatings(fixture.single);
+    auto actual = calculateGenreRatings(fixture.sharded);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (const auto &[genre, rating] : expected) {
+        EXPECT_NEAR(actual.at(genre), rating, 1e-9);
+    }
+    EXPECT_NEAR(calculateAverageRating(fixture.sharded), calculateAverageRating(fixture.single), 1e-9);
+
+    auto pred = GenreIs("Fiction");
+    auto filtered = calculateGenreRatings(fixture.sharded, pred);
+    ASSERT_EQ(filtered.size(), 1);
+    EXPECT_NEAR(filtered.at(Genre::Fiction), calculateGenreRatings(fixture.single, pred).at(Genre::Fiction), 1e-9);
+    EXPECT_NEAR(calculateAverageRating(fixture.sharded, YearBetween(1900, 1950)),
+                calculateAverageRating(fixture.single, YearBetween(1900, 1950)), 1e-9);
+
+    // Из агрегатов шардов получается тот же ответ
+    for (size_t shard = 0; shard < fixture.sharded.ShardCount(); ++shard) {
+        fixture.sharded.GetShard(shard).EnableAggregates();
+    }
+    for (const auto &[genre, rating] : expected) {
+        EXPECT_NEAR(calculateGenreRatings(fixture.sharded).at(genre), rating, 1e-9);
+    }
+}
+
+TEST(TestShardedBookDatabase, AuthorHistogramMatchesSingleDatabase) {
+    Fixture fixture{3};
+    auto expected = buildAuthorHistogramFlat(fixture.single);
+    auto actual = buildAuthorHistogramFlat(fixture.sharded);
+    ASSERT_EQ(actual.size(), expected.size());
+    EXPECT_TRUE(std::ranges::equal(actual, expected));
+}
+
+TEST(TestShardedBookDatabase, TopNMatchesSingleDatabase) {
+    Fixture fixture{4};
+    for (size_t count : {0, 1, 10, 100, 6000}) {
+        auto expected = getTopNBy(fixture.single.cbegin(), fixture.single.cend(), count, comp::LessByPopularity{});
+        auto actual = getTopNBy(fixture.sharded, count, comp::LessByPopularity{});
+        ASSERT_EQ(actual.size(), expected.size()) << count;
+        for (size_t i = 0; i < actual.size(); ++i) {
+            EXPECT_EQ(actual[i].get().read_count, expected[i].get().read_count) << count << ' ' << i;
+        }
+    }
+}
+
+TEST(TestShardedBookDatabase, SampleIsDistinctAndProportional) {
+    Fixture fixture{4, 4000};
+    EXPECT_TRUE(sampleRandomBooks(fixture.sharded, 0).empty());
+    EXPECT_EQ(sampleRandomBooks(fixture.sharded, 10000).size(), 4000);
+
+    std::vector<size_t> hits(fixture.sharded.ShardCount());
+    constexpr size_t kRounds = 50;
+    constexpr size_t kSample = 400;
+    for (size_t round = 0; round < kRounds; ++round) {
+        auto sample = sampleRandomBooks(fixture.sharded, kSample);
+        ASSERT_EQ(sample.size(), kSample);
+        std::set<const Book *> distinct;
+        std::ranges::for_each(sample, [&](const Book &book) { distinct.insert(&book); });
+        EXPECT_EQ(distinct.size(), kSample);
+        for (const Book &book : sample) {
+            hits[fixture.sharded.ShardOf(book.author)]++;
+        }
+    }
+    // Доля шарда в выборке близка к его доле книг
+    for (size_t shard = 0; shard < hits.size(); ++shard) {
+        const double expected = static_cast<double>(fixture.sharded.GetShard(shard).size()) / 4000.0;
+        EXPECT_NEAR(static_cast<double>(hits[shard]) / (kRounds * kSample), expected, 0.02) << shard;
+    }
+}
+
+TEST(TestShardedBookDatabase, SingleShard) {
+    Fixture fixture{1, 100};
+    EXPECT_EQ(fixture.sharded.GetShard(0).size(), 100);
+    EXPECT_EQ(filterBooks(fixture.sharded, RatingAbove(4.0)).size(),
+              filterBooks(fixture.single, RatingAbove(4.0)).size());
+}
+
+TEST(TestShardedBookDatabase, ZeroShardsRejected) { EXPECT_THROW(ShardedBookDatabase<>{0}, std::invalid_argument); }
+// ################ Шардированная база ###################
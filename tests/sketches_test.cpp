@@ -0,0 +1,243 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "sharded_book_database.hpp"
+#include "sketches.hpp"
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+// Book хранит имя автора как string_view, поэтому имена живут всё время теста
+const std::vector<std::string> &sketchAuthorNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (size_t author = 0; author < 5000; ++author) {
+            result.push_back("Author" + std::to_string(author));
+        }
+        return result;
+    }();
+    return names;
+}
+
+// Авторы по закону Ципфа: автор i встречается с частотой ~1 / (i + 1)
+std::vector<Book> makeSketchBooks(size_t count) {
+    std::mt19937 gen{11};
+    std::vector<double> weights(sketchAuthorNames().size());
+    for (size_t i = 0; i < weights.size(); ++i) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    std::discrete_distribution<size_t> author(weights.begin(), weights.end());
+    std::lognormal_distribution<double> read_count(5.0, 1.0);
+    std::normal_distribution<double> rating(3.5, 0.8);
+
+    std::vector<Book> books;
+    books.reserve(count);
+    for (size_t row = 0; row < count; ++row) {
+        books.emplace_back(sketchAuthorNames()[author(gen)], "Title" + std::to_string(row), 1950,
+                           static_cast<Genre>(row % kGenreCount), rating(gen), static_cast<int>(read_count(gen)));
+    }
+    return books;
+}
+
+// Доля значений строго меньше и не больше value: для оценки квантиля q должно быть below <= q <= not_above
+void expectRankNear(std::vector<double> sorted, double value, double q, double tolerance) {
+    std::ranges::sort(sorted);
+    const auto n = static_cast<double>(sorted.size());
+    const double below = static_cast<double>(std::ranges::lower_bound(sorted, value) - sorted.begin()) / n;
+    const double not_above = static_cast<double>(std::ranges::upper_bound(sorted, value) - sorted.begin()) / n;
+    EXPECT_LE(below, q + tolerance) << "q = " << q;
+    EXPECT_GE(not_above, q - tolerance) << "q = " << q;
+}
+
+}  // namespace
+
+// ################ Скетчи ###################
+TEST(TestHyperLogLog, EstimatesDistinctKeys) {
+    for (const size_t distinct : {100, 1000, 100000}) {
+        HyperLogLog hll;
+        for (size_t i = 0; i < distinct; ++i) {
+            // Повторы не меняют оценку
+            hll.Add("key" + std::to_string(i));
+            hll.Add("key" + std::to_string(i));
+        }
+        EXPECT_NEAR(hll.Estimate(), static_cast<double>(distinct), 0.05 * static_cast<double>(distinct));
+    }
+    EXPECT_EQ(HyperLogLog{}.Estimate(), 0.0);
+    EXPECT_EQ(HyperLogLog{12}.MemoryBytes(), 4096);
+}
+
+TEST(TestHyperLogLog, MergeEqualsSingleSketch) {
+    HyperLogLog all;
+    HyperLogLog left;
+    HyperLogLog right;
+    for (size_t i = 0; i < 20000; ++i) {
+        const auto key = "key" + std::to_string(i);
+        all.Add(key);
+        (i % 3 == 0 ? left : right).Add(key);
+    }
+    left.Merge(right);
+    EXPECT_EQ(left.Estimate(), all.Estimate());
+    EXPECT_THROW(left.Merge(HyperLogLog{10}), std::invalid_argument);
+    EXPECT_THROW(HyperLogLog{3}, std::invalid_argument);
+}
+
+TEST(TestTDigest, QuantilesMatchExact) {
+    std::mt19937 gen{5};
+    std::lognormal_distribution<double> dist(0.0, 1.5);
+    std::vector<double> values(200000);
+    std::ranges::generate(values, [&] { return dist(gen); });
+
+    TDigest digest;
+    std::ranges::for_each(values, [&](double value) { digest.Add(value); });
+    EXPECT_EQ(digest.Count(), static_cast<double>(values.size()));
+    for (const double q : {0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+        expectRankNear(values, digest.Quantile(q), q, 0.005);
+    }
+    EXPECT_EQ(digest.Quantile(0.0), *std::ranges::min_element(values));
+    EXPECT_EQ(digest.Quantile(1.0), *std::ranges::max_element(values));
+    // Память ограничена сжатием, а не числом значений
+    EXPECT_LT(digest.MemoryBytes(), 32 * 1024);
+}
+
+TEST(TestTDigest, MergedDigestsStayAccurate) {
+    std::mt19937 gen{9};
+    std::uniform_real_distribution<double> dist(-10.0, 10.0);
+    std::vector<double> values(100000);
+    std::ranges::generate(values, [&] { return dist(gen); });
+
+    std::vector<TDigest> parts(4);
+    for (size_t i = 0; i < values.size(); ++i) {
+        parts[i % parts.size()].Add(values[i]);
+    }
+    // Слияние и запросы квантилей не меняют исходные дайджесты
+    const size_t part_bytes = parts[0].MemoryBytes();
+    const double part_median = parts[0].Quantile(0.5);
+    TDigest merged;
+    std::ranges::for_each(parts, [&](const TDigest &part) { merged.Merge(part); });
+    for (const double q : {0.01, 0.5, 0.9, 0.99}) {
+        expectRankNear(values, merged.Quantile(q), q, 0.01);
+    }
+    EXPECT_EQ(parts[0].MemoryBytes(), part_bytes);
+    EXPECT_EQ(parts[0].Quantile(0.5), part_median);
+    EXPECT_EQ(merged.Count(), static_cast<double>(values.size()));
+
+    EXPECT_EQ(TDigest{}.Quantile(0.5), 0.0);
+    TDigest single;
+    single.Add(42.0);
+    EXPECT_EQ(single.Quantile(0.9), 42.0);
+}
+
+TEST(TestCountMinSketch, NeverUnderestimates) {
+    CountMinSketch sketch{1024, 4};
+    std::map<std::string, uint64_t> exact;
+    for (const Book &book : makeSketchBooks(50000)) {
+        sketch.Add(book.author);
+        exact[std::string{book.author}]++;
+    }
+    EXPECT_EQ(sketch.Total(), 50000);
+    size_t far = 0;
+    for (const auto &[key, count] : exact) {
+        const uint64_t estimate = sketch.Estimate(key);
+        EXPECT_GE(estimate, count);
+        // Погрешность e / width * N превышается с вероятностью exp(-depth)
+        far += static_cast<double>(estimate - count) > std::exp(1.0) / 1024 * 50000;
+    }
+    EXPECT_LT(far, exact.size() / 20);
+
+    CountMinSketch twice = sketch;
+    twice.Merge(sketch);
+    EXPECT_EQ(twice.Estimate("Author0"), 2 * sketch.Estimate("Author0"));
+    EXPECT_THROW(twice.Merge(CountMinSketch{512, 4}), std::invalid_argument);
+}
+
+TEST(TestHeavyHitters, FindsMostFrequentAuthors) {
+    const auto books = makeSketchBooks(100000);
+    std::map<std::string_view, uint64_t> exact;
+    std::ranges::for_each(books, [&](const Book &book) { exact[book.author]++; });
+    std::vector<std::pair<uint64_t, std::string_view>> ranked;
+    std::ranges::for_each(exact, [&](const auto &item) { ranked.emplace_back(item.second, item.first); });
+    std::ranges::sort(ranked, std::greater<>{});
+
+    // Потоки строят свои скетчи по частям базы, затем скетчи объединяются
+    constexpr size_t kThreads = 4;
+    std::vector<HeavyHitters> parts(kThreads, HeavyHitters{16});
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < kThreads; ++t) {
+            workers.emplace_back([&, t] {
+                for (size_t row = t; row < books.size(); row += kThreads) {
+                    parts[t].Add(books[row].author);
+                }
+            });
+        }
+    }
+    HeavyHitters merged{16};
+    std::ranges::for_each(parts, [&](const HeavyHitters &part) { merged.Merge(part); });
+
+    const auto top = merged.Top();
+    ASSERT_EQ(top.size(), 16);
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(top[i].key, ranked[i].second);
+        EXPECT_GE(top[i].count, ranked[i].first);
+        EXPECT_LE(static_cast<double>(top[i].count), 1.02 * static_cast<double>(ranked[i].first));
+    }
+}
+
+TEST(TestBookSketches, MaintainedByDatabase) {
+    const auto books = makeSketchBooks(20000);
+    BookDatabase<> db;
+    db.EnableSketches();
+    std::ranges::for_each(books, [&](const Book &book) { db.PushBack(book); });
+
+    BookSketches expected;
+    std::ranges::for_each(books, [&](const Book &book) { expected.Add(book); });
+    ASSERT_NE(db.GetSketches(), nullptr);
+    EXPECT_EQ(db.GetSketches()->DistinctAuthors(), expected.DistinctAuthors());
+    EXPECT_NEAR(db.GetSketches()->DistinctAuthors(), static_cast<double>(db.GetAuthors().size()),
+                0.05 * static_cast<double>(db.GetAuthors().size()));
+    EXPECT_EQ(db.GetSketches()->TopAuthors(), expected.TopAuthors());
+    EXPECT_EQ(db.GetSketches()->TopAuthors().front().key, "Author0");
+
+    // Скетчи не умеют удалять значения: после изменения книги они строятся заново
+    db.Modify(0, [](Book &book) { book.rating = 100.0; });
+    EXPECT_EQ(db.GetSketches()->Ratings().Max(), 100.0);
+    EXPECT_EQ(db.GetSketches()->Ratings().Count(), static_cast<double>(books.size()));
+
+    const auto copy = db;
+    EXPECT_EQ(copy.GetSketches()->DistinctAuthors(), db.GetSketches()->DistinctAuthors());
+    db.DisableSketches();
+    EXPECT_EQ(db.GetSketches(), nullptr);
+    EXPECT_LT(copy.GetSketches()->MemoryBytes(), 128 * 1024);
+}
+
+TEST(TestBookSketches, MergedAcrossShards) {
+    const auto books = makeSketchBooks(20000);
+    ShardedBookDatabase<> db{4};
+    db.Append(books);
+    // Часть шардов со скетчами, остальные сканируются
+    db.GetShard(0).EnableSketches();
+    db.GetShard(2).EnableSketches();
+
+    BookSketches expected;
+    std::ranges::for_each(books, [&](const Book &book) { expected.Add(book); });
+    const auto merged = mergeSketches(db);
+    EXPECT_EQ(merged.DistinctAuthors(), expected.DistinctAuthors());
+    EXPECT_EQ(merged.Ratings().Count(), static_cast<double>(books.size()));
+    EXPECT_EQ(merged.TopAuthors().front().key, "Author0");
+
+    std::vector<double> ratings;
+    std::ranges::transform(books, std::back_inserter(ratings), &Book::rating);
+    expectRankNear(ratings, merged.RatingQuantile(0.5), 0.5, 0.01);
+    expectRankNear(ratings, merged.RatingQuantile(0.99), 0.99, 0.005);
+    EXPECT_THROW(mergeSketches(db, {.hll_precision = 10}), std::invalid_argument);
+}
+// ################ Скетчи ###################
@@ -3,10 +3,19 @@
 #include "comparators.hpp"
 #include "filters.hpp"
 #include "statsistics.hpp"
+#include "thread_pool.hpp"
+#include "top_n.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <format>
+#include <functional>
 #include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 using namespace bookdb;
@@ -71,6 +80,65 @@ TEST_F(TestStatistics, getTopNBy) {
     EXPECT_TRUE(std::ranges::all_of(
         top_3_book, [&](const Book &book) { return std::ranges::find(topBooks, book) != topBooks.end(); }));
 }
+
+TEST_F(TestStatistics, getTopNByKeepsOrder) {
+    // Отбор не переставляет книги и работает на константной базе, результат - от лучшей к худшей
+    const auto &books = std::as_const(db).GetBooks();
+    const std::vector<Book> before(books.begin(), books.end());
+
+    auto topBooks = getTopNBy(books.cbegin(), books.cend(), 4, comp::LessByRating{});
+
+    EXPECT_TRUE(std::ranges::equal(books, before));
+    ASSERT_EQ(topBooks.size(), 4);
+    EXPECT_EQ(topBooks[0].get().title, "The Hobbit");
+    EXPECT_EQ(topBooks[1].get().title, "To Kill a Mockingbird");
+    EXPECT_EQ(topBooks[2].get().title, "Pride and Prejudice");
+    EXPECT_EQ(topBooks[3].get().title, "Jane Eyre");
+    EXPECT_EQ(&topBooks[0].get(), &books[8]);
+}
+
+TEST_F(TestStatistics, getTopNByTies) {
+    // Книги с равным рейтингом (The Great Gatsby и Brave New World) идут в порядке расположения в базе
+    const auto &books = std::as_const(db).GetBooks();
+    auto topBooks = getTopNBy(books.cbegin(), books.cend(), 6, comp::LessByRating{});
+    ASSERT_EQ(topBooks.size(), 6);
+    EXPECT_EQ(topBooks[4].get().title, "The Great Gatsby");
+    EXPECT_EQ(topBooks[5].get().title, "Brave New World");
+
+    EXPECT_EQ(getTopNBy(books.cbegin(), books.cend(), 100, comp::LessByRating{}).size(), books.size());
+    EXPECT_TRUE(getTopNBy(books.cbegin(), books.cend(), 0, comp::LessByRating{}).empty());
+}
+
+TEST_F(TestStatistics, StreamingTopN) {
+    // Потоковый отбор совпадает с отбором по готовой базе
+    StreamingTopN<comp::LessByPopularity> top{3};
+    std::ranges::for_each(std::as_const(db).GetBooks(), [&](const Book &book) { top.Offer(book); });
+
+    const auto &books = std::as_const(db).GetBooks();
+    auto expected = getTopNBy(books.cbegin(), books.cend(), 3, comp::LessByPopularity{});
+    EXPECT_TRUE(std::ranges::equal(top.Top(), expected,
+                                   [](const Book &lhs, const Book &rhs) { return lhs == rhs; }));
+    EXPECT_EQ(top.size(), 3);
+
+    EXPECT_FALSE(top.Offer(Book{"Author", "Unpopular", 2000, Genre::Fiction, 1.0, 1}));
+    EXPECT_TRUE(top.Offer(Book{"Author", "Popular", 2000, Genre::Fiction, 1.0, 1000}));
+    EXPECT_EQ(top.Top().front().title, "Popular");
+}
+
+TEST(TestBoundedTopN, Merge) {
+    BoundedTopN<int, std::greater<int>> left{3, {}};
+    BoundedTopN<int, std::greater<int>> right{3, {}};
+    for (int value : {5, 1, 9, 3}) {
+        left.Offer(value);
+    }
+    for (int value : {7, 2, 8}) {
+        right.Offer(value);
+    }
+    EXPECT_EQ(*left.Worst(), 3);
+
+    left.Merge(std::move(right));
+    EXPECT_EQ(std::move(left).TakeSorted(), (std::vector<int>{9, 8, 7}));
+}
 // ############################# Тесты на заполненной базе #################################
 
 // ############################# Тесты на пустой базе #################################
@@ -137,4 +205,96 @@ TEST_F(TestNotExistsData, getTopNBy) {
     auto topBooks = getTopNBy(db.begin(), db.end(), 3, comp::LessByRating{});
     EXPECT_TRUE(topBooks.size() == 2);
 }
-// ############################# Не верные данные #################################
\ No newline at end of file
+// ############################# Не верные данные #################################
+// ############################# Параллельные версии #################################
+class TestParallelStatistics : public ::testing::TestWithParam<size_t> {
+protected:
+    void SetUp() override {
+        // Достаточно книг, чтобы диапазон разбился на несколько частей
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < 10 * kParallelMinBooksPerTask + 123; ++i) {
+            db.EmplaceBack(std::format("Author{}", gen() % 5000), "Title", 1900 + static_cast<int>(gen() % 100),
+                           static_cast<Genre>(gen() % kGenreCount), static_cast<double>(gen() % 50) / 10.0, 1);
+        }
+    }
+
+    TestContainer db;
+    ThreadPool pool{GetParam()};
+};
+
+TEST_P(TestParallelStatistics, buildAuthorHistogramFlat) {
+    EXPECT_EQ(buildAuthorHistogramFlat(db, pool), buildAuthorHistogramFlat(db));
+}
+
+TEST_P(TestParallelStatistics, calculateGenreRatings) {
+    auto serial = calculateGenreRatings(db.begin(), db.end());
+    auto parallel = calculateGenreRatings(db.begin(), db.end(), pool);
+
+    ASSERT_EQ(parallel.size(), serial.size());
+    for (const auto &[genre, avg] : serial) {
+        EXPECT_NEAR(parallel[genre], avg, 1e-12);
+    }
+}
+
+TEST_P(TestParallelStatistics, calculateAverageRating) {
+    EXPECT_NEAR(calculateAverageRating(db.begin(), db.end(), pool), calculateAverageRating(db.begin(), db.end()),
+                1e-12);
+}
+
+TEST_P(TestParallelStatistics, getTopNBy) {
+    // Рейтинги повторяются, поэтому результат проверяет и порядок книг с равным ключом
+    const auto &books = std::as_const(db).GetBooks();
+    for (size_t count : {0, 1, 10, 1000}) {
+        auto serial = getTopNBy(books.cbegin(), books.cend(), count, comp::LessByRating{});
+        auto parallel = getTopNBy(books.cbegin(), books.cend(), count, comp::LessByRating{}, pool);
+        ASSERT_EQ(parallel.size(), serial.size());
+        EXPECT_TRUE(
+            std::ranges::equal(parallel, serial, [](const Book &lhs, const Book &rhs) { return &lhs == &rhs; }));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Threads, TestParallelStatistics, ::testing::Values(1, 2, 3, 8));
+
+TEST_F(TestEmptyStatistics, parallel) {
+    ThreadPool pool{4};
+    EXPECT_TRUE(buildAuthorHistogramFlat(db, pool).empty());
+    EXPECT_TRUE(calculateGenreRatings(db.begin(), db.end(), pool).empty());
+    EXPECT_DOUBLE_EQ(calculateAverageRating(db.begin(), db.end(), pool), 0.0);
+}
+
+TEST(TestThreadPool, ParallelForCoversRange) {
+    ThreadPool pool{3};
+    std::vector<int> visited(1000);
+    pool.ParallelFor(visited.size(), 7, [&](size_t, size_t first, size_t last) {
+        std::for_each(visited.begin() + first, visited.begin() + last, [](int &v) { v++; });
+    });
+    EXPECT_TRUE(std::ranges::all_of(visited, [](int v) { return v == 1; }));
+}
+
+TEST(TestThreadPool, ExceptionIsPropagated) {
+    ThreadPool pool{2};
+    EXPECT_THROW(pool.ParallelFor(10, 2, [](size_t part, size_t, size_t) {
+        if (part == 1) {
+            throw std::runtime_error("fail");
+        }
+    }),
+                 std::runtime_error);
+    EXPECT_THROW(ThreadPool{0}, std::logic_error);
+
+    // Часть 0 падает сразу, остальные ещё работают и пишут в стек вызывающего:
+    // ParallelFor возвращает управление только после их завершения
+    std::atomic<size_t> finished = 0;
+    std::vector<int> written(4);
+    EXPECT_THROW(pool.ParallelFor(4, 4, [&](size_t part, size_t, size_t) {
+        if (part == 0) {
+            throw std::runtime_error("fail");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        written[part] = 1;
+        finished++;
+    }),
+                 std::runtime_error);
+    EXPECT_EQ(finished, 3);
+    EXPECT_EQ(std::ranges::count(written, 1), 3);
+}
+// ############################# Параллельные версии #################################
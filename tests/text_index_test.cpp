@@ -0,0 +1,188 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "text_index.hpp"
+#include "text_search.hpp"
+#include <deque>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace bookdb;
+
+using TestContainer = BookDatabase<std::deque<Book>>;
+
+// ################ Списки вхождений ###################
+TEST(TestPostingList, RoundTrip) {
+    PostingList list;
+    list.Append(3, std::vector<uint32_t>{0, 5});
+    list.Append(200, std::vector<uint32_t>{1});
+    list.Append(100000, {});
+    EXPECT_EQ(list.size(), 3);
+    EXPECT_EQ(list.Rows(), (std::vector<size_t>{3, 200, 100000}));
+
+    auto cursor = list.Begin();
+    ASSERT_TRUE(cursor.Valid());
+    EXPECT_EQ(cursor.Row(), 3);
+    EXPECT_EQ(std::vector<uint32_t>(cursor.Positions().begin(), cursor.Positions().end()),
+              (std::vector<uint32_t>{0, 5}));
+    cursor.Seek(150);
+    EXPECT_EQ(cursor.Row(), 200);
+    cursor.Seek(100000);
+    EXPECT_TRUE(cursor.Positions().empty());
+    cursor.Next();
+    EXPECT_FALSE(cursor.Valid());
+}
+
+TEST(TestPostingList, SeekBySkips) {
+    PostingList list;
+    for (size_t row = 0; row < 10000; row += 3) {
+        list.Append(row, std::vector<uint32_t>{static_cast<uint32_t>(row % 7)});
+    }
+    auto cursor = list.Begin();
+    for (size_t row : {1, 2, 500, 501, 4000, 9998}) {
+        cursor.Seek(row);
+        ASSERT_TRUE(cursor.Valid());
+        EXPECT_EQ(cursor.Row(), (row + 2) / 3 * 3);
+        EXPECT_EQ(cursor.Positions().front(), cursor.Row() % 7);
+    }
+    // Курсор не возвращается назад
+    cursor.Seek(10);
+    EXPECT_EQ(cursor.Row(), 9999);
+    cursor.Seek(10000);
+    EXPECT_FALSE(cursor.Valid());
+}
+
+TEST(TestPostingList, Tokenize) {
+    EXPECT_EQ(detail::tokenize("The Lord of the Rings: Two-Towers"),
+              (std::vector<std::string>{"the", "lord", "of", "the", "rings", "two", "towers"}));
+    EXPECT_EQ(detail::tokenize("J.R.R. Tolkien"), (std::vector<std::string>{"j", "r", "r", "tolkien"}));
+    EXPECT_EQ(detail::tokenize("Charlotte Brontë"), (std::vector<std::string>{"charlotte", "brontë"}));
+    EXPECT_TRUE(detail::tokenize(" ,.- ").empty());
+}
+// ################ Списки вхождений ###################
+
+// ################ Полнотекстовый поиск ###################
+class TestTextSearch : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        db.EnableTextIndex({.trigrams = GetParam()});
+        db.EmplaceBack("George Orwell", "1984", 1949, Genre::SciFi, 4., 190);
+        db.EmplaceBack("George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120);
+        db.EmplaceBack("Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156);
+        db.EmplaceBack("J.R.R. Tolkien", "The Lord of the Rings", 1954, Genre::Fiction, 4.9, 203);
+        db.EmplaceBack("J.R.R. Tolkien", "The Hobbit", 1937, Genre::Fiction, 4.9, 203);
+        db.EmplaceBack("William Golding", "Lord of the Flies", 1954, Genre::Fiction, 4.2, 89);
+    }
+
+    // Случайные заголовки из небольшого словаря, чтобы слова часто повторялись
+    void AddRandomBooks(size_t count) {
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < count; ++i) {
+            std::string title;
+            for (size_t word = 0, words = 1 + gen() % 5; word < words; ++word) {
+                title += std::string{kWords[gen() % kWords.size()]} + (gen() % 4 == 0 ? ", " : " ");
+            }
+            db.EmplaceBack("Author " + std::string{kWords[gen() % kWords.size()]}, title, 1900, Genre::Fiction, 4.0, 1);
+        }
+    }
+
+    TextQuery RandomQuery(std::mt19937 &gen, int depth) {
+        const auto field = static_cast<TextField>(gen() % 3);
+        const auto word = kWords[gen() % kWords.size()];
+        switch (depth == 0 ? gen() % 4 : gen() % 6) {
+        case 0:
+            return TextQuery::Term(field, word);
+        case 1:
+            return TextQuery::Prefix(field, word.substr(0, 1 + gen() % word.size()));
+        case 2:
+            return TextQuery::Phrase(field, std::string{word} + " " + std::string{kWords[gen() % kWords.size()]});
+        case 3:
+            return TextQuery::Substring(field, word.substr(gen() % word.size()));
+        default: {
+            std::vector<TextQuery> children;
+            for (size_t i = 0, count = 1 + gen() % 3; i < count; ++i) {
+                children.push_back(RandomQuery(gen, depth - 1));
+            }
+            return gen() % 2 == 0 ? TextQuery::And(std::move(children)) : TextQuery::Or(std::move(children));
+        }
+        }
+    }
+
+    std::vector<size_t> Scan(const TextQuery &query) const {
+        std::vector<size_t> rows;
+        for (size_t row = 0; row < db.size(); ++row) {
+            if (detail::textMatches(query, db.GetBooks()[row])) {
+                rows.push_back(row);
+            }
+        }
+        return rows;
+    }
+
+    static constexpr std::array<std::string_view, 8> kWords{"the", "lord", "of", "rings", "war", "peace", "Night",
+                                                             "nightfall"};
+    TestContainer db;
+};
+
+TEST_P(TestTextSearch, Term) {
+    EXPECT_EQ(searchBooks(db, TextQuery::Term(TextField::Title, "LORD")), (std::vector<size_t>{4, 6}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Term(TextField::Author, "tolkien")), (std::vector<size_t>{4, 5}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Term(TextField::Any, "1984")), (std::vector<size_t>{0}));
+    EXPECT_TRUE(searchBooks(db, TextQuery::Term(TextField::Title, "lor")).empty());
+}
+
+TEST_P(TestTextSearch, Prefix) {
+    EXPECT_EQ(searchBooks(db, TextQuery::Prefix(TextField::Title, "Mock")), (std::vector<size_t>{3}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Prefix(TextField::Any, "g")), (std::vector<size_t>{0, 1, 2, 6}));
+}
+
+TEST_P(TestTextSearch, Phrase) {
+    EXPECT_EQ(searchBooks(db, TextQuery::Phrase(TextField::Title, "lord of the")), (std::vector<size_t>{4, 6}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Phrase(TextField::Title, "of the rings")), (std::vector<size_t>{4}));
+    EXPECT_TRUE(searchBooks(db, TextQuery::Phrase(TextField::Title, "the lord of flies")).empty());
+    EXPECT_TRUE(searchBooks(db, TextQuery::Phrase(TextField::Title, "rings the")).empty());
+}
+
+TEST_P(TestTextSearch, Substring) {
+    EXPECT_EQ(searchBooks(db, TextQuery::Substring(TextField::Title, "bbi")), (std::vector<size_t>{5}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Substring(TextField::Author, "orw")), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Substring(TextField::Title, "e g")), (std::vector<size_t>{2}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Substring(TextField::Title, "o")).size(), 4);
+}
+
+TEST_P(TestTextSearch, Combined) {
+    auto query = TextQuery::And({TextQuery::Term(TextField::Title, "lord"),
+                                 TextQuery::Or({TextQuery::Term(TextField::Author, "golding"),
+                                                TextQuery::Prefix(TextField::Title, "ring")})});
+    EXPECT_EQ(searchBooks(db, query), (std::vector<size_t>{4, 6}));
+    EXPECT_EQ(searchBooks(db, TextQuery::And({})).size(), db.size());
+    EXPECT_TRUE(searchBooks(db, TextQuery::Or({})).empty());
+}
+
+TEST_P(TestTextSearch, SameAsScan) {
+    AddRandomBooks(2000);
+    std::mt19937 gen{7};
+    for (int i = 0; i < 300; ++i) {
+        const auto query = RandomQuery(gen, 2);
+        ASSERT_EQ(searchBooks(db, query), Scan(query)) << i;
+    }
+}
+
+TEST_P(TestTextSearch, ModifyAndCopy) {
+    db.Modify(5, [](Book &book) { book.title = "The Silmarillion"; });
+    EXPECT_TRUE(searchBooks(db, TextQuery::Term(TextField::Title, "hobbit")).empty());
+    EXPECT_EQ(searchBooks(db, TextQuery::Term(TextField::Title, "silmarillion")), (std::vector<size_t>{5}));
+
+    TestContainer copy{db};
+    copy.EmplaceBack("J.R.R. Tolkien", "Unfinished Tales", 1980, Genre::Fiction, 4.5, 50);
+    EXPECT_EQ(searchBooks(copy, TextQuery::Term(TextField::Author, "tolkien")), (std::vector<size_t>{4, 5, 7}));
+    EXPECT_EQ(searchBooks(db, TextQuery::Term(TextField::Author, "tolkien")), (std::vector<size_t>{4, 5}));
+
+    // Без индекса запрос отвечается сканированием
+    db.DisableTextIndex();
+    EXPECT_EQ(searchBooks(db, TextQuery::Phrase(TextField::Title, "lord of the")), (std::vector<size_t>{4, 6}));
+}
+
+INSTANTIATE_TEST_SUITE_P(Trigrams, TestTextSearch, ::testing::Bool());
+// ################ Полнотекстовый поиск ###################
@@ -0,0 +1,186 @@
+#include "book.hpp"
+#include "durable_book_database.hpp"
+#include "write_ahead_log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bookdb;
+
+namespace {
+
+const std::vector<Book> wal_books{
+    {"George Orwell", "1984", 1949, Genre::SciFi, 4., 190},
+    {"George Orwell", "Animal Farm", 1945, Genre::Fiction, 4.4, 143},
+    {"F. Scott Fitzgerald", "The Great Gatsby", 1925, Genre::Fiction, 4.5, 120},
+    {"Charlotte Brontë", "Jane Eyre", 1847, Genre::Fiction, 4.6, 110},
+    {"William Golding", "", 1954, Genre::Mystery, 4.2, 89}};
+
+std::vector<Book> readBooks(const DurableBookDatabase<> &db) {
+    return {db.GetDatabase().cbegin(), db.GetDatabase().cend()};
+}
+
+}  // namespace
+
+class TestWriteAheadLog : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = std::filesystem::temp_directory_path() /
+               ("bookdb_wal_" + std::string{::testing::UnitTest::GetInstance()->current_test_info()->name()});
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override { std::filesystem::remove(path); }
+
+    void WriteBooks(const WalOptions &options = {}) {
+        DurableBookDatabase<> db{path, options};
+        std::ranges::for_each(wal_books, [&](const Book &book) { db.PushBack(book); });
+    }
+
+    std::filesystem::path path;
+};
+
+// ################ Журнал предзаписи ###################
+TEST_F(TestWriteAheadLog, ReplaysBooksOnOpen) {
+    WriteBooks();
+    DurableBookDatabase<> db{path};
+    EXPECT_EQ(db.GetLog().RecoveredRecords(), wal_books.size());
+    EXPECT_EQ(db.GetLog().TruncatedBytes(), 0);
+    EXPECT_EQ(readBooks(db), wal_books);
+    EXPECT_EQ(db.GetDatabase().GetAuthors().size(), 4);
+
+    // Новые книги дописываются после восстановленных
+    db.EmplaceBack("Harper Lee", "To Kill a Mockingbird", 1960, Genre::Fiction, 4.8, 156);
+    db.Sync();
+    DurableBookDatabase<> reopened{path};
+    ASSERT_EQ(reopened.size(), wal_books.size() + 1);
+    EXPECT_EQ(reopened.GetDatabase().back().author, "Harper Lee");
+}
+
+TEST_F(TestWriteAheadLog, EmptyLog) {
+    {
+        DurableBookDatabase<> db{path};
+        EXPECT_TRUE(db.empty());
+    }
+    EXPECT_EQ(std::filesystem::file_size(path), sizeof(WalHeader));
+    DurableBookDatabase<> db{path};
+    EXPECT_TRUE(db.empty());
+    EXPECT_EQ(db.GetLog().TruncatedBytes(), 0);
+}
+
+TEST_F(TestWriteAheadLog, TruncatesTornTail) {
+    WriteBooks();
+    const auto full_size = std::filesystem::file_size(path);
+    // Последняя запись оборвана посередине
+    std::filesystem::resize_file(path, full_size - 5);
+    {
+        DurableBookDatabase<> db{path};
+        EXPECT_EQ(db.size(), wal_books.size() - 1);
+        EXPECT_GT(db.GetLog().TruncatedBytes(), 0);
+        db.PushBack(wal_books.back());
+    }
+    DurableBookDatabase<> db{path};
+    EXPECT_EQ(db.GetLog().TruncatedBytes(), 0);
+    EXPECT_EQ(readBooks(db), wal_books);
+}
+
+TEST_F(TestWriteAheadLog, StopsAtCorruptedRecord) {
+    WriteBooks();
+    {
+        // Портим байт заголовка третьей книги внутри третьей записи
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const auto pos = bytes.find("The Great Gatsby");
+        ASSERT_NE(pos, std::string::npos);
+        file.seekp(static_cast<std::streamoff>(pos));
+        file.put('X');
+    }
+    DurableBookDatabase<> db{path};
+    EXPECT_EQ(db.size(), 2);
+    EXPECT_EQ(db.GetLog().RecoveredRecords(), 2);
+    EXPECT_GT(db.GetLog().TruncatedBytes(), 0);
+}
+
+TEST_F(TestWriteAheadLog, TornHeaderIsRewritten) {
+    {
+        std::ofstream file{path, std::ios::binary};
+        file.write("BOOK", 4);
+    }
+    WriteBooks();
+    DurableBookDatabase<> db{path};
+    EXPECT_EQ(readBooks(db), wal_books);
+}
+
+TEST_F(TestWriteAheadLog, RejectsForeignFile) {
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "definitely not a write-ahead log";
+    }
+    EXPECT_THROW(DurableBookDatabase<>{path}, std::runtime_error);
+}
+
+TEST_F(TestWriteAheadLog, SyncPolicies) {
+    for (auto sync : {WalSync::None, WalSync::Group, WalSync::Always}) {
+        std::filesystem::remove(path);
+        WriteAheadLog log{path, {.sync = sync}};
+        const auto lsn = log.Append(wal_books.front());
+        EXPECT_EQ(lsn, 1);
+        if (sync == WalSync::Always) {
+            EXPECT_EQ(log.DurableLsn(), lsn);
+        }
+        log.Append(wal_books.back());
+        log.Sync();
+        EXPECT_EQ(log.DurableLsn(), 2);
+        EXPECT_EQ(log.AppendedLsn(), 2);
+    }
+}
+
+TEST_F(TestWriteAheadLog, GroupCommitFlushesInBackground) {
+    WriteAheadLog log{path, {.sync = WalSync::Group, .group_commit_delay = std::chrono::microseconds{100}}};
+    log.Append(wal_books.front());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (log.DurableLsn() < 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_EQ(log.DurableLsn(), 1);
+}
+
+TEST_F(TestWriteAheadLog, ConcurrentAppends) {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kPerThread = 2000;
+    {
+        // Маленький порог группы заставляет писателей ждать места в буфере
+        WriteAheadLog log{path, {.sync = WalSync::Group, .group_commit_bytes = 4096}};
+        std::vector<std::jthread> writers;
+        for (size_t t = 0; t < kThreads; ++t) {
+            writers.emplace_back([&log, t] {
+                for (size_t i = 0; i < kPerThread; ++i) {
+                    log.Append(wal_books[(t + i) % wal_books.size()]);
+                }
+            });
+        }
+        writers.clear();
+        EXPECT_EQ(log.AppendedLsn(), kThreads * kPerThread);
+    }
+    size_t replayed = 0;
+    WriteAheadLog log{path, {}, [&](const WalRecord &record) {
+                          replayed += std::ranges::any_of(wal_books, [&](const Book &book) {
+                              return book.author == record.author && std::string_view{book.title} == record.title;
+                          });
+                      }};
+    EXPECT_EQ(replayed, kThreads * kPerThread);
+    EXPECT_EQ(log.RecoveredRecords(), kThreads * kPerThread);
+}
+
+TEST(TestWalRecord, Crc32c) {
+    // Контрольное значение CRC-32C из RFC 3720
+    const std::string digits = "123456789";
+    EXPECT_EQ(detail::crc32c(digits.data(), digits.size()), 0xE3069283u);
+}
+// ################ Журнал предзаписи ###################
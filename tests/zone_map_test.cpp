@@ -0,0 +1,216 @@
+#include "book.hpp"
+#include "book_database.hpp"
+#include "filters.hpp"
+#include "statsistics.hpp"
+#include "zone_map.hpp"
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <deque>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace bookdb;
+
+using TestContainer = BookDatabase<std::deque<Book>>;
+
+// Обход неконстантной базы только читает книги, поэтому не помечает производные структуры устаревшими
+static_assert(std::same_as<decltype(std::declval<TestContainer &>().begin()), TestContainer::const_iterator>);
+
+namespace {
+
+// Результат по зонам должен совпадать с полным сканированием книг
+template <typename Pred>
+void expectSameAsScan(const TestContainer &db, Pred pred) {
+    auto zoned = filterBooks(db, pred);
+    auto scanned = filterBooks(db.cbegin(), db.cend(), pred);
+    ASSERT_EQ(zoned.size(), scanned.size());
+    EXPECT_TRUE(std::ranges::equal(zoned, scanned, [](const Book &lhs, const Book &rhs) { return &lhs == &rhs; }));
+
+    std::vector<Book> matched(scanned.begin(), scanned.end());
+    const auto ratings = calculateGenreRatings(db, pred);
+    const auto expected = calculateGenreRatings(matched.cbegin(), matched.cend());
+    ASSERT_EQ(ratings.size(), expected.size());
+    for (const auto &[genre, avg] : expected) {
+        EXPECT_NEAR(ratings.at(genre), avg, 1e-9);
+    }
+    EXPECT_NEAR(calculateAverageRating(db, pred), calculateAverageRating(matched.cbegin(), matched.cend()), 1e-9);
+}
+
+}  // namespace
+
+// ################ Карта зон ###################
+TEST(TestZoneStats, Bounds) {
+    ZoneStats zone;
+    zone.Add(Book{"Author", "Title", 1950, Genre::SciFi, 4.0, 10});
+    zone.Add(Book{"Author", "Title", 1900, Genre::SciFi, 3.5, 20});
+    EXPECT_EQ(zone.min_year, 1900);
+    EXPECT_EQ(zone.max_year, 1950);
+    EXPECT_DOUBLE_EQ(zone.min_rating, 3.5);
+    EXPECT_DOUBLE_EQ(zone.max_rating, 4.0);
+    EXPECT_EQ(zone.min_read_count, 10);
+    EXPECT_EQ(zone.max_read_count, 20);
+    EXPECT_TRUE(zone.OnlyGenre(Genre::SciFi));
+    EXPECT_EQ(zone.ratings[static_cast<size_t>(Genre::SciFi)].count, 2);
+
+    // Блок с NaN не может целиком проходить условие на рейтинг
+    zone.Add(Book{"Author", "Title", 1920, Genre::Fiction, std::numeric_limits<double>::quiet_NaN(), 0});
+    EXPECT_EQ(detail::zoneMatch(RatingAbove(1.0), zone), ZoneMatch::Partial);
+    EXPECT_FALSE(zone.OnlyGenre(Genre::SciFi));
+
+    zone.Remove(Book{"Author", "Title", 1920, Genre::Fiction, 0.0, 0});
+    EXPECT_TRUE(zone.OnlyGenre(Genre::SciFi));
+}
+
+TEST(TestZoneStats, RemoveDoesNotDrift) {
+    std::mt19937 gen{7};
+    ZoneStats zone;
+    zone.Add(Book{"Author", "Title", 1950, Genre::Fiction, 4.2, 10});
+    for (size_t i = 0; i < 200000; ++i) {
+        const double rating = static_cast<double>(gen() % 50) / 10.0 + static_cast<double>(gen() % 1000) * 1e-7;
+        const Book book{"Author", "Title", 1950, Genre::Fiction, rating, 10};
+        zone.Add(book);
+        zone.Remove(book);
+    }
+    const auto sum = zone.ratings[static_cast<size_t>(Genre::Fiction)].Value();
+    EXPECT_EQ(sum.count, 1);
+    EXPECT_DOUBLE_EQ(sum.sum, 4.2);
+}
+
+TEST(TestZoneStats, Match) {
+    ZoneStats zone;
+    zone.Add(Book{"Author", "Title", 1900, Genre::SciFi, 3.0, 0});
+    zone.Add(Book{"Author", "Title", 1950, Genre::SciFi, 4.0, 0});
+
+    EXPECT_EQ(detail::zoneMatch(YearBetween(1960, 2000), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch(YearBetween(1920, 2000), zone), ZoneMatch::Partial);
+    EXPECT_EQ(detail::zoneMatch(YearBetween(1900, 1951), zone), ZoneMatch::All);
+    EXPECT_EQ(detail::zoneMatch(RatingAbove(4.0), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch(RatingAbove(2.9), zone), ZoneMatch::All);
+    EXPECT_EQ(detail::zoneMatch(GenreIs("Fiction"), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch(GenreIs("SciFi"), zone), ZoneMatch::All);
+
+    EXPECT_EQ(detail::zoneMatch(all_of(GenreIs("SciFi"), RatingAbove(3.5)), zone), ZoneMatch::Partial);
+    EXPECT_EQ(detail::zoneMatch(all_of(GenreIs("Fiction"), RatingAbove(3.5)), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch(any_of(GenreIs("SciFi"), RatingAbove(3.5)), zone), ZoneMatch::All);
+    EXPECT_EQ(detail::zoneMatch(any_of(GenreIs("Fiction"), RatingAbove(4.5)), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch(all_of(), zone), ZoneMatch::All);
+    EXPECT_EQ(detail::zoneMatch(any_of(), zone), ZoneMatch::None);
+    EXPECT_EQ(detail::zoneMatch([](const Book &) { return false; }, zone), ZoneMatch::Partial);
+}
+
+// Книги добавляются в хронологическом порядке, поэтому годы соседних книг близки
+class TestZoneMapBookDatabase : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 gen{42};
+        for (size_t i = 0; i < 5 * ZoneMap::kZoneRows + 100; ++i) {
+            db.EmplaceBack("Author" + std::to_string(gen() % 50), "Title", 1800 + static_cast<int>(i / 100),
+                           static_cast<Genre>(gen() % kGenreCount), static_cast<double>(gen() % 50) / 10.0,
+                           static_cast<int>(gen() % 1000));
+        }
+        db.GetZoneMap().ResetCounters();
+    }
+
+    TestContainer db;
+};
+
+TEST_F(TestZoneMapBookDatabase, UpdatedOnAppend) {
+    const auto &zones = db.GetZoneMap();
+    ASSERT_EQ(zones.size(), 6);
+    EXPECT_EQ(zones[0].min_year, 1800);
+    EXPECT_EQ(zones[0].max_year, 1800 + (ZoneMap::kZoneRows - 1) / 100);
+    EXPECT_EQ(zones[5].max_year, db.back().year);
+
+    size_t count = 0;
+    for (size_t zone = 0; zone < zones.size(); ++zone) {
+        for (const auto &sum : zones[zone].ratings) {
+            count += sum.count;
+        }
+    }
+    EXPECT_EQ(count, db.size());
+}
+
+TEST_F(TestZoneMapBookDatabase, SkipsZones) {
+    expectSameAsScan(db, YearBetween(1900, 1910));
+    const auto counters = db.GetZoneMap().GetCounters();
+    EXPECT_GT(counters.skipped, 0);
+    EXPECT_LT(counters.scanned, db.GetZoneMap().size());
+}
+
+TEST_F(TestZoneMapBookDatabase, FullZones) {
+    expectSameAsScan(db, YearBetween(1800, 1900));
+    EXPECT_GT(db.GetZoneMap().GetCounters().full, 0);
+
+    db.GetZoneMap().ResetCounters();
+    expectSameAsScan(db, all_of(YearBetween(0, 3000), RatingAbove(-1.0)));
+    // Зоны проверяют filterBooks, calculateGenreRatings и calculateAverageRating
+    EXPECT_EQ(db.GetZoneMap().GetCounters().full, 3 * db.GetZoneMap().size());
+}
+
+TEST_F(TestZoneMapBookDatabase, Composite) {
+    expectSameAsScan(db, any_of(GenreIs("SciFi"), all_of(YearBetween(1900, 1999), RatingAbove(2.5))));
+    expectSameAsScan(db, all_of(GenreIs("Mystery"), any_of(YearBetween(1810, 1820), YearBetween(1990, 2000))));
+
+    // Собственная лямбда не проверяется по метаданным, все зоны сканируются (трижды, см. expectSameAsScan)
+    db.GetZoneMap().ResetCounters();
+    expectSameAsScan(db, [](const Book &book) { return book.year % 7 == 0; });
+    EXPECT_EQ(db.GetZoneMap().GetCounters().skipped, 0);
+    EXPECT_EQ(db.GetZoneMap().GetCounters().scanned, 3 * db.GetZoneMap().size());
+}
+
+TEST_F(TestZoneMapBookDatabase, ModifyAndIterators) {
+    db.Modify(0, [](Book &book) { book.year = 2100; });
+    expectSameAsScan(db, YearBetween(2100, 2101));
+    EXPECT_EQ(filterBooks(db, YearBetween(2100, 2101)).size(), 1);
+
+    // Изменяемый доступ через MutableRange(): карта зон перестраивается при следующем обращении
+    std::ranges::reverse(db.MutableRange());
+    expectSameAsScan(db, YearBetween(1900, 1910));
+    EXPECT_EQ(db.GetZoneMap()[db.GetZoneMap().size() - 1].max_year, 2100);
+
+    db.Clear();
+    EXPECT_TRUE(db.GetZoneMap().empty());
+    EXPECT_TRUE(filterBooks(db, YearBetween(1900, 1910)).empty());
+    EXPECT_EQ(calculateAverageRating(db, YearBetween(1900, 1910)), 0.0);
+}
+
+TEST_F(TestZoneMapBookDatabase, MutableRangeInvalidatesOnDestruction) {
+    // Запрос посреди изменений перестраивает карту зон, но последующая запись через тот же диапазон
+    // снова делает её устаревшей
+    {
+        auto books = db.MutableRange();
+        auto it = books.begin();
+        EXPECT_FALSE(db.GetZoneMap().empty());
+        it->year = 2100;
+    }
+    EXPECT_EQ(filterBooks(db, YearBetween(2100, 2101)).size(), 1);
+    expectSameAsScan(db, YearBetween(2100, 2101));
+}
+
+TEST_F(TestZoneMapBookDatabase, ConcurrentReadersRebuildOnce) {
+    // После изменяемого доступа карта зон устарела; первое обращение любого из читателей перестраивает её,
+    // остальные ждут на мьютексе и получают уже готовую карту
+    std::ranges::reverse(db.MutableRange());
+    const auto expected = filterBooks(db.cbegin(), db.cend(), YearBetween(1900, 1910)).size();
+
+    const TestContainer &reader = db;
+    std::vector<size_t> found(4);
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < found.size(); ++thread) {
+        threads.emplace_back([&, thread] {
+            for (size_t i = 0; i < 20; ++i) {
+                found[thread] = filterBooks(reader, YearBetween(1900, 1910)).size();
+            }
+        });
+    }
+    std::ranges::for_each(threads, [](std::thread &thread) { thread.join(); });
+
+    EXPECT_TRUE(std::ranges::all_of(found, [&](size_t count) { return count == expected; }));
+    EXPECT_EQ(reader.GetZoneMap().size(), 6);
+}
+// ################ Карта зон ###################